@@ -17,6 +17,37 @@ DEFINES+=OVERRIDE_SAPI_HCSR04_GPIO_IRQ
 # Use FreeRTOS
 USE_FREERTOS=y
 FREERTOS_HEAP_TYPE=1
+# O(1) malloc/free with fragmentation stats (MemMang/heap_tlsf.c)
+#FREERTOS_HEAP_TYPE=tlsf
+
+# Static allocation of every kernel object, no FreeRTOS heap
+# (see inc/FreeRTOSMemory.h and etc/mem-report)
+APP_STATIC_ALLOCATION=n
+ifeq ($(APP_STATIC_ALLOCATION),y)
+DEFINES+=APP_STATIC_ALLOCATION
+FREERTOS_HEAP_TYPE=
+endif
+
+# Step and servo PWM generation on the Cortex-M0APP core. Needs the
+# M0 image flashed to bank B (make -C app/m0 download)
+APP_DUAL_CORE=n
+ifeq ($(APP_DUAL_CORE),y)
+DEFINES+=APP_DUAL_CORE
+endif
+
+# Rotary encoder decoded by the QEI peripheral (phases on the QEI_PHA
+# and QEI_PHB pins, see inc/encoder.h) instead of one GPIO interrupt
+# per clock edge
+APP_ENCODER_QEI=n
+ifeq ($(APP_ENCODER_QEI),y)
+DEFINES+=APP_ENCODER_QEI
+endif
+
+# ISR to task latency tables (DWT cycle counter), dumped with ":L"
+APP_LATENCY=n
+ifeq ($(APP_LATENCY),y)
+DEFINES+=APP_LATENCY
+endif
 
 # Tell SAPI to use FreeRTOS SYSTICK
 DEFINES+=TICK_OVER_RTOS
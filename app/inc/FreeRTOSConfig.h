@@ -50,12 +50,19 @@ extern int DbgConsole_Printf( const char *fmt_s, ... );
 
 
 #define configSUPPORT_STATIC_ALLOCATION              1
+/* Sin heap de FreeRTOS en modo de asignación estática (ver FreeRTOSMemory.h) */
+#ifdef APP_STATIC_ALLOCATION
+#define configSUPPORT_DYNAMIC_ALLOCATION             0
+#else
+#define configSUPPORT_DYNAMIC_ALLOCATION             1
+#endif
 
 #define configUSE_PREEMPTION                         1
 #define configUSE_TIME_SLICING						1
 #define configUSE_IDLE_HOOK                          0
 #define configUSE_TICK_HOOK                          0
-#define configUSE_TICKLESS_IDLE                      0
+#define configUSE_TICKLESS_IDLE                      1
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP        2
 #define configUSE_DAEMON_TASK_STARTUP_HOOK           0
 #define configCPU_CLOCK_HZ                           ( SystemCoreClock )
 #define configTICK_RATE_HZ                           ( ( TickType_t ) 1000 ) // 1000 ticks per second => 1ms tick rate
@@ -81,6 +88,29 @@ extern int DbgConsole_Printf( const char *fmt_s, ... );
 // Add old API compatibility
 #define configENABLE_BACKWARD_COMPATIBILITY          1
 
+/* Tickless idle: el tick sólo se suprime sin movimientos en curso
+ * (ver power.h) */
+extern void vPowerSuppressTicksAndSleep( uint32_t xExpectedIdleTime );
+extern void vPortSuppressTicksAndSleep( uint32_t xExpectedIdleTime );
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) \
+	vPowerSuppressTicksAndSleep( xExpectedIdleTime )
+
+/* Tiempo de ejecución de cada tarea para el análisis de tiempo de
+ * respuesta (ver latency.h y etc/rta). Las macros se expanden dentro
+ * de tasks.c, donde pxCurrentTCB y pxReadyTasksLists son visibles:
+ * una tarea que sale de ejecución fuera de la lista de tareas listas
+ * terminó su activación (se bloqueó o suspendió) */
+#ifdef APP_LATENCY
+extern void vLatencyTaskSwitchedIn( void *pvTask, uint32_t ulTaskNumber );
+extern void vLatencyTaskSwitchedOut( uint32_t ulTaskNumber, uint32_t ulBlocked );
+#define traceTASK_SWITCHED_IN() \
+	vLatencyTaskSwitchedIn( pxCurrentTCB, pxCurrentTCB->uxTCBNumber )
+#define traceTASK_SWITCHED_OUT() \
+	vLatencyTaskSwitchedOut( pxCurrentTCB->uxTCBNumber, \
+		listLIST_ITEM_CONTAINER( &pxCurrentTCB->xStateListItem ) != \
+		&pxReadyTasksLists[ pxCurrentTCB->uxPriority ] )
+#endif
+
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                        0
 #define configMAX_CO_ROUTINE_PRIORITIES              ( 2 )
@@ -104,6 +134,7 @@ extern int DbgConsole_Printf( const char *fmt_s, ... );
 #define INCLUDE_vTaskDelayUntil                      1
 #define INCLUDE_vTaskDelay                           1
 #define INCLUDE_xTaskGetSchedulerState               1
+#define INCLUDE_xTaskGetCurrentTaskHandle            1
 #define INCLUDE_xTimerPendFunctionCall               1
 #define INCLUDE_xSemaphoreGetMutexHolder             1
 
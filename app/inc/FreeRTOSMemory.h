@@ -0,0 +1,114 @@
+/*! \file FreeRTOSMemory.h
+    \brief Tamaño de stack de las tareas, banco de SRAM y
+    presupuesto de memoria estática de cada módulo.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Con APP_STATIC_ALLOCATION definido (APP_STATIC_ALLOCATION=y en
+    config.mk) todas las tareas, colas, timers y grupos de eventos de
+    la aplicación se crean con las APIs *Static de FreeRTOS, sin heap.
+    Cada módulo agrupa su memoria en una única estructura ubicada en
+    el banco de SRAM indicado aquí (ver bancos en lpc_open/lib/mem.ld).
+*/
+
+#ifndef FREERTOSMEMORY_H_
+#define FREERTOSMEMORY_H_
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+
+/*! \def appUSE_STATIC_ALLOCATION
+	\brief Creación estática de todos los objetos del kernel.
+*/
+#ifdef APP_STATIC_ALLOCATION
+#define appUSE_STATIC_ALLOCATION	1
+#else
+#define appUSE_STATIC_ALLOCATION	0
+#endif
+
+/* Tamaño de stack de cada tarea (en palabras) */
+
+#define stackLedBlinkTask			( configMINIMAL_STACK_SIZE )
+
+#define stackAppSyncTask			( configMINIMAL_STACK_SIZE * 2 )
+
+#define stackStepperControlTask		( configMINIMAL_STACK_SIZE * 2 )
+#define stackServoControlTask		( configMINIMAL_STACK_SIZE * 2 )
+
+#define stackUartRxTask				( configMINIMAL_STACK_SIZE * 2 )
+#define stackUartTxTask				( configMINIMAL_STACK_SIZE * 2 )
+
+#define stackEncoderTask			( configMINIMAL_STACK_SIZE * 2 )
+
+#define stackDisplayTask			( configMINIMAL_STACK_SIZE * 2 )
+
+#define stackMonitorTask			( configMINIMAL_STACK_SIZE * 2 )
+
+#define stackDeferredTask			( configMINIMAL_STACK_SIZE * 4 )
+
+/* Bancos de SRAM del LPC4337. La SRAM local está en el bus
+ * del Cortex-M4 y es la más rápida, la SRAM AHB queda para
+ * objetos menos críticos (y a futuro DMA) */
+
+#define memBANK_LOCAL32		".bss.$RamLoc32"	/* .data, .bss y stack de main */
+#define memBANK_LOCAL40		".bss.$RamLoc40"
+#define memBANK_AHB32		".bss.$RamAHB32"
+#define memBANK_AHB16		".bss.$RamAHB16"
+/* RamAHB_ETB16 no se asigna: queda para el mailbox y la imagen del
+ * Cortex-M0APP (ver ipc_mailbox.h) */
+
+/* Banco asignado a cada módulo */
+
+#define memBANK_APP			memBANK_LOCAL40
+#define memBANK_UART		memBANK_LOCAL40
+#define memBANK_STEPPER		memBANK_LOCAL40
+#define memBANK_SERVO		memBANK_LOCAL40
+#define memBANK_ENCODER		memBANK_LOCAL40
+#define memBANK_DISPLAY		memBANK_AHB32
+#define memBANK_MONITOR		memBANK_AHB32
+#define memBANK_DEFERRED	memBANK_LOCAL40
+#define memBANK_I2C			memBANK_AHB32
+
+/* Presupuesto de memoria estática de cada módulo en bytes.
+ * Se verifica en tiempo de compilación */
+
+#define memBUDGET_APP		2048
+#define memBUDGET_UART		3072
+#define memBUDGET_STEPPER	2048
+#define memBUDGET_SERVO		1536
+#define memBUDGET_ENCODER	1536
+#define memBUDGET_DISPLAY	1024
+#define memBUDGET_MONITOR	1024
+#define memBUDGET_DEFERRED	2048
+#define memBUDGET_I2C		128
+
+/*! \def memPLACE( BANK )
+	\brief Ubicar un objeto estático en el banco de SRAM BANK.
+*/
+#define memPLACE( BANK )	__attribute__(( section( BANK ) ))
+
+/*! \var typedef struct xMemoryModule MemoryModule_t
+	\brief Memoria estática ocupada por un módulo.
+*/
+typedef struct xMemoryModule {
+	/* Nombre del módulo */
+	const char *pcName;
+	/* Banco de SRAM (memBANK_*) */
+	const char *pcBank;
+	/* Bytes ocupados */
+	size_t xSize;
+	/* Bytes presupuestados */
+	size_t xBudget;
+} MemoryModule_t;
+
+/*! \def memMODULE( xModule, pcName, BANK, BUDGET, xMemory )
+	\brief Registrar la memoria estática xMemory del módulo para el
+	reporte, verificando el presupuesto en tiempo de compilación.
+*/
+#define memMODULE( xModule, pcName, BANK, BUDGET, xMemory )						\
+	_Static_assert( sizeof( xMemory ) <= ( BUDGET ),								\
+		"Memoria estatica del modulo " pcName " fuera de presupuesto" );			\
+	const MemoryModule_t xModule = { pcName, BANK, sizeof( xMemory ), BUDGET }
+
+#endif /* FREERTOSMEMORY_H_ */
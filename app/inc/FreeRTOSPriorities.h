@@ -24,4 +24,8 @@
 
 #define priorityDisplayTask			( configMAX_PRIORITIES - 6 )
 
+#define priorityMonitorTask			( configMAX_PRIORITIES - 6 )
+
+#define priorityDeferredTask			( configMAX_PRIORITIES - 1 )
+
 #endif /* FREERTOSPRIORITIES_H_ */
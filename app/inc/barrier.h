@@ -0,0 +1,139 @@
+/*! \file barrier.h
+    \brief Barrera de finalización de N partes basada en
+    notificaciones de tarea.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Una tarea arma la barrera con vBarrierArm(), indica con
+    vBarrierExpect() qué partes debe esperar antes de iniciar su
+    trabajo y espera con ulBarrierWait() a que esas partes (timers,
+    ISR u otras tareas) indiquen su finalización con vBarrierArrive()
+    o vBarrierArriveFromISR(). Cada parte setea su bit en el valor de
+    notificación de la tarea que espera (eSetBits), por lo que, a
+    diferencia de un grupo de eventos, no se recorre ninguna lista de
+    espera con el scheduler suspendido ni hace falta diferir el
+    seteo al timer service desde una ISR.
+
+    Los bits de las partes ocupan el rango [uxFirstBit, uxFirstBit +
+    uxParties) del valor de notificación, de forma que la tarea
+    puede seguir usando el resto de los bits para otros fines. Se
+    registra para cada parte la cantidad de finalizaciones, el máximo
+    tiempo desde que se armó la barrera y cuántas veces no llegó
+    antes del timeout de la espera.
+*/
+
+#ifndef BARRIER_H_
+#define BARRIER_H_
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*! \def barrierMAX_PARTIES
+	\brief Cantidad máxima de partes de una barrera.
+*/
+#define barrierMAX_PARTIES		8
+
+/*! \def barrierBENCH_RUNS
+	\brief Cantidad de esperas de cada método en el comando ":B".
+*/
+#define barrierBENCH_RUNS		16
+
+/*! \def barrierBENCH_FIRST_BIT
+	\brief Bit de notificación de la parte de prueba del comando
+	":B", fuera de los bits de error de la tarea AppSync.
+*/
+#define barrierBENCH_FIRST_BIT	16
+
+/*! \var typedef struct xBarrierParty BarrierParty_t
+	\brief Registro de finalizaciones de una parte.
+*/
+typedef struct xBarrierParty {
+	/* Cantidad de finalizaciones */
+	volatile uint32_t ulArrivals;
+	/* Cantidad de esperas en que no llegó antes del timeout */
+	volatile uint32_t ulLate;
+	/* Máximo tiempo entre el armado y la finalización en ticks */
+	volatile TickType_t xMaxTicks;
+} BarrierParty_t;
+
+/*! \var typedef struct xBarrier Barrier_t
+	\brief Barrera de finalización de N partes.
+*/
+typedef struct xBarrier {
+	/* Tarea que espera la finalización */
+	volatile TaskHandle_t xWaiter;
+	/* Cantidad de partes */
+	UBaseType_t uxParties;
+	/* Primer bit del valor de notificación */
+	UBaseType_t uxFirstBit;
+	/* Bits de todas las partes */
+	uint32_t ulMask;
+	/* Bits de las partes esperadas en la espera actual */
+	uint32_t ulExpected;
+	/* Bits de las partes que finalizaron en la espera actual */
+	uint32_t ulArrived;
+	/* Instante de armado */
+	volatile TickType_t xArmTime;
+	/* Registro de cada parte */
+	BarrierParty_t pxParty[ barrierMAX_PARTIES ];
+} Barrier_t;
+
+/*! \fn void vBarrierInit( Barrier_t *pxBarrier, UBaseType_t uxParties, UBaseType_t uxFirstBit )
+	\brief Inicialización de la barrera.
+	\param pxBarrier Barrera a inicializar.
+	\param uxParties Cantidad de partes (hasta barrierMAX_PARTIES).
+	\param uxFirstBit Bit del valor de notificación de la parte 0.
+*/
+void vBarrierInit( Barrier_t *pxBarrier, UBaseType_t uxParties, UBaseType_t uxFirstBit );
+
+/*! \fn void vBarrierArm( Barrier_t *pxBarrier )
+	\brief Armar la barrera sin partes esperadas: la tarea que llama
+	queda como la que espera y se descartan finalizaciones previas.
+*/
+void vBarrierArm( Barrier_t *pxBarrier );
+
+/*! \fn void vBarrierExpect( Barrier_t *pxBarrier, UBaseType_t uxParty )
+	\brief Agregar la parte a la espera actual. Debe llamarse antes
+	de iniciar el trabajo de la parte.
+*/
+void vBarrierExpect( Barrier_t *pxBarrier, UBaseType_t uxParty );
+
+/*! \fn void vBarrierArrive( Barrier_t *pxBarrier, UBaseType_t uxParty )
+	\brief Indicar la finalización de la parte desde una tarea o
+	callback de timer.
+*/
+void vBarrierArrive( Barrier_t *pxBarrier, UBaseType_t uxParty );
+
+/*! \fn void vBarrierArriveFromISR( Barrier_t *pxBarrier, UBaseType_t uxParty, BaseType_t *pxHigherPriorityTaskWoken )
+	\brief Indicar la finalización de la parte desde una ISR.
+	\param pxHigherPriorityTaskWoken pdTRUE si se debe solicitar
+	cambio de contexto con portYIELD_FROM_ISR.
+*/
+void vBarrierArriveFromISR( Barrier_t *pxBarrier, UBaseType_t uxParty,
+	BaseType_t *pxHigherPriorityTaskWoken );
+
+/*! \fn uint32_t ulBarrierWait( Barrier_t *pxBarrier, TickType_t xTicksToWait )
+	\brief Esperar la finalización de las partes esperadas. Si se cumple
+	el timeout, las partes pendientes se cuentan como tardías y se
+	puede volver a esperar sin rearmar la barrera.
+	\param xTicksToWait Máximo tiempo a esperar bloqueado.
+	\return Partes pendientes (bit i para la parte i), 0 si
+	finalizaron todas las esperadas.
+*/
+uint32_t ulBarrierWait( Barrier_t *pxBarrier, TickType_t xTicksToWait );
+
+/*! \fn void vBarrierReport( Barrier_t *pxBarrier, const char *pcName )
+	\brief Imprimir el registro de cada parte.
+*/
+void vBarrierReport( Barrier_t *pxBarrier, const char *pcName );
+
+/*! \fn void vBarrierBenchmark( void )
+	\brief Comparar la latencia desde la finalización de una parte
+	hasta que la tarea que espera se ejecuta frente a un grupo de
+	eventos (comando ":B", con APP_LATENCY).
+*/
+void vBarrierBenchmark( void );
+
+#endif /* BARRIER_H_ */
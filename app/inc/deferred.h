@@ -0,0 +1,105 @@
+/*! \file deferred.h
+    \brief Servicio de procesamiento diferido de interrupciones en
+    lotes, con buffers circulares lock-free por prioridad.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Las ISR publican trabajos pequeños (función y dos parámetros,
+    igual que xTimerPendFunctionCallFromISR) con
+    xDeferredPostFromISR() en el buffer de la prioridad indicada. Una
+    única tarea los ejecuta en lotes: vacía primero el buffer de
+    mayor prioridad y sólo se notifica cuando un buffer pasa de vacío
+    a no vacío, de forma que una ráfaga de interrupciones cuesta una
+    única notificación y no ocupa la cola de comandos del timer
+    service (configTIMER_QUEUE_LENGTH) que usan los motores.
+
+    Cada buffer tiene un único productor lock-free: todas las ISR que
+    publican en un mismo buffer deben tener la misma prioridad NVIC,
+    ya que así no pueden interrumpirse entre sí.
+
+    Se registran profundidad máxima, trabajos publicados y
+    descartados por buffer lleno de cada prioridad, y el tamaño de
+    los lotes. El comando ":M" incluye estos contadores. Con
+    APP_LATENCY definido, el comando ":B" compara el costo de
+    publicación y la latencia hasta la ejecución frente a
+    xTimerPendFunctionCallFromISR, publicando en un buffer propio.
+*/
+
+#ifndef DEFERRED_H_
+#define DEFERRED_H_
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*! \def deferredRING_LENGTH
+	\brief Cantidad de trabajos de cada buffer (potencia de 2).
+*/
+#define deferredRING_LENGTH		8
+
+/*! \def deferredMEMORY_BARRIER()
+	\brief Barrera entre trabajo e índices (DMB en Cortex-M).
+*/
+#ifndef deferredMEMORY_BARRIER
+#define deferredMEMORY_BARRIER()	__asm volatile( "dmb" ::: "memory" )
+#endif
+
+/*! \def deferredBENCH_RUNS
+	\brief Cantidad de publicaciones de cada método en el comando ":B".
+*/
+#define deferredBENCH_RUNS		32
+
+/*! \var typedef enum eDeferredPriority DeferredPriority_t
+	\brief Prioridad del trabajo diferido. Cada prioridad tiene su
+	buffer y debe usarse desde ISR de una única prioridad NVIC.
+*/
+typedef enum eDeferredPriority {
+	/* Eventos de tiempo crítico */
+	deferredPRIORITY_HIGH = 0,
+	/* Entradas de usuario (pulsador del encoder) */
+	deferredPRIORITY_LOW,
+	deferredPRIORITY_NUM
+} DeferredPriority_t;
+
+/*! \var typedef void (*DeferredFunction_t)( void *pvParameter1, uint32_t ulParameter2 )
+	\brief Función a ejecutar en la tarea de procesamiento diferido.
+*/
+typedef void (*DeferredFunction_t)( void *pvParameter1, uint32_t ulParameter2 );
+
+/*! \fn BaseType_t xDeferredPostFromISR( DeferredPriority_t xPriority, DeferredFunction_t pxFunction, void *pvParameter1, uint32_t ulParameter2, BaseType_t *pxHigherPriorityTaskWoken )
+	\brief Publicar un trabajo desde una ISR.
+	\param xPriority Buffer en que se publica el trabajo.
+	\param pxFunction Función a ejecutar en la tarea.
+	\param pvParameter1 Primer parámetro de la función.
+	\param ulParameter2 Segundo parámetro de la función.
+	\param pxHigherPriorityTaskWoken pdTRUE si se debe solicitar
+	cambio de contexto con portYIELD_FROM_ISR.
+	\return pdPASS o pdFAIL si el buffer está lleno (el trabajo se
+	descarta y se cuenta).
+*/
+BaseType_t xDeferredPostFromISR( DeferredPriority_t xPriority,
+	DeferredFunction_t pxFunction, void *pvParameter1, uint32_t ulParameter2,
+	BaseType_t *pxHigherPriorityTaskWoken );
+
+/*! \fn void vDeferredReport( void )
+	\brief Imprimir los contadores de cada buffer y de los lotes.
+*/
+void vDeferredReport( void );
+
+/*! \fn void vDeferredBenchmark( void )
+	\brief Comparar publicación y latencia a la ejecución frente a
+	xTimerPendFunctionCallFromISR (comando ":B", con APP_LATENCY).
+	Debe llamarse desde una tarea de menor prioridad que la tarea del
+	módulo y el timer service.
+*/
+void vDeferredBenchmark( void );
+
+/*! \fn BaseType_t xDeferredInit( void )
+	\brief Inicialización de los buffers y la tarea de procesamiento
+	diferido. Debe llamarse antes que la inicialización de los
+	módulos que publican trabajos.
+*/
+BaseType_t xDeferredInit( void );
+
+#endif /* DEFERRED_H_ */
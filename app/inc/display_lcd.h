@@ -9,14 +9,44 @@
 #ifndef DISPLAY_LCD_H_
 #define DISPLAY_LCD_H_
 
+/*! \def displayREFRESH_PERIOD_MS
+	\brief Período de actualización del display durante un
+	movimiento.
+*/
+#define displayREFRESH_PERIOD_MS	100
+
+/*! \def displayCOLUMNS
+	\brief Cantidad de caracteres por línea del display.
+*/
+#define displayCOLUMNS		16
+
+/*! \def displayLINES
+	\brief Cantidad de líneas del display.
+*/
+#define displayLINES		2
+
+/*! \def displayVALUE_COLUMN
+	\brief Columna del valor del motor seleccionado en la línea 1.
+*/
+#define displayVALUE_COLUMN	11
+
 /*! \fn void vUpdateSelection( uint8_t cSelection )
 	\brief Actualizar selección en el displat LCD.
 	\param cSel Entero con el índice de la selección.
 */
 void vUpdateSelection( uint8_t cSelection );
 
+/*! \fn void vDisplayRefresh( void )
+	\brief Solicitar a la tarea del display que actualice el valor
+	mostrado.
+*/
+void vDisplayRefresh( void );
+
 /*! \fn void vDisplayTask( void *pvParameters )
-	\brief Tarea para control de display LCD.
+	\brief Tarea para control de display LCD. Mantiene una copia del
+	contenido del display y escribe sólo las celdas que cambian, ante
+	un cambio de selección o de valor y periódicamente durante un
+	movimiento.
 */
 void vDisplayTask( void *pvParameters );
 
@@ -14,6 +14,19 @@
 
 #define driverINPUT_NUM	4
 
+/*! \def driverBENCH_RUNS
+	\brief Cantidad de escrituras de cada método en el comando ":B".
+*/
+#define driverBENCH_RUNS	64
+
+/*! \def driverBENCH_PIN
+	\brief Pin de la comparación del comando ":B" (LEDB) y su puerto y
+	bit GPIO para GPIO_FAST_WRITE.
+*/
+#define driverBENCH_PIN		LEDB
+#define driverBENCH_PORT	5
+#define driverBENCH_BIT		2
+
 /*! \var typedef gpioMap_t DriverIn_t
 	\brief Tipo de dato entrada a driver.
 */
@@ -24,16 +37,24 @@ typedef gpioMap_t DriverIn_t;
 */
 extern DriverIn_t pxDriver[3][4];
 
-/*! \fn void vDriverUpdate( DriverIn_t *xDriverInput, uint8_t cState )
+/*! \fn void vDriverUpdate( const gpioMask_t *pxDriverMask, uint8_t cState )
     \brief Escritura en driver de motor stepper dado un determinado estado.
-    \param xDriverInput Arrays de entradas al driver a setear.
+    \param pxDriverMask Entradas al driver resueltas con vDriverInit().
     \param cState Estado a escribir en el driver.
 */
-void vDriverUpdate( DriverIn_t *xDriverInput, uint8_t cState );
+void vDriverUpdate( const gpioMask_t *pxDriverMask, uint8_t cState );
+
+/*! \fn void vDriverInit( DriverIn_t *xDriverInput, gpioMask_t *pxDriverMask, uint8_t cInputNum )
+	\brief Inicialización de driver de motor stepper. Configura las
+	entradas como salidas y las agrupa por puerto (gpioMaskInit) para
+	que cada paso cambie todas las entradas a la vez.
+*/
+void vDriverInit( DriverIn_t *xDriverInput, gpioMask_t *pxDriverMask, uint8_t cInputNum );
 
-/*! \fn void vDriverInit( void )
-	\brief Inicialización de driver de motor stepper.
+/*! \fn void vDriverBenchmark( void )
+	\brief Comparar el costo en ciclos de gpioWrite, gpioToggle y de
+	sus versiones resueltas (comando ":B", con APP_LATENCY).
 */
-void vDriverInit( DriverIn_t *xDriverInput, uint8_t cInputNum );
+void vDriverBenchmark( void );
 
 #endif /* DRIVER_ULN2003_H_ */
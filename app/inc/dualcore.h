@@ -0,0 +1,80 @@
+/*! \file dualcore.h
+    \brief Arranque del Cortex-M0APP y comunicación con su motor
+    de pasos y PWM a través del mailbox compartido.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Con APP_DUAL_CORE definido (APP_DUAL_CORE=y en config.mk) y una
+    imagen válida del M0 en flash banco B (make -C app/m0 download),
+    los pasos de los motores y el duty del servo los genera el M0 y
+    el M4 no atiende interrupciones por paso. Si no hay imagen del M0
+    la aplicación sigue funcionando con los timers del M4.
+*/
+
+#ifndef DUALCORE_H_
+#define DUALCORE_H_
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+
+/* EDU-CIAA firmware_v3 includes */
+#include "sapi.h"
+
+/* Aplicación includes */
+#include "ipc_mailbox.h"
+
+/*! \def appUSE_DUAL_CORE
+	\brief Motor de pasos y PWM en el Cortex-M0APP.
+*/
+#ifdef APP_DUAL_CORE
+#define appUSE_DUAL_CORE	1
+#else
+#define appUSE_DUAL_CORE	0
+#endif
+
+/*! \def dualTICK_RATE_HZ
+	\brief Frecuencia de tick del motor de pasos del M0. Los
+	períodos de paso se expresan en estos ticks.
+*/
+#define dualTICK_RATE_HZ	1000
+
+/*! \def dualSTART_TIMEOUT
+	\brief Iteraciones de espera a que el M0 indique que está listo.
+*/
+#define dualSTART_TIMEOUT	1000000UL
+
+/*! \fn void vDualCoreSetStepperPins( uint8_t ucStepperIndex, const gpioMap_t *pxDriverInput, gpioMap_t xLed )
+	\brief Cargar en la configuración del mailbox los pines del
+	driver (ipcSTEPPER_INPUTS entradas) y LED de un motor. Llamar
+	para cada motor antes de xDualCoreInit().
+*/
+void vDualCoreSetStepperPins( uint8_t ucStepperIndex, const gpioMap_t *pxDriverInput,
+	gpioMap_t xLed );
+
+/*! \fn BaseType_t xDualCoreInit( void )
+	\brief Cargar la configuración en el mailbox y liberar el M0.
+	Debe llamarse luego de inicializar los drivers de los motores y
+	el SCT, y antes de iniciar el scheduler.
+	\return pdPASS si el M0 está en funcionamiento, pdFAIL si no hay
+	imagen válida o no respondió.
+*/
+BaseType_t xDualCoreInit( void );
+
+/*! \fn BaseType_t xDualCoreRunning( void )
+	\brief Consultar si el M0 está generando los pasos.
+*/
+BaseType_t xDualCoreRunning( void );
+
+/*! \fn void vDualCoreSendCommand( const IpcCommand_t *pxCommand )
+	\brief Enviar un comando al M0 (desde tareas). Si el buffer de
+	comandos está lleno espera un tick y reintenta.
+*/
+void vDualCoreSendCommand( const IpcCommand_t *pxCommand );
+
+/*! \fn uint32_t ulDualCoreGetPendingSteps( uint8_t ucStepperIndex )
+	\brief Pasos pendientes del motor publicados por el M0.
+*/
+uint32_t ulDualCoreGetPendingSteps( uint8_t ucStepperIndex );
+
+#endif /* DUALCORE_H_ */
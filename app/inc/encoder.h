@@ -10,6 +10,15 @@
     - De SCU: SCU_PORT, SCU_PIN, SCU_FUNC
     - De GPIO: GPIO_PORT, GPIO_PIN
 
+    Con APP_ENCODER_QEI definido (APP_ENCODER_QEI=y en config.mk) las
+    fases A y B del encoder se decodifican con el periférico QEI: la
+    posición se lee de su registro y se genera una
+    única interrupción cada vez que la posición se aleja
+    encoderQEI_THRESHOLD cuentas de la última procesada, por lo que
+    la carga de interrupciones no depende de la velocidad de giro.
+    Sin APP_ENCODER_QEI cada flanco de clock genera una interrupción
+    y la dirección se lee del pin DT.
+
 */
 
 #ifndef ENCODER_H_
@@ -19,16 +28,46 @@
 #include "FreeRTOS.h"
 #include "queue.h"
 
+/*! \def appUSE_ENCODER_QEI
+	\brief Decodificación en cuadratura con el periférico QEI.
+*/
+#ifdef APP_ENCODER_QEI
+#define appUSE_ENCODER_QEI	1
+#else
+#define appUSE_ENCODER_QEI	0
+#endif
+
 /*! \def encoderMAX_CLK_PULSES
-	\brief Cantidad máxima de pulsos admitidos por la aplicación.
+	\brief Cantidad máxima de pulsos pendientes admitidos por la
+	aplicación (tamaño del buffer circular, potencia de 2).
+*/
+#define encoderMAX_CLK_PULSES	128
+
+/*! \def encoderMSG_LENGTH
+	\brief Longitud del mensaje de consigna generado por el encoder
+	(no mayor a uartLINE_LENGTH).
 */
-#define encoderMAX_CLK_PULSES	100
+#define encoderMSG_LENGTH	10
 
 /*! \def encoderSTEP_TO_SEND
 	\brief Cantidad de pasos a enviar con cada pulso de encoder.
 */
 #define encoderANGLE_TO_SEND	15
 
+/*! \def encoderJOG_WINDOW_MS
+	\brief Ventana de acumulación de pulsos desde el primero. Los
+	pulsos de la ventana generan una única consigna, con un
+	desplazamiento por pulso que crece con la cantidad de pulsos
+	(curva de aceleración en encoder.c).
+*/
+#define encoderJOG_WINDOW_MS	50
+
+/*! \def encoderJOG_MAX_ANGLE
+	\brief Máximo ángulo de una consigna del encoder al motor paso a
+	paso.
+*/
+#define encoderJOG_MAX_ANGLE	360
+
 /*! \def encoderPIN_SW
 	\brief Conexión pin switch de encoder rotativo.
 */
@@ -77,6 +116,37 @@
 #define PININT1_NVIC_NAME     PIN_INT1_IRQn      // GPIO interrupt NVIC interrupt name
 
 
+/* Fases del encoder en las entradas QEI_PHA y QEI_PHB (PA_3 y PA_2,
+ * función 1). El pin index no se usa */
+#define encoderQEI_PHA_SCU_PORT		0xA
+#define encoderQEI_PHA_SCU_PIN		3
+#define encoderQEI_PHB_SCU_PORT		0xA
+#define encoderQEI_PHB_SCU_PIN		2
+#define encoderQEI_SCU_FUNC			SCU_MODE_FUNC1
+
+/*! \def encoderQEI_COUNTS_PER_DETENT
+	\brief Cuentas del QEI (flancos de ambas fases) por cada
+	posición de reposo del encoder, equivalente a un pulso de clock.
+*/
+#define encoderQEI_COUNTS_PER_DETENT	4
+
+/*! \def encoderQEI_THRESHOLD
+	\brief Cuentas de distancia a la última posición procesada que
+	generan la interrupción. Debe ser múltiplo de
+	encoderQEI_COUNTS_PER_DETENT.
+*/
+#define encoderQEI_THRESHOLD		encoderQEI_COUNTS_PER_DETENT
+
+/*! \def encoderQEI_FILTER_CYCLES
+	\brief Filtro digital de las fases: se descartan pulsos más
+	cortos que esta cantidad de ciclos de reloj del periférico.
+*/
+#define encoderQEI_FILTER_CYCLES	2048
+
+#if ( encoderQEI_THRESHOLD % encoderQEI_COUNTS_PER_DETENT ) != 0
+#error "encoderQEI_THRESHOLD debe ser multiplo de encoderQEI_COUNTS_PER_DETENT"
+#endif
+
 /*! \var QueueHandle_t xEncoderChoiceMailbox
 	\brief Mailbox con la selección actual de motor mediante
 	pulsador de encoder.
@@ -0,0 +1,77 @@
+/*! \file i2c_bus.h
+    \brief Acceso compartido de las tareas al bus I2C0 sobre la cola
+    de transacciones por interrupción de sapi_i2c.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Cada transacción (escritura, lectura o escritura seguida de
+    lectura con start repetido) se encola con i2cTransactionStart() y
+    la tarea queda bloqueada en una barrera de una parte hasta que la
+    interrupción del bus indica su finalización. Un mutex recursivo
+    ordena el acceso de las tareas y permite agrupar varias
+    transacciones de un mismo dispositivo con xI2cBusTake() y
+    vI2cBusGive(). Los drivers de sAPI (i2cRead() e i2cWrite()) pasan
+    por el mismo mutex y la misma espera bloqueada en lugar de
+    esperar activamente el estado de la transacción.
+
+    Las transacciones que se inician desde una ISR (expansor del LCD)
+    comparten la misma cola sin tomar el mutex. El comando ":M"
+    incluye transacciones, errores, bytes, profundidad máxima de la
+    cola y ocupación del bus desde el reporte anterior.
+*/
+
+#ifndef I2C_BUS_H_
+#define I2C_BUS_H_
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*! \def i2cbusRATE
+	\brief Velocidad del bus si no lo inicializó antes otro módulo.
+*/
+#define i2cbusRATE			100000
+
+/*! \def i2cbusNOTIFY_BIT
+	\brief Bit del valor de notificación de la tarea que espera una
+	transacción, fuera de los bits de la barrera de los servos y del
+	comando ":B".
+*/
+#define i2cbusNOTIFY_BIT	24
+
+/*! \fn BaseType_t xI2cBusTake( TickType_t xTicksToWait )
+	\brief Tomar el bus para una secuencia de transacciones.
+	\return pdPASS o pdFAIL si se cumple el timeout.
+*/
+BaseType_t xI2cBusTake( TickType_t xTicksToWait );
+
+/*! \fn void vI2cBusGive( void )
+	\brief Liberar el bus tomado con xI2cBusTake().
+*/
+void vI2cBusGive( void );
+
+/*! \fn BaseType_t xI2cBusTransfer( uint8_t ucAddress, const uint8_t *pucTx, uint16_t usTxSize, uint8_t *pucRx, uint16_t usRxSize, TickType_t xTicksToWait )
+	\brief Escribir usTxSize bytes y luego, con start repetido, leer
+	usRxSize bytes. Cualquiera de los dos tamaños puede ser 0.
+	\param ucAddress Dirección de 7 bits del dispositivo.
+	\param xTicksToWait Máximo tiempo a esperar el bus y la
+	transacción. Si se cumple, la transacción se cancela.
+	\return pdPASS o pdFAIL por timeout, NAK o error de bus.
+*/
+BaseType_t xI2cBusTransfer( uint8_t ucAddress, const uint8_t *pucTx, uint16_t usTxSize,
+	uint8_t *pucRx, uint16_t usRxSize, TickType_t xTicksToWait );
+
+/*! \fn void vI2cBusReport( void )
+	\brief Imprimir los contadores del bus y de la espera de las
+	tareas.
+*/
+void vI2cBusReport( void );
+
+/*! \fn BaseType_t xI2cBusInit( void )
+	\brief Inicialización del bus por interrupción y del mutex. Debe
+	llamarse antes que la inicialización de los módulos que lo usan.
+*/
+BaseType_t xI2cBusInit( void );
+
+#endif /* I2C_BUS_H_ */
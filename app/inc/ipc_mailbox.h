@@ -0,0 +1,214 @@
+/*! \file ipc_mailbox.h
+    \brief Mailbox en SRAM compartida entre el Cortex-M4
+    (FreeRTOS) y el Cortex-M0APP (motor de pasos y PWM).
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Archivo compartido por ambos núcleos: no depende de FreeRTOS ni
+    de sAPI. El mailbox contiene dos buffers circulares de un
+    productor y un consumidor (comandos M4 -> M0 y eventos M0 -> M4)
+    más el estado que publica el M0. Cada índice lo escribe un único
+    núcleo y los datos se ordenan con barreras de memoria, por lo que
+    no hace falta exclusión mutua entre núcleos. Luego de escribir,
+    el productor genera un evento entre núcleos (SEV) que dispara la
+    interrupción M0APP_IRQn en el M4 o M4_IRQn en el M0.
+
+    Mapa de memoria en modo de doble núcleo:
+    - 0x1B000000 (flash banco B): imagen del M0 (ver app/m0).
+    - 0x2000C000 (RamAHB_ETB16): mailbox (ipcMAILBOX_SIZE bytes).
+    - Resto de RamAHB_ETB16: datos y stack del M0.
+*/
+
+#ifndef IPC_MAILBOX_H_
+#define IPC_MAILBOX_H_
+
+#include <stdint.h>
+
+/*! \def ipcM0_IMAGE_ADDR
+	\brief Dirección de la imagen del M0 (flash banco B).
+*/
+#define ipcM0_IMAGE_ADDR		0x1B000000UL
+
+/*! \def ipcMAILBOX_ADDR
+	\brief Dirección del mailbox (inicio de RamAHB_ETB16).
+*/
+#define ipcMAILBOX_ADDR			0x2000C000UL
+
+/*! \def ipcMAILBOX_SIZE
+	\brief Espacio reservado para el mailbox en bytes.
+*/
+#define ipcMAILBOX_SIZE			0x400UL
+
+/*! \def ipcM0_RAM_ADDR
+	\brief Inicio de la RAM del M0, a continuación del mailbox.
+*/
+#define ipcM0_RAM_ADDR			( ipcMAILBOX_ADDR + ipcMAILBOX_SIZE )
+
+/*! \def ipcM0_RAM_TOP
+	\brief Fin de la RAM del M0 (fin de RamAHB_ETB16).
+*/
+#define ipcM0_RAM_TOP			0x20010000UL
+
+/*! \def ipcMAILBOX
+	\brief Puntero al mailbox compartido.
+*/
+#define ipcMAILBOX				( ( IpcMailbox_t * ) ipcMAILBOX_ADDR )
+
+/*! \def ipcMAGIC_READY
+	\brief Valor que escribe el M0 en ulReady al terminar su
+	inicialización.
+*/
+#define ipcMAGIC_READY			0x4D30524EUL
+
+/*! \def ipcSTEPPER_NUM
+	\brief Cantidad de motores paso a paso manejados por el M0.
+*/
+#define ipcSTEPPER_NUM			3
+
+/*! \def ipcSTEPPER_INPUTS
+	\brief Entradas de driver (ULN2003) por motor.
+*/
+#define ipcSTEPPER_INPUTS		4
+
+/*! \def ipcRING_LENGTH
+	\brief Longitud de los buffers de comandos y eventos
+	(potencia de 2).
+*/
+#define ipcRING_LENGTH			16
+
+/*! \def ipcMEMORY_BARRIER()
+	\brief Barrera entre datos e índices. Puede redefinirse para
+	compilar el protocolo fuera del microcontrolador.
+*/
+#ifndef ipcMEMORY_BARRIER
+#define ipcMEMORY_BARRIER()		__asm volatile( "dmb" ::: "memory" )
+#endif
+
+/*! \def ipcSIGNAL()
+	\brief Evento al otro núcleo (TXEV).
+*/
+#ifndef ipcSIGNAL
+#define ipcSIGNAL()				__asm volatile( "dsb\n\tsev" ::: "memory" )
+#endif
+
+/* Comandos M4 -> M0 */
+
+/*! \def ipcCMD_STEPPER_MOVE
+	\brief Mover ulValue pasos el motor ucChannel en dirección ucDir,
+	un paso cada ucPeriod ticks del M0.
+*/
+#define ipcCMD_STEPPER_MOVE		1
+/*! \def ipcCMD_STEPPER_STOP
+	\brief Descartar los pasos pendientes del motor ucChannel.
+*/
+#define ipcCMD_STEPPER_STOP		2
+/*! \def ipcCMD_SERVO_SET
+	\brief Escribir ulValue ticks en el match ucChannel del SCT.
+*/
+#define ipcCMD_SERVO_SET		3
+
+/* Eventos M0 -> M4 */
+
+/*! \def ipcEVT_STEPPER_DONE
+	\brief El motor ucChannel completó sus pasos pendientes.
+*/
+#define ipcEVT_STEPPER_DONE		1
+
+/*! \var typedef struct xIpcCommand IpcCommand_t
+	\brief Comando del M4 al M0.
+*/
+typedef struct xIpcCommand {
+	uint8_t ucType;
+	uint8_t ucChannel;
+	uint8_t ucDir;
+	uint8_t ucPeriod;
+	uint32_t ulValue;
+} IpcCommand_t;
+
+/*! \var typedef struct xIpcEvent IpcEvent_t
+	\brief Evento del M0 al M4.
+*/
+typedef struct xIpcEvent {
+	uint8_t ucType;
+	uint8_t ucChannel;
+	uint16_t usReserved;
+	uint32_t ulValue;
+} IpcEvent_t;
+
+/*! \var typedef struct xIpcConfig IpcConfig_t
+	\brief Configuración que escribe el M4 antes de liberar el M0.
+*/
+typedef struct xIpcConfig {
+	/* Puerto y pin GPIO de cada entrada de driver */
+	uint8_t pucDriverPort[ipcSTEPPER_NUM][ipcSTEPPER_INPUTS];
+	uint8_t pucDriverPin[ipcSTEPPER_NUM][ipcSTEPPER_INPUTS];
+	/* Puerto y pin GPIO del LED indicador de cada motor */
+	uint8_t pucLedPort[ipcSTEPPER_NUM];
+	uint8_t pucLedPin[ipcSTEPPER_NUM];
+	/* Frecuencia de clock del RITimer en Hz */
+	uint32_t ulTimerClockHz;
+	/* Frecuencia de tick del motor de pasos en Hz */
+	uint32_t ulTickRateHz;
+} IpcConfig_t;
+
+/*! \var typedef struct xIpcMailbox IpcMailbox_t
+	\brief Mailbox compartido.
+*/
+typedef struct xIpcMailbox {
+	/* ipcMAGIC_READY cuando el M0 está en funcionamiento */
+	volatile uint32_t ulReady;
+	/* Configuración (sólo lectura para el M0) */
+	IpcConfig_t xConfig;
+	/* Comandos: ulCommandHead lo escribe el M4, ulCommandTail el M0 */
+	volatile uint32_t ulCommandHead;
+	volatile uint32_t ulCommandTail;
+	IpcCommand_t pxCommand[ipcRING_LENGTH];
+	/* Eventos: ulEventHead lo escribe el M0, ulEventTail el M4 */
+	volatile uint32_t ulEventHead;
+	volatile uint32_t ulEventTail;
+	IpcEvent_t pxEvent[ipcRING_LENGTH];
+	/* Eventos descartados por buffer lleno (escribe el M0) */
+	volatile uint32_t ulEventDropped;
+	/* Pasos pendientes de cada motor (escribe el M0) */
+	volatile uint32_t pulPendingSteps[ipcSTEPPER_NUM];
+	/* Ticks del motor de pasos (escribe el M0) */
+	volatile uint32_t ulTicks;
+} IpcMailbox_t;
+
+_Static_assert( sizeof( IpcMailbox_t ) <= ipcMAILBOX_SIZE,
+	"Mailbox fuera del espacio reservado" );
+_Static_assert( ( ipcRING_LENGTH & ( ipcRING_LENGTH - 1 ) ) == 0,
+	"ipcRING_LENGTH debe ser potencia de 2" );
+
+/*! \fn void vIpcMailboxInit( IpcMailbox_t *pxMailbox )
+	\brief Inicialización del mailbox (M4, antes de liberar el M0).
+	No modifica la configuración.
+*/
+void vIpcMailboxInit( IpcMailbox_t *pxMailbox );
+
+/*! \fn int32_t lIpcCommandPut( IpcMailbox_t *pxMailbox, const IpcCommand_t *pxCommand )
+	\brief Escribir un comando (M4, único productor).
+	\return 1 si se escribió, 0 si el buffer está lleno.
+*/
+int32_t lIpcCommandPut( IpcMailbox_t *pxMailbox, const IpcCommand_t *pxCommand );
+
+/*! \fn int32_t lIpcCommandGet( IpcMailbox_t *pxMailbox, IpcCommand_t *pxCommand )
+	\brief Leer un comando (M0, único consumidor).
+	\return 1 si se leyó, 0 si el buffer está vacío.
+*/
+int32_t lIpcCommandGet( IpcMailbox_t *pxMailbox, IpcCommand_t *pxCommand );
+
+/*! \fn int32_t lIpcEventPut( IpcMailbox_t *pxMailbox, const IpcEvent_t *pxEvent )
+	\brief Escribir un evento (M0, único productor).
+	\return 1 si se escribió, 0 si el buffer está lleno.
+*/
+int32_t lIpcEventPut( IpcMailbox_t *pxMailbox, const IpcEvent_t *pxEvent );
+
+/*! \fn int32_t lIpcEventGet( IpcMailbox_t *pxMailbox, IpcEvent_t *pxEvent )
+	\brief Leer un evento (M4, único consumidor).
+	\return 1 si se leyó, 0 si el buffer está vacío.
+*/
+int32_t lIpcEventGet( IpcMailbox_t *pxMailbox, IpcEvent_t *pxEvent );
+
+#endif /* IPC_MAILBOX_H_ */
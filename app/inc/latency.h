@@ -0,0 +1,169 @@
+/*! \file latency.h
+    \brief Medición de latencia de interrupción a tarea con el
+    contador de ciclos DWT y un pin GPIO marcador.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Con APP_LATENCY definido (APP_LATENCY=y en config.mk) cada fuente
+    de interrupción instrumentada registra tres instantes con
+    DWT->CYCCNT: entrada a la ISR, portYIELD_FROM_ISR y ejecución de
+    la tarea que consume el dato. Se acumulan mínimo, promedio y
+    máximo de la ISR (entrada a yield) y de la latencia total
+    (entrada a tarea), más un histograma de la latencia total en
+    potencias de 2 de ciclos. La latencia total se mide desde la
+    primera interrupción no atendida por la tarea, por lo que incluye
+    el tiempo que los datos esperan en el buffer. El pin
+    latencyGPIO_MARKER queda en alto entre ambos instantes (mientras
+    alguna fuente tenga una interrupción no atendida) para medirlo con
+    osciloscopio. El comando ":L" imprime y reinicia las
+    tablas.
+
+    Además, con los hooks de trace del kernel (FreeRTOSConfig.h) se
+    mide el tiempo de ejecución de cada activación de cada tarea
+    (desde que entra en ejecución hasta que se bloquea, descontando
+    las expropiaciones) y el mínimo tiempo entre activaciones. El
+    reporte ":L" incluye estas mediciones en el formato que lee la
+    herramienta de análisis de tiempo de respuesta etc/rta.
+
+    Sin APP_LATENCY las macros de instrumentación no generan código.
+    latencyTIMESTAMP() y las macros del pin pueden redefinirse para
+    compilar el módulo fuera del microcontrolador.
+*/
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+
+/*! \def appUSE_LATENCY
+	\brief Instrumentación de latencia de interrupción a tarea.
+*/
+#ifdef APP_LATENCY
+#define appUSE_LATENCY		1
+#else
+#define appUSE_LATENCY		0
+#endif
+
+/*! \def latencyHIST_BINS
+	\brief Cantidad de intervalos del histograma. El último acumula
+	todas las latencias mayores.
+*/
+#define latencyHIST_BINS		12
+
+/*! \def latencyHIST_FIRST_BIT
+	\brief El primer intervalo del histograma acumula las latencias
+	menores a 2^(latencyHIST_FIRST_BIT + 1) ciclos.
+*/
+#define latencyHIST_FIRST_BIT	6
+
+/*! \def latencyMAX_TASKS
+	\brief Cantidad máxima de tareas medidas (por número de TCB).
+*/
+#define latencyMAX_TASKS		16
+
+/*! \def latencyGPIO_MARKER
+	\brief Pin marcador: alto desde la interrupción hasta que la
+	tarea la atiende.
+*/
+#define latencyGPIO_MARKER		LEDG
+
+/*! \def latencyTIMESTAMP()
+	\brief Instante actual en ciclos de CPU.
+*/
+#ifndef latencyTIMESTAMP
+#define latencyTIMESTAMP()		( DWT->CYCCNT )
+#endif
+
+/*! \def latencyMARKER_SET()
+	\brief Pin marcador en alto.
+*/
+#ifndef latencyMARKER_SET
+#define latencyMARKER_SET()		gpioWrite( latencyGPIO_MARKER, ON )
+#endif
+
+/*! \def latencyMARKER_CLEAR()
+	\brief Pin marcador en bajo.
+*/
+#ifndef latencyMARKER_CLEAR
+#define latencyMARKER_CLEAR()	gpioWrite( latencyGPIO_MARKER, OFF )
+#endif
+
+/*! \var typedef enum eLatencySource LatencySource_t
+	\brief Fuentes de interrupción instrumentadas.
+*/
+typedef enum eLatencySource {
+	/* Pin clock o QEI del encoder (vEncoderCLK_IRQ_HANDLER o
+	 * QEI_IRQHandler -> vEncoderTask) */
+	latencySRC_ENCODER = 0,
+	/* Recepción UART (vUartRxISR -> vUartRxTask) */
+	latencySRC_UART_RX,
+	latencySRC_NUM
+} LatencySource_t;
+
+#if ( appUSE_LATENCY == 1 )
+
+/*! \def latencyISR_ENTRY( xSource )
+	\brief Marcar la entrada a la ISR de la fuente.
+*/
+#define latencyISR_ENTRY( xSource )		vLatencyIsrEntry( xSource )
+
+/*! \def latencyISR_YIELD( xSource )
+	\brief Marcar el fin de la ISR (antes de portYIELD_FROM_ISR).
+*/
+#define latencyISR_YIELD( xSource )		vLatencyIsrYield( xSource )
+
+/*! \def latencyTASK_RESUME( xSource )
+	\brief Marcar que la tarea consumidora de la fuente está en
+	ejecución (al desbloquearse).
+*/
+#define latencyTASK_RESUME( xSource )	vLatencyTaskResume( xSource )
+
+/*! \fn void vLatencyIsrEntry( LatencySource_t xSource )
+	\brief Registrar la entrada a la ISR de la fuente.
+*/
+void vLatencyIsrEntry( LatencySource_t xSource );
+
+/*! \fn void vLatencyIsrYield( LatencySource_t xSource )
+	\brief Registrar el fin de la ISR de la fuente.
+*/
+void vLatencyIsrYield( LatencySource_t xSource );
+
+/*! \fn void vLatencyTaskResume( LatencySource_t xSource )
+	\brief Registrar la ejecución de la tarea consumidora.
+*/
+void vLatencyTaskResume( LatencySource_t xSource );
+
+/*! \fn void vLatencyTaskSwitchedIn( void *pvTask, uint32_t ulTaskNumber )
+	\brief Hook traceTASK_SWITCHED_IN: la tarea entra en ejecución.
+*/
+void vLatencyTaskSwitchedIn( void *pvTask, uint32_t ulTaskNumber );
+
+/*! \fn void vLatencyTaskSwitchedOut( uint32_t ulTaskNumber, uint32_t ulBlocked )
+	\brief Hook traceTASK_SWITCHED_OUT: la tarea sale de ejecución,
+	terminando su activación si ulBlocked es distinto de cero.
+*/
+void vLatencyTaskSwitchedOut( uint32_t ulTaskNumber, uint32_t ulBlocked );
+
+/*! \fn void vLatencyReport( void )
+	\brief Imprimir las tablas de latencia de cada fuente y
+	reiniciarlas (comando ":L").
+*/
+void vLatencyReport( void );
+
+/*! \fn void vLatencyInit( void )
+	\brief Habilitar el contador de ciclos y el pin marcador. Debe
+	llamarse antes de habilitar las interrupciones instrumentadas.
+*/
+void vLatencyInit( void );
+
+#else
+
+#define latencyISR_ENTRY( xSource )
+#define latencyISR_YIELD( xSource )
+#define latencyTASK_RESUME( xSource )
+
+#endif /* appUSE_LATENCY */
+
+#endif /* LATENCY_H_ */
@@ -0,0 +1,111 @@
+/*! \file lcd_hd44780.h
+    \brief Driver no bloqueante del display LCD HD44780, con
+    conexión directa de 4 bits o mediante el expansor I2C PCF8574T.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Las escrituras se agregan a un buffer circular de comandos y
+    retornan sin esperar al display. La secuencia de nibbles y
+    pulsos de enable la avanza la interrupción de un timer de
+    hardware (lcdTIMER), que además respeta el tiempo de ejecución
+    de cada comando, por lo que ninguna tarea queda esperando con
+    demoras activas como en sapi_lcd.c.
+
+    Con LCD_HD44780_I2C_PCF8574T definido (app/config.mk) cada
+    comando son cuatro bytes del expansor (nibble alto y bajo, con y
+    sin enable) y los comandos pendientes se envían en lotes de una
+    única transacción de la cola I2C de sapi_i2c, compartida con las
+    tareas (i2c_bus.h), sin cambios para el usuario del driver.
+
+    El buffer tiene un único productor: todas las escrituras deben
+    hacerse desde una misma tarea (la tarea del display).
+*/
+
+#ifndef LCD_HD44780_H_
+#define LCD_HD44780_H_
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*! \def lcdQUEUE_LENGTH
+	\brief Cantidad de comandos del buffer (potencia de 2). Alcanza
+	para la inicialización y un display 16x2 completo.
+*/
+#define lcdQUEUE_LENGTH		64
+
+/*! \def lcdTIMER
+	\brief Timer de sapi_timer.h que avanza la secuencia, con su
+	periférico, interrupción y reloj.
+*/
+#define lcdTIMER			TIMER1
+#define lcdTIMER_BASE		LPC_TIMER1
+#define lcdTIMER_IRQ		TIMER1_IRQn
+#define lcdTIMER_CLOCK		CLK_MX_TIMER1
+
+/*! \def lcdSTARTUP_MS
+	\brief Espera desde la alimentación hasta el primer comando.
+*/
+#define lcdSTARTUP_MS		50
+
+/*! \def lcdEN_PULSE_US
+	\brief Ancho del pulso de enable y de su tiempo en bajo.
+*/
+#define lcdEN_PULSE_US		1
+
+/*! \def lcdEXEC_US
+	\brief Tiempo de ejecución de un comando o dato (37 us).
+*/
+#define lcdEXEC_US			50
+
+/*! \def lcdLONG_EXEC_US
+	\brief Tiempo de ejecución de clear y return home (1,52 ms).
+*/
+#define lcdLONG_EXEC_US		2000
+
+/*! \def lcdI2C_RATE
+	\brief Velocidad del bus I2C con el expansor PCF8574T, si no lo
+	inicializó antes i2c_bus.c.
+*/
+#define lcdI2C_RATE			100000
+
+/*! \def lcdI2C_ADDRESS
+	\brief Dirección del expansor PCF8574T (A2-A0 en alto).
+*/
+#define lcdI2C_ADDRESS		0x27
+
+/*! \def lcdI2C_BATCH
+	\brief Máxima cantidad de comandos de una transferencia I2C.
+*/
+#define lcdI2C_BATCH		8
+
+/*! \fn BaseType_t xLcdInit( void )
+	\brief Inicialización del timer (y del bus I2C con el expansor) y
+	encolado de la secuencia de inicialización del display en modo
+	4 bits: display encendido sin cursor, borrado y cursor en 0, 0.
+	La secuencia se ejecuta una vez iniciado el scheduler.
+*/
+BaseType_t xLcdInit( void );
+
+/*! \fn void vLcdCommand( uint8_t ucCommand )
+	\brief Encolar un comando.
+*/
+void vLcdCommand( uint8_t ucCommand );
+
+/*! \fn void vLcdData( uint8_t ucData )
+	\brief Encolar un caracter en la posición del cursor.
+*/
+void vLcdData( uint8_t ucData );
+
+/*! \fn void vLcdGoToXY( uint8_t x, uint8_t y )
+	\brief Encolar el cambio de posición del cursor.
+*/
+void vLcdGoToXY( uint8_t x, uint8_t y );
+
+/*! \fn void vLcdClear( void )
+	\brief Encolar el borrado del display.
+*/
+void vLcdClear( void );
+
+#endif /* LCD_HD44780_H_ */
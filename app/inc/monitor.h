@@ -0,0 +1,58 @@
+/*! \file monitor.h
+    \brief Tarea de monitoreo de stack de las tareas y heap de
+    FreeRTOS, con reporte de tamaño de stack recomendado.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    La tarea muestrea la marca de agua (mínimo espacio libre
+    histórico) del stack de cada tarea y el espacio libre del heap,
+    y guarda los mínimos. Muestrea periódicamente sólo durante los
+    movimientos (power.h); en reposo, al comenzar y terminar cada
+    movimiento y antes de cada reporte. Si una tarea queda por
+    debajo de monitorSTACK_WARNING_WORDS se avisa por UART una
+    única vez. El comando ":M" solicita el reporte con el stack
+    recomendado para cada tarea.
+*/
+
+#ifndef MONITOR_H_
+#define MONITOR_H_
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+
+/*! \def monitorPERIOD_MS
+	\brief Período de muestreo en milisegundos durante los
+	movimientos.
+*/
+#define monitorPERIOD_MS			1000
+
+/*! \def monitorMAX_TASKS
+	\brief Cantidad máxima de tareas monitoreadas.
+*/
+#define monitorMAX_TASKS			16
+
+/*! \def monitorSTACK_WARNING_WORDS
+	\brief Espacio libre de stack (en palabras) por debajo del
+	cual se avisa riesgo de overflow.
+*/
+#define monitorSTACK_WARNING_WORDS	16
+
+/*! \def monitorSTACK_MARGIN_WORDS
+	\brief Margen (en palabras) que se suma al máximo uso de stack
+	observado para obtener el tamaño recomendado.
+*/
+#define monitorSTACK_MARGIN_WORDS	32
+
+/*! \fn void vMonitorRequestReport( void )
+	\brief Solicitar a la tarea de monitoreo el reporte de stack y
+	heap (comando ":M").
+*/
+void vMonitorRequestReport( void );
+
+/*! \fn BaseType_t xMonitorInit( void )
+	\brief Inicialización de la tarea de monitoreo.
+*/
+BaseType_t xMonitorInit( void );
+
+#endif /* MONITOR_H_ */
@@ -0,0 +1,64 @@
+/*! \file power.h
+    \brief Tickless idle con tick activo sólo durante movimientos
+    de los motores.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Con configUSE_TICKLESS_IDLE la tarea idle detiene el tick del
+    kernel cuando no hay tareas listas hasta el próximo timeout, y
+    el SysTick reprogramado despierta al procesador. Mientras haya
+    un movimiento en curso (vPowerMotionBegin() sin su
+    vPowerMotionEnd()) el tick no se suprime, de forma que los timers
+    de los motores no sufren la corrección de tick al salir del modo
+    de bajo consumo; en ese caso la tarea idle duerme con WFI hasta
+    la próxima interrupción. Las tareas registradas con
+    vPowerRegisterMotionListener() se notifican al iniciar y terminar
+    el movimiento, para que solo despierten periódicamente durante
+    el mismo.
+*/
+
+#ifndef POWER_H_
+#define POWER_H_
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*! \def powerMAX_LISTENERS
+	\brief Cantidad máxima de tareas notificadas en los cambios de
+	estado de movimiento.
+*/
+#define powerMAX_LISTENERS		4
+
+/*! \fn void vPowerMotionBegin( void )
+	\brief Indicar el inicio de un movimiento (mantiene el tick).
+*/
+void vPowerMotionBegin( void );
+
+/*! \fn void vPowerMotionEnd( void )
+	\brief Indicar el fin de un movimiento iniciado con
+	vPowerMotionBegin().
+*/
+void vPowerMotionEnd( void );
+
+/*! \fn BaseType_t xPowerMotionActive( void )
+	\brief Consultar si hay algún movimiento en curso.
+*/
+BaseType_t xPowerMotionActive( void );
+
+/*! \fn void vPowerRegisterMotionListener( TaskHandle_t xTask )
+	\brief Registrar una tarea a notificar (xTaskNotifyGive) cuando
+	comienza o termina el movimiento. Llamar antes de iniciar el
+	scheduler.
+*/
+void vPowerRegisterMotionListener( TaskHandle_t xTask );
+
+/*! \fn void vPowerSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+	\brief Implementación de portSUPPRESS_TICKS_AND_SLEEP: suprime el
+	tick sólo si no hay movimiento en curso. Durante el movimiento
+	duerme con WFI y el tick activo.
+*/
+void vPowerSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+
+#endif /* POWER_H_ */
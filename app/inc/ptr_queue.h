@@ -0,0 +1,163 @@
+/*! \file ptr_queue.h
+    \brief Cola de punteros por referencia (sin copia) para
+    los mensajes de la aplicación.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Las colas de FreeRTOS copian cada elemento con memcpy y un
+    tamaño genérico. Esta cola guarda directamente punteros en sus
+    posiciones, por lo que la escritura y lectura es la asignación
+    de una palabra dentro de una sección crítica. Las funciones de
+    envío y recepción mantienen la firma de sus equivalentes de
+    queue.h (el elemento se pasa por referencia), y se agregan
+    variantes que escriben o leen N punteros en una misma sección
+    crítica.
+
+    El bloqueo se implementa con dos semáforos binarios que sólo se
+    señalizan en las transiciones vacía -> no vacía y llena -> no
+    llena, de modo que una cola con lugar y un consumidor activo no
+    agrega llamadas al kernel.
+*/
+
+#ifndef PTR_QUEUE_H_
+#define PTR_QUEUE_H_
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/*! \def ptrqueueBENCH_RUNS
+	\brief Cantidad de llenados y vaciados por cola en la comparación
+	del comando ":B".
+*/
+#define ptrqueueBENCH_RUNS		16
+
+/*! \def ptrqueueBENCH_MAX_LENGTH
+	\brief Longitud de la cola más larga comparada (xUartTxQueue).
+*/
+#define ptrqueueBENCH_MAX_LENGTH	100
+
+/*! \var typedef struct xPtrQueue PtrQueue_t
+	\brief Cola de punteros.
+*/
+typedef struct xPtrQueue {
+	/* Posiciones de la cola */
+	void **ppvStorage;
+	/* Cantidad de posiciones */
+	UBaseType_t uxLength;
+	/* Índice del próximo elemento a leer */
+	UBaseType_t uxReadIndex;
+	/* Cantidad de elementos en la cola */
+	UBaseType_t uxMessagesWaiting;
+	/* Señal de cola no vacía para los consumidores */
+	SemaphoreHandle_t xItemsAvailable;
+	/* Señal de cola no llena para los productores */
+	SemaphoreHandle_t xSpaceAvailable;
+	StaticSemaphore_t xItemsAvailableBuffer;
+	StaticSemaphore_t xSpaceAvailableBuffer;
+} PtrQueue_t;
+
+/*! \var typedef PtrQueue_t StaticPtrQueue_t
+	\brief Memoria de una cola de punteros creada en forma estática.
+*/
+typedef PtrQueue_t StaticPtrQueue_t;
+
+/*! \var typedef PtrQueue_t * PtrQueueHandle_t
+	\brief Handle de una cola de punteros.
+*/
+typedef PtrQueue_t * PtrQueueHandle_t;
+
+/*! \fn PtrQueueHandle_t xPtrQueueCreateStatic( UBaseType_t uxLength, void **ppvStorage, StaticPtrQueue_t *pxStaticQueue )
+	\brief Creación de cola de punteros en memoria estática.
+	\param uxLength Cantidad de punteros que puede guardar la cola.
+	\param ppvStorage Arreglo de uxLength punteros.
+	\param pxStaticQueue Memoria de la estructura de la cola.
+	\return Handle de la cola creada.
+*/
+PtrQueueHandle_t xPtrQueueCreateStatic( UBaseType_t uxLength, void **ppvStorage,
+	StaticPtrQueue_t *pxStaticQueue );
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+/*! \fn PtrQueueHandle_t xPtrQueueCreate( UBaseType_t uxLength )
+	\brief Creación de cola de punteros en el heap de FreeRTOS.
+	\param uxLength Cantidad de punteros que puede guardar la cola.
+	\return Handle de la cola creada o NULL si no hay memoria.
+*/
+PtrQueueHandle_t xPtrQueueCreate( UBaseType_t uxLength );
+#endif
+
+/*! \fn BaseType_t xPtrQueueSendToBack( PtrQueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait )
+	\brief Escribir un puntero al final de la cola.
+	\param xQueue Handle de la cola.
+	\param pvItemToQueue Puntero al puntero a escribir (igual que
+	xQueueSendToBack).
+	\param xTicksToWait Máximo tiempo a esperar lugar en la cola.
+	\return pdPASS o errQUEUE_FULL.
+*/
+BaseType_t xPtrQueueSendToBack( PtrQueueHandle_t xQueue, const void *pvItemToQueue,
+	TickType_t xTicksToWait );
+
+/*! \fn BaseType_t xPtrQueueSendToBackFromISR( PtrQueueHandle_t xQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken )
+	\brief Escribir un puntero al final de la cola desde una ISR.
+	\return pdPASS o errQUEUE_FULL.
+*/
+BaseType_t xPtrQueueSendToBackFromISR( PtrQueueHandle_t xQueue, const void *pvItemToQueue,
+	BaseType_t *pxHigherPriorityTaskWoken );
+
+/*! \fn BaseType_t xPtrQueueReceive( PtrQueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait )
+	\brief Leer un puntero del inicio de la cola.
+	\param xQueue Handle de la cola.
+	\param pvBuffer Puntero a la variable donde guardar el puntero
+	leído (igual que xQueueReceive).
+	\param xTicksToWait Máximo tiempo a esperar un elemento.
+	\return pdPASS o errQUEUE_EMPTY.
+*/
+BaseType_t xPtrQueueReceive( PtrQueueHandle_t xQueue, void *pvBuffer,
+	TickType_t xTicksToWait );
+
+/*! \fn BaseType_t xPtrQueueReceiveFromISR( PtrQueueHandle_t xQueue, void *pvBuffer, BaseType_t *pxHigherPriorityTaskWoken )
+	\brief Leer un puntero del inicio de la cola desde una ISR.
+	\return pdPASS o errQUEUE_EMPTY.
+*/
+BaseType_t xPtrQueueReceiveFromISR( PtrQueueHandle_t xQueue, void *pvBuffer,
+	BaseType_t *pxHigherPriorityTaskWoken );
+
+/*! \fn UBaseType_t uxPtrQueueSendToBackBulk( PtrQueueHandle_t xQueue, void * const *ppvItems, UBaseType_t uxCount, TickType_t xTicksToWait )
+	\brief Escribir uxCount punteros al final de la cola. Se escriben
+	todos los que entran en una misma sección crítica y se espera
+	lugar para el resto.
+	\param ppvItems Arreglo de punteros a escribir.
+	\param uxCount Cantidad de punteros.
+	\param xTicksToWait Máximo tiempo a esperar lugar en la cola.
+	\return Cantidad de punteros escritos.
+*/
+UBaseType_t uxPtrQueueSendToBackBulk( PtrQueueHandle_t xQueue, void * const *ppvItems,
+	UBaseType_t uxCount, TickType_t xTicksToWait );
+
+/*! \fn UBaseType_t uxPtrQueueReceiveBulk( PtrQueueHandle_t xQueue, void **ppvItems, UBaseType_t uxMaxCount, TickType_t xTicksToWait )
+	\brief Leer hasta uxMaxCount punteros en una misma sección
+	crítica, esperando a que haya al menos uno.
+	\param ppvItems Arreglo donde guardar los punteros leídos.
+	\param uxMaxCount Máxima cantidad de punteros a leer.
+	\param xTicksToWait Máximo tiempo a esperar un elemento.
+	\return Cantidad de punteros leídos.
+*/
+UBaseType_t uxPtrQueueReceiveBulk( PtrQueueHandle_t xQueue, void **ppvItems,
+	UBaseType_t uxMaxCount, TickType_t xTicksToWait );
+
+/*! \fn UBaseType_t uxPtrQueueMessagesWaiting( PtrQueueHandle_t xQueue )
+	\brief Cantidad de punteros en la cola.
+*/
+UBaseType_t uxPtrQueueMessagesWaiting( PtrQueueHandle_t xQueue );
+
+/*! \fn void vPtrQueueBenchmark( void )
+	\brief Comparar el costo por mensaje frente a una cola de FreeRTOS
+	de punteros con las longitudes y lecturas de xMsgQueue,
+	xUartTxQueue y xStepperSetPointQueue (comando ":B", con
+	APP_LATENCY).
+*/
+void vPtrQueueBenchmark( void );
+
+#endif /* PTR_QUEUE_H_ */
@@ -4,62 +4,105 @@
     \author Gonzalo G. Fernández
     \version 1.0
     \date Julio 2020
+
+    Hasta servoMAX_CHANNELS servos comparten el SCT a 50 Hz: el match
+    0 define el frame y el match servoSCT_MATCH( ch ) termina el pulso
+    de cada canal. La tarea del servo escribe los pulsos en una tabla
+    sin bloqueo (vServoEngineBegin, vServoEngineWrite y
+    vServoEngineCommit) y la interrupción de fin de frame la copia a
+    los registros de recarga, que el SCT aplica a todos los canales a
+    la vez al inicio del frame siguiente. Cada canal llega a su
+    destino con una rampa trapezoidal de velocidad y aceleración
+    limitadas, avanzada un paso por frame en la misma interrupción,
+    que sólo está habilitada mientras hay una tabla pendiente o una
+    rampa en curso. El fin de cada rampa se indica a la tarea del
+    servo con una barrera (barrier.h), como en los motores paso a
+    paso.
 */
 
 #ifndef SERVO_H_
 #define SERVO_H_
 
-/*! \def servoANGLE_MIN
-	\brief Mínimo ángulo permitido.
+/* Aplicación includes */
+#include "servo_motion.h"
+
+/*! \def servoPULSE_MIN_US
+	\brief Pulso en us para menor posición (-90°) por defecto, hasta
+	calibrar con ":XC".
 */
-#define servoANGLE_MIN		0
-/*! \def servoANGLE_MAX
-	\brief Máximo ángulo permitido.
+#define servoPULSE_MIN_US	1000
+/*! \def servoPULSE_MAX_US
+	\brief Pulso en us para mayor posición (+90°) por defecto, hasta
+	calibrar con ":XC".
 */
-#define servoANGLE_MAX		180
+#define servoPULSE_MAX_US	2000
 
-/*! \def servoPWM_PERIOD
-	\brief Periodo PWM en ms.
+/*! \def servoPULSE_LIMIT_MIN_US
+	\brief Mínimo pulso admitido en la calibración.
+*/
+#define servoPULSE_LIMIT_MIN_US	400
+/*! \def servoPULSE_LIMIT_MAX_US
+	\brief Máximo pulso admitido en la calibración.
 */
-#define servoPWM_PERIOD		20
+#define servoPULSE_LIMIT_MAX_US	2600
 
-/*! \def servoPULSE_MIN
-	\brief Pulso en ms para menor posición (-90°).
+/*! \def servoVELOCITY_MAX_DPS
+	\brief Velocidad máxima por defecto en °/s, hasta cambiarla con
+	":XV".
 */
-#define servoPULSE_MIN		1
-/*! \def servoPULSE_MAX
-	\brief Pulso en ms para mayor posición (+90°).
+#define servoVELOCITY_MAX_DPS	180
+/*! \def servoACCEL_MAX_DPS2
+	\brief Aceleración máxima por defecto en °/s².
 */
-#define servoPULSE_MAX		2
+#define servoACCEL_MAX_DPS2		720
 
-/*! \def servoDUTYCYCLE_MIN
-	\brief Duty-cycle para posición -90°.
+/*! \def servoVELOCITY_LIMIT_DPS
+	\brief Máxima velocidad admitida con ":XV".
 */
-#define servoDUTYCYCLE_MIN	servoPULSE_MIN*100/servoPWM_PERIOD
+#define servoVELOCITY_LIMIT_DPS	1000
+/*! \def servoACCEL_LIMIT_DPS2
+	\brief Máxima aceleración admitida con ":XV".
+*/
+#define servoACCEL_LIMIT_DPS2	10000
 
-/*! \def servoDUTYCYCLE_MAX
-	\brief Duty-cycle para posición +90°.
+/*! \def servoDONE_MARGIN_MS
+	\brief Margen sobre la duración esperada de una rampa antes de
+	avisar que no finalizó (SRV:LATE).
 */
-#define servoDUTYCYCLE_MAX	servoPULSE_MAX*100/servoPWM_PERIOD
+#define servoDONE_MARGIN_MS		200
 
 /*! \def servoSCT_PWM
 	\brief Base del periférico SCT en el chip.
 */
 #define servoSCT_PWM			LPC_SCT
-/*! \def servoSCT_PWM_PIN_SERVO
-	\brief Pin de coneción del servo en COUT1 (TFIL_1 o SERVO0).
-*/
-#define servoSCT_PWM_PIN			1
-/*! \def servoSCT_PWM_INDEX
-	\brief Conexión en pin con index 2.
-*/
-#define servoSCT_PWM_INDEX		2
 
 /*! \def servoSCT_PWM_RATE
 	\brief Frecuencia del PWM en SCT (50Hz)
 */
 #define servoSCT_PWM_RATE		1000/servoPWM_PERIOD
 
+/*! \def servoMAX_CHANNELS
+	\brief Máxima cantidad de canales del SCT (match 1 a 8).
+*/
+#define servoMAX_CHANNELS		8
+
+/*! \def servoCHANNEL_NUM
+	\brief Cantidad de servos conectados. El pin de cada canal se
+	define en pxServoChannel (servo.c).
+*/
+#define servoCHANNEL_NUM		1
+
+/*! \def servoSCT_MATCH( ch )
+	\brief Match y evento del SCT que terminan el pulso del canal.
+	El match 0 define el período (frame) de todos los canales.
+*/
+#define servoSCT_MATCH( ch )	( ( ch ) + 1 )
+
+/*! \def servoSCT_PWM_PIN_SERVO
+	\brief Pin de coneción del servo en COUT1 (TFIL_1 o SERVO0).
+*/
+#define servoSCT_PWM_PIN			1
+
 /*!	\def servoSCU_PORT
 	\brief Puerto 4 de SCU
 */
@@ -79,11 +122,21 @@
 */
 #define servoERROR_NOTIF_ANG	5
 
+/*! \def servoERROR_NOTIF_CAL
+	\brief Bit de error de calibración del motor.
+*/
+#define servoERROR_NOTIF_CAL	6
+
+/*! \def servoERROR_NOTIF_ID
+	\brief Bit de error de canal del motor.
+*/
+#define servoERROR_NOTIF_ID		7
+
 /*! \def servoVALUE_INCREMENT
 	\brief Mínimo valor que provoca un incremento
 	en la posición del motor.
 */
-#define servoVALUE_INCRMENT	36
+#define servoVALUE_INCRMENT	5
 
 /*! \var QueueHandle_t xServoPositionMailbox
 	\brief Handle del mailbox que contendrá la posición
@@ -97,6 +150,55 @@ extern QueueHandle_t xServoPositionMailbox;
 */
 void vServoSendMsg( char *pcMsg);
 
+/*! \fn void vServoEngineBegin( void )
+	\brief Iniciar la escritura de la tabla de pulsos. Los canales
+	escritos hasta vServoEngineCommit() se aplican juntos en el mismo
+	frame. Sólo debe escribir la tabla la tarea del servo.
+*/
+void vServoEngineBegin( void );
+
+/*! \fn void vServoEngineWrite( uint8_t ucChannel, uint32_t ulTicks, uint32_t ulVelocity, uint32_t ulAccel )
+	\brief Escribir el pulso destino de un canal en ticks del SCT. La
+	interrupción de frame lleva el pulso al destino con una rampa
+	trapezoidal.
+	\param ulVelocity Velocidad máxima en ticks por frame, 0 para
+	saltar directamente al destino.
+	\param ulAccel Aceleración máxima en ticks por frame al cuadrado.
+*/
+void vServoEngineWrite( uint8_t ucChannel, uint32_t ulTicks,
+	uint32_t ulVelocity, uint32_t ulAccel );
+
+/*! \fn void vServoEngineCommit( void )
+	\brief Publicar la tabla: la interrupción del próximo frame la
+	copia a los registros de recarga del SCT, que toman efecto todos
+	en el inicio del frame siguiente.
+*/
+void vServoEngineCommit( void );
+
+/*! \fn void vServoReport( void )
+	\brief Imprimir los frames actualizados y los reintentos por
+	escritura de la tabla en curso.
+*/
+void vServoReport( void );
+
+/*! \fn BaseType_t xServoCalibrate( uint8_t ucChannel, uint32_t ulPulseMinUs, uint32_t ulPulseMaxUs )
+	\brief Cambiar los pulsos de 0° y 180° del canal y reposicionar el
+	servo en el ángulo actual (comando ":XC<min>,<max>[,<canal>]" en
+	us).
+	\return pdFAIL si los pulsos están fuera de
+	[servoPULSE_LIMIT_MIN_US, servoPULSE_LIMIT_MAX_US] o el mínimo no
+	es menor que el máximo.
+*/
+BaseType_t xServoCalibrate( uint8_t ucChannel, uint32_t ulPulseMinUs, uint32_t ulPulseMaxUs );
+
+/*! \fn BaseType_t xServoSetLimits( uint8_t ucChannel, uint32_t ulVelocityDps, uint32_t ulAccelDps2 )
+	\brief Cambiar la velocidad y aceleración máximas del canal para
+	las próximas consignas (comando ":XV<°/s>,<°/s²>[,<canal>]").
+	\return pdFAIL si algún límite es 0 o supera
+	servoVELOCITY_LIMIT_DPS o servoACCEL_LIMIT_DPS2.
+*/
+BaseType_t xServoSetLimits( uint8_t ucChannel, uint32_t ulVelocityDps, uint32_t ulAccelDps2 );
+
 /*! \fn BaseType_t xServoInit( void )
 	\brief Inicialización de módulo asociado a servomotor.
 */
@@ -0,0 +1,72 @@
+/*! \file servo_motion.h
+    \brief Cálculos del servomotor que no dependen del hardware:
+    ancho de pulso en ticks del SCT para un ángulo y rampa
+    trapezoidal de cada frame.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Separado de servo.c para compilarlo y probarlo en el host
+    (app/test/servo_motion).
+*/
+
+#ifndef SERVO_MOTION_H_
+#define SERVO_MOTION_H_
+
+#include <stdint.h>
+
+/* FreeRTOS.org includes. */
+#include "FreeRTOS.h"
+
+/*! \def servoANGLE_MIN
+	\brief Mínimo ángulo permitido.
+*/
+#define servoANGLE_MIN		0
+/*! \def servoANGLE_MAX
+	\brief Máximo ángulo permitido.
+*/
+#define servoANGLE_MAX		180
+
+/*! \def servoPWM_PERIOD
+	\brief Periodo PWM en ms.
+*/
+#define servoPWM_PERIOD		20
+
+/*! \fn uint32_t ulServoAngleToTicks( uint32_t ulAngle, uint32_t ulPulseMinUs, uint32_t ulPulseMaxUs, uint32_t ulTicksPerFrame )
+	\brief Ancho de pulso en ticks del SCT para un ángulo, por
+	interpolación lineal entre los pulsos de 0° y 180° y redondeo al
+	tick más cercano (sin cuantizar el ángulo).
+	\param ulAngle Ángulo entre servoANGLE_MIN y servoANGLE_MAX.
+	\param ulPulseMinUs Pulso en us para servoANGLE_MIN.
+	\param ulPulseMaxUs Pulso en us para servoANGLE_MAX.
+	\param ulTicksPerFrame Ticks del SCT en servoPWM_PERIOD.
+*/
+uint32_t ulServoAngleToTicks( uint32_t ulAngle, uint32_t ulPulseMinUs,
+	uint32_t ulPulseMaxUs, uint32_t ulTicksPerFrame );
+
+/*! \var typedef struct xServoRamp ServoRamp_t
+	\brief Estado de la rampa de un canal, sólo lo modifica la
+	interrupción de frame. Unidades: ticks del SCT, ticks por frame y
+	ticks por frame al cuadrado.
+*/
+typedef struct xServoRamp {
+	int32_t lPosition;
+	int32_t lVelocity;
+	int32_t lTarget;
+	int32_t lVelocityMax;
+	int32_t lAccel;
+	BaseType_t xActive;
+} ServoRamp_t;
+
+/*! \fn BaseType_t xServoRampStep( ServoRamp_t *pxRamp )
+	\brief Avanzar un frame la rampa trapezoidal del canal: frena si la
+	distancia de frenado alcanza la distancia al destino, si se mueve
+	en sentido contrario o si supera la velocidad máxima, y si no
+	acelera hasta la velocidad máxima. Con lVelocityMax o lAccel en 0
+	salta al destino.
+	\param pxRamp Rampa del canal.
+	\return pdTRUE al llegar al destino.
+*/
+BaseType_t xServoRampStep( ServoRamp_t *pxRamp );
+
+#endif /* SERVO_MOTION_H_ */
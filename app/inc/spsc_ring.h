@@ -0,0 +1,103 @@
+/*! \file spsc_ring.h
+    \brief Buffer circular de bytes lock-free para un único
+    productor (típicamente una ISR) y un único consumidor
+    (una tarea).
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Los índices avanzan libremente y sólo los escribe su dueño
+    (ulHead el productor, ulTail el consumidor), por lo que no hace
+    falta sección crítica: basta con lecturas/escrituras de 32 bits
+    y barreras de memoria. La tarea consumidora sólo se notifica
+    cuando el buffer pasa de vacío a no vacío, de manera que una
+    ráfaga de datos cuesta una única notificación.
+*/
+
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*! \def spscMEMORY_BARRIER()
+	\brief Barrera entre datos e índices (DMB en Cortex-M). Puede
+	redefinirse para compilar el buffer fuera del microcontrolador.
+*/
+#ifndef spscMEMORY_BARRIER
+#define spscMEMORY_BARRIER()	__asm volatile( "dmb" ::: "memory" )
+#endif
+
+/*! \var typedef struct xSpscRing SpscRing_t
+	\brief Buffer circular de un productor y un consumidor.
+*/
+typedef struct xSpscRing {
+	/* Memoria del buffer (tamaño potencia de 2) */
+	uint8_t *pucBuffer;
+	/* Tamaño del buffer menos uno */
+	uint32_t ulMask;
+	/* Índice de escritura, sólo lo modifica el productor */
+	volatile uint32_t ulHead;
+	/* Índice de lectura, sólo lo modifica el consumidor */
+	volatile uint32_t ulTail;
+	/* Tarea consumidora a notificar */
+	volatile TaskHandle_t xConsumer;
+	/* Cantidad de bytes descartados por buffer lleno */
+	volatile uint32_t ulDropped;
+} SpscRing_t;
+
+/*! \fn void vSpscRingInit( SpscRing_t *pxRing, uint8_t *pucBuffer, uint32_t ulSize )
+	\brief Inicialización del buffer circular.
+	\param pxRing Buffer circular a inicializar.
+	\param pucBuffer Memoria del buffer.
+	\param ulSize Tamaño de la memoria, debe ser potencia de 2.
+*/
+void vSpscRingInit( SpscRing_t *pxRing, uint8_t *pucBuffer, uint32_t ulSize );
+
+/*! \fn BaseType_t xSpscRingPutFromISR( SpscRing_t *pxRing, const uint8_t *pucData, uint32_t ulLength, BaseType_t *pxHigherPriorityTaskWoken )
+	\brief Escribir bytes desde el productor (ISR). Se escriben
+	todos o ninguno.
+	\param pxRing Buffer circular.
+	\param pucData Bytes a escribir.
+	\param ulLength Cantidad de bytes.
+	\param pxHigherPriorityTaskWoken pdTRUE si se debe solicitar
+	cambio de contexto con portYIELD_FROM_ISR.
+	\return pdPASS o pdFAIL si no hay espacio.
+*/
+BaseType_t xSpscRingPutFromISR( SpscRing_t *pxRing, const uint8_t *pucData,
+	uint32_t ulLength, BaseType_t *pxHigherPriorityTaskWoken );
+
+/*! \fn BaseType_t xSpscRingPut( SpscRing_t *pxRing, const uint8_t *pucData, uint32_t ulLength )
+	\brief Escribir bytes desde el productor (tarea). Se escriben
+	todos o ninguno.
+	\param pxRing Buffer circular.
+	\param pucData Bytes a escribir.
+	\param ulLength Cantidad de bytes.
+	\return pdPASS o pdFAIL si no hay espacio.
+*/
+BaseType_t xSpscRingPut( SpscRing_t *pxRing, const uint8_t *pucData, uint32_t ulLength );
+
+/*! \fn uint32_t ulSpscRingGet( SpscRing_t *pxRing, uint8_t *pucData, uint32_t ulMaxLength )
+	\brief Leer los bytes disponibles sin bloquear (consumidor).
+	\param pxRing Buffer circular.
+	\param pucData Destino de los bytes leídos.
+	\param ulMaxLength Máxima cantidad de bytes a leer.
+	\return Cantidad de bytes leídos.
+*/
+uint32_t ulSpscRingGet( SpscRing_t *pxRing, uint8_t *pucData, uint32_t ulMaxLength );
+
+/*! \fn uint32_t ulSpscRingReceive( SpscRing_t *pxRing, uint8_t *pucData, uint32_t ulMaxLength, TickType_t xTicksToWait )
+	\brief Leer bytes bloqueando hasta que haya al menos uno
+	(consumidor). La tarea que llama queda registrada como
+	consumidora y su notificación de tarea se usa como señal.
+	\param pxRing Buffer circular.
+	\param pucData Destino de los bytes leídos.
+	\param ulMaxLength Máxima cantidad de bytes a leer.
+	\param xTicksToWait Máximo tiempo a esperar bloqueado.
+	\return Cantidad de bytes leídos, 0 si se cumplió el tiempo.
+*/
+uint32_t ulSpscRingReceive( SpscRing_t *pxRing, uint8_t *pucData,
+	uint32_t ulMaxLength, TickType_t xTicksToWait );
+
+#endif /* SPSC_RING_H_ */
@@ -17,6 +17,18 @@
 */
 #define stepperAPP_NUM  3
 
+/*! \def stepperDONE_MARGIN_MS
+    \brief Margen sobre la duración esperada de una consigna
+    antes de avisar que un motor no la finalizó (SCT:LATE).
+*/
+#define stepperDONE_MARGIN_MS	500
+
+/*! \def stepperJOG_MSG_LENGTH
+    \brief Longitud del buffer de la consigna relativa pendiente de
+    cada motor (ver vStepperJog).
+*/
+#define stepperJOG_MSG_LENGTH	24
+
 /*! \def stepperTIMER_PERIOD
     \brief Periodo de pasos de los motores (velocidad del motor)
 */
@@ -80,15 +92,39 @@ typedef char StepperDir_t;
 */
 uint32_t ulStepperGetAngle( uint8_t ucStepperIndex );
 
+/*! \fn void vStepperDoneFromISR( uint8_t ucStepperIndex, BaseType_t *pxHigherPriorityTaskWoken )
+	\brief Indicar desde una ISR que el motor completó su consigna.
+	\param ucStepperIndex Índice del motor paso a paso.
+	\param pxHigherPriorityTaskWoken Igual que en las APIs FromISR.
+*/
+void vStepperDoneFromISR( uint8_t ucStepperIndex, BaseType_t *pxHigherPriorityTaskWoken );
+
 /*! \fn void vStepperSendMsg( char *pcMsg )
 	\brief Enviar consigna a cola de consignas pendientes.
 	\param pcMsg String con consigna a enviar.
 */
 void vStepperSendMsg( char *pcMsg );
 
+/*! \fn void vStepperJog( uint8_t ucStepperIndex, int32_t lAngle )
+	\brief Mover el motor lAngle grados relativos a la posición
+	actual (negativo en dirección stepperDIR_NEGATIVE). Si la consigna
+	relativa anterior del motor sigue en la cola se actualiza en el
+	lugar, sumando el ángulo (con el total limitado a
+	±encoderJOG_MAX_ANGLE), en lugar de encolar una nueva. Debe
+	llamarse siempre desde la misma tarea.
+	\param ucStepperIndex Índice del motor paso a paso.
+	\param lAngle Ángulo relativo en grados.
+*/
+void vStepperJog( uint8_t ucStepperIndex, int32_t lAngle );
+
 /*! \fn BaseType_t xStepperInit( void )
     \brief Inicialización de motores de la aplicación.
 */
 BaseType_t xStepperInit( void );
 
+/*! \fn void vStepperReport( void )
+	\brief Imprimir el registro de finalización de cada motor.
+*/
+void vStepperReport( void );
+
 #endif /* STEPPER_H_ */
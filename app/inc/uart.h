@@ -20,26 +20,67 @@
 /* EDU-CIAA firmware_v3 includes */
 #include "sapi.h"
 
-/*! \def uartQUEUE_RX_LENGTH
-	\brief Longitud de cola de recepción.
+/*! \def uartRING_RX_LENGTH
+	\brief Longitud del buffer circular de recepción (potencia de 2).
 */
-#define uartQUEUE_RX_LENGTH  100
+#define uartRING_RX_LENGTH  128
 
 /*! \def uartQUEUE_TX_LENGTH
 	\brief Longitud de cola de transmisión.
 */
 #define uartQUEUE_TX_LENGTH  100
 
+/*! \def uartTX_BATCH_LENGTH
+	\brief Máxima cantidad de mensajes que la tarea de transmisión
+	lee de la cola en una misma sección crítica.
+*/
+#define uartTX_BATCH_LENGTH  8
+
 /*! \def uartBUFFER_RX_LENGTH
 	\brief Tamaño de buffer de caracteres recibidos.
 */
 #define uartBUFFER_RX_LENGTH 50
 
+/*! \def uartLINE_LENGTH
+	\brief Tamaño de cada buffer de línea recibida, con lugar para
+	el sufijo " - error" que agrega la tarea de sincronización.
+*/
+#define uartLINE_LENGTH ( uartBUFFER_RX_LENGTH + 10 )
+
+/*! \def uartLINE_POOL_LENGTH
+	\brief Cantidad de líneas recibidas o tomadas con
+	pcUartAllocLine() que pueden estar en uso a la vez (en colas o
+	siendo procesadas).
+*/
+#define uartLINE_POOL_LENGTH 4
+
 /*! \fn void vUartSendMsg( char *pcMsg )
 	\brief Enviar mensaje a la cola de transmisión.
 */
 void vUartSendMsg( char *pcMsg );
 
+/*! \fn void vUartReleaseCmd( char *pcCmd )
+	\brief Devolver al pool una línea recibida por UART. Cualquier
+	otro puntero se ignora.
+*/
+void vUartReleaseCmd( char *pcCmd );
+
+/*! \fn char *pcUartAllocLine( TickType_t xTicksToWait )
+	\brief Tomar una línea libre del pool para un mensaje generado
+	por otro módulo. La libera quien la consume, igual que una línea
+	recibida (tarea de transmisión o pcUartTakeCmd).
+	\param xTicksToWait Máximo tiempo a esperar una línea libre.
+	\return Línea de uartLINE_LENGTH caracteres o NULL.
+*/
+char *pcUartAllocLine( TickType_t xTicksToWait );
+
+/*! \fn char *pcUartTakeCmd( char *pcCmd, char *pcBuffer )
+	\brief Si pcCmd es una línea del pool, copiarla en pcBuffer
+	(uartLINE_LENGTH) y liberarla.
+	\return Mensaje a procesar.
+*/
+char *pcUartTakeCmd( char *pcCmd, char *pcBuffer );
+
 /*! \fn BaseType_t uartAppInit(void)
 	\brief Inicialización de módulo UART con sus respectivas colas.
 */
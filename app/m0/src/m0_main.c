@@ -0,0 +1,264 @@
+/*! \file m0_main.c
+    \brief Motor de pasos y PWM del servo en el Cortex-M0APP.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Imagen independiente (sin FreeRTOS ni sAPI) que se ejecuta desde
+    flash banco B. El RITimer genera la base de tiempo de los pasos:
+    en cada tick se avanza la secuencia de medio paso de los motores
+    activos escribiendo directamente los registros GPIO. Los comandos
+    llegan del M4 por el mailbox (ipc_mailbox.h) y al completar una
+    consigna se publica un evento. Ambas interrupciones tienen la misma
+    prioridad, por lo que el estado de los motores no necesita
+    protección adicional.
+*/
+
+/* LPCOpen includes (sólo registros) */
+#include "chip.h"
+
+/* Aplicación includes */
+#include "ipc_mailbox.h"
+
+/*! \def m0DRIVER_STATES
+	\brief Cantidad de estados de la secuencia de medio paso.
+*/
+#define m0DRIVER_STATES		8
+
+/*! \def m0IRQ_PRIORITY
+	\brief Prioridad del RITimer y del evento del M4.
+*/
+#define m0IRQ_PRIORITY		1
+
+/*! \var typedef struct xM0Stepper M0Stepper_t
+	\brief Estado de un motor en el M0.
+*/
+typedef struct xM0Stepper {
+	/* Motor con pasos pendientes */
+	uint8_t ucActive;
+	/* Dirección de los pasos */
+	uint8_t ucDir;
+	/* Estado actual de entradas al driver */
+	uint8_t ucState;
+	/* Ticks entre pasos */
+	uint8_t ucPeriod;
+	/* Ticks restantes para el próximo paso */
+	uint8_t ucCount;
+	/* Pasos pendientes */
+	uint32_t ulPending;
+} M0Stepper_t;
+
+/*! \var uint8_t pucM0DriverSequence[m0DRIVER_STATES]
+	\brief Secuencia de medio paso, un bit por entrada del driver
+	(misma secuencia que vDriverUpdate()).
+*/
+static const uint8_t pucM0DriverSequence[m0DRIVER_STATES] = {
+	0x3, 0x2, 0x6, 0x4, 0xC, 0x8, 0x9, 0x1
+};
+
+/*! \var M0Stepper_t pxM0Stepper[ipcSTEPPER_NUM]
+	\brief Estado de los motores.
+*/
+static M0Stepper_t pxM0Stepper[ipcSTEPPER_NUM];
+
+/*! \fn static void prvM0GpioWrite( uint8_t ucPort, uint8_t ucPin, uint8_t ucValue )
+	\brief Escritura de un pin GPIO por su registro de byte.
+*/
+static inline void prvM0GpioWrite( uint8_t ucPort, uint8_t ucPin, uint8_t ucValue )
+{
+	LPC_GPIO_PORT->B[ucPort][ucPin] = ucValue;
+}
+
+/*! \fn static void prvM0DriverUpdate( uint8_t ucIndex )
+	\brief Escritura en driver del motor según su estado.
+*/
+static void prvM0DriverUpdate( uint8_t ucIndex )
+{
+	const IpcConfig_t *pxConfig = &ipcMAILBOX->xConfig;
+	uint8_t ucPattern = pucM0DriverSequence[pxM0Stepper[ucIndex].ucState];
+
+	for ( uint8_t i=0; i<ipcSTEPPER_INPUTS; i++ ) {
+		prvM0GpioWrite( pxConfig->pucDriverPort[ucIndex][i],
+			pxConfig->pucDriverPin[ucIndex][i], ( ucPattern >> i ) & 1 );
+	}
+}
+
+/*! \fn static void prvM0StepperDone( uint8_t ucIndex )
+	\brief Fin de consigna: apagar LED y avisar al M4.
+*/
+static void prvM0StepperDone( uint8_t ucIndex )
+{
+	const IpcConfig_t *pxConfig = &ipcMAILBOX->xConfig;
+	IpcEvent_t xEvent = { .ucType = ipcEVT_STEPPER_DONE, .ucChannel = ucIndex };
+
+	pxM0Stepper[ucIndex].ucActive = 0;
+	prvM0GpioWrite( pxConfig->pucLedPort[ucIndex], pxConfig->pucLedPin[ucIndex], 0 );
+	lIpcEventPut( ipcMAILBOX, &xEvent );
+}
+
+/*! \fn void RIT_IRQHandler( void )
+	\brief Tick del motor de pasos.
+*/
+void RIT_IRQHandler( void )
+{
+	M0Stepper_t *pxStepper;
+	uint32_t ulSignal = 0;
+
+	LPC_RITIMER->CTRL |= RIT_CTRL_INT;
+	ipcMAILBOX->ulTicks++;
+
+	for ( uint8_t i=0; i<ipcSTEPPER_NUM; i++ ) {
+		pxStepper = &pxM0Stepper[i];
+		if ( !pxStepper->ucActive || ( --pxStepper->ucCount > 0 ) ) {
+			continue;
+		}
+		pxStepper->ucCount = pxStepper->ucPeriod;
+
+		if ( pxStepper->ulPending == 0 ) {
+			prvM0StepperDone( i );
+			ulSignal = 1;
+			continue;
+		}
+
+		if ( pxStepper->ucDir == 0 ) {
+			pxStepper->ucState = ( pxStepper->ucState - 1 ) & ( m0DRIVER_STATES - 1 );
+		} else {
+			pxStepper->ucState = ( pxStepper->ucState + 1 ) & ( m0DRIVER_STATES - 1 );
+		}
+		prvM0DriverUpdate( i );
+
+		pxStepper->ulPending--;
+		ipcMAILBOX->pulPendingSteps[i] = pxStepper->ulPending;
+	}
+
+	if ( ulSignal ) {
+		ipcSIGNAL();
+	}
+}
+
+/*! \fn void M4_IRQHandler( void )
+	\brief Evento del M4: procesar los comandos pendientes.
+*/
+void M4_IRQHandler( void )
+{
+	const IpcConfig_t *pxConfig = &ipcMAILBOX->xConfig;
+	IpcCommand_t xCommand;
+	M0Stepper_t *pxStepper;
+
+	LPC_CREG->M4TXEVENT = 0;
+
+	while ( lIpcCommandGet( ipcMAILBOX, &xCommand ) ) {
+		switch ( xCommand.ucType ) {
+		case ipcCMD_STEPPER_MOVE:
+			if ( xCommand.ucChannel >= ipcSTEPPER_NUM ) {
+				break;
+			}
+			pxStepper = &pxM0Stepper[xCommand.ucChannel];
+			pxStepper->ucDir = xCommand.ucDir;
+			pxStepper->ucPeriod = ( xCommand.ucPeriod > 0 ) ? xCommand.ucPeriod : 1;
+			pxStepper->ucCount = pxStepper->ucPeriod;
+			pxStepper->ulPending = xCommand.ulValue;
+			pxStepper->ucActive = 1;
+			ipcMAILBOX->pulPendingSteps[xCommand.ucChannel] = xCommand.ulValue;
+			prvM0GpioWrite( pxConfig->pucLedPort[xCommand.ucChannel],
+				pxConfig->pucLedPin[xCommand.ucChannel], 1 );
+			break;
+
+		case ipcCMD_STEPPER_STOP:
+			if ( xCommand.ucChannel < ipcSTEPPER_NUM ) {
+				/* El evento de fin se publica en el próximo paso */
+				pxM0Stepper[xCommand.ucChannel].ulPending = 0;
+			}
+			break;
+
+		case ipcCMD_SERVO_SET:
+			LPC_SCT->MATCHREL[xCommand.ucChannel].U = xCommand.ulValue;
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+/*! \fn int main( void )
+	\brief Configuración del RITimer y espera de interrupciones.
+*/
+int main( void )
+{
+	const IpcConfig_t *pxConfig = &ipcMAILBOX->xConfig;
+
+	/* El M4 habilitó el clock del RITimer y cargó la configuración */
+	LPC_RITIMER->CTRL = 0;
+	LPC_RITIMER->COUNTER = 0;
+	LPC_RITIMER->MASK = 0;
+	LPC_RITIMER->COMPVAL = pxConfig->ulTimerClockHz / pxConfig->ulTickRateHz - 1;
+	LPC_RITIMER->CTRL = RIT_CTRL_INT | RIT_CTRL_ENCLR | RIT_CTRL_ENBR | RIT_CTRL_TEN;
+
+	NVIC_SetPriority( RITIMER_IRQn, m0IRQ_PRIORITY );
+	NVIC_SetPriority( M4_IRQn, m0IRQ_PRIORITY );
+	LPC_CREG->M4TXEVENT = 0;
+	NVIC_ClearPendingIRQ( M4_IRQn );
+	NVIC_EnableIRQ( RITIMER_IRQn );
+	NVIC_EnableIRQ( M4_IRQn );
+
+	/* Avisar al M4 que el motor está en funcionamiento */
+	ipcMEMORY_BARRIER();
+	ipcMAILBOX->ulReady = ipcMAGIC_READY;
+
+	for ( ;; ) {
+		__WFI();
+	}
+}
+
+/* Arranque de la imagen */
+
+extern uint32_t _etext, _sdata, _edata, _sbss, _ebss, _vStackTop;
+
+/*! \fn void Reset_Handler( void )
+	\brief Inicialización de .data y .bss y salto a main().
+*/
+void Reset_Handler( void )
+{
+	uint32_t *pulSrc = &_etext;
+	uint32_t *pulDst;
+
+	for ( pulDst = &_sdata; pulDst < &_edata; ) {
+		*pulDst++ = *pulSrc++;
+	}
+	for ( pulDst = &_sbss; pulDst < &_ebss; ) {
+		*pulDst++ = 0;
+	}
+	main();
+	for ( ;; );
+}
+
+/*! \fn void Default_Handler( void )
+	\brief Excepciones no esperadas.
+*/
+void Default_Handler( void )
+{
+	for ( ;; );
+}
+
+/*! \var pvM0Vectors
+	\brief Tabla de vectores del M0 (hasta RITIMER_IRQn).
+*/
+__attribute__ (( section( ".isr_vector" ), used ))
+static void ( * const pvM0Vectors[] )( void ) = {
+	( void ( * )( void ) ) &_vStackTop,
+	Reset_Handler,
+	Default_Handler,		/* NMI */
+	Default_Handler,		/* HardFault */
+	0, 0, 0, 0, 0, 0, 0,
+	Default_Handler,		/* SVCall */
+	0, 0,
+	Default_Handler,		/* PendSV */
+	Default_Handler,		/* SysTick */
+	Default_Handler,		/* 0 RTC */
+	M4_IRQHandler,			/* 1 M4 */
+	Default_Handler, Default_Handler, Default_Handler, Default_Handler,
+	Default_Handler, Default_Handler, Default_Handler, Default_Handler,
+	Default_Handler,		/* 10 SCT */
+	RIT_IRQHandler			/* 11 RITIMER */
+};
@@ -14,6 +14,7 @@
 #include "FreeRTOS.h"
 #include "FreeRTOSConfig.h"
 #include "FreeRTOSPriorities.h"
+#include "FreeRTOSMemory.h"
 #include "task.h"
 #include "queue.h"
 
@@ -26,6 +27,15 @@
 #include "stepper.h"
 #include "servo.h"
 #include "display_lcd.h"
+#include "monitor.h"
+#include "dualcore.h"
+#include "latency.h"
+#include "power.h"
+#include "deferred.h"
+#include "barrier.h"
+#include "ptr_queue.h"
+#include "driver_uln2003.h"
+#include "i2c_bus.h"
 
 /*! \def appQUEUE_MSG_LENGTH
 	\brief Longitud de cola de mensajes recibidos.
@@ -37,10 +47,65 @@
 */
 TaskHandle_t xAppSyncTaskHandle = NULL;
 
-/*! \var QueueHandle_t xMsgQueue
+/*! \var TaskHandle_t xLedBlinkTaskHandle
+	\brief Handle de la tarea de blink de LED.
+*/
+static TaskHandle_t xLedBlinkTaskHandle = NULL;
+
+/*! \var PtrQueueHandle_t xMsgQueue
     \brief Cola de mensajes recibidos.
 */
-QueueHandle_t xMsgQueue;
+PtrQueueHandle_t xMsgQueue;
+
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+/*! \var xAppMemory
+	\brief Memoria estática de tareas y cola de mensajes del módulo.
+*/
+static struct {
+	StaticTask_t xSyncTaskTCB;
+	StackType_t puxSyncTaskStack[ stackAppSyncTask ];
+	StaticTask_t xLedBlinkTaskTCB;
+	StackType_t puxLedBlinkTaskStack[ stackLedBlinkTask ];
+	StaticPtrQueue_t xMsgQueue;
+	void *pvMsgQueueStorage[ appQUEUE_MSG_LENGTH ];
+} xAppMemory memPLACE( memBANK_APP );
+
+memMODULE( xAppMemoryModule, "App", memBANK_APP, memBUDGET_APP, xAppMemory );
+
+extern const MemoryModule_t xUartMemoryModule;
+extern const MemoryModule_t xStepperMemoryModule;
+extern const MemoryModule_t xServoMemoryModule;
+extern const MemoryModule_t xDisplayMemoryModule;
+extern const MemoryModule_t xEncoderMemoryModule;
+extern const MemoryModule_t xMonitorMemoryModule;
+extern const MemoryModule_t xDeferredMemoryModule;
+extern const MemoryModule_t xI2cBusMemoryModule;
+
+/*! \var const MemoryModule_t *pxMemoryModules[]
+	\brief Memoria estática de cada módulo para el reporte.
+*/
+static const MemoryModule_t * const pxMemoryModules[] = {
+	&xAppMemoryModule,
+	&xUartMemoryModule,
+	&xStepperMemoryModule,
+	&xServoMemoryModule,
+	&xDisplayMemoryModule,
+	&xEncoderMemoryModule,
+	&xMonitorMemoryModule,
+	&xDeferredMemoryModule,
+	&xI2cBusMemoryModule
+};
+
+/*! \var const char *pcMemoryBanks[]
+	\brief Bancos de SRAM incluidos en el reporte.
+*/
+static const char * const pcMemoryBanks[] = {
+	memBANK_LOCAL32,
+	memBANK_LOCAL40,
+	memBANK_AHB32,
+	memBANK_AHB16
+};
+#endif
 
 /*! \fn vErrorNotifHandling( uint32_t ulNotifError )
 	\brief Gestió de errores obtenidos por notificación de tarea.
@@ -68,6 +133,14 @@ void vErrorNotifHandling( uint32_t ulNotifError )
 		if ( ulNotifError & (1 << servoERROR_NOTIF_ANG ) ) {
 			vUartSendMsg( "AST:ERR:SRVANG" );
 		}
+		/* Error en calibración de servo */
+		if ( ulNotifError & (1 << servoERROR_NOTIF_CAL ) ) {
+			vUartSendMsg( "AST:ERR:SRVCAL" );
+		}
+		/* Error en canal de servo */
+		if ( ulNotifError & (1 << servoERROR_NOTIF_ID ) ) {
+			vUartSendMsg( "AST:ERR:SRVID" );
+		}
 	}
 }
 
@@ -84,7 +157,7 @@ void vAppSyncTask( void *pvParameters )
     char *pcErrorMsg = "Error en mensaje previo";
 
     for ( ;; ) {
-        xQueueReceive(
+        xPtrQueueReceive(
             /* Handle de la cola a leer */
             xMsgQueue,
             /* Puntero a la memoria donde guardar lectura */
@@ -111,6 +184,27 @@ void vAppSyncTask( void *pvParameters )
 			/* Escribir mensaje en cola de consignas */
 			vStepperSendMsg( pcMsgReceived );
 		}
+        /* Reporte de stack y heap */
+        if ( pcMsgReceived[1] == 'M' ) {
+        	vMonitorRequestReport();
+        }
+#if ( appUSE_LATENCY == 1 )
+        /* Reporte de latencia de interrupción a tarea */
+        if ( pcMsgReceived[1] == 'L' ) {
+        	vLatencyReport();
+        }
+        /* Comparación de procesamiento diferido con el timer service */
+        if ( pcMsgReceived[1] == 'B' ) {
+        	vDeferredBenchmark();
+        	vBarrierBenchmark();
+        	vDriverBenchmark();
+        	vPtrQueueBenchmark();
+        }
+#endif
+        /* Las consignas a motores las libera la tarea que las procesa */
+        if ( ( pcMsgReceived[1] != 'X' ) && ( pcMsgReceived[1] != 'S' ) ) {
+        	vUartReleaseCmd( pcMsgReceived );
+        }
 
         /* Verificación de notificación de error */
         ulNotifError = ulTaskNotifyTake( pdTRUE, 0 );
@@ -125,13 +219,49 @@ void vAppSyncTask( void *pvParameters )
 void vLedBlinkTask( void *pvParameters )
 {
 	for ( ;; ) {
-		/* Indicador en LEDB */
-		gpioToggle( LEDB );
-		/* Parpadeo de medio segundo */
-		vTaskDelay( pdMS_TO_TICKS( 500 ) );
+		if ( xPowerMotionActive() ) {
+			/* Indicador en LEDB: parpadeo de medio segundo durante
+			 * los movimientos */
+			gpioToggle( LEDB );
+			ulTaskNotifyTake( pdTRUE, pdMS_TO_TICKS( 500 ) );
+		} else {
+			/* Encendido fijo en reposo, sin despertar al procesador
+			 * hasta el próximo movimiento */
+			gpioWrite( LEDB, ON );
+			ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+		}
 	}
 }
 
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+/*! \fn void vMemoryReport( void )
+	\brief Reporte de memoria estática por módulo y por banco
+	de SRAM.
+*/
+void vMemoryReport( void )
+{
+	size_t xBankTotal;
+
+	/* Memoria de cada módulo frente a su presupuesto */
+	for ( uint8_t i=0; i<sizeof( pxMemoryModules )/sizeof( pxMemoryModules[0] ); i++ ) {
+		printf( "Size %s: %u/%u (%s)\n", pxMemoryModules[i]->pcName,
+			( unsigned ) pxMemoryModules[i]->xSize, ( unsigned ) pxMemoryModules[i]->xBudget,
+			pxMemoryModules[i]->pcBank + strlen( ".bss.$" ) );
+	}
+
+	/* Total de cada banco */
+	for ( uint8_t i=0; i<sizeof( pcMemoryBanks )/sizeof( pcMemoryBanks[0] ); i++ ) {
+		xBankTotal = 0;
+		for ( uint8_t j=0; j<sizeof( pxMemoryModules )/sizeof( pxMemoryModules[0] ); j++ ) {
+			if ( strcmp( pxMemoryModules[j]->pcBank, pcMemoryBanks[i] ) == 0 ) {
+				xBankTotal += pxMemoryModules[j]->xSize;
+			}
+		}
+		printf( "Bank %s: %u\n", pcMemoryBanks[i] + strlen( ".bss.$" ),
+			( unsigned ) xBankTotal );
+	}
+}
+#else
 /*! \fn size_t xPrintModuleSize( const char *pcName, size_t xPreviousFreeHeapSize )
 	\brief Obtener tamaño del módulo en base al espacio
 	disponible previo.
@@ -142,45 +272,114 @@ size_t xPrintModuleSize( const char *pcName, size_t xPreviousFreeHeapSize )
 {
 	/* Obtener información del espacio libre */
 	size_t xFreeHeapSize = xPortGetFreeHeapSize();
-	printf( "Size %s: %d\n", pcName, xPreviousFreeHeapSize - xFreeHeapSize );
+	printf( "Size %s: %u\n", pcName,
+		( unsigned ) ( xPreviousFreeHeapSize - xFreeHeapSize ) );
 	return xFreeHeapSize;
 }
+#endif
 
 int main( void )
 {
     /* Inicialización de la placa */
     boardConfig();
 
+#if ( appUSE_STATIC_ALLOCATION == 0 )
     /* Obtener información de espacio disponible */
     size_t xPreviousSize = xPortGetFreeHeapSize();
-    printf( "Espacio disponible: %d\n", xPreviousSize );
+    printf( "Espacio disponible: %u\n", ( unsigned ) xPreviousSize );
+#endif
 
     /* Flags de estado de los diferentes módulos */
     BaseType_t xStatus;
 
+#if ( appUSE_LATENCY == 1 )
+    /* Contador de ciclos antes de habilitar las interrupciones */
+    vLatencyInit();
+#endif
+
+    /* Inicialización de procesamiento diferido de interrupciones,
+     * antes de los módulos que lo usan */
+    xStatus = xDeferredInit(); configASSERT( xStatus == pdPASS );
+#if ( appUSE_STATIC_ALLOCATION == 0 )
+    xPreviousSize = xPrintModuleSize( "Deferred", xPreviousSize);
+#endif
+
     /* Inicialización de UART */
     xStatus = xUartInit(); configASSERT( xStatus == pdPASS );
+#if ( appUSE_STATIC_ALLOCATION == 0 )
     xPreviousSize = xPrintModuleSize( "UART", xPreviousSize);
+#endif
 
     /* Inicialización de motor stepper */
     xStatus = xStepperInit(); configASSERT( xStatus == pdPASS );
+#if ( appUSE_STATIC_ALLOCATION == 0 )
     xPreviousSize = xPrintModuleSize( "Stepper", xPreviousSize);
+#endif
 
     /* Inicialización de servo motor */
     xStatus = xServoInit(); configASSERT( xStatus == pdPASS );
+#if ( appUSE_STATIC_ALLOCATION == 0 )
     /* Obtener información del espacio libre */
     xPreviousSize = xPrintModuleSize( "Servo", xPreviousSize);
+#endif
+
+#if ( appUSE_DUAL_CORE == 1 )
+    /* Arranque del M0 (motor de pasos y PWM). Sin imagen válida los
+     * pasos siguen a cargo de los timers del M4 */
+    if ( xDualCoreInit() == pdPASS ) {
+    	printf( "M0: motor de pasos en funcionamiento\n" );
+    }
+#endif
+
+    /* Inicialización del bus I2C, antes del display (expansor
+     * PCF8574T) */
+    xStatus = xI2cBusInit(); configASSERT( xStatus == pdPASS );
+#if ( appUSE_STATIC_ALLOCATION == 0 )
+    xPreviousSize = xPrintModuleSize( "I2C", xPreviousSize);
+#endif
 
     /* Inicialización de display LCD */
     xStatus = xDisplayInit(); configASSERT( xStatus == pdPASS );
+#if ( appUSE_STATIC_ALLOCATION == 0 )
     xPreviousSize = xPrintModuleSize( "Display", xPreviousSize);
+#endif
 
     /* Inicialización de encoder rotativo */
 	xStatus = xEncoderInit(); configASSERT( xStatus == pdPASS );
+#if ( appUSE_STATIC_ALLOCATION == 0 )
 	xPreviousSize = xPrintModuleSize( "Encoder", xPreviousSize);
+#endif
 
+    /* Inicialización de monitor de stack y heap */
+	xStatus = xMonitorInit(); configASSERT( xStatus == pdPASS );
+#if ( appUSE_STATIC_ALLOCATION == 0 )
+	xPreviousSize = xPrintModuleSize( "Monitor", xPreviousSize);
+#endif
+
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+    /* Creación de cola de mensajes recibidos */
+    xMsgQueue = xPtrQueueCreateStatic( appQUEUE_MSG_LENGTH,
+    	xAppMemory.pvMsgQueueStorage, &xAppMemory.xMsgQueue );
+    /* Verificación de cola creada con éxito */
+	configASSERT( xMsgQueue != NULL );
+
+    /* Creación de tarea de control de flujo de trabajo del programa */
+    xAppSyncTaskHandle = xTaskCreateStatic( vAppSyncTask,
+    	( const char * ) "AppSyncTask", stackAppSyncTask, NULL,
+		priorityAppSyncTask, xAppMemory.puxSyncTaskStack,
+		&xAppMemory.xSyncTaskTCB );
+
+    /* Tarea con blink de LED para visual de aplicación funcionando */
+    xLedBlinkTaskHandle = xTaskCreateStatic( vLedBlinkTask,
+    	( const char * ) "LedBlinkTask", stackLedBlinkTask, NULL,
+		priorityLedBlinkTask, xAppMemory.puxLedBlinkTaskStack,
+		&xAppMemory.xLedBlinkTaskTCB );
+
+    /* Reporte de memoria estática por módulo y banco */
+    vMemoryReport();
+#else
     /* Creación de cola de mensajes recibidos */
-    xMsgQueue = xQueueCreate( appQUEUE_MSG_LENGTH, sizeof( char * ) );
+    xMsgQueue = xPtrQueueCreate( appQUEUE_MSG_LENGTH );
     /* Verificación de cola creada con éxito */
 	configASSERT( xMsgQueue != NULL );
 
@@ -191,7 +390,7 @@ int main( void )
         /* Nombre de la tarea amigable para el usuario */
         ( const char * ) "AppSyncTask",
         /* Tamaño de stack de la tarea */
-        configMINIMAL_STACK_SIZE*2,
+        stackAppSyncTask,
         /* Parámetros de la tarea */
         NULL,
         /* Prioridad de la tarea */
@@ -202,11 +401,15 @@ int main( void )
 
     /* Tarea con blink de LED para visual de aplicación funcionando */
     xStatus = xTaskCreate( vLedBlinkTask, ( const char * ) "LedBlinkTask",
-    	configMINIMAL_STACK_SIZE, NULL, priorityLedBlinkTask, NULL );
+    	stackLedBlinkTask, NULL, priorityLedBlinkTask, &xLedBlinkTaskHandle );
 
     /* Obtener información de espacio disponible */
 	xPreviousSize = xPortGetFreeHeapSize();
-	printf( "Espacio disponible: %d\n", xPreviousSize );
+	printf( "Espacio disponible: %u\n", ( unsigned ) xPreviousSize );
+#endif
+
+    /* Blink de LED sólo durante movimientos */
+    vPowerRegisterMotionListener( xLedBlinkTaskHandle );
 
     /* Inicialización de Scheduler */
     vTaskStartScheduler();
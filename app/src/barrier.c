@@ -0,0 +1,275 @@
+/*! \file barrier.c
+    \brief Barrera de finalización de N partes basada en
+    notificaciones de tarea.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+/* Utilidades includes */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "event_groups.h"
+#include "FreeRTOSMemory.h"
+
+/* EDU-CIAA firmware_v3 includes */
+#include "sapi.h"
+#include "chip.h"
+
+/* Aplicación includes */
+#include "barrier.h"
+#include "latency.h"
+
+/*! \fn void vBarrierInit( Barrier_t *pxBarrier, UBaseType_t uxParties, UBaseType_t uxFirstBit )
+	\brief Inicialización de la barrera.
+*/
+void vBarrierInit( Barrier_t *pxBarrier, UBaseType_t uxParties, UBaseType_t uxFirstBit )
+{
+	configASSERT( ( uxParties > 0 ) && ( uxParties <= barrierMAX_PARTIES ) );
+	configASSERT( uxFirstBit + uxParties <= 32 );
+
+	memset( pxBarrier, 0, sizeof( Barrier_t ) );
+	pxBarrier->uxParties = uxParties;
+	pxBarrier->uxFirstBit = uxFirstBit;
+	pxBarrier->ulMask = ( ( 1UL << uxParties ) - 1 ) << uxFirstBit;
+}
+
+/*! \fn void vBarrierArm( Barrier_t *pxBarrier )
+	\brief Armar la barrera.
+*/
+void vBarrierArm( Barrier_t *pxBarrier )
+{
+	pxBarrier->xWaiter = xTaskGetCurrentTaskHandle();
+	pxBarrier->ulArrived = 0;
+	pxBarrier->ulExpected = 0;
+	pxBarrier->xArmTime = xTaskGetTickCount();
+	/* Descartar bits de partes que llegaron tarde a la espera anterior,
+	 * sin modificar el resto del valor de notificación */
+	xTaskNotifyWait( pxBarrier->ulMask, pxBarrier->ulMask, NULL, 0 );
+}
+
+/*! \fn void vBarrierExpect( Barrier_t *pxBarrier, UBaseType_t uxParty )
+	\brief Agregar la parte a la espera actual.
+*/
+void vBarrierExpect( Barrier_t *pxBarrier, UBaseType_t uxParty )
+{
+	configASSERT( uxParty < pxBarrier->uxParties );
+
+	pxBarrier->ulExpected |= 1UL << ( pxBarrier->uxFirstBit + uxParty );
+}
+
+/*! \fn static void prvBarrierRecord( Barrier_t *pxBarrier, UBaseType_t uxParty, TickType_t xNow )
+	\brief Registrar la finalización de la parte.
+*/
+static void prvBarrierRecord( Barrier_t *pxBarrier, UBaseType_t uxParty, TickType_t xNow )
+{
+	BarrierParty_t *pxParty = &pxBarrier->pxParty[uxParty];
+	TickType_t xTicks = xNow - pxBarrier->xArmTime;
+
+	pxParty->ulArrivals++;
+	if ( xTicks > pxParty->xMaxTicks ) {
+		pxParty->xMaxTicks = xTicks;
+	}
+}
+
+/*! \fn void vBarrierArrive( Barrier_t *pxBarrier, UBaseType_t uxParty )
+	\brief Indicar la finalización de la parte desde una tarea o
+	callback de timer.
+*/
+void vBarrierArrive( Barrier_t *pxBarrier, UBaseType_t uxParty )
+{
+	configASSERT( uxParty < pxBarrier->uxParties );
+	configASSERT( pxBarrier->xWaiter != NULL );
+
+	prvBarrierRecord( pxBarrier, uxParty, xTaskGetTickCount() );
+	xTaskNotify( pxBarrier->xWaiter, 1UL << ( pxBarrier->uxFirstBit + uxParty ),
+		eSetBits );
+}
+
+/*! \fn void vBarrierArriveFromISR( Barrier_t *pxBarrier, UBaseType_t uxParty, BaseType_t *pxHigherPriorityTaskWoken )
+	\brief Indicar la finalización de la parte desde una ISR.
+*/
+void vBarrierArriveFromISR( Barrier_t *pxBarrier, UBaseType_t uxParty,
+	BaseType_t *pxHigherPriorityTaskWoken )
+{
+	if ( ( uxParty >= pxBarrier->uxParties ) || ( pxBarrier->xWaiter == NULL ) ) {
+		return;
+	}
+
+	prvBarrierRecord( pxBarrier, uxParty, xTaskGetTickCountFromISR() );
+	xTaskNotifyFromISR( pxBarrier->xWaiter,
+		1UL << ( pxBarrier->uxFirstBit + uxParty ), eSetBits,
+		pxHigherPriorityTaskWoken );
+}
+
+/*! \fn uint32_t ulBarrierWait( Barrier_t *pxBarrier, TickType_t xTicksToWait )
+	\brief Esperar la finalización de las partes esperadas.
+*/
+uint32_t ulBarrierWait( Barrier_t *pxBarrier, TickType_t xTicksToWait )
+{
+	TimeOut_t xTimeOut;
+	uint32_t ulValue, ulPending;
+
+	vTaskSetTimeOutState( &xTimeOut );
+	while ( ( pxBarrier->ulArrived & pxBarrier->ulExpected ) != pxBarrier->ulExpected ) {
+		/* Cualquier notificación despierta a la tarea; sólo se limpian
+		 * los bits de la barrera */
+		xTaskNotifyWait( 0, pxBarrier->ulMask, &ulValue, xTicksToWait );
+		pxBarrier->ulArrived |= ulValue & pxBarrier->ulMask;
+		if ( ( ( pxBarrier->ulArrived & pxBarrier->ulExpected ) != pxBarrier->ulExpected ) &&
+			( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdTRUE ) ) {
+			break;
+		}
+	}
+
+	ulPending = ( pxBarrier->ulExpected & ~pxBarrier->ulArrived ) >> pxBarrier->uxFirstBit;
+	/* Partes que no llegaron antes del timeout */
+	for ( UBaseType_t i=0; i<pxBarrier->uxParties; i++ ) {
+		if ( ulPending & ( 1UL << i ) ) {
+			pxBarrier->pxParty[i].ulLate++;
+		}
+	}
+	return ulPending;
+}
+
+/*! \fn void vBarrierReport( Barrier_t *pxBarrier, const char *pcName )
+	\brief Imprimir el registro de cada parte.
+*/
+void vBarrierReport( Barrier_t *pxBarrier, const char *pcName )
+{
+	BarrierParty_t *pxParty;
+
+	for ( UBaseType_t i=0; i<pxBarrier->uxParties; i++ ) {
+		pxParty = &pxBarrier->pxParty[i];
+		printf( "BAR:%s p%u n %u late %u max %u ms\n", pcName, ( unsigned ) i,
+			( unsigned ) pxParty->ulArrivals, ( unsigned ) pxParty->ulLate,
+			( unsigned ) ( pxParty->xMaxTicks * portTICK_PERIOD_MS ) );
+	}
+}
+
+#if ( appUSE_LATENCY == 1 )
+
+/*! \var xBarrierBench
+	\brief Objetos e instantes de la comparación del comando ":B".
+	Una única parte, un timer one-shot que finaliza en el tick
+	siguiente (con la tarea ya bloqueada) y un grupo de eventos
+	equivalente.
+*/
+static struct {
+	Barrier_t xBarrier;
+	EventGroupHandle_t xEventGroup;
+	TimerHandle_t xTimer;
+	BaseType_t xUseEventGroup;
+	/* Instantes antes y después de la finalización */
+	volatile uint32_t ulSignal;
+	volatile uint32_t ulSignalDone;
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+	StaticEventGroup_t xEventGroupBuffer;
+	StaticTimer_t xTimerBuffer;
+#endif
+} xBarrierBench;
+
+/*! \fn static void prvBarrierBenchCallback( TimerHandle_t xTimer )
+	\brief Finalización de la parte de prueba desde el timer service,
+	como en los motores paso a paso.
+*/
+static void prvBarrierBenchCallback( TimerHandle_t xTimer )
+{
+	xBarrierBench.ulSignal = latencyTIMESTAMP();
+	if ( xBarrierBench.xUseEventGroup ) {
+		xEventGroupSetBits( xBarrierBench.xEventGroup, 1 );
+	} else {
+		vBarrierArrive( &xBarrierBench.xBarrier, 0 );
+	}
+	xBarrierBench.ulSignalDone = latencyTIMESTAMP();
+}
+
+/*! \fn static void prvBarrierBenchRun( const char *pcName, BaseType_t xUseEventGroup )
+	\brief Esperar barrierBENCH_RUNS finalizaciones con el método
+	indicado e imprimir el costo de la finalización y la latencia
+	hasta que la tarea que espera se ejecuta, en ciclos.
+*/
+static void prvBarrierBenchRun( const char *pcName, BaseType_t xUseEventGroup )
+{
+	uint32_t ulSignal, ulWake, ulCount = 0;
+	uint32_t ulSignalMax = 0, ulWakeMax = 0;
+	uint64_t ullSignalSum = 0, ullWakeSum = 0;
+	BaseType_t xDone;
+
+	xBarrierBench.xUseEventGroup = xUseEventGroup;
+	for ( uint32_t i=0; i<barrierBENCH_RUNS; i++ ) {
+		if ( xUseEventGroup ) {
+			xEventGroupClearBits( xBarrierBench.xEventGroup, 1 );
+		} else {
+			vBarrierArm( &xBarrierBench.xBarrier );
+			vBarrierExpect( &xBarrierBench.xBarrier, 0 );
+		}
+		xTimerStart( xBarrierBench.xTimer, portMAX_DELAY );
+
+		if ( xUseEventGroup ) {
+			xDone = ( xEventGroupWaitBits( xBarrierBench.xEventGroup, 1,
+				pdTRUE, pdTRUE, pdMS_TO_TICKS( 100 ) ) & 1 ) != 0;
+		} else {
+			xDone = ulBarrierWait( &xBarrierBench.xBarrier, pdMS_TO_TICKS( 100 ) ) == 0;
+		}
+		ulWake = latencyTIMESTAMP() - xBarrierBench.ulSignal;
+		if ( !xDone ) {
+			continue;
+		}
+		ulSignal = xBarrierBench.ulSignalDone - xBarrierBench.ulSignal;
+
+		ulCount++;
+		ullSignalSum += ulSignal;
+		ullWakeSum += ulWake;
+		if ( ulSignal > ulSignalMax ) {
+			ulSignalMax = ulSignal;
+		}
+		if ( ulWake > ulWakeMax ) {
+			ulWakeMax = ulWake;
+		}
+	}
+
+	if ( ulCount == 0 ) {
+		printf( "BAR:BENCH %s n 0\n", pcName );
+		return;
+	}
+	printf( "BAR:BENCH %s n %u signal avg %u max %u wake avg %u max %u\n", pcName,
+		( unsigned ) ulCount,
+		( unsigned ) ( ullSignalSum / ulCount ), ( unsigned ) ulSignalMax,
+		( unsigned ) ( ullWakeSum / ulCount ), ( unsigned ) ulWakeMax );
+}
+
+/*! \fn void vBarrierBenchmark( void )
+	\brief Comparar la barrera frente a un grupo de eventos
+	(comando ":B").
+*/
+void vBarrierBenchmark( void )
+{
+	if ( xBarrierBench.xTimer == NULL ) {
+		vBarrierInit( &xBarrierBench.xBarrier, 1, barrierBENCH_FIRST_BIT );
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+		xBarrierBench.xEventGroup = xEventGroupCreateStatic(
+			&xBarrierBench.xEventGroupBuffer );
+		xBarrierBench.xTimer = xTimerCreateStatic( "BarrierBench", 1, pdFALSE,
+			NULL, prvBarrierBenchCallback, &xBarrierBench.xTimerBuffer );
+#else
+		xBarrierBench.xEventGroup = xEventGroupCreate();
+		xBarrierBench.xTimer = xTimerCreate( "BarrierBench", 1, pdFALSE,
+			NULL, prvBarrierBenchCallback );
+#endif
+		if ( ( xBarrierBench.xEventGroup == NULL ) || ( xBarrierBench.xTimer == NULL ) ) {
+			printf( "BAR:BENCH error\n" );
+			return;
+		}
+	}
+
+	prvBarrierBenchRun( "evgroup", pdTRUE );
+	prvBarrierBenchRun( "notify", pdFALSE );
+}
+
+#endif /* appUSE_LATENCY */
@@ -0,0 +1,348 @@
+/*! \file deferred.c
+    \brief Servicio de procesamiento diferido de interrupciones en
+    lotes, con buffers circulares lock-free por prioridad.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+/* Utilidades includes */
+#include <stdio.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "FreeRTOSPriorities.h"
+#include "FreeRTOSMemory.h"
+
+/* EDU-CIAA firmware_v3 includes */
+#include "sapi.h"
+#include "chip.h"
+
+/* Aplicación includes */
+#include "deferred.h"
+#include "latency.h"
+
+/*! \var typedef struct xDeferredWork DeferredWork_t
+	\brief Trabajo pendiente.
+*/
+typedef struct xDeferredWork {
+	DeferredFunction_t pxFunction;
+	void *pvParameter1;
+	uint32_t ulParameter2;
+} DeferredWork_t;
+
+/*! \var typedef struct xDeferredRing DeferredRing_t
+	\brief Buffer circular de trabajos de una prioridad. Los índices
+	avanzan libremente y sólo los escribe su dueño (ulHead la ISR,
+	ulTail la tarea), como en spsc_ring.h.
+*/
+typedef struct xDeferredRing {
+	DeferredWork_t pxWork[ deferredRING_LENGTH ];
+	/* Índice de escritura, sólo lo modifica el productor */
+	volatile uint32_t ulHead;
+	/* Índice de lectura, sólo lo modifica la tarea */
+	volatile uint32_t ulTail;
+	/* Trabajos publicados */
+	volatile uint32_t ulPosted;
+	/* Trabajos descartados por buffer lleno */
+	volatile uint32_t ulDropped;
+	/* Máxima cantidad de trabajos pendientes observada */
+	volatile uint32_t ulMaxDepth;
+} DeferredRing_t;
+
+/*! \var DeferredRing_t pxDeferredRing[deferredPRIORITY_NUM]
+	\brief Buffer de cada prioridad.
+*/
+static DeferredRing_t pxDeferredRing[ deferredPRIORITY_NUM ];
+
+#if ( appUSE_LATENCY == 1 )
+/*! \var DeferredRing_t xDeferredBenchRing
+	\brief Buffer propio del comando ":B", que publica desde una tarea:
+	los buffers de cada prioridad sólo admiten a sus ISR como
+	productoras. La tarea lo vacía después de todas las prioridades.
+*/
+static DeferredRing_t xDeferredBenchRing;
+#endif
+
+/*! \var TaskHandle_t xDeferredTaskHandle
+	\brief Handle de la tarea de procesamiento diferido.
+*/
+static TaskHandle_t xDeferredTaskHandle = NULL;
+
+/*! \var uint32_t ulDeferredBatches
+	\brief Cantidad de lotes procesados (una notificación cada uno).
+*/
+static uint32_t ulDeferredBatches = 0;
+
+/*! \var uint32_t ulDeferredMaxBatch
+	\brief Máxima cantidad de trabajos procesados en un lote.
+*/
+static uint32_t ulDeferredMaxBatch = 0;
+
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+/*! \var xDeferredMemory
+	\brief Memoria estática de la tarea del módulo.
+*/
+static struct {
+	StaticTask_t xTaskTCB;
+	StackType_t puxTaskStack[ stackDeferredTask ];
+} xDeferredMemory memPLACE( memBANK_DEFERRED );
+
+memMODULE( xDeferredMemoryModule, "Deferred", memBANK_DEFERRED, memBUDGET_DEFERRED, xDeferredMemory );
+#endif
+
+/*! \fn static BaseType_t prvDeferredPost( DeferredRing_t *pxRing, DeferredFunction_t pxFunction, void *pvParameter1, uint32_t ulParameter2, BaseType_t *pxHigherPriorityTaskWoken )
+	\brief Publicar un trabajo en el buffer (único productor).
+*/
+static BaseType_t prvDeferredPost( DeferredRing_t *pxRing,
+	DeferredFunction_t pxFunction, void *pvParameter1, uint32_t ulParameter2,
+	BaseType_t *pxHigherPriorityTaskWoken )
+{
+	uint32_t ulHead = pxRing->ulHead;
+	uint32_t ulDepth = ulHead - pxRing->ulTail;
+	DeferredWork_t *pxWork;
+
+	/* Verificación de espacio disponible */
+	if ( ulDepth >= deferredRING_LENGTH ) {
+		pxRing->ulDropped++;
+		return pdFAIL;
+	}
+
+	pxWork = &pxRing->pxWork[ ulHead & ( deferredRING_LENGTH - 1 ) ];
+	pxWork->pxFunction = pxFunction;
+	pxWork->pvParameter1 = pvParameter1;
+	pxWork->ulParameter2 = ulParameter2;
+
+	/* El trabajo debe ser visible antes que el índice */
+	deferredMEMORY_BARRIER();
+	pxRing->ulHead = ulHead + 1;
+	deferredMEMORY_BARRIER();
+
+	pxRing->ulPosted++;
+	if ( ulDepth + 1 > pxRing->ulMaxDepth ) {
+		pxRing->ulMaxDepth = ulDepth + 1;
+	}
+
+	/* Notificar sólo en la transición de vacío a no vacío. El índice
+	 * de lectura se vuelve a leer después de publicar: la tarea o bien
+	 * ve el trabajo nuevo antes de bloquearse o bien recibe la
+	 * notificación */
+	if ( ( pxRing->ulTail == ulHead ) && ( xDeferredTaskHandle != NULL ) ) {
+		vTaskNotifyGiveFromISR( xDeferredTaskHandle, pxHigherPriorityTaskWoken );
+	}
+	return pdPASS;
+}
+
+/*! \fn BaseType_t xDeferredPostFromISR( DeferredPriority_t xPriority, DeferredFunction_t pxFunction, void *pvParameter1, uint32_t ulParameter2, BaseType_t *pxHigherPriorityTaskWoken )
+	\brief Publicar un trabajo desde una ISR.
+*/
+BaseType_t xDeferredPostFromISR( DeferredPriority_t xPriority,
+	DeferredFunction_t pxFunction, void *pvParameter1, uint32_t ulParameter2,
+	BaseType_t *pxHigherPriorityTaskWoken )
+{
+	return prvDeferredPost( &pxDeferredRing[xPriority], pxFunction,
+		pvParameter1, ulParameter2, pxHigherPriorityTaskWoken );
+}
+
+/*! \fn static uint32_t prvDeferredDrain( DeferredRing_t *pxRing )
+	\brief Ejecutar todos los trabajos pendientes del buffer.
+	\return Cantidad de trabajos ejecutados.
+*/
+static uint32_t prvDeferredDrain( DeferredRing_t *pxRing )
+{
+	uint32_t ulTail = pxRing->ulTail;
+	uint32_t ulHead = pxRing->ulHead;
+	uint32_t ulCount = ulHead - ulTail;
+	DeferredWork_t xWork;
+
+	/* Los trabajos se leen después de haber leído el índice de escritura */
+	deferredMEMORY_BARRIER();
+	while ( ulTail != ulHead ) {
+		xWork = pxRing->pxWork[ ulTail & ( deferredRING_LENGTH - 1 ) ];
+		/* Liberar el lugar antes de ejecutar, así la ISR puede volver
+		 * a publicar mientras la función se ejecuta */
+		deferredMEMORY_BARRIER();
+		pxRing->ulTail = ++ulTail;
+		deferredMEMORY_BARRIER();
+		xWork.pxFunction( xWork.pvParameter1, xWork.ulParameter2 );
+	}
+	return ulCount;
+}
+
+/*! \fn void vDeferredTask( void *pvParameters )
+	\brief Tarea de procesamiento diferido. Cada notificación inicia
+	un lote que termina cuando todos los buffers están vacíos.
+*/
+void vDeferredTask( void *pvParameters )
+{
+	uint32_t ulBatch, ulDrained;
+
+	for ( ;; ) {
+		ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+		ulBatch = 0;
+		do {
+			ulDrained = 0;
+			/* Un trabajo de mayor prioridad publicado durante el lote
+			 * se atiende antes de seguir con los de menor prioridad */
+			for ( uint8_t i=0; i<deferredPRIORITY_NUM && ulDrained == 0; i++ ) {
+				ulDrained = prvDeferredDrain( &pxDeferredRing[i] );
+			}
+#if ( appUSE_LATENCY == 1 )
+			if ( ulDrained == 0 ) {
+				ulDrained = prvDeferredDrain( &xDeferredBenchRing );
+			}
+#endif
+			ulBatch += ulDrained;
+		} while ( ulDrained > 0 );
+
+		ulDeferredBatches++;
+		if ( ulBatch > ulDeferredMaxBatch ) {
+			ulDeferredMaxBatch = ulBatch;
+		}
+	}
+}
+
+/*! \fn void vDeferredReport( void )
+	\brief Imprimir los contadores de cada buffer y de los lotes.
+*/
+void vDeferredReport( void )
+{
+	DeferredRing_t *pxRing;
+
+	for ( uint8_t i=0; i<deferredPRIORITY_NUM; i++ ) {
+		pxRing = &pxDeferredRing[i];
+		printf( "DEF:Q%u depth %u max %u/%u posted %u drops %u\n", i,
+			( unsigned ) ( pxRing->ulHead - pxRing->ulTail ),
+			( unsigned ) pxRing->ulMaxDepth, deferredRING_LENGTH,
+			( unsigned ) pxRing->ulPosted, ( unsigned ) pxRing->ulDropped );
+	}
+	printf( "DEF:BATCH n %u max %u\n", ( unsigned ) ulDeferredBatches,
+		( unsigned ) ulDeferredMaxBatch );
+}
+
+#if ( appUSE_LATENCY == 1 )
+
+/*! \var uint32_t ulDeferredBenchTimestamp
+	\brief Instante de ejecución del trabajo de prueba.
+*/
+static volatile uint32_t ulDeferredBenchTimestamp;
+
+/*! \fn static void prvDeferredBenchFunction( void *pvParameter1, uint32_t ulParameter2 )
+	\brief Trabajo de prueba: registra el instante de ejecución.
+*/
+static void prvDeferredBenchFunction( void *pvParameter1, uint32_t ulParameter2 )
+{
+	ulDeferredBenchTimestamp = latencyTIMESTAMP();
+}
+
+/*! \fn static void prvDeferredBenchRun( const char *pcName, BaseType_t xUseTimer )
+	\brief Publicar deferredBENCH_RUNS trabajos de prueba con el
+	método indicado e imprimir costo de publicación y latencia
+	hasta la ejecución en ciclos.
+*/
+static void prvDeferredBenchRun( const char *pcName, BaseType_t xUseTimer )
+{
+	uint32_t ulStart, ulPost, ulRun;
+	uint32_t ulPostMax = 0, ulRunMax = 0, ulCount = 0;
+	uint64_t ullPostSum = 0, ullRunSum = 0;
+	BaseType_t xHigherPriorityTaskWoken, xStatus;
+	UBaseType_t uxSavedInterruptStatus;
+
+	for ( uint32_t i=0; i<deferredBENCH_RUNS; i++ ) {
+		xHigherPriorityTaskWoken = pdFALSE;
+		ulDeferredBenchTimestamp = 0;
+
+		/* Publicación con interrupciones enmascaradas, como desde una ISR */
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		ulStart = latencyTIMESTAMP();
+		if ( xUseTimer ) {
+			xStatus = xTimerPendFunctionCallFromISR( prvDeferredBenchFunction,
+				NULL, 0, &xHigherPriorityTaskWoken );
+		} else {
+			xStatus = prvDeferredPost( &xDeferredBenchRing,
+				prvDeferredBenchFunction, NULL, 0, &xHigherPriorityTaskWoken );
+		}
+		ulPost = latencyTIMESTAMP() - ulStart;
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		/* La tarea que ejecuta el trabajo es de mayor prioridad */
+		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+		if ( ( xStatus != pdPASS ) || ( ulDeferredBenchTimestamp == 0 ) ) {
+			continue;
+		}
+		ulRun = ulDeferredBenchTimestamp - ulStart;
+
+		ulCount++;
+		ullPostSum += ulPost;
+		ullRunSum += ulRun;
+		if ( ulPost > ulPostMax ) {
+			ulPostMax = ulPost;
+		}
+		if ( ulRun > ulRunMax ) {
+			ulRunMax = ulRun;
+		}
+	}
+
+	if ( ulCount == 0 ) {
+		printf( "DEF:BENCH %s n 0\n", pcName );
+		return;
+	}
+	printf( "DEF:BENCH %s n %u post avg %u max %u run avg %u max %u\n", pcName,
+		( unsigned ) ulCount,
+		( unsigned ) ( ullPostSum / ulCount ), ( unsigned ) ulPostMax,
+		( unsigned ) ( ullRunSum / ulCount ), ( unsigned ) ulRunMax );
+}
+
+/*! \fn void vDeferredBenchmark( void )
+	\brief Comparar publicación y latencia a la ejecución frente a
+	xTimerPendFunctionCallFromISR (comando ":B").
+*/
+void vDeferredBenchmark( void )
+{
+	printf( "LAT:CLK %u Hz\n", ( unsigned ) SystemCoreClock );
+	prvDeferredBenchRun( "pend", pdTRUE );
+	prvDeferredBenchRun( "ring", pdFALSE );
+}
+
+#endif /* appUSE_LATENCY */
+
+/*! \fn BaseType_t xDeferredInit( void )
+	\brief Inicialización de los buffers y la tarea de procesamiento
+	diferido.
+*/
+BaseType_t xDeferredInit( void )
+{
+	for ( uint8_t i=0; i<deferredPRIORITY_NUM; i++ ) {
+		pxDeferredRing[i].ulHead = 0;
+		pxDeferredRing[i].ulTail = 0;
+		pxDeferredRing[i].ulPosted = 0;
+		pxDeferredRing[i].ulDropped = 0;
+		pxDeferredRing[i].ulMaxDepth = 0;
+	}
+
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+	xDeferredTaskHandle = xTaskCreateStatic( vDeferredTask,
+		( const char * ) "DeferredTask", stackDeferredTask, NULL,
+		priorityDeferredTask, xDeferredMemory.puxTaskStack,
+		&xDeferredMemory.xTaskTCB );
+	return ( xDeferredTaskHandle != NULL ) ? pdPASS : pdFAIL;
+#else
+	return xTaskCreate(
+		/* Puntero a la función que implementa la tarea */
+		vDeferredTask,
+		/* Nombre de la tarea amigable para el usuario */
+		( const char * ) "DeferredTask",
+		/* Tamaño de stack de la tarea */
+		stackDeferredTask,
+		/* Parámetros de la tarea */
+		NULL,
+		/* Prioridad de la tarea */
+		priorityDeferredTask,
+		/* Handle de la tarea creada */
+		&xDeferredTaskHandle
+	);
+#endif
+}
@@ -6,10 +6,15 @@
     \date Septiembre 2020
 */
 
+/* Utilidades includes */
+#include <stdio.h>
+#include <string.h>
+
 /* FreeRTOS includes */
 #include "FreeRTOS.h"
 #include "FreeRTOSConfig.h"
 #include "FreeRTOSPriorities.h"
+#include "FreeRTOSMemory.h"
 #include "task.h"
 
 /* EDU-CIAA firmware_v3 includes */
@@ -17,86 +22,180 @@
 
 /* Aplicación includes */
 #include "display_lcd.h"
+#include "lcd_hd44780.h"
 #include "encoder.h"
 #include "stepper.h"
 #include "servo.h"
 #include "uart.h"
+#include "power.h"
 
 /*! \var TaskHandle_t xDisplayTaskHandle
 	\brief Handle de la tarea de control del Display LCD.
 */
 TaskHandle_t xDisplayTaskHandle;
 
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+/*! \var xDisplayMemory
+	\brief Memoria estática de la tarea del módulo.
+*/
+static struct {
+	StaticTask_t xTaskTCB;
+	StackType_t puxTaskStack[ stackDisplayTask ];
+} xDisplayMemory memPLACE( memBANK_DISPLAY );
+
+memMODULE( xDisplayMemoryModule, "Display", memBANK_DISPLAY, memBUDGET_DISPLAY, xDisplayMemory );
+#endif
+
+/*! \var pcDisplayLabel
+	\brief Texto de la línea 1 de cada selección. El valor se escribe
+	desde la columna displayVALUE_COLUMN en las selecciones de motor.
+*/
+static const char * const pcDisplayLabel[] = {
+	"STEPPER 1:      ",
+	"STEPPER 2:      ",
+	"STEPPER 3:      ",
+	"SERVO EXT:      ",
+	" EDU-CIAA RTOS  "
+};
+
+/*! \var pcDisplayFrame
+	\brief Contenido solicitado para cada celda del display. Sólo lo
+	modifica la tarea del display.
+*/
+static char pcDisplayFrame[ displayLINES ][ displayCOLUMNS ];
+
+/*! \var pcDisplayShadow
+	\brief Contenido actual de cada celda del display LCD.
+*/
+static char pcDisplayShadow[ displayLINES ][ displayCOLUMNS ];
+
+/*! \var pusDisplayDirty
+	\brief Celdas de cada línea cuyo contenido solicitado difiere del
+	actual (bit i para la columna i).
+*/
+static uint16_t pusDisplayDirty[ displayLINES ];
+
+/*! \var ucDisplaySelection
+	\brief Última selección del menú indicada con vUpdateSelection().
+*/
+static volatile uint8_t ucDisplaySelection;
+
+/*! \fn static void prvDisplayPut( uint8_t x, uint8_t y, const char *pcStr )
+	\brief Escribir un texto en el contenido solicitado, marcando
+	sólo las celdas que cambian respecto del display.
+*/
+static void prvDisplayPut( uint8_t x, uint8_t y, const char *pcStr )
+{
+	for ( ; ( *pcStr != '\0' ) && ( x < displayCOLUMNS ); pcStr++, x++ ) {
+		pcDisplayFrame[y][x] = *pcStr;
+		if ( pcDisplayShadow[y][x] != *pcStr ) {
+			pusDisplayDirty[y] |= ( uint16_t ) ( 1U << x );
+		} else {
+			pusDisplayDirty[y] &= ( uint16_t ) ~( 1U << x );
+		}
+	}
+}
+
+/*! \fn static void prvDisplayPutValue( uint8_t x, uint8_t y, uint32_t ulValue )
+	\brief Escribir un valor en formato de tres dígitos.
+*/
+static void prvDisplayPutValue( uint8_t x, uint8_t y, uint32_t ulValue )
+{
+	char pcDigits[4];
+
+	ulValue %= 1000;
+	pcDigits[0] = '0' + ulValue / 100;
+	pcDigits[1] = '0' + ( ulValue / 10 ) % 10;
+	pcDigits[2] = '0' + ulValue % 10;
+	pcDigits[3] = '\0';
+	prvDisplayPut( x, y, pcDigits );
+}
+
+/*! \fn static void prvDisplayFlush( void )
+	\brief Escribir en el display sólo las celdas marcadas. Las celdas
+	contiguas se escriben sin reposicionar el cursor, ya que el
+	controlador incrementa la dirección después de cada caracter.
+*/
+static void prvDisplayFlush( void )
+{
+	for ( uint8_t y=0; y<displayLINES; y++ ) {
+		/* Columna siguiente a la última escrita (cursor del LCD) */
+		uint8_t ucCursor = displayCOLUMNS;
+
+		for ( uint8_t x=0; pusDisplayDirty[y] != 0; x++ ) {
+			if ( ( pusDisplayDirty[y] & ( 1U << x ) ) == 0 ) {
+				continue;
+			}
+			if ( x != ucCursor ) {
+				vLcdGoToXY( x, y );
+			}
+			vLcdData( pcDisplayFrame[y][x] );
+			pcDisplayShadow[y][x] = pcDisplayFrame[y][x];
+			pusDisplayDirty[y] &= ( uint16_t ) ~( 1U << x );
+			ucCursor = x + 1;
+		}
+	}
+}
+
 /*! \fn void vUpdateSelection( uint8_t cSelection )
 	\brief Actualizar selección en el displat LCD.
 	\param cSel Entero con el índice de la selección.
 */
 void vUpdateSelection( uint8_t cSelection )
 {
-	/* Colocar cursor en posición 0, 1 */
-	lcdGoToXY( 0, 1 );
-
-	switch ( cSelection ) {
-	case 0:
-		lcdSendStringRaw( "STEPPER 1:      " );
-		printf("STEPPER 1:      \n");
-		break;
-	case 1:
-		lcdSendStringRaw( "STEPPER 2:      " );
-		printf("STEPPER 2:      \n");
-		break;
-	case 2:
-		lcdSendStringRaw( "STEPPER 3:      " );
-		printf("STEPPER 3:      \n");
-		break;
-	case 3:
-		lcdSendStringRaw( "SERVO EXT:      " );
-		printf("SERVO EXT:      \n");
-		break;
-	default:
-		lcdSendStringRaw( " EDU-CIAA RTOS  " );
-		printf("EDU-CIAA RTOS\n");
-		break;
+	if ( cSelection > stepperAPP_NUM + 1 ) {
+		cSelection = stepperAPP_NUM + 1;
+	}
+	ucDisplaySelection = cSelection;
+	printf( "%s\n", pcDisplayLabel[ cSelection ] );
+
+	/* La línea se redibuja en la tarea del display */
+	vDisplayRefresh();
+}
+
+/*! \fn void vDisplayRefresh( void )
+	\brief Solicitar a la tarea del display que actualice el valor
+	mostrado.
+*/
+void vDisplayRefresh( void )
+{
+	if ( xDisplayTaskHandle != NULL ) {
+		xTaskNotifyGive( xDisplayTaskHandle );
 	}
 }
 
 /*! \fn void vDisplayTask( void *pvParameters )
-	\brief Tarea para control de display LCD.
+	\brief Tarea para control de display LCD. Arma el contenido
+	solicitado a partir de la selección y el valor del motor
+	seleccionado y escribe sólo las celdas que cambiaron.
 */
 void vDisplayTask( void *pvParameters )
 {
-	char* pcAngleTxt;
-
-	/* Selección inicial de menu en display */
-	vUpdateSelection( 0 );
-
-	uint8_t cMenuSel = 0;
+	uint8_t cMenuSel;
 	uint32_t value;
-	char pcAuxMsg[4];
 
 	for ( ;; ) {
-		/* Lectura del valor actual en mailbox */
-		xQueuePeek( xEncoderChoiceMailbox, &cMenuSel, portMAX_DELAY );
-
-		/* Colocar cursor en posición 0, 0 */
-		lcdGoToXY( 11, 1 );
+		cMenuSel = ucDisplaySelection;
+		prvDisplayPut( 0, 1, pcDisplayLabel[ cMenuSel ] );
 
 		/* Selección de motores paso a paso */
 		if ( cMenuSel < stepperAPP_NUM ) {
 			/* Obtener ángulo pendiente de motor */
 			value = ulStepperGetAngle( cMenuSel );
-			/* Escribir ángulo pendiente en formato de tres dígitos */
-			sprintf( pcAuxMsg, "%03d", value );
-			lcdSendStringRaw( pcAuxMsg );
+			prvDisplayPutValue( displayVALUE_COLUMN, 1, value );
 		/* Selección de servomotor */
 		} else if ( cMenuSel == stepperAPP_NUM ) {
-			xQueuePeek( xServoPositionMailbox, &value, portMAX_DELAY );
-			/* Escribir posición del motor en formato de 3 dígitos */
-			sprintf( pcAuxMsg, "%03d", value );
-			lcdSendStringRaw( pcAuxMsg );
+			uint8_t ucServoPosition;
+			xQueuePeek( xServoPositionMailbox, &ucServoPosition, portMAX_DELAY );
+			prvDisplayPutValue( displayVALUE_COLUMN, 1, ucServoPosition );
 		}
 
-		vTaskDelay( pdMS_TO_TICKS( 500 ) );
+		prvDisplayFlush();
+
+		/* Durante un movimiento se actualiza el ángulo pendiente
+		 * periódicamente, sin movimiento sólo ante un cambio */
+		ulTaskNotifyTake( pdTRUE, xPowerMotionActive() ?
+			pdMS_TO_TICKS( displayREFRESH_PERIOD_MS ) : portMAX_DELAY );
 	}
 }
 
@@ -105,41 +204,34 @@ void vDisplayTask( void *pvParameters )
 */
 BaseType_t xDisplayInit( void )
 {
-	/* Inicialización de interfaz I2C */
-	//i2cInit( I2C0, 100000 );
-
-	/* Esperar que se estabilice la alimentación del LCD
-	 * No utilizo la API vTaskDelay por ser un proceso a
-	 * ejecutar antes de lanzar el Scheduler */
-	//delay( LCD_STARTUP_WAIT_MS );
-
-	/* Inicialización del display */
-	lcdInit(
-			16,	/*Ancho de línea */
-			2,	/* Cantidad de líneas */
-			5,	/* Ancho en pixeles de un caracter */
-			8	/* Altura en pixeles de un caracter */
-			);
-
-	/* Apagar cursor (no es necesario en la aplicación) */
-	lcdCursorSet( LCD_CURSOR_OFF );
-	/* Limpiar pantalla */
-	lcdClear();
-
-	/* Colocar cursor en posición 0, 0 */
-	lcdGoToXY( 0, 0 );
+	/* Inicialización del display, sin esperas: la secuencia la
+	 * ejecuta el driver una vez iniciado el scheduler */
+	if ( xLcdInit() != pdPASS ) {
+		return pdFAIL;
+	}
+	memset( pcDisplayShadow, ' ', sizeof( pcDisplayShadow ) );
+	memset( pcDisplayFrame, ' ', sizeof( pcDisplayFrame ) );
+
 	/* Mensaje de inicialización */
-	lcdSendStringRaw( "MyEP FIng UNCuyo" );
+	prvDisplayPut( 0, 0, "MyEP FIng UNCuyo" );
+	prvDisplayFlush();
 
 	/* Creación de tarea para control de display LCD */
 	BaseType_t xStatus;
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+	xDisplayTaskHandle = xTaskCreateStatic( vDisplayTask,
+		( const char * ) "DisplayTask", stackDisplayTask, NULL,
+		priorityDisplayTask, xDisplayMemory.puxTaskStack,
+		&xDisplayMemory.xTaskTCB );
+	xStatus = ( xDisplayTaskHandle != NULL ) ? pdPASS : pdFAIL;
+#else
 	xStatus = xTaskCreate(
 		/* Puntero a la función que implementa la tarea */
 		vDisplayTask,
 		/* Nombre de la tarea amigable para el usuario */
 		( const char * ) "DisplayTask",
 		/* Tamaño de stack de la tarea */
-		configMINIMAL_STACK_SIZE*2,
+		stackDisplayTask,
 		/* Parámetros de la tarea */
 		NULL,
 		/* Prioridad de la tarea */
@@ -147,6 +239,12 @@ BaseType_t xDisplayInit( void )
 		/* Handle de la tarea creada */
 		&xDisplayTaskHandle
 	);
+#endif
+
+	/* Actualización periódica sólo durante movimientos */
+	if ( xStatus == pdPASS ) {
+		vPowerRegisterMotionListener( xDisplayTaskHandle );
+	}
 
 	return xStatus;
 }
@@ -6,8 +6,16 @@
     \date Julio 2020
 */
 
+/* Utilidades includes */
+#include <stdio.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
 /* Aplicación includes */
 #include "driver_uln2003.h"
+#include "latency.h"
 
 /*! \var DriverIn_t *pxDriverA
 	\brief Arrays de entradas al driver del motor A
@@ -18,82 +26,99 @@ DriverIn_t pxDriver[3][4] = {
 		{ T_COL0, T_FIL2, T_FIL3, T_FIL0 }
 };
 
-/*! \fn void vDriverUpdate( DriverIn_t *xDriverInput, uint8_t cState )
+/*! \var pucDriverSequence
+	\brief Secuencia de medio paso: bit i en alto activa la entrada i
+	del driver.
+*/
+static const uint8_t pucDriverSequence[8] = {
+		0x03, 0x02, 0x06, 0x04, 0x0C, 0x08, 0x09, 0x01
+};
+
+/*! \fn void vDriverUpdate( const gpioMask_t *pxDriverMask, uint8_t cState )
     \brief Escritura en driver de motor stepper dado un determinado estado.
-    \param xDriverInput Arrays de entradas al driver a setear.
+    \param pxDriverMask Entradas al driver resueltas con vDriverInit().
     \param cState Estado a escribir en el driver.
 */
-void vDriverUpdate( DriverIn_t *xDriverInput, uint8_t cState )
+void vDriverUpdate( const gpioMask_t *pxDriverMask, uint8_t cState )
 {
-    switch ( cState ) {
-        case 0:
-            gpioWrite(xDriverInput[0], ON);
-            gpioWrite(xDriverInput[1], ON);
-            gpioWrite(xDriverInput[2], OFF);
-            gpioWrite(xDriverInput[3], OFF);
-            break;
-
-        case 1:
-            gpioWrite(xDriverInput[0], OFF);
-			gpioWrite(xDriverInput[1], ON);
-			gpioWrite(xDriverInput[2], OFF);
-			gpioWrite(xDriverInput[3], OFF);
-            break;
-
-        case 2:
-            gpioWrite(xDriverInput[0], OFF);
-			gpioWrite(xDriverInput[1], ON);
-			gpioWrite(xDriverInput[2], ON);
-			gpioWrite(xDriverInput[3], OFF);
-            break;
-
-        case 3:
-            gpioWrite(xDriverInput[0], OFF);
-			gpioWrite(xDriverInput[1], OFF);
-			gpioWrite(xDriverInput[2], ON);
-			gpioWrite(xDriverInput[3], OFF);
-            break;
-
-        case 4:
-            gpioWrite(xDriverInput[0], OFF);
-			gpioWrite(xDriverInput[1], OFF);
-			gpioWrite(xDriverInput[2], ON);
-			gpioWrite(xDriverInput[3], ON);
-            break;
-
-        case 5:
-            gpioWrite(xDriverInput[0], OFF);
-			gpioWrite(xDriverInput[1], OFF);
-			gpioWrite(xDriverInput[2], OFF);
-			gpioWrite(xDriverInput[3], ON);
-            break;
-
-        case 6:
-            gpioWrite(xDriverInput[0], ON);
-			gpioWrite(xDriverInput[1], OFF);
-			gpioWrite(xDriverInput[2], OFF);
-			gpioWrite(xDriverInput[3], ON);
-            break;
-
-        case 7:
-            gpioWrite(xDriverInput[0], ON);
-			gpioWrite(xDriverInput[1], OFF);
-			gpioWrite(xDriverInput[2], OFF);
-			gpioWrite(xDriverInput[3], OFF);
-            break;
-    }
+	/* Las cuatro entradas cambian a la vez, una escritura enmascarada
+	por puerto GPIO */
+	gpioWriteMask( pxDriverMask, pucDriverSequence[ cState & 0x07 ] );
 }
 
-/*! \fn void vDriverInit( DriverIn_t *xDriverInput, uint8_t cInputNum )
+/*! \fn void vDriverInit( DriverIn_t *xDriverInput, gpioMask_t *pxDriverMask, uint8_t cInputNum )
 	\brief Inicialización de driver de motor stepper.
-	\param vDriverInput Array con entradas al driver.
-	\param cDriverNum Cantidad de entradas.
+	\param xDriverInput Array con entradas al driver.
+	\param pxDriverMask Conjunto de pines que se resuelve para
+	vDriverUpdate().
+	\param cInputNum Cantidad de entradas.
 */
-void vDriverInit( DriverIn_t *xDriverInput, uint8_t cInputNum )
+void vDriverInit( DriverIn_t *xDriverInput, gpioMask_t *pxDriverMask, uint8_t cInputNum )
 {
 	/* Inicialización del pin en la placa asociado
 	como salida */
 	for ( uint8_t i=0; i<cInputNum; i++ ) {
 		gpioInit( xDriverInput[i], GPIO_OUTPUT );
 	}
+	gpioMaskInit( pxDriverMask, xDriverInput, cInputNum );
+}
+
+#if ( appUSE_LATENCY == 1 )
+
+/*! \fn void vDriverBenchmark( void )
+	\brief Medir el costo promedio en ciclos de driverBENCH_RUNS
+	escrituras y conmutaciones del pin driverBENCH_PIN con cada
+	método: búsqueda en la tabla de sAPI, handle resuelto y macro con
+	puerto y pin constantes.
+*/
+void vDriverBenchmark( void )
+{
+	gpioFast_t xPin;
+	uint32_t ulStart, pulCycles[5];
+	bool_t xValue = gpioRead( driverBENCH_PIN );
+
+	gpioFastInit( driverBENCH_PIN, &xPin );
+
+	taskENTER_CRITICAL();
+	ulStart = latencyTIMESTAMP();
+	for ( uint32_t i=0; i<driverBENCH_RUNS; i++ ) {
+		gpioWrite( driverBENCH_PIN, i & 1 );
+	}
+	pulCycles[0] = latencyTIMESTAMP() - ulStart;
+
+	ulStart = latencyTIMESTAMP();
+	for ( uint32_t i=0; i<driverBENCH_RUNS; i++ ) {
+		gpioFastWrite( &xPin, i & 1 );
+	}
+	pulCycles[1] = latencyTIMESTAMP() - ulStart;
+
+	ulStart = latencyTIMESTAMP();
+	for ( uint32_t i=0; i<driverBENCH_RUNS; i++ ) {
+		GPIO_FAST_WRITE( driverBENCH_PORT, driverBENCH_BIT, i & 1 );
+	}
+	pulCycles[2] = latencyTIMESTAMP() - ulStart;
+
+	ulStart = latencyTIMESTAMP();
+	for ( uint32_t i=0; i<driverBENCH_RUNS; i++ ) {
+		gpioToggle( driverBENCH_PIN );
+	}
+	pulCycles[3] = latencyTIMESTAMP() - ulStart;
+
+	ulStart = latencyTIMESTAMP();
+	for ( uint32_t i=0; i<driverBENCH_RUNS; i++ ) {
+		gpioFastToggle( &xPin );
+	}
+	pulCycles[4] = latencyTIMESTAMP() - ulStart;
+	taskEXIT_CRITICAL();
+
+	gpioWrite( driverBENCH_PIN, xValue );
+
+	printf( "GPIO:BENCH write %u fast %u const %u toggle %u fast %u cycles\n",
+		( unsigned ) ( pulCycles[0] / driverBENCH_RUNS ),
+		( unsigned ) ( pulCycles[1] / driverBENCH_RUNS ),
+		( unsigned ) ( pulCycles[2] / driverBENCH_RUNS ),
+		( unsigned ) ( pulCycles[3] / driverBENCH_RUNS ),
+		( unsigned ) ( pulCycles[4] / driverBENCH_RUNS ) );
 }
+
+#endif /* appUSE_LATENCY */
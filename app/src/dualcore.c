@@ -0,0 +1,180 @@
+/*! \file dualcore.c
+    \brief Arranque del Cortex-M0APP y comunicación con su motor
+    de pasos y PWM a través del mailbox compartido.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* EDU-CIAA firmware_v3 includes */
+#include "sapi.h"
+#include "chip.h"
+
+/* Aplicación includes */
+#include "dualcore.h"
+#include "stepper.h"
+
+#if ( appUSE_DUAL_CORE == 1 )
+
+/*! \var const pinInitGpioLpc4337_t gpioPinsInit[]
+	\brief Tabla de pines de sAPI (sapi_gpio.c), para traducir
+	gpioMap_t a puerto y pin GPIO para el M0.
+*/
+extern const pinInitGpioLpc4337_t gpioPinsInit[];
+
+/*! \var BaseType_t xDualCoreStarted
+	\brief El M0 indicó que está en funcionamiento.
+*/
+static BaseType_t xDualCoreStarted = pdFALSE;
+
+/*! \fn void vDualCoreSetStepperPins( uint8_t ucStepperIndex, const gpioMap_t *pxDriverInput, gpioMap_t xLed )
+	\brief Cargar en la configuración del mailbox los pines del
+	driver y LED de un motor.
+*/
+void vDualCoreSetStepperPins( uint8_t ucStepperIndex, const gpioMap_t *pxDriverInput,
+	gpioMap_t xLed )
+{
+	IpcConfig_t *pxConfig = &ipcMAILBOX->xConfig;
+
+	configASSERT( ucStepperIndex < ipcSTEPPER_NUM );
+
+	for ( uint8_t i=0; i<ipcSTEPPER_INPUTS; i++ ) {
+		pxConfig->pucDriverPort[ucStepperIndex][i] = gpioPinsInit[pxDriverInput[i]].gpio.port;
+		pxConfig->pucDriverPin[ucStepperIndex][i] = gpioPinsInit[pxDriverInput[i]].gpio.pin;
+	}
+	pxConfig->pucLedPort[ucStepperIndex] = gpioPinsInit[xLed].gpio.port;
+	pxConfig->pucLedPin[ucStepperIndex] = gpioPinsInit[xLed].gpio.pin;
+}
+
+/*! \fn static BaseType_t prvDualCoreImageValid( void )
+	\brief Verificación de la tabla de vectores de la imagen del M0:
+	stack inicial dentro de su RAM y reset dentro del banco B.
+*/
+static BaseType_t prvDualCoreImageValid( void )
+{
+	const uint32_t *pulVectors = ( const uint32_t * ) ipcM0_IMAGE_ADDR;
+
+	if ( ( pulVectors[0] <= ipcM0_RAM_ADDR ) || ( pulVectors[0] > ipcM0_RAM_TOP ) ) {
+		return pdFALSE;
+	}
+	if ( ( pulVectors[1] < ipcM0_IMAGE_ADDR ) ||
+		( pulVectors[1] >= ipcM0_IMAGE_ADDR + 0x80000UL ) ) {
+		return pdFALSE;
+	}
+	return pdTRUE;
+}
+
+/*! \fn BaseType_t xDualCoreInit( void )
+	\brief Cargar la configuración en el mailbox y liberar el M0.
+*/
+BaseType_t xDualCoreInit( void )
+{
+	if ( prvDualCoreImageValid() == pdFALSE ) {
+		printf( "M0: sin imagen en 0x%08X\n", ( unsigned ) ipcM0_IMAGE_ADDR );
+		return pdFAIL;
+	}
+
+	/* M0 en reset mientras se prepara el mailbox */
+	Chip_RGU_TriggerReset( RGU_M0APP_RST );
+	while ( Chip_RGU_InReset( RGU_M0APP_RST ) == false );
+
+	vIpcMailboxInit( ipcMAILBOX );
+
+	/* El RITimer lo usa el M0 como base de tiempo de los pasos */
+	Chip_RIT_Init( LPC_RITIMER );
+	ipcMAILBOX->xConfig.ulTimerClockHz = Chip_Clock_GetRate( CLK_MX_RITIMER );
+	ipcMAILBOX->xConfig.ulTickRateHz = dualTICK_RATE_HZ;
+
+	/* Interrupción por eventos del M0. Usa APIs FromISR, por lo que
+	 * su prioridad no puede superar configMAX_SYSCALL_INTERRUPT_PRIORITY */
+	NVIC_SetPriority( M0APP_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1 );
+	Chip_CREG_ClearM0AppEvent();
+	NVIC_ClearPendingIRQ( M0APP_IRQn );
+
+	/* Mapeo de la imagen en la dirección 0 del M0 y liberación del reset */
+	Chip_CREG_SetM0AppMemMap( ipcM0_IMAGE_ADDR );
+	Chip_RGU_ClearReset( RGU_M0APP_RST );
+
+	/* Esperar a que el M0 termine su inicialización */
+	for ( uint32_t i=0; i<dualSTART_TIMEOUT; i++ ) {
+		if ( ipcMAILBOX->ulReady == ipcMAGIC_READY ) {
+			xDualCoreStarted = pdTRUE;
+			break;
+		}
+	}
+	if ( xDualCoreStarted == pdFALSE ) {
+		Chip_RGU_TriggerReset( RGU_M0APP_RST );
+		printf( "M0: sin respuesta\n" );
+		return pdFAIL;
+	}
+
+	NVIC_EnableIRQ( M0APP_IRQn );
+	return pdPASS;
+}
+
+/*! \fn BaseType_t xDualCoreRunning( void )
+	\brief Consultar si el M0 está generando los pasos.
+*/
+BaseType_t xDualCoreRunning( void )
+{
+	return xDualCoreStarted;
+}
+
+/*! \fn void vDualCoreSendCommand( const IpcCommand_t *pxCommand )
+	\brief Enviar un comando al M0 (desde tareas).
+*/
+void vDualCoreSendCommand( const IpcCommand_t *pxCommand )
+{
+	int32_t lWritten;
+
+	for ( ;; ) {
+		/* Varias tareas envían comandos, el M4 debe ser un único productor */
+		taskENTER_CRITICAL();
+		{
+			lWritten = lIpcCommandPut( ipcMAILBOX, pxCommand );
+		}
+		taskEXIT_CRITICAL();
+
+		if ( lWritten ) {
+			break;
+		}
+		/* Buffer lleno, el M0 lo vacía en su próxima interrupción */
+		ipcSIGNAL();
+		vTaskDelay( 1 );
+	}
+	ipcSIGNAL();
+}
+
+/*! \fn uint32_t ulDualCoreGetPendingSteps( uint8_t ucStepperIndex )
+	\brief Pasos pendientes del motor publicados por el M0.
+*/
+uint32_t ulDualCoreGetPendingSteps( uint8_t ucStepperIndex )
+{
+	return ipcMAILBOX->pulPendingSteps[ucStepperIndex];
+}
+
+/*! \fn void M0APP_IRQHandler( void )
+	\brief Interrupción por evento del M0: procesar los eventos
+	pendientes del mailbox.
+*/
+void M0APP_IRQHandler( void )
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	IpcEvent_t xEvent;
+
+	Chip_CREG_ClearM0AppEvent();
+
+	while ( lIpcEventGet( ipcMAILBOX, &xEvent ) ) {
+		if ( xEvent.ucType == ipcEVT_STEPPER_DONE ) {
+			vStepperDoneFromISR( xEvent.ucChannel, &xHigherPriorityTaskWoken );
+		}
+	}
+
+	portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+#endif /* appUSE_DUAL_CORE */
@@ -23,6 +23,7 @@
 #include "semphr.h"
 #include "timers.h"
 #include "FreeRTOSPriorities.h"
+#include "FreeRTOSMemory.h"
 
 /* EDU-CIAA firmware_v3 includes */
 #include "sapi.h"
@@ -30,22 +31,43 @@
 
 /* Aplicación includes */
 #include "encoder.h"
+#include "spsc_ring.h"
 #include "uart.h"
 #include "stepper.h"
 #include "servo.h"
 #include "display_lcd.h"
+#include "latency.h"
+#include "deferred.h"
+
+#if ( appUSE_ENCODER_QEI == 1 )
+/* Registros del QEI (LPC_QEI_T en qei_18xx_43xx.h) */
+#define qeiCON_RESP			( 1UL << 0 )	/* Reset del contador de posición */
+#define qeiCONF_CAPMODE		( 1UL << 2 )	/* Flancos de ambas fases (4x) */
+#define qeiINT_POS0			( 1UL << 6 )	/* Posición igual a CMPOS0 */
+#define qeiINT_POS1			( 1UL << 7 )	/* Posición igual a CMPOS1 */
+
+/*! \var TaskHandle_t xEncoderTaskHandle
+	\brief Handle de la tarea del encoder, notificada por el QEI.
+*/
+static TaskHandle_t xEncoderTaskHandle = NULL;
 
-/*! \var SemaphoreHandle_t xEncoderPositivePulseSemaphore
-	\brief Semáforo que guarda la cantidad de pulsos positivos
-	generados por el encoder en pin clock.
+/*! \var uint32_t ulEncoderQeiLast
+	\brief Posición del QEI del último pulso entregado a la tarea.
+*/
+static uint32_t ulEncoderQeiLast = 0;
+#else
+/*! \var SpscRing_t xEncoderPulseRing
+	\brief Buffer circular con la dirección (stepperDIR_POSITIVE o
+	stepperDIR_NEGATIVE) de cada pulso generado por el encoder en
+	pin clock.
 */
-SemaphoreHandle_t xEncoderPositivePulseSemaphore;
+SpscRing_t xEncoderPulseRing;
 
-/*! \var SemaphoreHandle_t xEncoderNegativePulseSemaphore
-	\brief Semáforo que guarda la cantidad de pulsos negativos
-	generados por el encoder en pin clock.
+/*! \var uint8_t pucEncoderPulseStorage[encoderMAX_CLK_PULSES]
+	\brief Memoria del buffer circular de pulsos.
 */
-SemaphoreHandle_t xEncoderNegativePulseSemaphore;
+static uint8_t pucEncoderPulseStorage[encoderMAX_CLK_PULSES];
+#endif
 
 /*! \var QueueHandle_t xEncoderChoiceMailbox
 	\brief Mailbox con la selección actual de motor mediante
@@ -53,9 +75,38 @@ SemaphoreHandle_t xEncoderNegativePulseSemaphore;
 */
 QueueHandle_t xEncoderChoiceMailbox;
 
+/*! \var xEncoderJogCurve
+	\brief Curva de aceleración: multiplicador del desplazamiento
+	para una cantidad de pulsos en la ventana de acumulación menor o
+	igual a ulPulses.
+*/
+static const struct {
+	uint32_t ulPulses;
+	uint32_t ulGain;
+} xEncoderJogCurve[] = {
+	{ 2,	1 },
+	{ 4,	2 },
+	{ 8,	4 },
+	{ 16,	8 }
+};
+
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+/*! \var xEncoderMemory
+	\brief Memoria estática de tarea y mailbox del módulo.
+*/
+static struct {
+	StaticTask_t xTaskTCB;
+	StackType_t puxTaskStack[ stackEncoderTask ];
+	StaticQueue_t xChoiceMailbox;
+	uint8_t pucChoiceMailboxStorage[ sizeof( uint8_t ) ];
+} xEncoderMemory memPLACE( memBANK_ENCODER );
+
+memMODULE( xEncoderMemoryModule, "Encoder", memBANK_ENCODER, memBUDGET_ENCODER, xEncoderMemory );
+#endif
+
 /*! \fn void vDeferredHandlingFunction( void* pvParameter1, uint32_t ulParameter2 )
-	\brief Función a ejecutar como procesamiento diferido a tarea RTOS daemon
-	desde encoder (ante el pulsador).
+	\brief Función a ejecutar como procesamiento diferido a tarea de
+	lotes (deferred.h) desde encoder (ante el pulsador).
 	\param pvParameter1 Primer parámetro de la función en forma void* para apuntar
 	a estructura.
 	\param ulParameter2 Segundo parámetro de la función en forma de uint32_t.
@@ -81,26 +132,113 @@ static void vDeferredHandlingFunction( void* pvParameter1, uint32_t ulParameter2
 	vUartSendMsg("ENC_SW");
 }
 
+#if ( appUSE_ENCODER_QEI == 1 )
+/*! \fn void QEI_IRQHandler( void )
+	\brief Interrupción del QEI por alcanzar el umbral de posición.
+*/
+void QEI_IRQHandler( void )
+{
+	latencyISR_ENTRY( latencySRC_ENCODER );
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	/* Una única interrupción por umbral: queda deshabilitada hasta que
+	 * la tarea procese la posición y vuelva a armar las comparaciones */
+	LPC_QEI->IEC = qeiINT_POS0 | qeiINT_POS1;
+	LPC_QEI->CLR = qeiINT_POS0 | qeiINT_POS1;
+	vTaskNotifyGiveFromISR( xEncoderTaskHandle, &xHigherPriorityTaskWoken );
+
+	latencyISR_YIELD( latencySRC_ENCODER );
+	portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+/*! \fn static void prvEncoderQeiArm( void )
+	\brief Armar las comparaciones de posición a encoderQEI_THRESHOLD
+	cuentas de la última posición procesada, en ambos sentidos.
+*/
+static void prvEncoderQeiArm( void )
+{
+	LPC_QEI->CMPOS0 = ulEncoderQeiLast + encoderQEI_THRESHOLD;
+	LPC_QEI->CMPOS1 = ulEncoderQeiLast - encoderQEI_THRESHOLD;
+	LPC_QEI->CLR = qeiINT_POS0 | qeiINT_POS1;
+	LPC_QEI->IES = qeiINT_POS0 | qeiINT_POS1;
+}
+
+/*! \fn static BaseType_t prvEncoderReceivePulse( uint8_t *pucDir, TickType_t xTicksToWait )
+	\brief Esperar el próximo pulso del encoder (una posición de
+	reposo) a partir de la posición del QEI.
+	\param pucDir Dirección del pulso.
+	\param xTicksToWait Máximo tiempo a esperar bloqueado.
+	\return pdTRUE si hubo un pulso, pdFALSE si se cumplió el tiempo.
+*/
+static BaseType_t prvEncoderReceivePulse( uint8_t *pucDir, TickType_t xTicksToWait )
+{
+	TimeOut_t xTimeOut;
+	int32_t lDelta;
+
+	vTaskSetTimeOutState( &xTimeOut );
+	for ( ;; ) {
+		lDelta = ( int32_t ) ( LPC_QEI->POS - ulEncoderQeiLast );
+		if ( lDelta >= encoderQEI_COUNTS_PER_DETENT ) {
+			ulEncoderQeiLast += encoderQEI_COUNTS_PER_DETENT;
+			*pucDir = stepperDIR_POSITIVE;
+			return pdTRUE;
+		}
+		if ( lDelta <= -encoderQEI_COUNTS_PER_DETENT ) {
+			ulEncoderQeiLast -= encoderQEI_COUNTS_PER_DETENT;
+			*pucDir = stepperDIR_NEGATIVE;
+			return pdTRUE;
+		}
+
+		prvEncoderQeiArm();
+		/* La comparación es por igualdad: si la posición alcanzó el
+		 * umbral antes de armarla no habrá interrupción */
+		lDelta = ( int32_t ) ( LPC_QEI->POS - ulEncoderQeiLast );
+		if ( ( lDelta >= encoderQEI_THRESHOLD ) || ( lDelta <= -encoderQEI_THRESHOLD ) ) {
+			continue;
+		}
+		if ( ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdTRUE ) ||
+			( ulTaskNotifyTake( pdTRUE, xTicksToWait ) == 0 ) ) {
+			return pdFALSE;
+		}
+		latencyTASK_RESUME( latencySRC_ENCODER );
+	}
+}
+#else
 /*! \fn void PININT1_IRQ_HANDLER( void )
 	\brief Handler interrupt from GPIO pin or GPIO pin mapped to PININT
 */
 void vEncoderCLK_IRQ_HANDLER( void )
 {
+	latencyISR_ENTRY( latencySRC_ENCODER );
 	Chip_PININT_ClearIntStatus( LPC_GPIO_PIN_INT, PININTCH( PININT1_INDEX ) );
 	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-	if ( gpioRead( encoderPIN_DT ) ) {
-		/* Agregar pulso positivo al semáforo contador */
-		xSemaphoreGiveFromISR( xEncoderPositivePulseSemaphore,
-			&xHigherPriorityTaskWoken );
-	} else {
-		/* Agregar pulso positivo al semáforo contador */
-		xSemaphoreGiveFromISR( xEncoderNegativePulseSemaphore,
-			&xHigherPriorityTaskWoken );
-	}
-
+	/* Dirección del pulso según el pin DT */
+	uint8_t ucDir = gpioRead( encoderPIN_DT ) ?
+		stepperDIR_POSITIVE : stepperDIR_NEGATIVE;
+	/* Agregar pulso al buffer circular (se descarta si está lleno) */
+	xSpscRingPutFromISR( &xEncoderPulseRing, &ucDir, 1,
+		&xHigherPriorityTaskWoken );
+
+	latencyISR_YIELD( latencySRC_ENCODER );
 	portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
 }
 
+/*! \fn static BaseType_t prvEncoderReceivePulse( uint8_t *pucDir, TickType_t xTicksToWait )
+	\brief Esperar el próximo pulso del encoder del buffer circular.
+	\param pucDir Dirección del pulso.
+	\param xTicksToWait Máximo tiempo a esperar bloqueado.
+	\return pdTRUE si hubo un pulso, pdFALSE si se cumplió el tiempo.
+*/
+static BaseType_t prvEncoderReceivePulse( uint8_t *pucDir, TickType_t xTicksToWait )
+{
+	if ( ulSpscRingReceive( &xEncoderPulseRing, pucDir, 1, xTicksToWait ) == 0 ) {
+		return pdFALSE;
+	}
+	latencyTASK_RESUME( latencySRC_ENCODER );
+	return pdTRUE;
+}
+#endif
+
 /*! \fn void PININT_IRQ_HANDLER( void )
 	\brief Handler interrupt from GPIO pin or GPIO pin mapped to PININT
 */
@@ -111,9 +249,11 @@ void PININT_IRQ_HANDLER( void )
 
 	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-	/* Procesamiento diferido al RTOS daemon */
-	xTimerPendFunctionCallFromISR(
-			/* Puntero a la función a ejecutar en la tarea daemon */
+	/* Procesamiento diferido a la tarea de lotes */
+	xDeferredPostFromISR(
+			/* Buffer de entradas de usuario */
+			deferredPRIORITY_LOW,
+			/* Puntero a la función a ejecutar en la tarea */
 			vDeferredHandlingFunction,
 			/* Primer parámetro de la función en forma void* para apuntar a estructura */
 			NULL,
@@ -126,8 +266,24 @@ void PININT_IRQ_HANDLER( void )
 	portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
 }
 
+/*! \fn static uint32_t prvEncoderJogGain( uint32_t ulPulses )
+	\brief Curva de aceleración: multiplicador del desplazamiento por
+	pulso según la cantidad de pulsos en la ventana de acumulación.
+*/
+static uint32_t prvEncoderJogGain( uint32_t ulPulses )
+{
+	for ( uint8_t i=0; i<sizeof( xEncoderJogCurve )/sizeof( xEncoderJogCurve[0] ); i++ ) {
+		if ( ulPulses <= xEncoderJogCurve[i].ulPulses ) {
+			return xEncoderJogCurve[i].ulGain;
+		}
+	}
+	return xEncoderJogCurve[ sizeof( xEncoderJogCurve )/sizeof( xEncoderJogCurve[0] ) - 1 ].ulGain;
+}
+
 /*! \fn void vEncoderTask( void *pvParameters )
-	\brief Tarea de procesamiento de información de encoder.
+	\brief Tarea de procesamiento de información de encoder. Acumula
+	los pulsos durante encoderJOG_WINDOW_MS desde el primero y genera
+	una única consigna relativa, escalada según la velocidad de giro.
 */
 void vEncoderTask( void *pvParameters )
 {
@@ -135,90 +291,79 @@ void vEncoderTask( void *pvParameters )
 	uint8_t cValue = 0;
 	xQueueOverwrite( xEncoderChoiceMailbox, &cValue );
 
-	/* Creación de set de semáforos */
-	static QueueSetHandle_t xEncoderSemaphoreSet;
-	xEncoderSemaphoreSet = xQueueCreateSet( 2 * encoderMAX_CLK_PULSES );
-	/* Agregar semáforos al set */
-	xQueueAddToSet( xEncoderPositivePulseSemaphore, xEncoderSemaphoreSet );
-	xQueueAddToSet( xEncoderNegativePulseSemaphore, xEncoderSemaphoreSet );
-	/* Semáforo con información */
-	SemaphoreHandle_t xReceivedSemaphore;
-
-	/* Puntero al mensaje a enviar */
-	char *pcMsgToSend = ( char * ) pvPortMalloc( 10 * sizeof( char ) );
-	/* Caracter auxiliar */
-	char cAuxChar[2] = "0";
+	/* Dirección del pulso recibido */
+	uint8_t ucDir;
+	/* Pulsos en la ventana y desplazamiento neto en pulsos */
+	uint32_t ulPulses;
+	int32_t lDetents;
+	/* Mensaje de la consigna, en una línea del pool de UART por
+	 * destino: las colas guardan sólo el puntero y cada destino
+	 * libera su copia */
+	char pcMsg[encoderMSG_LENGTH];
+	char *pcLine;
+	/* Ventana de acumulación */
+	TimeOut_t xTimeOut;
+	TickType_t xTicksToWait;
 
 	for ( ;; ) {
+		/* Primer pulso y acumulación de los siguientes en la ventana */
+		prvEncoderReceivePulse( &ucDir, portMAX_DELAY );
+		lDetents = ( ucDir == stepperDIR_POSITIVE ) ? 1 : -1;
+		ulPulses = 1;
+		xTicksToWait = pdMS_TO_TICKS( encoderJOG_WINDOW_MS );
+		vTaskSetTimeOutState( &xTimeOut );
+		while ( ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE ) &&
+			prvEncoderReceivePulse( &ucDir, xTicksToWait ) ) {
+			lDetents += ( ucDir == stepperDIR_POSITIVE ) ? 1 : -1;
+			ulPulses++;
+		}
+		if ( lDetents == 0 ) {
+			continue;
+		}
+		/* Escalado según la velocidad de giro */
+		lDetents *= ( int32_t ) prvEncoderJogGain( ulPulses );
+
 		/* Lectura de selección de motor en mailbox */
 		xQueuePeek( xEncoderChoiceMailbox, &cValue, portMAX_DELAY );
-		/* Inicio de mensaje */
 		if ( cValue < stepperAPP_NUM ) {
-			/* Consigna a motor paso a paso */
-			strcpy( pcMsgToSend, ":S" );
-			cAuxChar[0] = cValue + '0';
-			strcat( pcMsgToSend, cAuxChar );
+			/* Consigna relativa al motor paso a paso, acumulada en la
+			 * pendiente si todavía no se procesó */
+			int32_t lAngle = lDetents * encoderANGLE_TO_SEND;
+			if ( lAngle > encoderJOG_MAX_ANGLE ) {
+				lAngle = encoderJOG_MAX_ANGLE;
+			} else if ( lAngle < -encoderJOG_MAX_ANGLE ) {
+				lAngle = -encoderJOG_MAX_ANGLE;
+			}
+			vStepperJog( cValue, lAngle );
+			snprintf( pcMsg, encoderMSG_LENGTH, ":S%uD%uA%03ld", cValue,
+				( lAngle < 0 ) ? stepperDIR_NEGATIVE : stepperDIR_POSITIVE,
+				labs( lAngle ) );
 		} else if ( cValue == stepperAPP_NUM ) {
-			/* Consigna a servomotor */
-			strcpy( pcMsgToSend, ":X" );
+			/* Consigna absoluta al servomotor */
+			uint8_t cPositionValue;
+			int32_t lPosition;
+			xQueuePeek( xServoPositionMailbox, &cPositionValue, portMAX_DELAY );
+			lPosition = cPositionValue + lDetents * servoVALUE_INCRMENT;
+			if ( lPosition > 180 ) {
+				lPosition = 180;
+			} else if ( lPosition < 0 ) {
+				lPosition = 0;
+			}
+			if ( lPosition == cPositionValue ) {
+				continue;
+			}
+			snprintf( pcMsg, encoderMSG_LENGTH, ":X%d", ( int ) lPosition );
+			pcLine = pcUartAllocLine( portMAX_DELAY );
+			memcpy( pcLine, pcMsg, encoderMSG_LENGTH );
+			vServoSendMsg( pcLine );
 		} else {
 			/* Excepción, valor no válido (no debería suceder) */
 			continue;
 		}
 
-		/* Lectura de handle del set */
-		xReceivedSemaphore = ( SemaphoreHandle_t ) xQueueSelectFromSet( xEncoderSemaphoreSet, portMAX_DELAY );
-		/* Obtener que semáforo tiene información y realizar take */
-		if ( xReceivedSemaphore == xEncoderPositivePulseSemaphore ) {
-			xSemaphoreTake( xEncoderPositivePulseSemaphore, portMAX_DELAY );
-			if ( cValue < stepperAPP_NUM ) {
-				strcat( pcMsgToSend, "D\0" );
-				cAuxChar[0] = (char)stepperDIR_POSITIVE + '0';
-				strcat( pcMsgToSend, cAuxChar );
-				/* Ángulo a setear */
-				strcat( pcMsgToSend, "A015" );
-				/* Enviar mensaje a cola de consignas */
-				vStepperSendMsg( pcMsgToSend );
-			} else {
-				uint8_t cPositionValue;
-				xQueuePeek( xServoPositionMailbox, &cPositionValue, portMAX_DELAY );
-				if ( cPositionValue >= 180 ) {
-					continue;
-				} else {
-					cPositionValue += servoVALUE_INCRMENT;
-					char pcAuxValue[4];
-					sprintf( pcAuxValue, "%d", cPositionValue );
-					strcat( pcMsgToSend, pcAuxValue );
-					vServoSendMsg( pcMsgToSend );
-				}
-			}
-		} else if ( xReceivedSemaphore == xEncoderNegativePulseSemaphore ) {
-			xSemaphoreTake( xEncoderNegativePulseSemaphore, portMAX_DELAY );
-
-			if ( cValue < stepperAPP_NUM ) {
-				strcat( pcMsgToSend, "D\0" );
-				cAuxChar[0] = (char)stepperDIR_NEGATIVE + '0';
-				strcat( pcMsgToSend, cAuxChar );
-				/* Ángulo a setear */
-				strcat( pcMsgToSend, "A015" );
-				/* Enviar mensaje a cola de consignas */
-				vStepperSendMsg( pcMsgToSend );
-			} else {
-				uint8_t cPositionValue;
-				xQueuePeek( xServoPositionMailbox, &cPositionValue, portMAX_DELAY );
-				if ( cPositionValue <= 0 ) {
-					continue;
-				} else {
-					cPositionValue -= servoVALUE_INCRMENT;
-					char pcAuxValue[4];
-					sprintf( pcAuxValue, "%d", cPositionValue );
-					strcat( pcMsgToSend, pcAuxValue );
-					vServoSendMsg( pcMsgToSend );
-				}
-			}
-		}
-
-		vUartSendMsg( pcMsgToSend );
+		pcLine = pcUartAllocLine( portMAX_DELAY );
+		memcpy( pcLine, pcMsg, encoderMSG_LENGTH );
+		vUartSendMsg( pcLine );
 	}
 }
 
@@ -263,6 +408,39 @@ BaseType_t xEncoderInit( void )
 	NVIC_EnableIRQ( PININT_NVIC_NAME );
 	NVIC_SetPriority( PININT_NVIC_NAME, 255 );
 
+#if ( appUSE_ENCODER_QEI == 1 )
+	/* Fases A y B en las entradas del QEI */
+	Chip_SCU_PinMuxSet( encoderQEI_PHA_SCU_PORT, encoderQEI_PHA_SCU_PIN,
+		SCU_MODE_PULLUP | SCU_MODE_INBUFF_EN | encoderQEI_SCU_FUNC );
+	Chip_SCU_PinMuxSet( encoderQEI_PHB_SCU_PORT, encoderQEI_PHB_SCU_PIN,
+		SCU_MODE_PULLUP | SCU_MODE_INBUFF_EN | encoderQEI_SCU_FUNC );
+
+	/* Reloj y reset del periférico */
+	Chip_Clock_Enable( CLK_MX_QEI );
+	Chip_RGU_TriggerReset( RGU_QEI_RST );
+	while ( Chip_RGU_InReset( RGU_QEI_RST ) ) {}
+
+	/* Cuenta de flancos de ambas fases, contador de posición libre
+	 * (la diferencia con la última posición se calcula módulo 2^32) */
+	LPC_QEI->IEC = 0xFFFFFFFF;
+	LPC_QEI->CONF = qeiCONF_CAPMODE;
+	LPC_QEI->MAXPOS = 0xFFFFFFFF;
+	LPC_QEI->FILTERPHA = encoderQEI_FILTER_CYCLES;
+	LPC_QEI->FILTERPHB = encoderQEI_FILTER_CYCLES;
+	LPC_QEI->CON = qeiCON_RESP;
+	LPC_QEI->CLR = 0xFFFFFFFF;
+	ulEncoderQeiLast = LPC_QEI->POS;
+
+	/* Las comparaciones de posición las habilita la tarea */
+	NVIC_ClearPendingIRQ( QEI_IRQn );
+	NVIC_SetPriority( QEI_IRQn, 255 );
+	NVIC_EnableIRQ( QEI_IRQn );
+#else
+	/* Inicialización del buffer circular de pulsos antes de
+	habilitar la interrupción de clock */
+	vSpscRingInit( &xEncoderPulseRing, pucEncoderPulseStorage,
+		encoderMAX_CLK_PULSES );
+
 	/* Configuracion como entrada de CLK y DIR */
 	gpioConfig( encoderPIN_CLK, GPIO_INPUT_PULLUP );
 	gpioConfig( encoderPIN_DT, GPIO_INPUT_PULLUP );
@@ -284,6 +462,7 @@ BaseType_t xEncoderInit( void )
 	NVIC_EnableIRQ( PIN_INT0_IRQn + PININT1_INDEX );
 	/* Seteo del nivel de prioridad de la interrupción 0 */
 	NVIC_SetPriority( PININT1_NVIC_NAME, 255 );
+#endif
 
 	/*
 	* Select irq channel to handle a GPIO interrupt, using its port and pin to specify it
@@ -304,41 +483,42 @@ BaseType_t xEncoderInit( void )
 //	NVIC_SetPriority( PININT2_NVIC_NAME, 255 );
 
 	/* Creación de mailbox con selección de motor */
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+	xEncoderChoiceMailbox = xQueueCreateStatic( 1, sizeof( uint8_t ),
+		xEncoderMemory.pucChoiceMailboxStorage, &xEncoderMemory.xChoiceMailbox );
+#else
 	xEncoderChoiceMailbox = xQueueCreate( 1, sizeof( uint8_t ) );
+#endif
 	/* Verificación de mailbox creado con éxito */
 	configASSERT( xEncoderChoiceMailbox != NULL );
 
-	/* Creación de semáforo contador para pulsos positivos de clock */
-	xEncoderPositivePulseSemaphore = xSemaphoreCreateCounting(
-		/* Cantidad máxima de elementos */
-		encoderMAX_CLK_PULSES,
-		/* Cuenta inicial del semáforo */
-		0
-	);
-	/* Creación de semáforo contador para pulsos negativos de clock */
-	xEncoderNegativePulseSemaphore = xSemaphoreCreateCounting(
-		/* Cantidad máxima de elementos */
-		encoderMAX_CLK_PULSES,
-		/* Cuenta inicial del semáforo */
-		0
-	);
-
 	/* Creación de tarea de procesamiento de información de encoder */
 	BaseType_t xStatus = pdPASS;
+	TaskHandle_t xHandle = NULL;
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+	xHandle = xTaskCreateStatic( vEncoderTask, ( const char * ) "EncoderTask",
+		stackEncoderTask, NULL, priorityEncoderTask,
+		xEncoderMemory.puxTaskStack, &xEncoderMemory.xTaskTCB );
+	xStatus = ( xHandle != NULL ) ? pdPASS : pdFAIL;
+#else
 	xStatus = xTaskCreate(
 		/* Puntero a la función que implementa la tarea */
 		vEncoderTask,
 		/* Nombre de la tarea amigable para el usuario */
 		( const char * ) "EncoderTask",
 		/* Tamaño de stack de la tarea */
-		configMINIMAL_STACK_SIZE*2,
+		stackEncoderTask,
 		/* Parámetros de la tarea */
 		NULL,
 		/* Prioridad de la tarea */
 		priorityEncoderTask,
 		/* Handle de la tarea creada */
-		NULL
+		&xHandle
 	);
+#endif
+#if ( appUSE_ENCODER_QEI == 1 )
+	xEncoderTaskHandle = xHandle;
+#endif
 
 	return xStatus;
 }
@@ -0,0 +1,191 @@
+/*! \file i2c_bus.c
+    \brief Acceso compartido de las tareas al bus I2C0 sobre la cola
+    de transacciones por interrupción de sapi_i2c.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+/* Utilidades includes */
+#include <stdio.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "FreeRTOSMemory.h"
+
+/* EDU-CIAA firmware_v3 includes */
+#include "sapi.h"
+#include "chip.h"
+
+/* Aplicación includes */
+#include "i2c_bus.h"
+#include "barrier.h"
+
+/*! \var xI2cBus
+	\brief Mutex, barrera y transacción de la tarea que tiene el bus
+	(sólo una tarea espera a la vez). Contadores del reporte anterior
+	para la ocupación del bus.
+*/
+static struct {
+	SemaphoreHandle_t xMutex;
+	Barrier_t xBarrier;
+	i2cTransaction_t xTransaction;
+	i2cStats_t xLastStats;
+	uint32_t ulLastCycles;
+} xI2cBus;
+
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+/*! \var xI2cBusMemory
+	\brief Memoria estática del mutex del módulo.
+*/
+static struct {
+	StaticSemaphore_t xMutexBuffer;
+} xI2cBusMemory memPLACE( memBANK_I2C );
+
+memMODULE( xI2cBusMemoryModule, "I2C", memBANK_I2C, memBUDGET_I2C, xI2cBusMemory );
+#endif
+
+/*! \fn static void prvI2cBusDone( i2cTransaction_t *pxTransaction )
+	\brief Finalización de la transacción desde I2C0_IRQHandler().
+*/
+static void prvI2cBusDone( i2cTransaction_t *pxTransaction )
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	vBarrierArriveFromISR( &xI2cBus.xBarrier, 0, &xHigherPriorityTaskWoken );
+	portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+/*! \fn BaseType_t xI2cBusTake( TickType_t xTicksToWait )
+	\brief Tomar el bus para una secuencia de transacciones.
+*/
+BaseType_t xI2cBusTake( TickType_t xTicksToWait )
+{
+	return xSemaphoreTakeRecursive( xI2cBus.xMutex, xTicksToWait );
+}
+
+/*! \fn void vI2cBusGive( void )
+	\brief Liberar el bus.
+*/
+void vI2cBusGive( void )
+{
+	xSemaphoreGiveRecursive( xI2cBus.xMutex );
+}
+
+/*! \fn static BaseType_t prvI2cBusRun( i2cTransaction_t *pxTransaction, TickType_t xTicksToWait )
+	\brief Tomar el bus, encolar la transacción y esperar en la barrera
+	su finalización.
+	\return pdPASS o pdFAIL por timeout, NAK o error de bus.
+*/
+static BaseType_t prvI2cBusRun( i2cTransaction_t *pxTransaction, TickType_t xTicksToWait )
+{
+	TimeOut_t xTimeOut;
+	BaseType_t xResult = pdFAIL;
+
+	vTaskSetTimeOutState( &xTimeOut );
+	if ( xI2cBusTake( xTicksToWait ) != pdPASS ) {
+		return pdFAIL;
+	}
+	xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait );
+
+	pxTransaction->callback = prvI2cBusDone;
+	pxTransaction->param = NULL;
+
+	vBarrierArm( &xI2cBus.xBarrier );
+	vBarrierExpect( &xI2cBus.xBarrier, 0 );
+	if ( i2cTransactionStart( I2C0, pxTransaction ) ) {
+		if ( ulBarrierWait( &xI2cBus.xBarrier, xTicksToWait ) != 0 ) {
+			/* Bus bloqueado o cola demorada: la transacción no puede
+			 * quedar en la cola al liberar el bus */
+			i2cTransactionCancel( I2C0, pxTransaction );
+		}
+		xResult = ( pxTransaction->status == I2CM_STATUS_OK ) ? pdPASS : pdFAIL;
+	}
+
+	vI2cBusGive();
+	return xResult;
+}
+
+/*! \fn static bool_t prvI2cBusBlocking( i2cTransaction_t *pxTransaction )
+	\brief Transacción de i2cRead() e i2cWrite() (drivers de sAPI):
+	la tarea queda bloqueada como con xI2cBusTransfer(). Antes de
+	iniciar el scheduler no hay tarea que bloquear y se espera el
+	estado de la transacción.
+*/
+static bool_t prvI2cBusBlocking( i2cTransaction_t *pxTransaction )
+{
+	if ( xTaskGetSchedulerState() != taskSCHEDULER_RUNNING ) {
+		while ( !i2cTransactionStart( I2C0, pxTransaction ) );
+		while ( pxTransaction->status == I2CM_STATUS_BUSY );
+		return pxTransaction->status == I2CM_STATUS_OK;
+	}
+	return prvI2cBusRun( pxTransaction, portMAX_DELAY ) == pdPASS;
+}
+
+/*! \fn BaseType_t xI2cBusTransfer( uint8_t ucAddress, const uint8_t *pucTx, uint16_t usTxSize, uint8_t *pucRx, uint16_t usRxSize, TickType_t xTicksToWait )
+	\brief Escribir y luego leer con start repetido.
+*/
+BaseType_t xI2cBusTransfer( uint8_t ucAddress, const uint8_t *pucTx, uint16_t usTxSize,
+	uint8_t *pucRx, uint16_t usRxSize, TickType_t xTicksToWait )
+{
+	i2cTransaction_t *pxTransaction = &xI2cBus.xTransaction;
+
+	pxTransaction->slaveAddress = ucAddress;
+	pxTransaction->txBuffer = pucTx;
+	pxTransaction->txSize = usTxSize;
+	pxTransaction->rxBuffer = pucRx;
+	pxTransaction->rxSize = usRxSize;
+	return prvI2cBusRun( pxTransaction, xTicksToWait );
+}
+
+/*! \fn void vI2cBusReport( void )
+	\brief Imprimir los contadores del bus.
+*/
+void vI2cBusReport( void )
+{
+	i2cStats_t xStats;
+	uint32_t ulCycles = DWT->CYCCNT;
+	uint32_t ulElapsed = ulCycles - xI2cBus.ulLastCycles;
+	uint32_t ulBusy, ulPermil;
+
+	i2cGetStats( I2C0, &xStats );
+	ulBusy = xStats.busyCycles - xI2cBus.xLastStats.busyCycles;
+	/* Ocupación en décimas de porcentaje */
+	ulPermil = ulElapsed ? ( uint32_t ) ( ( uint64_t ) ulBusy * 1000 / ulElapsed ) : 0;
+
+	printf( "I2C:STATS n %u err %u bytes %u queue max %u busy %u.%u%%\n",
+		( unsigned ) ( xStats.transactions - xI2cBus.xLastStats.transactions ),
+		( unsigned ) ( xStats.errors - xI2cBus.xLastStats.errors ),
+		( unsigned ) ( xStats.bytes - xI2cBus.xLastStats.bytes ),
+		( unsigned ) xStats.maxQueued,
+		( unsigned ) ( ulPermil / 10 ), ( unsigned ) ( ulPermil % 10 ) );
+	vBarrierReport( &xI2cBus.xBarrier, "I2C" );
+
+	xI2cBus.xLastStats = xStats;
+	xI2cBus.ulLastCycles = ulCycles;
+}
+
+/*! \fn BaseType_t xI2cBusInit( void )
+	\brief Inicialización del bus y del mutex.
+*/
+BaseType_t xI2cBusInit( void )
+{
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+	xI2cBus.xMutex = xSemaphoreCreateRecursiveMutexStatic( &xI2cBusMemory.xMutexBuffer );
+#else
+	xI2cBus.xMutex = xSemaphoreCreateRecursiveMutex();
+#endif
+	if ( xI2cBus.xMutex == NULL ) {
+		return pdFAIL;
+	}
+	vBarrierInit( &xI2cBus.xBarrier, 1, i2cbusNOTIFY_BIT );
+
+	if ( !i2cAsyncInit( I2C0, i2cbusRATE ) ) {
+		return pdFAIL;
+	}
+	i2cAsyncSetBlockingTransfer( I2C0, prvI2cBusBlocking );
+	xI2cBus.ulLastCycles = DWT->CYCCNT;
+	return pdPASS;
+}
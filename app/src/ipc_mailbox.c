@@ -0,0 +1,100 @@
+/*! \file ipc_mailbox.c
+    \brief Mailbox en SRAM compartida entre el Cortex-M4
+    (FreeRTOS) y el Cortex-M0APP (motor de pasos y PWM).
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Se compila en ambas imágenes (ver app/m0/Makefile).
+*/
+
+/* Aplicación includes */
+#include "ipc_mailbox.h"
+
+/*! \fn void vIpcMailboxInit( IpcMailbox_t *pxMailbox )
+	\brief Inicialización del mailbox (M4, antes de liberar el M0).
+*/
+void vIpcMailboxInit( IpcMailbox_t *pxMailbox )
+{
+	pxMailbox->ulReady = 0;
+	pxMailbox->ulCommandHead = 0;
+	pxMailbox->ulCommandTail = 0;
+	pxMailbox->ulEventHead = 0;
+	pxMailbox->ulEventTail = 0;
+	pxMailbox->ulEventDropped = 0;
+	for ( uint8_t i=0; i<ipcSTEPPER_NUM; i++ ) {
+		pxMailbox->pulPendingSteps[i] = 0;
+	}
+	pxMailbox->ulTicks = 0;
+	ipcMEMORY_BARRIER();
+}
+
+/*! \fn int32_t lIpcCommandPut( IpcMailbox_t *pxMailbox, const IpcCommand_t *pxCommand )
+	\brief Escribir un comando (M4, único productor).
+*/
+int32_t lIpcCommandPut( IpcMailbox_t *pxMailbox, const IpcCommand_t *pxCommand )
+{
+	uint32_t ulHead = pxMailbox->ulCommandHead;
+
+	if ( ulHead - pxMailbox->ulCommandTail >= ipcRING_LENGTH ) {
+		return 0;
+	}
+	pxMailbox->pxCommand[ ulHead & ( ipcRING_LENGTH - 1 ) ] = *pxCommand;
+	/* El comando debe ser visible antes que el índice */
+	ipcMEMORY_BARRIER();
+	pxMailbox->ulCommandHead = ulHead + 1;
+	return 1;
+}
+
+/*! \fn int32_t lIpcCommandGet( IpcMailbox_t *pxMailbox, IpcCommand_t *pxCommand )
+	\brief Leer un comando (M0, único consumidor).
+*/
+int32_t lIpcCommandGet( IpcMailbox_t *pxMailbox, IpcCommand_t *pxCommand )
+{
+	uint32_t ulTail = pxMailbox->ulCommandTail;
+
+	if ( ulTail == pxMailbox->ulCommandHead ) {
+		return 0;
+	}
+	/* El comando se lee después de haber leído el índice */
+	ipcMEMORY_BARRIER();
+	*pxCommand = pxMailbox->pxCommand[ ulTail & ( ipcRING_LENGTH - 1 ) ];
+	/* Liberar la posición una vez copiado el comando */
+	ipcMEMORY_BARRIER();
+	pxMailbox->ulCommandTail = ulTail + 1;
+	return 1;
+}
+
+/*! \fn int32_t lIpcEventPut( IpcMailbox_t *pxMailbox, const IpcEvent_t *pxEvent )
+	\brief Escribir un evento (M0, único productor).
+*/
+int32_t lIpcEventPut( IpcMailbox_t *pxMailbox, const IpcEvent_t *pxEvent )
+{
+	uint32_t ulHead = pxMailbox->ulEventHead;
+
+	if ( ulHead - pxMailbox->ulEventTail >= ipcRING_LENGTH ) {
+		pxMailbox->ulEventDropped++;
+		return 0;
+	}
+	pxMailbox->pxEvent[ ulHead & ( ipcRING_LENGTH - 1 ) ] = *pxEvent;
+	ipcMEMORY_BARRIER();
+	pxMailbox->ulEventHead = ulHead + 1;
+	return 1;
+}
+
+/*! \fn int32_t lIpcEventGet( IpcMailbox_t *pxMailbox, IpcEvent_t *pxEvent )
+	\brief Leer un evento (M4, único consumidor).
+*/
+int32_t lIpcEventGet( IpcMailbox_t *pxMailbox, IpcEvent_t *pxEvent )
+{
+	uint32_t ulTail = pxMailbox->ulEventTail;
+
+	if ( ulTail == pxMailbox->ulEventHead ) {
+		return 0;
+	}
+	ipcMEMORY_BARRIER();
+	*pxEvent = pxMailbox->pxEvent[ ulTail & ( ipcRING_LENGTH - 1 ) ];
+	ipcMEMORY_BARRIER();
+	pxMailbox->ulEventTail = ulTail + 1;
+	return 1;
+}
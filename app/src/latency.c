@@ -0,0 +1,392 @@
+/*! \file latency.c
+    \brief Medición de latencia de interrupción a tarea con el
+    contador de ciclos DWT y un pin GPIO marcador.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+/* Utilidades includes */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* EDU-CIAA firmware_v3 includes */
+#include "sapi.h"
+#include "chip.h"
+
+/* Aplicación includes */
+#include "latency.h"
+
+#if ( appUSE_LATENCY == 1 )
+
+/*! \var typedef struct xLatencyStats LatencyStats_t
+	\brief Estadísticas de un intervalo en ciclos.
+*/
+typedef struct xLatencyStats {
+	uint32_t ulCount;
+	uint32_t ulMin;
+	uint32_t ulMax;
+	uint64_t ullSum;
+} LatencyStats_t;
+
+/*! \var typedef struct xLatencyData LatencyData_t
+	\brief Instantes y tablas de una fuente de interrupción.
+*/
+typedef struct xLatencyData {
+	/* Entrada a la ISR en curso */
+	volatile uint32_t ulIsrEntry;
+	/* Entrada a la primera ISR no atendida por la tarea */
+	volatile uint32_t ulPendingEntry;
+	/* Hay una interrupción no atendida por la tarea */
+	volatile uint32_t ulPending;
+	/* Entrada a ISR a portYIELD_FROM_ISR (escribe la ISR) */
+	LatencyStats_t xIsr;
+	/* Entrada a ISR a tarea en ejecución (escribe la tarea) */
+	LatencyStats_t xTask;
+	/* Histograma de la latencia total */
+	uint32_t pulHistogram[latencyHIST_BINS];
+} LatencyData_t;
+
+/*! \var typedef struct xLatencyTask LatencyTask_t
+	\brief Tiempo de ejecución de las activaciones de una tarea.
+*/
+typedef struct xLatencyTask {
+	/* Tarea medida (NULL si el número de TCB no se usó) */
+	TaskHandle_t xTask;
+	/* Inicio del tramo en ejecución actual */
+	uint32_t ulSwitchIn;
+	/* Inicio de la activación actual */
+	uint32_t ulJobStart;
+	/* Ciclos ejecutados en la activación actual */
+	uint32_t ulJobCycles;
+	/* Hay una activación en curso */
+	uint32_t ulInJob;
+	/* Activaciones completas */
+	uint32_t ulJobs;
+	/* Máximo y suma de ciclos por activación */
+	uint32_t ulWcet;
+	uint64_t ullSum;
+	/* Mínimo tiempo entre inicios de activaciones */
+	uint32_t ulMinInterArrival;
+} LatencyTask_t;
+
+/*! \var LatencyTask_t pxLatencyTask[latencyMAX_TASKS]
+	\brief Mediciones de cada tarea indexadas por número de TCB.
+*/
+static LatencyTask_t pxLatencyTask[latencyMAX_TASKS];
+
+/*! \var LatencyData_t pxLatencyData[latencySRC_NUM]
+	\brief Datos de cada fuente.
+*/
+static LatencyData_t pxLatencyData[latencySRC_NUM];
+
+/*! \var ulLatencyPendingMask
+	\brief Fuentes con una interrupción no atendida (bit por fuente).
+	El pin marcador es único y queda en alto mientras haya alguna.
+*/
+static volatile uint32_t ulLatencyPendingMask;
+
+/*! \var const char *pcLatencySourceName[latencySRC_NUM]
+	\brief Nombre de cada fuente en el reporte.
+*/
+static const char * const pcLatencySourceName[latencySRC_NUM] = {
+	"ENC",
+	"UART"
+};
+
+/*! \fn static void prvLatencyStatsReset( LatencyStats_t *pxStats )
+	\brief Reiniciar las estadísticas de un intervalo.
+*/
+static void prvLatencyStatsReset( LatencyStats_t *pxStats )
+{
+	pxStats->ulCount = 0;
+	pxStats->ulMin = UINT32_MAX;
+	pxStats->ulMax = 0;
+	pxStats->ullSum = 0;
+}
+
+/*! \fn static void prvLatencyStatsAdd( LatencyStats_t *pxStats, uint32_t ulCycles )
+	\brief Acumular una medición en las estadísticas de un intervalo.
+*/
+static void prvLatencyStatsAdd( LatencyStats_t *pxStats, uint32_t ulCycles )
+{
+	pxStats->ulCount++;
+	pxStats->ullSum += ulCycles;
+	if ( ulCycles < pxStats->ulMin ) {
+		pxStats->ulMin = ulCycles;
+	}
+	if ( ulCycles > pxStats->ulMax ) {
+		pxStats->ulMax = ulCycles;
+	}
+}
+
+/*! \fn static uint8_t prvLatencyBin( uint32_t ulCycles )
+	\brief Intervalo del histograma correspondiente a ulCycles.
+*/
+static uint8_t prvLatencyBin( uint32_t ulCycles )
+{
+	int32_t lBit;
+
+	if ( ulCycles == 0 ) {
+		return 0;
+	}
+	/* Posición del bit más significativo */
+	lBit = 31 - __builtin_clz( ulCycles ) - latencyHIST_FIRST_BIT;
+	if ( lBit < 0 ) {
+		return 0;
+	}
+	if ( lBit >= latencyHIST_BINS ) {
+		return latencyHIST_BINS - 1;
+	}
+	return ( uint8_t ) lBit;
+}
+
+/*! \fn void vLatencyIsrEntry( LatencySource_t xSource )
+	\brief Registrar la entrada a la ISR de la fuente.
+*/
+void vLatencyIsrEntry( LatencySource_t xSource )
+{
+	LatencyData_t *pxData = &pxLatencyData[xSource];
+	uint32_t ulNow = latencyTIMESTAMP();
+
+	UBaseType_t uxSavedInterruptStatus;
+
+	pxData->ulIsrEntry = ulNow;
+	/* La latencia total se mide desde la primera interrupción que
+	 * la tarea todavía no atendió */
+	if ( pxData->ulPending == 0 ) {
+		pxData->ulPendingEntry = ulNow;
+		pxData->ulPending = 1;
+		/* La ISR de otra fuente puede anidarse */
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+		{
+			if ( ulLatencyPendingMask == 0 ) {
+				latencyMARKER_SET();
+			}
+			ulLatencyPendingMask |= 1UL << xSource;
+		}
+		taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+	}
+}
+
+/*! \fn void vLatencyIsrYield( LatencySource_t xSource )
+	\brief Registrar el fin de la ISR de la fuente.
+*/
+void vLatencyIsrYield( LatencySource_t xSource )
+{
+	LatencyData_t *pxData = &pxLatencyData[xSource];
+
+	prvLatencyStatsAdd( &pxData->xIsr, latencyTIMESTAMP() - pxData->ulIsrEntry );
+}
+
+/*! \fn void vLatencyTaskResume( LatencySource_t xSource )
+	\brief Registrar la ejecución de la tarea consumidora.
+*/
+void vLatencyTaskResume( LatencySource_t xSource )
+{
+	LatencyData_t *pxData = &pxLatencyData[xSource];
+	uint32_t ulNow = latencyTIMESTAMP();
+	uint32_t ulCycles, ulPending;
+
+	/* La ISR de la fuente no debe modificar el instante pendiente
+	 * entre la lectura y el borrado */
+	taskENTER_CRITICAL();
+	{
+		ulPending = pxData->ulPending;
+		ulCycles = ulNow - pxData->ulPendingEntry;
+		if ( ulPending ) {
+			pxData->ulPending = 0;
+			ulLatencyPendingMask &= ~( 1UL << xSource );
+			if ( ulLatencyPendingMask == 0 ) {
+				latencyMARKER_CLEAR();
+			}
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	/* Lectura sin interrupción nueva (datos ya atendidos) */
+	if ( ulPending == 0 ) {
+		return;
+	}
+
+	prvLatencyStatsAdd( &pxData->xTask, ulCycles );
+	pxData->pulHistogram[prvLatencyBin( ulCycles )]++;
+}
+
+/*! \fn void vLatencyTaskSwitchedIn( void *pvTask, uint32_t ulTaskNumber )
+	\brief Hook traceTASK_SWITCHED_IN (dentro de vTaskSwitchContext).
+*/
+void vLatencyTaskSwitchedIn( void *pvTask, uint32_t ulTaskNumber )
+{
+	LatencyTask_t *pxTask;
+	uint32_t ulNow = latencyTIMESTAMP();
+
+	if ( ulTaskNumber >= latencyMAX_TASKS ) {
+		return;
+	}
+	pxTask = &pxLatencyTask[ulTaskNumber];
+	pxTask->xTask = ( TaskHandle_t ) pvTask;
+	pxTask->ulSwitchIn = ulNow;
+
+	if ( pxTask->ulInJob == 0 ) {
+		/* Nueva activación: la liberación se aproxima con el primer
+		 * ingreso en ejecución */
+		if ( ( pxTask->ulJobs > 0 ) &&
+			( ulNow - pxTask->ulJobStart < pxTask->ulMinInterArrival ) ) {
+			pxTask->ulMinInterArrival = ulNow - pxTask->ulJobStart;
+		}
+		pxTask->ulJobStart = ulNow;
+		pxTask->ulJobCycles = 0;
+		pxTask->ulInJob = 1;
+	}
+}
+
+/*! \fn void vLatencyTaskSwitchedOut( uint32_t ulTaskNumber, uint32_t ulBlocked )
+	\brief Hook traceTASK_SWITCHED_OUT (dentro de vTaskSwitchContext).
+*/
+void vLatencyTaskSwitchedOut( uint32_t ulTaskNumber, uint32_t ulBlocked )
+{
+	LatencyTask_t *pxTask;
+
+	if ( ulTaskNumber >= latencyMAX_TASKS ) {
+		return;
+	}
+	pxTask = &pxLatencyTask[ulTaskNumber];
+	pxTask->ulJobCycles += latencyTIMESTAMP() - pxTask->ulSwitchIn;
+
+	/* Expropiada: la activación continúa en el próximo tramo */
+	if ( ulBlocked == 0 ) {
+		return;
+	}
+	pxTask->ulInJob = 0;
+	pxTask->ulJobs++;
+	pxTask->ullSum += pxTask->ulJobCycles;
+	if ( pxTask->ulJobCycles > pxTask->ulWcet ) {
+		pxTask->ulWcet = pxTask->ulJobCycles;
+	}
+}
+
+/*! \fn static void prvLatencyTaskReport( void )
+	\brief Imprimir y reiniciar las mediciones de cada tarea: número
+	de activaciones, prioridad, WCET y promedio medidos, y mínimo
+	tiempo entre activaciones, en ciclos.
+*/
+static void prvLatencyTaskReport( void )
+{
+	LatencyTask_t xSnapshot;
+
+	for ( uint8_t i=0; i<latencyMAX_TASKS; i++ ) {
+		taskENTER_CRITICAL();
+		{
+			xSnapshot = pxLatencyTask[i];
+			pxLatencyTask[i].ulJobs = 0;
+			pxLatencyTask[i].ulWcet = 0;
+			pxLatencyTask[i].ullSum = 0;
+			pxLatencyTask[i].ulMinInterArrival = UINT32_MAX;
+		}
+		taskEXIT_CRITICAL();
+
+		if ( ( xSnapshot.xTask == NULL ) || ( xSnapshot.ulJobs == 0 ) ) {
+			continue;
+		}
+		/* Nombre sin espacios para el análisis ("Tmr Svc") */
+		char pcName[configMAX_TASK_NAME_LEN];
+		strncpy( pcName, pcTaskGetName( xSnapshot.xTask ), sizeof( pcName ) - 1 );
+		pcName[sizeof( pcName ) - 1] = '\0';
+		for ( char *pc = pcName; *pc != '\0'; pc++ ) {
+			if ( *pc == ' ' ) {
+				*pc = '_';
+			}
+		}
+		printf( "LAT:TSK %s prio %u n %u wcet %u avg %u tmin %u\n", pcName,
+			( unsigned ) uxTaskPriorityGet( xSnapshot.xTask ),
+			( unsigned ) xSnapshot.ulJobs, ( unsigned ) xSnapshot.ulWcet,
+			( unsigned ) ( xSnapshot.ullSum / xSnapshot.ulJobs ),
+			( unsigned ) xSnapshot.ulMinInterArrival );
+	}
+}
+
+/*! \fn static void prvLatencyPrintStats( const char *pcSource, const char *pcInterval, const LatencyStats_t *pxStats )
+	\brief Imprimir las estadísticas de un intervalo.
+*/
+static void prvLatencyPrintStats( const char *pcSource, const char *pcInterval,
+	const LatencyStats_t *pxStats )
+{
+	if ( pxStats->ulCount == 0 ) {
+		printf( "LAT:%s %s n 0\n", pcSource, pcInterval );
+		return;
+	}
+	printf( "LAT:%s %s n %u min %u avg %u max %u\n", pcSource, pcInterval,
+		( unsigned ) pxStats->ulCount, ( unsigned ) pxStats->ulMin,
+		( unsigned ) ( pxStats->ullSum / pxStats->ulCount ),
+		( unsigned ) pxStats->ulMax );
+}
+
+/*! \fn void vLatencyReport( void )
+	\brief Imprimir las tablas de latencia de cada fuente y
+	reiniciarlas (comando ":L").
+*/
+void vLatencyReport( void )
+{
+	LatencyData_t xSnapshot;
+
+	printf( "LAT:CLK %u Hz\n", ( unsigned ) SystemCoreClock );
+
+	for ( uint8_t i=0; i<latencySRC_NUM; i++ ) {
+		/* Copia y reinicio sin interrupciones de por medio */
+		taskENTER_CRITICAL();
+		{
+			xSnapshot = pxLatencyData[i];
+			prvLatencyStatsReset( &pxLatencyData[i].xIsr );
+			prvLatencyStatsReset( &pxLatencyData[i].xTask );
+			memset( pxLatencyData[i].pulHistogram, 0,
+				sizeof( pxLatencyData[i].pulHistogram ) );
+		}
+		taskEXIT_CRITICAL();
+
+		prvLatencyPrintStats( pcLatencySourceName[i], "isr", &xSnapshot.xIsr );
+		prvLatencyPrintStats( pcLatencySourceName[i], "task", &xSnapshot.xTask );
+		for ( uint8_t j=0; j<latencyHIST_BINS; j++ ) {
+			if ( xSnapshot.pulHistogram[j] > 0 ) {
+				/* Límite superior del intervalo en ciclos */
+				printf( "LAT:%s hist %s%u %u\n", pcLatencySourceName[i],
+					( j == latencyHIST_BINS - 1 ) ? ">=" : "<",
+					( unsigned ) ( 1UL << ( j + latencyHIST_FIRST_BIT +
+						( ( j == latencyHIST_BINS - 1 ) ? 0 : 1 ) ) ),
+					( unsigned ) xSnapshot.pulHistogram[j] );
+			}
+		}
+	}
+
+	prvLatencyTaskReport();
+}
+
+/*! \fn void vLatencyInit( void )
+	\brief Habilitar el contador de ciclos y el pin marcador.
+*/
+void vLatencyInit( void )
+{
+	ulLatencyPendingMask = 0;
+	for ( uint8_t i=0; i<latencySRC_NUM; i++ ) {
+		pxLatencyData[i].ulPending = 0;
+		prvLatencyStatsReset( &pxLatencyData[i].xIsr );
+		prvLatencyStatsReset( &pxLatencyData[i].xTask );
+	}
+	for ( uint8_t i=0; i<latencyMAX_TASKS; i++ ) {
+		pxLatencyTask[i].ulMinInterArrival = UINT32_MAX;
+	}
+
+	/* Contador de ciclos del DWT */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	gpioConfig( latencyGPIO_MARKER, GPIO_OUTPUT );
+	latencyMARKER_CLEAR();
+}
+
+#endif /* appUSE_LATENCY */
@@ -0,0 +1,366 @@
+/*! \file lcd_hd44780.c
+    \brief Driver no bloqueante del display LCD HD44780, con
+    conexión directa de 4 bits o mediante el expansor I2C PCF8574T.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "task.h"
+
+/* EDU-CIAA firmware_v3 includes */
+#include "sapi.h"
+#include "sapi_timer.h"
+#include "chip.h"
+
+/* Aplicación includes */
+#include "lcd_hd44780.h"
+#include "spsc_ring.h"
+
+/*! \def lcdENTRY_RS
+	\brief Comando con RS en alto (dato).
+*/
+#define lcdENTRY_RS			( 1U << 8 )
+/*! \def lcdENTRY_NIBBLE
+	\brief Sólo se envía el nibble alto (inicialización en modo 8 bits).
+*/
+#define lcdENTRY_NIBBLE		( 1U << 9 )
+/*! \def lcdENTRY_LONG
+	\brief Comando con tiempo de ejecución lcdLONG_EXEC_US.
+*/
+#define lcdENTRY_LONG		( 1U << 10 )
+/*! \def lcdENTRY_DELAY
+	\brief Espera del valor en ms, sin escritura al display.
+*/
+#define lcdENTRY_DELAY		( 1U << 11 )
+
+/*! \var pusLcdQueue
+	\brief Buffer circular de comandos. Los índices avanzan
+	libremente y sólo los escribe su dueño (ulHead la tarea, ulTail
+	la interrupción del timer), como en spsc_ring.h.
+*/
+static uint16_t pusLcdQueue[ lcdQUEUE_LENGTH ];
+static volatile uint32_t ulLcdHead = 0;
+static volatile uint32_t ulLcdTail = 0;
+
+/*! \var xLcdIdle
+	\brief pdTRUE si el timer está detenido por buffer vacío.
+*/
+static volatile BaseType_t xLcdIdle = pdFALSE;
+
+/*! \var ulLcdTicksPerUs
+	\brief Cuentas del timer por microsegundo.
+*/
+static uint32_t ulLcdTicksPerUs;
+
+/*! \fn static uint32_t prvLcdExecUs( uint16_t usEntry )
+	\brief Tiempo de ejecución del comando.
+*/
+static uint32_t prvLcdExecUs( uint16_t usEntry )
+{
+	return ( usEntry & lcdENTRY_LONG ) ? lcdLONG_EXEC_US : lcdEXEC_US;
+}
+
+/*! \fn static void prvLcdSchedule( uint32_t ulUs )
+	\brief Programar la siguiente interrupción del timer. El timer se
+	detiene y vuelve a cero en cada coincidencia. Con lcdEN_PULSE_US
+	la coincidencia puede ocurrir antes de salir del callback: queda
+	pendiente porque TIMER1_IRQHandler() de sAPI borra la anterior
+	antes de llamarlo.
+*/
+static void prvLcdSchedule( uint32_t ulUs )
+{
+	Chip_TIMER_SetMatch( lcdTIMER_BASE, TIMERCOMPAREMATCH0, ulUs * ulLcdTicksPerUs );
+	Chip_TIMER_Enable( lcdTIMER_BASE );
+}
+
+#ifdef LCD_HD44780_I2C_PCF8574T
+
+/*! \var xLcdXfer
+	\brief Transacción I2C en curso y bytes del lote.
+*/
+static i2cTransaction_t xLcdXfer;
+static uint8_t pucLcdBatch[ lcdI2C_BATCH * 4 ];
+
+/*! \var ulLcdBatchExecUs
+	\brief Tiempo de ejecución del último comando del lote.
+*/
+static uint32_t ulLcdBatchExecUs;
+
+/*! \fn static uint8_t *prvLcdPutNibble( uint8_t *pucByte, uint8_t ucNibble, uint16_t usEntry )
+	\brief Agregar al lote los bytes del expansor de un nibble: con
+	enable en alto y luego en bajo. Cada byte dura más que el pulso
+	de enable mínimo a lcdI2C_RATE.
+*/
+static uint8_t *prvLcdPutNibble( uint8_t *pucByte, uint8_t ucNibble, uint16_t usEntry )
+{
+	uint8_t ucPort = ( ucNibble & 0xF0 ) | ( 1U << LCD_HD44780_BACKLIGHT );
+
+	if ( usEntry & lcdENTRY_RS ) {
+		ucPort |= 1U << LCD_HD44780_RS;
+	}
+	*pucByte++ = ucPort | ( 1U << LCD_HD44780_EN );
+	*pucByte++ = ucPort;
+	return pucByte;
+}
+
+/*! \fn static void prvLcdXferDone( i2cTransaction_t *pxTransaction )
+	\brief Finalización del lote desde I2C0_IRQHandler(). Se espera
+	el tiempo de ejecución del último comando antes del lote
+	siguiente. Un error descarta el lote.
+*/
+static void prvLcdXferDone( i2cTransaction_t *pxTransaction )
+{
+	prvLcdSchedule( ulLcdBatchExecUs );
+}
+
+/*! \fn static void prvLcdTimerCallback( void *pvParameter )
+	\brief Enviar los comandos pendientes en un lote. El lote termina
+	en una espera o en un comando con tiempo de ejecución propio, ya
+	que el tiempo de los bytes siguientes sólo cubre lcdEXEC_US.
+*/
+static void prvLcdTimerCallback( void *pvParameter )
+{
+	uint8_t *pucByte = pucLcdBatch;
+	uint16_t usEntry;
+
+	ulLcdBatchExecUs = lcdEXEC_US;
+	while ( ( ulLcdTail != ulLcdHead ) && ( pucByte < &pucLcdBatch[ sizeof( pucLcdBatch ) ] ) ) {
+		usEntry = pusLcdQueue[ ulLcdTail & ( lcdQUEUE_LENGTH - 1 ) ];
+		if ( usEntry & lcdENTRY_DELAY ) {
+			if ( pucByte == pucLcdBatch ) {
+				ulLcdTail++;
+				prvLcdSchedule( ( usEntry & 0xFF ) * 1000 );
+				return;
+			}
+			break;
+		}
+		ulLcdTail++;
+
+		pucByte = prvLcdPutNibble( pucByte, usEntry & 0xF0, usEntry );
+		if ( ( usEntry & lcdENTRY_NIBBLE ) == 0 ) {
+			pucByte = prvLcdPutNibble( pucByte, ( usEntry << 4 ) & 0xF0, usEntry );
+		}
+		if ( usEntry & ( lcdENTRY_NIBBLE | lcdENTRY_LONG ) ) {
+			ulLcdBatchExecUs = prvLcdExecUs( usEntry );
+			break;
+		}
+	}
+
+	if ( pucByte == pucLcdBatch ) {
+		xLcdIdle = pdTRUE;
+		return;
+	}
+
+	xLcdXfer.slaveAddress = lcdI2C_ADDRESS;
+	xLcdXfer.txBuffer = pucLcdBatch;
+	xLcdXfer.txSize = pucByte - pucLcdBatch;
+	xLcdXfer.rxBuffer = NULL;
+	xLcdXfer.rxSize = 0;
+	xLcdXfer.callback = prvLcdXferDone;
+	xLcdXfer.param = NULL;
+	if ( !i2cTransactionStart( I2C0, &xLcdXfer ) ) {
+		/* Cola del bus llena: se descarta el lote como ante un error */
+		prvLcdSchedule( ulLcdBatchExecUs );
+	}
+}
+
+#else
+
+/*! \var usLcdEntry
+	\brief Comando en curso y paso de su secuencia.
+*/
+static uint16_t usLcdEntry;
+static uint8_t ucLcdStep = 0;
+
+/*! \var xLcdBusPins
+	\brief D4-D7 (bits 0 a 3) y RS (bit 4), escritos juntos con una
+	escritura enmascarada por puerto.
+*/
+static gpioMask_t xLcdBusPins;
+static const gpioMap_t pxLcdBusMap[] = {
+	LCD_HD44780_D4, LCD_HD44780_D5, LCD_HD44780_D6, LCD_HD44780_D7,
+	LCD_HD44780_RS
+};
+
+/*! \fn static void prvLcdSetNibble( uint8_t ucNibble )
+	\brief Escribir el nibble alto en D7-D4 y RS según el comando en
+	curso, sin estados intermedios en los pines.
+*/
+static void prvLcdSetNibble( uint8_t ucNibble )
+{
+	gpioWriteMask( &xLcdBusPins, ( ucNibble >> 4 ) |
+		( ( usLcdEntry & lcdENTRY_RS ) ? 0x10 : 0 ) );
+}
+
+/*! \fn static void prvLcdTimerCallback( void *pvParameter )
+	\brief Avanzar un paso la secuencia del comando en curso:
+	nibble alto y pulso de enable, nibble bajo y pulso de enable y
+	espera del tiempo de ejecución.
+*/
+static void prvLcdTimerCallback( void *pvParameter )
+{
+	switch ( ucLcdStep ) {
+	case 0:
+		if ( ulLcdTail == ulLcdHead ) {
+			xLcdIdle = pdTRUE;
+			return;
+		}
+		usLcdEntry = pusLcdQueue[ ulLcdTail & ( lcdQUEUE_LENGTH - 1 ) ];
+		ulLcdTail++;
+		if ( usLcdEntry & lcdENTRY_DELAY ) {
+			prvLcdSchedule( ( usLcdEntry & 0xFF ) * 1000 );
+			return;
+		}
+		prvLcdSetNibble( usLcdEntry & 0xF0 );
+		gpioWrite( LCD_HD44780_EN, ON );
+		ucLcdStep = 1;
+		prvLcdSchedule( lcdEN_PULSE_US );
+		break;
+	case 1:
+		gpioWrite( LCD_HD44780_EN, OFF );
+		if ( usLcdEntry & lcdENTRY_NIBBLE ) {
+			ucLcdStep = 0;
+			prvLcdSchedule( prvLcdExecUs( usLcdEntry ) );
+		} else {
+			ucLcdStep = 2;
+			prvLcdSchedule( lcdEN_PULSE_US );
+		}
+		break;
+	case 2:
+		prvLcdSetNibble( ( usLcdEntry << 4 ) & 0xF0 );
+		gpioWrite( LCD_HD44780_EN, ON );
+		ucLcdStep = 3;
+		prvLcdSchedule( lcdEN_PULSE_US );
+		break;
+	default:
+		gpioWrite( LCD_HD44780_EN, OFF );
+		ucLcdStep = 0;
+		prvLcdSchedule( prvLcdExecUs( usLcdEntry ) );
+		break;
+	}
+}
+
+#endif /* LCD_HD44780_I2C_PCF8574T */
+
+/*! \fn static void prvLcdPut( uint16_t usEntry )
+	\brief Encolar un comando y reanudar el timer si estaba detenido.
+	Con el buffer lleno la tarea se bloquea hasta que haya lugar;
+	antes de iniciar el scheduler el comando se descarta.
+*/
+static void prvLcdPut( uint16_t usEntry )
+{
+	while ( ulLcdHead - ulLcdTail >= lcdQUEUE_LENGTH ) {
+		if ( xTaskGetSchedulerState() != taskSCHEDULER_RUNNING ) {
+			return;
+		}
+		vTaskDelay( 1 );
+	}
+
+	pusLcdQueue[ ulLcdHead & ( lcdQUEUE_LENGTH - 1 ) ] = usEntry;
+	spscMEMORY_BARRIER();
+	ulLcdHead++;
+
+	/* La interrupción del timer no puede ejecutarse dentro de la
+	 * sección crítica (prioridad menor a la máxima de syscall) */
+	taskENTER_CRITICAL();
+	if ( xLcdIdle ) {
+		xLcdIdle = pdFALSE;
+		prvLcdSchedule( 1 );
+	}
+	taskEXIT_CRITICAL();
+}
+
+/*! \fn void vLcdCommand( uint8_t ucCommand )
+	\brief Encolar un comando.
+*/
+void vLcdCommand( uint8_t ucCommand )
+{
+	uint16_t usEntry = ucCommand;
+
+	/* Clear display y return home */
+	if ( ucCommand < E_ENTRY_MODE_SET ) {
+		usEntry |= lcdENTRY_LONG;
+	}
+	prvLcdPut( usEntry );
+}
+
+/*! \fn void vLcdData( uint8_t ucData )
+	\brief Encolar un caracter en la posición del cursor.
+*/
+void vLcdData( uint8_t ucData )
+{
+	prvLcdPut( ucData | lcdENTRY_RS );
+}
+
+/*! \fn void vLcdGoToXY( uint8_t x, uint8_t y )
+	\brief Encolar el cambio de posición del cursor.
+*/
+void vLcdGoToXY( uint8_t x, uint8_t y )
+{
+	static const uint8_t pucLineAddress[] = { 0x00, 0x40, 0x14, 0x54 };
+
+	if ( y >= sizeof( pucLineAddress ) ) {
+		return;
+	}
+	vLcdCommand( E_SET_DDRAM_ADDR | ( pucLineAddress[y] + x ) );
+}
+
+/*! \fn void vLcdClear( void )
+	\brief Encolar el borrado del display.
+*/
+void vLcdClear( void )
+{
+	vLcdCommand( E_CLEAR_DISPLAY );
+}
+
+/*! \fn BaseType_t xLcdInit( void )
+	\brief Inicialización del driver y del display.
+*/
+BaseType_t xLcdInit( void )
+{
+#ifdef LCD_HD44780_I2C_PCF8574T
+	/* Bus compartido con i2c_bus.c: si ya está inicializado se
+	 * mantiene su velocidad */
+	if ( !i2cAsyncInit( I2C0, lcdI2C_RATE ) ) {
+		return pdFAIL;
+	}
+#else
+	gpioInit( LCD_HD44780_RS, GPIO_OUTPUT );
+	gpioInit( LCD_HD44780_EN, GPIO_OUTPUT );
+	gpioInit( LCD_HD44780_D4, GPIO_OUTPUT );
+	gpioInit( LCD_HD44780_D5, GPIO_OUTPUT );
+	gpioInit( LCD_HD44780_D6, GPIO_OUTPUT );
+	gpioInit( LCD_HD44780_D7, GPIO_OUTPUT );
+	gpioWrite( LCD_HD44780_EN, OFF );
+	gpioMaskInit( &xLcdBusPins, pxLcdBusMap, sizeof( pxLcdBusMap ) / sizeof( gpioMap_t ) );
+#endif
+
+	/* Secuencia de inicialización en modo 4 bits (hoja de datos
+	 * HD44780, figura 24). El timer arranca tras la espera de
+	 * alimentación y se detiene en cada coincidencia */
+	prvLcdPut( 0x30 | lcdENTRY_NIBBLE );
+	prvLcdPut( 5 | lcdENTRY_DELAY );
+	prvLcdPut( 0x30 | lcdENTRY_NIBBLE );
+	prvLcdPut( 0x30 | lcdENTRY_NIBBLE );
+	prvLcdPut( 0x20 | lcdENTRY_NIBBLE );
+	/* 4 bits, 2 líneas, caracteres de 5x8 */
+	vLcdCommand( E_FUNCTION_SET | 0x08 );
+	/* Display encendido sin cursor */
+	vLcdCommand( E_DISPLAY_ON_OFF_CTRL | 0x04 | LCD_CURSOR_OFF );
+	vLcdClear();
+	/* Incremento de la dirección sin desplazamiento */
+	vLcdCommand( E_ENTRY_MODE_SET | 0x02 );
+
+	ulLcdTicksPerUs = Chip_Clock_GetRate( lcdTIMER_CLOCK ) / 1000000;
+	Timer_Init( lcdTIMER, lcdSTARTUP_MS * 1000 * ulLcdTicksPerUs, prvLcdTimerCallback );
+	Chip_TIMER_StopOnMatchEnable( lcdTIMER_BASE, TIMERCOMPAREMATCH0 );
+	/* Sin llamadas a la API de FreeRTOS en la interrupción, pero debe
+	 * quedar enmascarada por las secciones críticas de prvLcdPut() */
+	NVIC_SetPriority( lcdTIMER_IRQ, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1 );
+
+	return pdPASS;
+}
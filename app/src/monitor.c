@@ -0,0 +1,320 @@
+/*! \file monitor.c
+    \brief Tarea de monitoreo de stack de las tareas y heap de
+    FreeRTOS, con reporte de tamaño de stack recomendado.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+/* Utilidades includes */
+#include <string.h>
+#include <stdio.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSPriorities.h"
+#include "FreeRTOSMemory.h"
+#include "task.h"
+
+/* Aplicación includes */
+#include "monitor.h"
+#include "uart.h"
+#include "deferred.h"
+#include "i2c_bus.h"
+#include "stepper.h"
+#include "servo.h"
+#include "power.h"
+
+/*! \def monitorHEAP_WARNING_BYTES
+	\brief Espacio libre de heap por debajo del cual se avisa.
+*/
+#define monitorHEAP_WARNING_BYTES	512
+
+/*! \var typedef struct xMonitorRecord MonitorRecord_t
+	\brief Mínimos registrados de una tarea.
+*/
+typedef struct xMonitorRecord {
+	/* Número de tarea asignado por el kernel (identificador único) */
+	UBaseType_t xTaskNumber;
+	/* Nombre de la tarea (guardado en su TCB) */
+	const char *pcName;
+	/* Tamaño de stack con que se creó la tarea (0 si es desconocido) */
+	uint32_t ulStackDepth;
+	/* Mínimo espacio libre de stack observado en palabras */
+	uint16_t usMinFree;
+	/* Aviso de overflow ya enviado */
+	BaseType_t xWarned;
+	/* Mensaje de aviso (vUartSendMsg no copia el string) */
+	char pcWarning[ sizeof( "MON:WRN:STK:" ) + configMAX_TASK_NAME_LEN ];
+} MonitorRecord_t;
+
+/*! \var xMonitorStackDepth
+	\brief Tamaño de stack de cada tarea según su nombre. El kernel
+	no guarda el tamaño con que se creó la tarea, por lo que se toma
+	de las mismas macros usadas al crearla (FreeRTOSMemory.h).
+*/
+static const struct {
+	const char *pcName;
+	uint32_t ulStackDepth;
+} xMonitorStackDepth[] = {
+	{ "AppSyncTask",		stackAppSyncTask },
+	{ "LedBlinkTask",		stackLedBlinkTask },
+	{ "UartRxTask",			stackUartRxTask },
+	{ "UartTxTask",			stackUartTxTask },
+	{ "StepperControlTask",	stackStepperControlTask },
+	{ "ServoControlTask",	stackServoControlTask },
+	{ "EncoderTask",		stackEncoderTask },
+	{ "DisplayTask",		stackDisplayTask },
+	{ "MonitorTask",		stackMonitorTask },
+	{ "DeferredTask",		stackDeferredTask },
+	/* Tareas del kernel (ver static_provider.c) */
+	{ "IDLE",				configMINIMAL_STACK_SIZE },
+	{ "Tmr Svc",			configTIMER_TASK_STACK_DEPTH }
+};
+
+/*! \var TaskHandle_t xMonitorTaskHandle
+	\brief Handle de la tarea de monitoreo.
+*/
+static TaskHandle_t xMonitorTaskHandle = NULL;
+
+/*! \var BaseType_t xMonitorReportPending
+	\brief Reporte solicitado, para distinguir la notificación de
+	vMonitorRequestReport() de las de cambio de movimiento.
+*/
+static volatile BaseType_t xMonitorReportPending = pdFALSE;
+
+/*! \var TaskStatus_t pxMonitorTaskStatus[monitorMAX_TASKS]
+	\brief Estado de las tareas obtenido en cada muestreo.
+*/
+static TaskStatus_t pxMonitorTaskStatus[monitorMAX_TASKS];
+
+/*! \var MonitorRecord_t pxMonitorRecord[monitorMAX_TASKS]
+	\brief Mínimos registrados de cada tarea.
+*/
+static MonitorRecord_t pxMonitorRecord[monitorMAX_TASKS];
+
+/*! \var UBaseType_t uxMonitorRecordCount
+	\brief Cantidad de tareas registradas.
+*/
+static UBaseType_t uxMonitorRecordCount = 0;
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+/*! \var size_t xMonitorMinFreeHeap
+	\brief Mínimo espacio libre de heap observado.
+*/
+static size_t xMonitorMinFreeHeap = ( size_t ) -1;
+#endif
+
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+/*! \var xMonitorMemory
+	\brief Memoria estática de la tarea del módulo.
+*/
+static struct {
+	StaticTask_t xTaskTCB;
+	StackType_t puxTaskStack[ stackMonitorTask ];
+} xMonitorMemory memPLACE( memBANK_MONITOR );
+
+memMODULE( xMonitorMemoryModule, "Monitor", memBANK_MONITOR, memBUDGET_MONITOR, xMonitorMemory );
+#endif
+
+/*! \fn static uint32_t prvMonitorStackDepth( const char *pcName )
+	\brief Tamaño de stack de la tarea pcName.
+	\return Tamaño en palabras o 0 si la tarea no es conocida.
+*/
+static uint32_t prvMonitorStackDepth( const char *pcName )
+{
+	for ( uint8_t i=0; i<sizeof( xMonitorStackDepth )/sizeof( xMonitorStackDepth[0] ); i++ ) {
+		/* El kernel trunca el nombre a configMAX_TASK_NAME_LEN - 1 */
+		if ( strncmp( pcName, xMonitorStackDepth[i].pcName,
+			configMAX_TASK_NAME_LEN - 1 ) == 0 ) {
+			return xMonitorStackDepth[i].ulStackDepth;
+		}
+	}
+	return 0;
+}
+
+/*! \fn static MonitorRecord_t *prvMonitorRecord( const TaskStatus_t *pxStatus )
+	\brief Registro de la tarea, creándolo si es la primera vez
+	que se observa.
+	\return Registro de la tarea o NULL si no hay lugar.
+*/
+static MonitorRecord_t *prvMonitorRecord( const TaskStatus_t *pxStatus )
+{
+	MonitorRecord_t *pxRecord;
+
+	for ( UBaseType_t i=0; i<uxMonitorRecordCount; i++ ) {
+		if ( pxMonitorRecord[i].xTaskNumber == pxStatus->xTaskNumber ) {
+			return &pxMonitorRecord[i];
+		}
+	}
+	if ( uxMonitorRecordCount >= monitorMAX_TASKS ) {
+		return NULL;
+	}
+
+	pxRecord = &pxMonitorRecord[uxMonitorRecordCount++];
+	pxRecord->xTaskNumber = pxStatus->xTaskNumber;
+	pxRecord->pcName = pxStatus->pcTaskName;
+	pxRecord->ulStackDepth = prvMonitorStackDepth( pxStatus->pcTaskName );
+	pxRecord->usMinFree = pxStatus->usStackHighWaterMark;
+	pxRecord->xWarned = pdFALSE;
+	strcpy( pxRecord->pcWarning, "MON:WRN:STK:" );
+	strcat( pxRecord->pcWarning, pxStatus->pcTaskName );
+
+	return pxRecord;
+}
+
+/*! \fn static void prvMonitorSample( void )
+	\brief Muestreo de marca de agua de stack de todas las tareas
+	y del espacio libre de heap.
+*/
+static void prvMonitorSample( void )
+{
+	UBaseType_t uxTasks;
+	MonitorRecord_t *pxRecord;
+
+	/* Estado de todas las tareas, incluida la marca de agua de stack */
+	uxTasks = uxTaskGetSystemState( pxMonitorTaskStatus, monitorMAX_TASKS, NULL );
+	/* Si hay más tareas que monitorMAX_TASKS no se obtiene ninguna */
+	configASSERT( uxTasks > 0 );
+
+	for ( UBaseType_t i=0; i<uxTasks; i++ ) {
+		pxRecord = prvMonitorRecord( &pxMonitorTaskStatus[i] );
+		if ( pxRecord == NULL ) {
+			continue;
+		}
+		if ( pxMonitorTaskStatus[i].usStackHighWaterMark < pxRecord->usMinFree ) {
+			pxRecord->usMinFree = pxMonitorTaskStatus[i].usStackHighWaterMark;
+		}
+		/* Aviso de stack cerca del overflow */
+		if ( ( pxRecord->usMinFree < monitorSTACK_WARNING_WORDS ) &&
+			( pxRecord->xWarned == pdFALSE ) ) {
+			pxRecord->xWarned = pdTRUE;
+			vUartSendMsg( pxRecord->pcWarning );
+		}
+	}
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	size_t xFreeHeap = xPortGetFreeHeapSize();
+	if ( xFreeHeap < xMonitorMinFreeHeap ) {
+		/* Aviso al cruzar el umbral */
+		if ( ( xFreeHeap < monitorHEAP_WARNING_BYTES ) &&
+			( xMonitorMinFreeHeap >= monitorHEAP_WARNING_BYTES ) ) {
+			vUartSendMsg( "MON:WRN:HEAP" );
+		}
+		xMonitorMinFreeHeap = xFreeHeap;
+	}
+#endif
+}
+
+/*! \fn static void prvMonitorReport( void )
+	\brief Reporte de uso de stack de cada tarea con el tamaño
+	recomendado (máximo uso observado más monitorSTACK_MARGIN_WORDS,
+	redondeado a 8 palabras) y del heap.
+*/
+static void prvMonitorReport( void )
+{
+	MonitorRecord_t *pxRecord;
+	uint32_t ulUsed, ulRecommended;
+	int32_t lReclaim = 0;
+
+	for ( UBaseType_t i=0; i<uxMonitorRecordCount; i++ ) {
+		pxRecord = &pxMonitorRecord[i];
+		if ( pxRecord->ulStackDepth == 0 ) {
+			/* Tamaño desconocido, sólo el espacio libre mínimo */
+			printf( "MON:STK %s free %u\n", pxRecord->pcName,
+				( unsigned ) pxRecord->usMinFree );
+			continue;
+		}
+		ulUsed = pxRecord->ulStackDepth - pxRecord->usMinFree;
+		ulRecommended = ( ulUsed + monitorSTACK_MARGIN_WORDS + 7 ) & ~7UL;
+		lReclaim += ( int32_t ) pxRecord->ulStackDepth - ( int32_t ) ulRecommended;
+		printf( "MON:STK %s size %u used %u free %u rec %u\n", pxRecord->pcName,
+			( unsigned ) pxRecord->ulStackDepth, ( unsigned ) ulUsed,
+			( unsigned ) pxRecord->usMinFree, ( unsigned ) ulRecommended );
+	}
+	/* Palabras a recuperar (negativo si hay que agrandar stacks) */
+	printf( "MON:STK reclaim %d words\n", ( int ) lReclaim );
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	printf( "MON:HEAP free %u min %u total %u\n", ( unsigned ) xPortGetFreeHeapSize(),
+		( unsigned ) xMonitorMinFreeHeap, ( unsigned ) configTOTAL_HEAP_SIZE );
+#endif
+
+	/* Buffers de procesamiento diferido */
+	vDeferredReport();
+	/* Contadores y ocupación del bus I2C */
+	vI2cBusReport();
+	/* Finalización de consignas de los motores */
+	vStepperReport();
+	vServoReport();
+}
+
+/*! \fn void vMonitorTask( void *pvParameters )
+	\brief Tarea de monitoreo. Muestrea cada monitorPERIOD_MS durante
+	los movimientos y, en reposo, al comenzar y terminar cada
+	movimiento y en cada solicitud de reporte.
+*/
+void vMonitorTask( void *pvParameters )
+{
+	for ( ;; ) {
+		prvMonitorSample();
+		if ( xMonitorReportPending ) {
+			xMonitorReportPending = pdFALSE;
+			prvMonitorReport();
+		}
+		/* En reposo las tareas sólo se ejecutan por comandos, que
+		 * inician un movimiento o piden el reporte: sin movimiento
+		 * no se despierta al procesador */
+		ulTaskNotifyTake( pdTRUE, xPowerMotionActive() ?
+			pdMS_TO_TICKS( monitorPERIOD_MS ) : portMAX_DELAY );
+	}
+}
+
+/*! \fn void vMonitorRequestReport( void )
+	\brief Solicitar a la tarea de monitoreo el reporte de stack y
+	heap (comando ":M").
+*/
+void vMonitorRequestReport( void )
+{
+	if ( xMonitorTaskHandle != NULL ) {
+		xMonitorReportPending = pdTRUE;
+		xTaskNotifyGive( xMonitorTaskHandle );
+	}
+}
+
+/*! \fn BaseType_t xMonitorInit( void )
+	\brief Inicialización de la tarea de monitoreo.
+*/
+BaseType_t xMonitorInit( void )
+{
+	BaseType_t xStatus;
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+	xMonitorTaskHandle = xTaskCreateStatic( vMonitorTask,
+		( const char * ) "MonitorTask", stackMonitorTask, NULL,
+		priorityMonitorTask, xMonitorMemory.puxTaskStack,
+		&xMonitorMemory.xTaskTCB );
+	xStatus = ( xMonitorTaskHandle != NULL ) ? pdPASS : pdFAIL;
+#else
+	xStatus = xTaskCreate(
+		/* Puntero a la función que implementa la tarea */
+		vMonitorTask,
+		/* Nombre de la tarea amigable para el usuario */
+		( const char * ) "MonitorTask",
+		/* Tamaño de stack de la tarea */
+		stackMonitorTask,
+		/* Parámetros de la tarea */
+		NULL,
+		/* Prioridad de la tarea */
+		priorityMonitorTask,
+		/* Handle de la tarea creada */
+		&xMonitorTaskHandle
+	);
+#endif
+
+	/* Muestreo periódico sólo durante movimientos */
+	if ( xStatus == pdPASS ) {
+		vPowerRegisterMotionListener( xMonitorTaskHandle );
+	}
+
+	return xStatus;
+}
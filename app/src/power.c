@@ -0,0 +1,125 @@
+/*! \file power.c
+    \brief Tickless idle con tick activo sólo durante movimientos
+    de los motores.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* EDU-CIAA firmware_v3 includes */
+#include "chip.h"
+
+/* Aplicación includes */
+#include "power.h"
+
+/*! \var UBaseType_t uxPowerMotionCount
+	\brief Cantidad de movimientos en curso.
+*/
+static volatile UBaseType_t uxPowerMotionCount = 0;
+
+/*! \var TaskHandle_t pxPowerListener[powerMAX_LISTENERS]
+	\brief Tareas notificadas en los cambios de estado de movimiento.
+*/
+static TaskHandle_t pxPowerListener[powerMAX_LISTENERS];
+
+/*! \var UBaseType_t uxPowerListenerCount
+	\brief Cantidad de tareas registradas.
+*/
+static UBaseType_t uxPowerListenerCount = 0;
+
+/*! \fn static void prvPowerNotifyListeners( void )
+	\brief Notificar a las tareas registradas el cambio de estado.
+*/
+static void prvPowerNotifyListeners( void )
+{
+	for ( UBaseType_t i=0; i<uxPowerListenerCount; i++ ) {
+		xTaskNotifyGive( pxPowerListener[i] );
+	}
+}
+
+/*! \fn void vPowerMotionBegin( void )
+	\brief Indicar el inicio de un movimiento (mantiene el tick).
+*/
+void vPowerMotionBegin( void )
+{
+	UBaseType_t uxPrevious;
+
+	taskENTER_CRITICAL();
+	{
+		uxPrevious = uxPowerMotionCount++;
+	}
+	taskEXIT_CRITICAL();
+
+	if ( uxPrevious == 0 ) {
+		prvPowerNotifyListeners();
+	}
+}
+
+/*! \fn void vPowerMotionEnd( void )
+	\brief Indicar el fin de un movimiento iniciado con
+	vPowerMotionBegin().
+*/
+void vPowerMotionEnd( void )
+{
+	UBaseType_t uxCurrent;
+
+	taskENTER_CRITICAL();
+	{
+		configASSERT( uxPowerMotionCount > 0 );
+		uxCurrent = --uxPowerMotionCount;
+	}
+	taskEXIT_CRITICAL();
+
+	if ( uxCurrent == 0 ) {
+		prvPowerNotifyListeners();
+	}
+}
+
+/*! \fn BaseType_t xPowerMotionActive( void )
+	\brief Consultar si hay algún movimiento en curso.
+*/
+BaseType_t xPowerMotionActive( void )
+{
+	return ( uxPowerMotionCount > 0 ) ? pdTRUE : pdFALSE;
+}
+
+/*! \fn void vPowerRegisterMotionListener( TaskHandle_t xTask )
+	\brief Registrar una tarea a notificar cuando comienza o termina
+	el movimiento.
+*/
+void vPowerRegisterMotionListener( TaskHandle_t xTask )
+{
+	configASSERT( uxPowerListenerCount < powerMAX_LISTENERS );
+	pxPowerListener[uxPowerListenerCount++] = xTask;
+}
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+/*! \fn void vPowerSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+	\brief Implementación de portSUPPRESS_TICKS_AND_SLEEP: suprime el
+	tick sólo si no hay movimiento en curso, y si no duerme con WFI
+	hasta la próxima interrupción (a lo sumo el tick).
+*/
+void vPowerSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+{
+	if ( uxPowerMotionCount == 0 ) {
+		vPortSuppressTicksAndSleep( xExpectedIdleTime );
+		return;
+	}
+
+	/* Con movimiento en curso el tick no se interrumpe. Con las
+	 * interrupciones deshabilitadas una tarea lista desde que la
+	 * tarea idle suspendió el scheduler cancela el WFI, que igual
+	 * despierta con la interrupción pendiente */
+	__disable_irq();
+	__DSB();
+	__ISB();
+	if ( eTaskConfirmSleepModeStatus() != eAbortSleep ) {
+		__WFI();
+	}
+	__enable_irq();
+}
+#endif
@@ -0,0 +1,391 @@
+/*! \file ptr_queue.c
+    \brief Cola de punteros por referencia (sin copia) para
+    los mensajes de la aplicación.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+/* Utilidades includes */
+#include <stdio.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/* EDU-CIAA firmware_v3 includes */
+#include "chip.h"
+
+/* Aplicación includes */
+#include "ptr_queue.h"
+#include "latency.h"
+
+/*! \fn static UBaseType_t prvPtrQueueWrite( PtrQueue_t *pxQueue, void * const *ppvItems, UBaseType_t uxCount, BaseType_t *pxWasEmpty )
+	\brief Escribir hasta uxCount punteros. Debe llamarse dentro de
+	una sección crítica.
+	\param pxWasEmpty pdTRUE si la cola estaba vacía y se escribió.
+	\return Cantidad de punteros escritos.
+*/
+static UBaseType_t prvPtrQueueWrite( PtrQueue_t *pxQueue, void * const *ppvItems,
+	UBaseType_t uxCount, BaseType_t *pxWasEmpty )
+{
+	UBaseType_t uxFree = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
+	UBaseType_t uxWriteIndex = pxQueue->uxReadIndex + pxQueue->uxMessagesWaiting;
+
+	if ( uxCount > uxFree ) {
+		uxCount = uxFree;
+	}
+	if ( uxWriteIndex >= pxQueue->uxLength ) {
+		uxWriteIndex -= pxQueue->uxLength;
+	}
+
+	for ( UBaseType_t i=0; i<uxCount; i++ ) {
+		pxQueue->ppvStorage[uxWriteIndex] = ppvItems[i];
+		if ( ++uxWriteIndex == pxQueue->uxLength ) {
+			uxWriteIndex = 0;
+		}
+	}
+
+	*pxWasEmpty = ( ( pxQueue->uxMessagesWaiting == 0 ) && ( uxCount > 0 ) ) ? pdTRUE : pdFALSE;
+	pxQueue->uxMessagesWaiting += uxCount;
+
+	return uxCount;
+}
+
+/*! \fn static UBaseType_t prvPtrQueueRead( PtrQueue_t *pxQueue, void **ppvItems, UBaseType_t uxMaxCount, BaseType_t *pxWasFull )
+	\brief Leer hasta uxMaxCount punteros. Debe llamarse dentro de
+	una sección crítica.
+	\param pxWasFull pdTRUE si la cola estaba llena y se leyó.
+	\return Cantidad de punteros leídos.
+*/
+static UBaseType_t prvPtrQueueRead( PtrQueue_t *pxQueue, void **ppvItems,
+	UBaseType_t uxMaxCount, BaseType_t *pxWasFull )
+{
+	UBaseType_t uxCount = pxQueue->uxMessagesWaiting;
+	UBaseType_t uxReadIndex = pxQueue->uxReadIndex;
+
+	if ( uxCount > uxMaxCount ) {
+		uxCount = uxMaxCount;
+	}
+
+	for ( UBaseType_t i=0; i<uxCount; i++ ) {
+		ppvItems[i] = pxQueue->ppvStorage[uxReadIndex];
+		if ( ++uxReadIndex == pxQueue->uxLength ) {
+			uxReadIndex = 0;
+		}
+	}
+
+	*pxWasFull = ( ( pxQueue->uxMessagesWaiting == pxQueue->uxLength ) && ( uxCount > 0 ) ) ? pdTRUE : pdFALSE;
+	pxQueue->uxReadIndex = uxReadIndex;
+	pxQueue->uxMessagesWaiting -= uxCount;
+
+	return uxCount;
+}
+
+/*! \fn PtrQueueHandle_t xPtrQueueCreateStatic( UBaseType_t uxLength, void **ppvStorage, StaticPtrQueue_t *pxStaticQueue )
+	\brief Creación de cola de punteros en memoria estática.
+*/
+PtrQueueHandle_t xPtrQueueCreateStatic( UBaseType_t uxLength, void **ppvStorage,
+	StaticPtrQueue_t *pxStaticQueue )
+{
+	configASSERT( uxLength > 0 );
+	configASSERT( ppvStorage != NULL );
+	configASSERT( pxStaticQueue != NULL );
+
+	pxStaticQueue->ppvStorage = ppvStorage;
+	pxStaticQueue->uxLength = uxLength;
+	pxStaticQueue->uxReadIndex = 0;
+	pxStaticQueue->uxMessagesWaiting = 0;
+	pxStaticQueue->xItemsAvailable = xSemaphoreCreateBinaryStatic(
+		&pxStaticQueue->xItemsAvailableBuffer );
+	pxStaticQueue->xSpaceAvailable = xSemaphoreCreateBinaryStatic(
+		&pxStaticQueue->xSpaceAvailableBuffer );
+
+	return pxStaticQueue;
+}
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+/*! \fn PtrQueueHandle_t xPtrQueueCreate( UBaseType_t uxLength )
+	\brief Creación de cola de punteros en el heap de FreeRTOS.
+	La estructura y las posiciones se reservan en un único bloque.
+*/
+PtrQueueHandle_t xPtrQueueCreate( UBaseType_t uxLength )
+{
+	PtrQueue_t *pxQueue = ( PtrQueue_t * ) pvPortMalloc(
+		sizeof( PtrQueue_t ) + uxLength * sizeof( void * ) );
+
+	if ( pxQueue == NULL ) {
+		return NULL;
+	}
+	return xPtrQueueCreateStatic( uxLength, ( void ** ) ( pxQueue + 1 ), pxQueue );
+}
+#endif
+
+/*! \fn UBaseType_t uxPtrQueueSendToBackBulk( PtrQueueHandle_t xQueue, void * const *ppvItems, UBaseType_t uxCount, TickType_t xTicksToWait )
+	\brief Escribir uxCount punteros al final de la cola.
+*/
+UBaseType_t uxPtrQueueSendToBackBulk( PtrQueueHandle_t xQueue, void * const *ppvItems,
+	UBaseType_t uxCount, TickType_t xTicksToWait )
+{
+	UBaseType_t uxSent = 0, uxWritten;
+	BaseType_t xWasEmpty, xIsFull, xBlocked = pdFALSE;
+	TimeOut_t xTimeOut;
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	for ( ;; ) {
+		taskENTER_CRITICAL();
+		{
+			uxWritten = prvPtrQueueWrite( xQueue, &ppvItems[uxSent],
+				uxCount - uxSent, &xWasEmpty );
+			xIsFull = ( xQueue->uxMessagesWaiting == xQueue->uxLength );
+		}
+		taskEXIT_CRITICAL();
+
+		/* Despertar al consumidor sólo en la transición vacía -> no vacía */
+		if ( xWasEmpty == pdTRUE ) {
+			xSemaphoreGive( xQueue->xItemsAvailable );
+		}
+		/* Un productor que estuvo bloqueado pasa la señal al
+		 * siguiente si todavía queda lugar */
+		if ( ( xBlocked == pdTRUE ) && ( uxWritten > 0 ) && !xIsFull ) {
+			xSemaphoreGive( xQueue->xSpaceAvailable );
+		}
+
+		uxSent += uxWritten;
+		if ( uxSent == uxCount ) {
+			break;
+		}
+		if ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdTRUE ) {
+			break;
+		}
+		/* Cola llena, esperar a que un consumidor libere lugar */
+		xSemaphoreTake( xQueue->xSpaceAvailable, xTicksToWait );
+		xBlocked = pdTRUE;
+	}
+
+	return uxSent;
+}
+
+/*! \fn UBaseType_t uxPtrQueueReceiveBulk( PtrQueueHandle_t xQueue, void **ppvItems, UBaseType_t uxMaxCount, TickType_t xTicksToWait )
+	\brief Leer hasta uxMaxCount punteros esperando a que haya al
+	menos uno.
+*/
+UBaseType_t uxPtrQueueReceiveBulk( PtrQueueHandle_t xQueue, void **ppvItems,
+	UBaseType_t uxMaxCount, TickType_t xTicksToWait )
+{
+	UBaseType_t uxRead;
+	BaseType_t xWasFull, xIsEmpty, xBlocked = pdFALSE;
+	TimeOut_t xTimeOut;
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	for ( ;; ) {
+		taskENTER_CRITICAL();
+		{
+			uxRead = prvPtrQueueRead( xQueue, ppvItems, uxMaxCount, &xWasFull );
+			xIsEmpty = ( xQueue->uxMessagesWaiting == 0 );
+		}
+		taskEXIT_CRITICAL();
+
+		/* Despertar a un productor sólo en la transición llena -> no llena */
+		if ( xWasFull == pdTRUE ) {
+			xSemaphoreGive( xQueue->xSpaceAvailable );
+		}
+
+		if ( uxRead > 0 ) {
+			/* Un consumidor que estuvo bloqueado pasa la señal al
+			 * siguiente si todavía quedan elementos */
+			if ( ( xBlocked == pdTRUE ) && !xIsEmpty ) {
+				xSemaphoreGive( xQueue->xItemsAvailable );
+			}
+			break;
+		}
+		if ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdTRUE ) {
+			break;
+		}
+		/* Cola vacía, esperar a que un productor escriba */
+		xSemaphoreTake( xQueue->xItemsAvailable, xTicksToWait );
+		xBlocked = pdTRUE;
+	}
+
+	return uxRead;
+}
+
+/*! \fn BaseType_t xPtrQueueSendToBack( PtrQueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait )
+	\brief Escribir un puntero al final de la cola.
+*/
+BaseType_t xPtrQueueSendToBack( PtrQueueHandle_t xQueue, const void *pvItemToQueue,
+	TickType_t xTicksToWait )
+{
+	return ( uxPtrQueueSendToBackBulk( xQueue, ( void * const * ) pvItemToQueue,
+		1, xTicksToWait ) == 1 ) ? pdPASS : errQUEUE_FULL;
+}
+
+/*! \fn BaseType_t xPtrQueueReceive( PtrQueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait )
+	\brief Leer un puntero del inicio de la cola.
+*/
+BaseType_t xPtrQueueReceive( PtrQueueHandle_t xQueue, void *pvBuffer,
+	TickType_t xTicksToWait )
+{
+	return ( uxPtrQueueReceiveBulk( xQueue, ( void ** ) pvBuffer,
+		1, xTicksToWait ) == 1 ) ? pdPASS : errQUEUE_EMPTY;
+}
+
+/*! \fn BaseType_t xPtrQueueSendToBackFromISR( PtrQueueHandle_t xQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken )
+	\brief Escribir un puntero al final de la cola desde una ISR.
+*/
+BaseType_t xPtrQueueSendToBackFromISR( PtrQueueHandle_t xQueue, const void *pvItemToQueue,
+	BaseType_t *pxHigherPriorityTaskWoken )
+{
+	UBaseType_t uxSavedInterruptStatus, uxWritten;
+	BaseType_t xWasEmpty;
+
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+	{
+		uxWritten = prvPtrQueueWrite( xQueue, ( void * const * ) pvItemToQueue,
+			1, &xWasEmpty );
+	}
+	taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+	if ( xWasEmpty == pdTRUE ) {
+		xSemaphoreGiveFromISR( xQueue->xItemsAvailable, pxHigherPriorityTaskWoken );
+	}
+
+	return ( uxWritten == 1 ) ? pdPASS : errQUEUE_FULL;
+}
+
+/*! \fn BaseType_t xPtrQueueReceiveFromISR( PtrQueueHandle_t xQueue, void *pvBuffer, BaseType_t *pxHigherPriorityTaskWoken )
+	\brief Leer un puntero del inicio de la cola desde una ISR.
+*/
+BaseType_t xPtrQueueReceiveFromISR( PtrQueueHandle_t xQueue, void *pvBuffer,
+	BaseType_t *pxHigherPriorityTaskWoken )
+{
+	UBaseType_t uxSavedInterruptStatus, uxRead;
+	BaseType_t xWasFull;
+
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+	{
+		uxRead = prvPtrQueueRead( xQueue, ( void ** ) pvBuffer, 1, &xWasFull );
+	}
+	taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+	if ( xWasFull == pdTRUE ) {
+		xSemaphoreGiveFromISR( xQueue->xSpaceAvailable, pxHigherPriorityTaskWoken );
+	}
+
+	return ( uxRead == 1 ) ? pdPASS : errQUEUE_EMPTY;
+}
+
+/*! \fn UBaseType_t uxPtrQueueMessagesWaiting( PtrQueueHandle_t xQueue )
+	\brief Cantidad de punteros en la cola.
+*/
+UBaseType_t uxPtrQueueMessagesWaiting( PtrQueueHandle_t xQueue )
+{
+	return xQueue->uxMessagesWaiting;
+}
+
+#if ( appUSE_LATENCY == 1 )
+
+/*! \var xPtrQueueBench
+	\brief Colas del comando ":B", creadas sobre la misma memoria
+	en cada carga de trabajo.
+*/
+static struct {
+	StaticPtrQueue_t xPtrQueue;
+	void *pvPtrStorage[ ptrqueueBENCH_MAX_LENGTH ];
+	StaticQueue_t xQueue;
+	uint8_t pucQueueStorage[ ptrqueueBENCH_MAX_LENGTH * sizeof( void * ) ];
+} xPtrQueueBench;
+
+/*! \var pxPtrQueueBenchLoad
+	\brief Cargas de trabajo: longitud de la cola y cantidad de
+	mensajes que el consumidor lee por llamada.
+*/
+static const struct {
+	const char *pcName;
+	UBaseType_t uxLength;
+	UBaseType_t uxBatch;
+} pxPtrQueueBenchLoad[] = {
+	{ "msg", 50, 1 },		/* xMsgQueue (appQUEUE_MSG_LENGTH) */
+	{ "uarttx", 100, 8 },	/* xUartTxQueue (uartTX_BATCH_LENGTH) */
+	{ "stepper", 10, 1 },	/* xStepperSetPointQueue */
+};
+
+/*! \fn static void prvPtrQueueBenchRun( UBaseType_t uxLoad, BaseType_t xUsePtrQueue )
+	\brief Llenar y vaciar ptrqueueBENCH_RUNS veces la cola sin
+	bloquear e imprimir el costo promedio por mensaje en ciclos.
+*/
+static void prvPtrQueueBenchRun( UBaseType_t uxLoad, BaseType_t xUsePtrQueue )
+{
+	UBaseType_t uxLength = pxPtrQueueBenchLoad[uxLoad].uxLength;
+	UBaseType_t uxBatch = pxPtrQueueBenchLoad[uxLoad].uxBatch;
+	PtrQueueHandle_t xPtrQueue = NULL;
+	QueueHandle_t xQueue = NULL;
+	void *pvItem = &xPtrQueueBench, *pvItems[ 8 ];
+	uint32_t ulStart, ulSendSum = 0, ulReceiveSum = 0, ulCount = 0;
+	UBaseType_t uxRead;
+
+	if ( xUsePtrQueue ) {
+		xPtrQueue = xPtrQueueCreateStatic( uxLength, xPtrQueueBench.pvPtrStorage,
+			&xPtrQueueBench.xPtrQueue );
+	} else {
+		xQueue = xQueueCreateStatic( uxLength, sizeof( void * ),
+			xPtrQueueBench.pucQueueStorage, &xPtrQueueBench.xQueue );
+	}
+
+	for ( uint32_t i=0; i<ptrqueueBENCH_RUNS; i++ ) {
+		/* Llenado con un productor, un mensaje por llamada */
+		ulStart = latencyTIMESTAMP();
+		for ( UBaseType_t j=0; j<uxLength; j++ ) {
+			if ( xUsePtrQueue ) {
+				xPtrQueueSendToBack( xPtrQueue, &pvItem, 0 );
+			} else {
+				xQueueSendToBack( xQueue, &pvItem, 0 );
+			}
+		}
+		ulSendSum += latencyTIMESTAMP() - ulStart;
+
+		/* Vaciado como el consumidor de la cola */
+		ulStart = latencyTIMESTAMP();
+		for ( UBaseType_t j=0; j<uxLength; j+=uxRead ) {
+			if ( xUsePtrQueue ) {
+				uxRead = uxPtrQueueReceiveBulk( xPtrQueue, pvItems, uxBatch, 0 );
+			} else {
+				uxRead = 0;
+				while ( ( uxRead < uxBatch ) &&
+					( xQueueReceive( xQueue, &pvItems[uxRead], 0 ) == pdPASS ) ) {
+					uxRead++;
+				}
+			}
+			if ( uxRead == 0 ) {
+				break;
+			}
+		}
+		ulReceiveSum += latencyTIMESTAMP() - ulStart;
+		ulCount += uxLength;
+	}
+
+	if ( !xUsePtrQueue ) {
+		vQueueDelete( xQueue );
+	}
+
+	printf( "PQ:BENCH %s %s n %u send %u receive %u cycles/msg\n",
+		pxPtrQueueBenchLoad[uxLoad].pcName, xUsePtrQueue ? "ptrqueue" : "queue",
+		( unsigned ) ulCount, ( unsigned ) ( ulSendSum / ulCount ),
+		( unsigned ) ( ulReceiveSum / ulCount ) );
+}
+
+/*! \fn void vPtrQueueBenchmark( void )
+	\brief Comparar la cola de punteros frente a una cola de FreeRTOS
+	(comando ":B").
+*/
+void vPtrQueueBenchmark( void )
+{
+	for ( UBaseType_t i=0; i<sizeof( pxPtrQueueBenchLoad ) / sizeof( pxPtrQueueBenchLoad[0] ); i++ ) {
+		prvPtrQueueBenchRun( i, pdFALSE );
+		prvPtrQueueBenchRun( i, pdTRUE );
+	}
+}
+
+#endif /* appUSE_LATENCY */
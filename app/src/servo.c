@@ -7,11 +7,13 @@
 */
 
 /* Utilidades includes */
+#include <stdio.h>
 #include <stdlib.h>
 
 /* FreeRTOS.org includes. */
 #include "FreeRTOS.h"
 #include "FreeRTOSPriorities.h"
+#include "FreeRTOSMemory.h"
 #include "task.h"
 #include "queue.h"
 
@@ -21,16 +23,22 @@
 
 /* Aplicación includes */
 #include "servo.h"
+#include "ptr_queue.h"
+#include "dualcore.h"
+#include "display_lcd.h"
+#include "barrier.h"
+#include "power.h"
+#include "uart.h"
 
 /*! \var TaskHandle_t xAppSyncTaskHandle
 	\brief Handle de la tarea que sincroniza mensajes.
 */
 extern TaskHandle_t xAppSyncTaskHandle;
 
-/*! \var QueueHandle_t xServoSetPointQueue
+/*! \var PtrQueueHandle_t xServoSetPointQueue
     \brief Cola de consignas recibidas a ejecutar.
 */
-QueueHandle_t xServoSetPointQueue;
+PtrQueueHandle_t xServoSetPointQueue;
 
 /*! \var QueueHandle_t xServoPositionMailbox
 	\brief Handle del mailbox que contendrá la posición
@@ -38,29 +46,94 @@ QueueHandle_t xServoSetPointQueue;
 */
 QueueHandle_t xServoPositionMailbox;
 
-/*! \fn uint8_t ucServoValue( uint8_t ucAngle )
-	\brief Conversión a valor de ángulo dada la discretización
-	que impone el sistema.
-	\param Ángulo a setear introducido por el usuario.
-	\return Ángulo dada la discretización del sistema.
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+/*! \var xServoMemory
+	\brief Memoria estática de tarea, cola y mailbox del módulo.
 */
-uint8_t ucServoValue( uint8_t ucAngle )
-{
-	uint8_t ucMinDiff = servoANGLE_MAX / 10;
-	if ( ( servoANGLE_MIN <= ucAngle ) && ( ucAngle < ucMinDiff ) ) {
-		return servoANGLE_MIN;
-	} else if ( ( ucMinDiff < ucAngle ) && ( ucAngle < 3*ucMinDiff ) ) {
-		return 2 * ucMinDiff;
-	} else if ( ( 3*ucMinDiff < ucAngle ) && ( ucAngle < 5*ucMinDiff ) ) {
-		return 4 * ucMinDiff;
-	} else if ( ( 5*ucMinDiff < ucAngle ) && ( ucAngle < 7*ucMinDiff ) ) {
-		return 6 * ucMinDiff;
-	} else if ( ( 7*ucMinDiff < ucAngle ) && ( ucAngle < 9*ucMinDiff ) ) {
-		return 8 * ucMinDiff;
-	} else if ( ( 9*ucMinDiff < ucAngle ) && ( ucAngle <= servoANGLE_MAX ) ) {
-		return 10 * ucMinDiff;
-	}
-}
+static struct {
+	StaticTask_t xControlTaskTCB;
+	StackType_t puxControlTaskStack[ stackServoControlTask ];
+	StaticPtrQueue_t xSetPointQueue;
+	void *pvSetPointQueueStorage[ servoMAX_SETPOINT_QUEUE_LENGTH ];
+	StaticQueue_t xPositionMailbox;
+	uint8_t pucPositionMailboxStorage[ sizeof( uint8_t ) ];
+} xServoMemory memPLACE( memBANK_SERVO );
+
+memMODULE( xServoMemoryModule, "Servo", memBANK_SERVO, memBUDGET_SERVO, xServoMemory );
+#endif
+
+/*! \var typedef struct xServoChannel ServoChannel_t
+	\brief Pin de salida de un canal.
+*/
+typedef struct xServoChannel {
+	/* Puerto y pin de SCU */
+	uint8_t ucScuPort;
+	uint8_t ucScuPin;
+	/* Salida CTOUT del SCT (función 1 del pin) */
+	uint8_t ucOutput;
+} ServoChannel_t;
+
+/*! \var pxServoChannel
+	\brief Pines de los canales. En la EDU-CIAA casi todas las salidas
+	CTOUT libres comparten pin con los drivers de los motores paso a
+	paso, el LCD o los LEDs; por ejemplo SPI_MISO (P1_3, CTOUT8) y
+	SPI_MOSI (P1_4, CTOUT9) quedan libres si no se usa el SPI.
+*/
+static const ServoChannel_t pxServoChannel[ servoCHANNEL_NUM ] = {
+	{ servoSCU_PORT, servoSCU_PIN, servoSCT_PWM_PIN }
+};
+
+/*! \var pulServoTicks
+	\brief Tabla de pulsos de cada canal en ticks del SCT. La escribe
+	la tarea del servo y la lee la interrupción de frame sin
+	secciones críticas: ulServoSequence es impar mientras la tabla se
+	está escribiendo y la interrupción reintenta en el frame
+	siguiente.
+*/
+static volatile uint32_t pulServoTicks[ servoCHANNEL_NUM ];
+static volatile uint32_t pulServoVelocity[ servoCHANNEL_NUM ];
+static volatile uint32_t pulServoAccel[ servoCHANNEL_NUM ];
+static volatile uint32_t ulServoSequence = 0;
+
+/*! \var pxServoRamp
+	\brief Rampa de cada canal.
+*/
+static ServoRamp_t pxServoRamp[ servoCHANNEL_NUM ];
+
+/*! \var xServoBarrier
+	\brief Barrera de finalización de las rampas, una parte por canal.
+*/
+static Barrier_t xServoBarrier;
+
+/*! \var ulServoApplied
+	\brief Secuencia de la última tabla copiada al SCT.
+*/
+static uint32_t ulServoApplied = 0;
+
+/*! \var ulServoFrames
+	\brief Frames en que se actualizó la tabla y frames en que se
+	reintentó por escritura en curso.
+*/
+static volatile uint32_t ulServoFrames = 0;
+static volatile uint32_t ulServoRetries = 0;
+
+/*! \var ulServoPulseMinUs
+	\brief Pulsos de calibración para 0° y 180° en us de cada canal.
+*/
+static uint32_t pulServoPulseMinUs[ servoCHANNEL_NUM ];
+static uint32_t pulServoPulseMaxUs[ servoCHANNEL_NUM ];
+
+/*! \var pucServoAngle
+	\brief Último ángulo escrito en cada canal.
+*/
+static uint8_t pucServoAngle[ servoCHANNEL_NUM ];
+
+/*! \var pulServoVelocityDps
+	\brief Velocidad y aceleración máximas de cada canal en °/s y
+	°/s².
+*/
+static uint32_t pulServoVelocityDps[ servoCHANNEL_NUM ];
+static uint32_t pulServoAccelDps2[ servoCHANNEL_NUM ];
 
 /*! \fn void vServoSendMsg( char *pcMsg )
 	\brief Enviar consigna a cola de consignas pendientes.
@@ -69,7 +142,7 @@ uint8_t ucServoValue( uint8_t ucAngle )
 void vServoSendMsg( char *pcMsg)
 {
 	/* Escribir mensaje en cola de transmisión */
-	xQueueSendToBack(
+	xPtrQueueSendToBack(
 		/* Handle de la cola a escribir */
 		xServoSetPointQueue,
 		/* Puntero al dato a escribir */
@@ -87,44 +160,252 @@ void vServoStop( void )
 	Chip_SCTPWM_Stop( servoSCT_PWM );
 }
 
-/*! \fn BaseType_t xServoAbsoluteSetPoint( uint8_t ucSetPointValue )
-	\brief Setear la posición absoluta del servo.
-	\param ucSetPointValue Posición a setear.
+/*! \fn void vServoEngineBegin( void )
+	\brief Iniciar la escritura de la tabla de pulsos.
+*/
+void vServoEngineBegin( void )
+{
+	ulServoSequence++;
+	__asm volatile( "dmb" ::: "memory" );
+}
+
+/*! \fn void vServoEngineWrite( uint8_t ucChannel, uint32_t ulTicks, uint32_t ulVelocity, uint32_t ulAccel )
+	\brief Escribir el pulso destino de un canal y sus límites.
 */
-BaseType_t xServoAbsoluteSetPoint( uint8_t ucSetPointValue )
+void vServoEngineWrite( uint8_t ucChannel, uint32_t ulTicks,
+	uint32_t ulVelocity, uint32_t ulAccel )
 {
-	/* Verificación de consigna menor al mínimo admisible */
-	if ( ucSetPointValue < servoANGLE_MIN ) {
-		/* Setear valor mínimo admisible */
-		Chip_SCTPWM_SetDutyCycle( servoSCT_PWM, servoSCT_PWM_INDEX,
-			Chip_SCTPWM_PercentageToTicks( servoSCT_PWM,
-				servoDUTYCYCLE_MIN ) );
-
-		/* Actualización del valor en mailbox */
-		ucSetPointValue = servoANGLE_MIN;
-		xQueueOverwrite( xServoPositionMailbox, &ucSetPointValue );
-		/* Devolver error */
+	configASSERT( ucChannel < servoCHANNEL_NUM );
+
+	pulServoTicks[ ucChannel ] = ulTicks;
+	pulServoVelocity[ ucChannel ] = ulVelocity;
+	pulServoAccel[ ucChannel ] = ulAccel;
+}
+
+/*! \fn void vServoEngineCommit( void )
+	\brief Publicar la tabla de pulsos.
+*/
+void vServoEngineCommit( void )
+{
+	__asm volatile( "dmb" ::: "memory" );
+	ulServoSequence++;
+
+#if ( appUSE_DUAL_CORE == 1 )
+	/* El M0 escribe los registros de recarga del SCT */
+	if ( xDualCoreRunning() ) {
+		for ( uint8_t i=0; i<servoCHANNEL_NUM; i++ ) {
+			IpcCommand_t xCommand = {
+				.ucType = ipcCMD_SERVO_SET,
+				.ucChannel = servoSCT_MATCH( i ),
+				.ulValue = pulServoTicks[i]
+			};
+			vDualCoreSendCommand( &xCommand );
+		}
+		return;
+	}
+#endif
+
+	/* La interrupción de frame sólo se habilita con una tabla
+	 * pendiente, para no despertar al procesador cada 20 ms */
+	taskENTER_CRITICAL();
+	Chip_SCT_EnableEventInt( servoSCT_PWM, SCT_EVT_0 );
+	taskEXIT_CRITICAL();
+}
+
+/*! \fn void SCT_IRQHandler( void )
+	\brief Interrupción de fin de frame (match 0). Toma la tabla
+	publicada como nuevo destino de cada canal, avanza las rampas
+	activas y escribe los pulsos en los registros de recarga, que el
+	SCT carga en todos los canales a la vez en el próximo límite. Se
+	deshabilita cuando no quedan rampas ni tablas pendientes.
+*/
+void SCT_IRQHandler( void )
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	BaseType_t xPending = pdFALSE;
+	ServoRamp_t *pxRamp;
+	uint32_t ulSequence;
+
+	servoSCT_PWM->EVFLAG = SCT_EVT_0;
+
+	ulSequence = ulServoSequence;
+	if ( ulSequence & 1 ) {
+		/* Tabla en escritura, reintentar en el próximo frame */
+		ulServoRetries++;
+		xPending = pdTRUE;
+	} else if ( ulSequence != ulServoApplied ) {
+		__asm volatile( "dmb" ::: "memory" );
+		for ( uint8_t i=0; i<servoCHANNEL_NUM; i++ ) {
+			pxRamp = &pxServoRamp[i];
+			if ( ( int32_t ) pulServoTicks[i] != pxRamp->lTarget ) {
+				pxRamp->lTarget = pulServoTicks[i];
+				pxRamp->xActive = pdTRUE;
+			}
+			pxRamp->lVelocityMax = pulServoVelocity[i];
+			pxRamp->lAccel = pulServoAccel[i];
+		}
+		ulServoApplied = ulSequence;
+		ulServoFrames++;
+	}
+
+	for ( uint8_t i=0; i<servoCHANNEL_NUM; i++ ) {
+		pxRamp = &pxServoRamp[i];
+		if ( pxRamp->xActive == pdFALSE ) {
+			continue;
+		}
+		if ( xServoRampStep( pxRamp ) ) {
+			pxRamp->xActive = pdFALSE;
+			vBarrierArriveFromISR( &xServoBarrier, i, &xHigherPriorityTaskWoken );
+		} else {
+			xPending = pdTRUE;
+		}
+		servoSCT_PWM->MATCHREL[ servoSCT_MATCH( i ) ].U = pxRamp->lPosition;
+	}
+
+	if ( xPending == pdFALSE ) {
+		servoSCT_PWM->EVEN &= ~SCT_EVT_0;
+	}
+	portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+/*! \fn void vServoReport( void )
+	\brief Imprimir los contadores del motor de servos.
+*/
+void vServoReport( void )
+{
+	printf( "SRV:ENG ch %u frames %u retry %u\n", ( unsigned ) servoCHANNEL_NUM,
+		( unsigned ) ulServoFrames, ( unsigned ) ulServoRetries );
+	vBarrierReport( &xServoBarrier, "SRV" );
+}
+
+/*! \fn static BaseType_t prvServoRamped( void )
+	\brief pdTRUE si las rampas las ejecuta la interrupción de frame
+	del M4. Con el M0 en funcionamiento el pulso se escribe sin rampa.
+*/
+static BaseType_t prvServoRamped( void )
+{
+#if ( appUSE_DUAL_CORE == 1 )
+	if ( xDualCoreRunning() ) {
+		return pdFALSE;
+	}
+#endif
+	return pdTRUE;
+}
+
+/*! \fn static void prvServoSetAngle( uint8_t ucChannel, uint8_t ucAngle )
+	\brief Mover el canal al ángulo con la calibración y los límites
+	actuales y esperar el fin de la rampa, como una consigna de los
+	motores paso a paso (SRV:BGN, SRV:END y SRV:LATE si no termina en
+	el tiempo esperado). El canal 0 actualiza el mailbox de posición.
+*/
+static void prvServoSetAngle( uint8_t ucChannel, uint8_t ucAngle )
+{
+	uint32_t ulFrame = Chip_SCTPWM_GetTicksPerCycle( servoSCT_PWM );
+	uint32_t ulTicks = ulServoAngleToTicks( ucAngle, pulServoPulseMinUs[ ucChannel ],
+		pulServoPulseMaxUs[ ucChannel ], ulFrame );
+	/* Ticks del recorrido completo, para convertir los límites */
+	uint64_t ullSpan = ulServoAngleToTicks( servoANGLE_MAX, pulServoPulseMinUs[ ucChannel ],
+		pulServoPulseMaxUs[ ucChannel ], ulFrame ) -
+		ulServoAngleToTicks( servoANGLE_MIN, pulServoPulseMinUs[ ucChannel ],
+		pulServoPulseMaxUs[ ucChannel ], ulFrame );
+	uint32_t ulRate = servoSCT_PWM_RATE;
+	uint32_t ulVelocity = ullSpan * pulServoVelocityDps[ ucChannel ] / ( servoANGLE_MAX * ulRate );
+	uint32_t ulAccel = ullSpan * pulServoAccelDps2[ ucChannel ] / ( servoANGLE_MAX * ulRate * ulRate );
+	uint32_t ulDistance, ulFrames;
+	BaseType_t xMove = ( ulTicks != pulServoTicks[ ucChannel ] ) && prvServoRamped();
+
+	pucServoAngle[ ucChannel ] = ucAngle;
+	if ( ucChannel == 0 ) {
+		xQueueOverwrite( xServoPositionMailbox, &ucAngle );
+		vDisplayRefresh();
+	}
+
+	/* Límites de al menos un tick por frame */
+	ulVelocity = ( ulVelocity == 0 ) ? 1 : ulVelocity;
+	ulAccel = ( ulAccel == 0 ) ? 1 : ulAccel;
+	ulDistance = ( ulTicks > pulServoTicks[ ucChannel ] ) ?
+		ulTicks - pulServoTicks[ ucChannel ] : pulServoTicks[ ucChannel ] - ulTicks;
+
+	if ( xMove ) {
+		vBarrierArm( &xServoBarrier );
+		vBarrierExpect( &xServoBarrier, ucChannel );
+	}
+	vServoEngineBegin();
+	vServoEngineWrite( ucChannel, ulTicks, ulVelocity, ulAccel );
+	vServoEngineCommit();
+	if ( xMove == pdFALSE ) {
+		return;
+	}
+
+	/* Mantener el tick durante el movimiento */
+	vPowerMotionBegin();
+	vUartSendMsg( "SRV:BGN" );
+
+	/* Duración de la rampa trapezoidal más un frame de latencia */
+	ulFrames = ulDistance / ulVelocity + ulVelocity / ulAccel + 2;
+	if ( ulBarrierWait( &xServoBarrier,
+			pdMS_TO_TICKS( ulFrames * servoPWM_PERIOD + servoDONE_MARGIN_MS ) ) ) {
+		vUartSendMsg( "SRV:LATE" );
+		ulBarrierWait( &xServoBarrier, portMAX_DELAY );
+	}
+
+	vPowerMotionEnd();
+	vUartSendMsg( "SRV:END" );
+}
+
+/*! \fn BaseType_t xServoSetLimits( uint8_t ucChannel, uint32_t ulVelocityDps, uint32_t ulAccelDps2 )
+	\brief Cambiar la velocidad y aceleración máximas del canal.
+*/
+BaseType_t xServoSetLimits( uint8_t ucChannel, uint32_t ulVelocityDps, uint32_t ulAccelDps2 )
+{
+	if ( ( ucChannel >= servoCHANNEL_NUM ) ||
+		( ulVelocityDps == 0 ) || ( ulVelocityDps > servoVELOCITY_LIMIT_DPS ) ||
+		( ulAccelDps2 == 0 ) || ( ulAccelDps2 > servoACCEL_LIMIT_DPS2 ) ) {
 		return pdFAIL;
 	}
-	/* Verificación de consigna mayor al máximo admisible */
-	if ( ucSetPointValue > servoANGLE_MAX ) {
-		/* Setear valor máximo admisible */
-		Chip_SCTPWM_SetDutyCycle( servoSCT_PWM, servoSCT_PWM_INDEX,
-			Chip_SCTPWM_PercentageToTicks( servoSCT_PWM,
-				servoDUTYCYCLE_MAX ) );
-
-		/* Actualización del valor en mailbox */
-		ucSetPointValue = servoANGLE_MAX;
-		xQueueOverwrite( xServoPositionMailbox, &ucSetPointValue );
-		/* Devolver error */
+
+	pulServoVelocityDps[ ucChannel ] = ulVelocityDps;
+	pulServoAccelDps2[ ucChannel ] = ulAccelDps2;
+
+	return pdPASS;
+}
+
+/*! \fn static BaseType_t prvServoAbsoluteSetPoint( uint8_t ucChannel, uint32_t ulSetPointValue )
+	\brief Setear la posición absoluta de un servo.
+	\param ucChannel Canal del servo.
+	\param ulSetPointValue Posición a setear.
+*/
+static BaseType_t prvServoAbsoluteSetPoint( uint8_t ucChannel, uint32_t ulSetPointValue )
+{
+	/* Verificación de consigna fuera del rango admisible: se setea
+	 * el límite y se devuelve error. servoANGLE_MIN es 0 y una
+	 * consigna negativa llega de strtoul como un valor mayor a
+	 * servoANGLE_MAX */
+	if ( ulSetPointValue > servoANGLE_MAX ) {
+		prvServoSetAngle( ucChannel, servoANGLE_MAX );
 		return pdFAIL;
 	}
 
-	Chip_SCTPWM_SetDutyCycle( servoSCT_PWM, servoSCT_PWM_INDEX,
-		Chip_SCTPWM_PercentageToTicks( servoSCT_PWM,
-			ucServoValue( ucSetPointValue )*5/servoANGLE_MAX + 5 ) );
+	prvServoSetAngle( ucChannel, ulSetPointValue );
 
-	xQueueOverwrite( xServoPositionMailbox, &ucSetPointValue );
+	return pdPASS;
+}
+
+/*! \fn BaseType_t xServoCalibrate( uint8_t ucChannel, uint32_t ulPulseMinUs, uint32_t ulPulseMaxUs )
+	\brief Cambiar los pulsos de 0° y 180° del canal.
+*/
+BaseType_t xServoCalibrate( uint8_t ucChannel, uint32_t ulPulseMinUs, uint32_t ulPulseMaxUs )
+{
+	if ( ( ucChannel >= servoCHANNEL_NUM ) ||
+		( ulPulseMinUs < servoPULSE_LIMIT_MIN_US ) ||
+		( ulPulseMaxUs > servoPULSE_LIMIT_MAX_US ) ||
+		( ulPulseMinUs >= ulPulseMaxUs ) ) {
+		return pdFAIL;
+	}
+
+	pulServoPulseMinUs[ ucChannel ] = ulPulseMinUs;
+	pulServoPulseMaxUs[ ucChannel ] = ulPulseMaxUs;
+	prvServoSetAngle( ucChannel, pucServoAngle[ ucChannel ] );
 
 	return pdPASS;
 }
@@ -137,18 +418,26 @@ void vServoControlTask( void *pvParameters )
 {
 	/* Puntero a consignas recibidas */
 	char *pcReceivedSetPoint;
+	/* Copia de la consigna recibida por UART */
+	char pcSetPoint[uartLINE_LENGTH];
 
-	/* Valor de ángulo a setear */
-	uint8_t ulAngleValue = 0;
+	/* Canal y valor de ángulo a setear */
+	uint32_t ulChannel;
+	uint32_t ulAngleValue;
+	char *pcEnd;
+	/* Posición inicial del mailbox (elementos de uint8_t) */
+	uint8_t ucPosition = servoANGLE_MIN;
 
-	xQueueOverwrite( xServoPositionMailbox, &ulAngleValue );
+	xQueueOverwrite( xServoPositionMailbox, &ucPosition );
 
-	/* Inicialización del servo en 0 */
-	xServoAbsoluteSetPoint( 30 );
+	/* Inicialización de los servos en 30 */
+	for ( uint8_t i=0; i<servoCHANNEL_NUM; i++ ) {
+		prvServoAbsoluteSetPoint( i, 30 );
+	}
 
 	for ( ;; ) {
 		/* Lectura de cola de consignas */
-		xQueueReceive(
+		xPtrQueueReceive(
 			/* Handle de la cola a leer */
 			xServoSetPointQueue,
 			/* Elemento donde guardar información leída */
@@ -156,12 +445,63 @@ void vServoControlTask( void *pvParameters )
 			/* Máxima cantidad de tiempo a esperar por una lectura */
 			portMAX_DELAY
 		);
+		pcReceivedSetPoint = pcUartTakeCmd( pcReceivedSetPoint, pcSetPoint );
+
+		/* Calibración de pulsos ":XC<min>,<max>[,<canal>]" */
+		if ( pcReceivedSetPoint[2] == 'C' ) {
+			uint32_t ulPulseMinUs = strtoul( &pcReceivedSetPoint[3], &pcEnd, 10 );
+			uint32_t ulPulseMaxUs = 0;
+
+			ulChannel = 0;
+			if ( *pcEnd == ',' ) {
+				ulPulseMaxUs = strtoul( pcEnd + 1, &pcEnd, 10 );
+				if ( *pcEnd == ',' ) {
+					ulChannel = strtoul( pcEnd + 1, NULL, 10 );
+				}
+			}
+			if ( ( ulChannel >= servoCHANNEL_NUM ) ||
+				( xServoCalibrate( ulChannel, ulPulseMinUs, ulPulseMaxUs ) == pdFAIL ) ) {
+				xTaskNotify( xAppSyncTaskHandle,
+					( 1 << servoERROR_NOTIF_CAL ), eSetBits );
+			}
+			continue;
+		}
 
-		/* Lectura de ID del motor a setear */
-		ulAngleValue = atoi( &pcReceivedSetPoint[2] );
+		/* Límites de rampa ":XV<°/s>,<°/s²>[,<canal>]" */
+		if ( pcReceivedSetPoint[2] == 'V' ) {
+			uint32_t ulVelocityDps = strtoul( &pcReceivedSetPoint[3], &pcEnd, 10 );
+			uint32_t ulAccelDps2 = 0;
+
+			ulChannel = 0;
+			if ( *pcEnd == ',' ) {
+				ulAccelDps2 = strtoul( pcEnd + 1, &pcEnd, 10 );
+				if ( *pcEnd == ',' ) {
+					ulChannel = strtoul( pcEnd + 1, NULL, 10 );
+				}
+			}
+			if ( ( ulChannel >= servoCHANNEL_NUM ) ||
+				( xServoSetLimits( ulChannel, ulVelocityDps, ulAccelDps2 ) == pdFAIL ) ) {
+				xTaskNotify( xAppSyncTaskHandle,
+					( 1 << servoERROR_NOTIF_CAL ), eSetBits );
+			}
+			continue;
+		}
+
+		/* Consigna ":X<ángulo>" al canal 0 o ":X<canal>A<ángulo>" */
+		ulAngleValue = strtoul( &pcReceivedSetPoint[2], &pcEnd, 10 );
+		ulChannel = 0;
+		if ( *pcEnd == 'A' ) {
+			ulChannel = ulAngleValue;
+			ulAngleValue = strtoul( pcEnd + 1, NULL, 10 );
+		}
+		if ( ulChannel >= servoCHANNEL_NUM ) {
+			xTaskNotify( xAppSyncTaskHandle,
+				( 1 << servoERROR_NOTIF_ID ), eSetBits );
+			continue;
+		}
 
 		/* Seteo de consigna */
-		if ( xServoAbsoluteSetPoint( ulAngleValue ) == pdFAIL ) {
+		if ( prvServoAbsoluteSetPoint( ulChannel, ulAngleValue ) == pdFAIL ) {
 			/* Error en ángulo */
 			xTaskNotify( xAppSyncTaskHandle,
 				( 1 << servoERROR_NOTIF_ANG ), eSetBits );
@@ -180,19 +520,37 @@ BaseType_t xServoInit( void )
 	/* Setear frecuencia del SCT */
 	Chip_SCTPWM_SetRate( servoSCT_PWM, servoSCT_PWM_RATE );
 
-	/* Setear como salida el pin de salida específico */
-	Chip_SCU_PinMuxSet( servoSCU_PORT, servoSCU_PIN,
-		( SCU_MODE_INACT | SCU_MODE_FUNC1 ) );
+	for ( uint8_t i=0; i<servoCHANNEL_NUM; i++ ) {
+		pulServoPulseMinUs[i] = servoPULSE_MIN_US;
+		pulServoPulseMaxUs[i] = servoPULSE_MAX_US;
+		pucServoAngle[i] = servoANGLE_MIN;
+		pulServoVelocityDps[i] = servoVELOCITY_MAX_DPS;
+		pulServoAccelDps2[i] = servoACCEL_MAX_DPS2;
+
+		/* Setear como salida el pin de salida específico */
+		Chip_SCU_PinMuxSet( pxServoChannel[i].ucScuPort, pxServoChannel[i].ucScuPin,
+			( SCU_MODE_INACT | SCU_MODE_FUNC1 ) );
+
+		/* Asignar un pin de salida PWM a un canal */
+		Chip_SCTPWM_SetOutPin( servoSCT_PWM, servoSCT_MATCH( i ),
+			pxServoChannel[i].ucOutput );
+
+		/* Setear el duty-cycle para la salida de PWM
+		 * generada en el canal */
+		pulServoTicks[i] = ulServoAngleToTicks( servoANGLE_MIN, servoPULSE_MIN_US,
+			servoPULSE_MAX_US, Chip_SCTPWM_GetTicksPerCycle( servoSCT_PWM ) );
+		Chip_SCTPWM_SetDutyCycle( servoSCT_PWM, servoSCT_MATCH( i ), pulServoTicks[i] );
+		pxServoRamp[i].lPosition = pulServoTicks[i];
+		pxServoRamp[i].lTarget = pulServoTicks[i];
+	}
 
-	/* Asignar un pin de salida PWM a un canal */
-	Chip_SCTPWM_SetOutPin( servoSCT_PWM, servoSCT_PWM_INDEX,
-		servoSCT_PWM_PIN );
+	vBarrierInit( &xServoBarrier, servoCHANNEL_NUM, 0 );
 
-	/* Setear el duty-cycle para la salida de PWM
-	 * generada en el canal */
-	Chip_SCTPWM_SetDutyCycle( servoSCT_PWM, servoSCT_PWM_INDEX,
-				Chip_SCTPWM_PercentageToTicks( servoSCT_PWM,
-					servoDUTYCYCLE_MIN ) );
+	/* Interrupción de frame para copiar la tabla de pulsos. Se
+	 * habilita en el NVIC y por evento sólo con una tabla pendiente */
+	Chip_SCT_DisableEventInt( servoSCT_PWM, SCT_EVT_0 );
+	NVIC_SetPriority( SCT_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1 );
+	NVIC_EnableIRQ( SCT_IRQn );
 
 	/* Lanzar el canal PWM */
 	Chip_SCTPWM_Start( servoSCT_PWM );
@@ -201,19 +559,27 @@ BaseType_t xServoInit( void )
 	BaseType_t xStatus;
 
 	/* Creación de cola de consignas recibidas a ejecutar */
-	xServoSetPointQueue = xQueueCreate(
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+	xServoSetPointQueue = xPtrQueueCreateStatic( servoMAX_SETPOINT_QUEUE_LENGTH,
+		xServoMemory.pvSetPointQueueStorage, &xServoMemory.xSetPointQueue );
+#else
+	xServoSetPointQueue = xPtrQueueCreate(
 		/* Longitud máxima de la cola */
-		servoMAX_SETPOINT_QUEUE_LENGTH,
-		/* Tamaño de elementos a guardar en cola */
-		sizeof( char * )
+		servoMAX_SETPOINT_QUEUE_LENGTH
 	);
+#endif
 	/* Verificación de cola creada con éxito */
 	if ( xServoSetPointQueue == NULL ) {
 		return pdFAIL;
 	}
 
 	/* Creación de mailbox para guardar posición del motor */
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+	xServoPositionMailbox = xQueueCreateStatic( 1, sizeof( uint8_t ),
+		xServoMemory.pucPositionMailboxStorage, &xServoMemory.xPositionMailbox );
+#else
 	xServoPositionMailbox = xQueueCreate( 1, sizeof( uint8_t ) );
+#endif
 	/* Verificación de mailbox creado con éxito */
 	if ( xServoPositionMailbox == NULL ) {
 		return pdFAIL;
@@ -221,9 +587,15 @@ BaseType_t xServoInit( void )
 
 	/* Creación de tarea para procesamiento asociado
 	al servo motor */
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+	xStatus = ( xTaskCreateStatic( vServoControlTask, (const char *)"ServoControlTask",
+		stackServoControlTask, NULL, priorityServoControlTask,
+		xServoMemory.puxControlTaskStack, &xServoMemory.xControlTaskTCB ) != NULL ) ? pdPASS : pdFAIL;
+#else
 	xStatus = xTaskCreate( vServoControlTask, (const char *)"ServoControlTask",
-		configMINIMAL_STACK_SIZE*2, NULL,
+		stackServoControlTask, NULL,
 		priorityServoControlTask, NULL );
+#endif
 	/* Verificación de tarea creada con éxito */
 	if ( xStatus == pdFAIL ) {
 		return pdFAIL;
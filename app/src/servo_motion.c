@@ -0,0 +1,104 @@
+/*! \file servo_motion.c
+    \brief Cálculos del servomotor que no dependen del hardware:
+    ancho de pulso en ticks del SCT para un ángulo y rampa
+    trapezoidal de cada frame.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+/* Utilidades includes */
+#include <stdlib.h>
+
+/* Aplicación includes */
+#include "servo_motion.h"
+
+/*! \fn uint32_t ulServoAngleToTicks( uint32_t ulAngle, uint32_t ulPulseMinUs, uint32_t ulPulseMaxUs, uint32_t ulTicksPerFrame )
+	\brief Ancho de pulso en ticks del SCT para un ángulo.
+*/
+uint32_t ulServoAngleToTicks( uint32_t ulAngle, uint32_t ulPulseMinUs,
+	uint32_t ulPulseMaxUs, uint32_t ulTicksPerFrame )
+{
+	/* Pulso en ns, escalado por servoANGLE_MAX para no perder la
+	 * fracción de us de cada grado */
+	uint64_t ullPulse = ( uint64_t ) ulPulseMinUs * 1000 * servoANGLE_MAX +
+		( uint64_t ) ( ulPulseMaxUs - ulPulseMinUs ) * 1000 * ulAngle;
+	uint64_t ullFrame = ( uint64_t ) servoPWM_PERIOD * 1000000 * servoANGLE_MAX;
+
+	return ( uint32_t ) ( ( ullPulse * ulTicksPerFrame + ullFrame / 2 ) / ullFrame );
+}
+
+/*! \fn static int64_t prvServoBrakeDistance( int32_t lSpeed, int32_t lAccel )
+	\brief Distancia que recorre la rampa desde lSpeed hasta detenerse,
+	frenando lAccel por frame a partir del frame siguiente.
+*/
+static int64_t prvServoBrakeDistance( int32_t lSpeed, int32_t lAccel )
+{
+	/* Frames con velocidad lSpeed - k * lAccel positiva */
+	int64_t llFrames = ( lSpeed > 0 ) ? ( lSpeed - 1 ) / lAccel : 0;
+
+	return llFrames * lSpeed - lAccel * llFrames * ( llFrames + 1 ) / 2;
+}
+
+/*! \fn BaseType_t xServoRampStep( ServoRamp_t *pxRamp )
+	\brief Avanzar un frame la rampa trapezoidal del canal.
+*/
+BaseType_t xServoRampStep( ServoRamp_t *pxRamp )
+{
+	int32_t lDistance = pxRamp->lTarget - pxRamp->lPosition;
+	int32_t lDirection = ( lDistance < 0 ) ? -1 : 1;
+	/* Distancia y velocidad en el sentido del destino */
+	int32_t lRemaining = lDistance * lDirection;
+	int32_t lSpeed = pxRamp->lVelocity * lDirection;
+	int32_t lLow, lHigh, lMid;
+
+	/* Sin límites: salto directo al destino */
+	if ( ( pxRamp->lVelocityMax == 0 ) || ( pxRamp->lAccel == 0 ) ) {
+		pxRamp->lPosition = pxRamp->lTarget;
+		pxRamp->lVelocity = 0;
+		return pdTRUE;
+	}
+
+	/* Velocidades alcanzables en este frame: por encima de la velocidad
+	 * máxima (límite reducido durante el movimiento) sólo se frena */
+	lLow = lSpeed - pxRamp->lAccel;
+	lHigh = lSpeed + pxRamp->lAccel;
+	if ( lHigh > pxRamp->lVelocityMax ) {
+		lHigh = ( lLow > pxRamp->lVelocityMax ) ? lLow : pxRamp->lVelocityMax;
+	}
+
+	if ( lHigh > 0 ) {
+		if ( lLow < 0 ) {
+			lLow = 0;
+		}
+		if ( lLow + prvServoBrakeDistance( lLow, pxRamp->lAccel ) <= lRemaining ) {
+			/* Mayor velocidad desde la que todavía se frena en el
+			 * destino, por búsqueda binaria */
+			while ( lLow < lHigh ) {
+				lMid = lLow + ( lHigh - lLow + 1 ) / 2;
+				if ( lMid + prvServoBrakeDistance( lMid, pxRamp->lAccel ) <= lRemaining ) {
+					lLow = lMid;
+				} else {
+					lHigh = lMid - 1;
+				}
+			}
+		}
+		/* Si no, el destino cambió y no se puede frenar antes de
+		 * pasarlo: frenado máximo y regreso en los frames siguientes */
+		lSpeed = lLow;
+	} else {
+		/* Alejándose del destino: frenado máximo */
+		lSpeed = lHigh;
+	}
+
+	pxRamp->lVelocity = lSpeed * lDirection;
+	pxRamp->lPosition += pxRamp->lVelocity;
+
+	/* Llegada: el último paso es a lo sumo lAccel, el frenado a cero
+	 * respeta la aceleración */
+	if ( pxRamp->lPosition == pxRamp->lTarget ) {
+		pxRamp->lVelocity = 0;
+		return pdTRUE;
+	}
+	return pdFALSE;
+}
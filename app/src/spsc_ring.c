@@ -0,0 +1,149 @@
+/*! \file spsc_ring.c
+    \brief Buffer circular de bytes lock-free para un único
+    productor (típicamente una ISR) y un único consumidor
+    (una tarea).
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+/* Aplicación includes */
+#include "spsc_ring.h"
+
+/*! \fn void vSpscRingInit( SpscRing_t *pxRing, uint8_t *pucBuffer, uint32_t ulSize )
+	\brief Inicialización del buffer circular.
+	\param pxRing Buffer circular a inicializar.
+	\param pucBuffer Memoria del buffer.
+	\param ulSize Tamaño de la memoria, debe ser potencia de 2.
+*/
+void vSpscRingInit( SpscRing_t *pxRing, uint8_t *pucBuffer, uint32_t ulSize )
+{
+	/* Verificación de tamaño potencia de 2 */
+	configASSERT( ( ulSize != 0 ) && ( ( ulSize & ( ulSize - 1 ) ) == 0 ) );
+
+	pxRing->pucBuffer = pucBuffer;
+	pxRing->ulMask = ulSize - 1;
+	pxRing->ulHead = 0;
+	pxRing->ulTail = 0;
+	pxRing->xConsumer = NULL;
+	pxRing->ulDropped = 0;
+}
+
+/*! \fn static BaseType_t prvSpscRingWrite( SpscRing_t *pxRing, const uint8_t *pucData, uint32_t ulLength )
+	\brief Copiar bytes al buffer y publicar el nuevo índice de escritura.
+	\return pdTRUE si el consumidor debe ser notificado, pdFALSE si no,
+	o -1 si no hay espacio.
+*/
+static BaseType_t prvSpscRingWrite( SpscRing_t *pxRing, const uint8_t *pucData, uint32_t ulLength )
+{
+	uint32_t ulHead = pxRing->ulHead;
+	uint32_t ulTail = pxRing->ulTail;
+
+	/* Verificación de espacio disponible */
+	if ( ( pxRing->ulMask + 1 ) - ( ulHead - ulTail ) < ulLength ) {
+		pxRing->ulDropped += ulLength;
+		return -1;
+	}
+
+	for ( uint32_t i=0; i<ulLength; i++ ) {
+		pxRing->pucBuffer[ ( ulHead + i ) & pxRing->ulMask ] = pucData[i];
+	}
+
+	/* Los datos deben ser visibles antes que el índice */
+	spscMEMORY_BARRIER();
+	pxRing->ulHead = ulHead + ulLength;
+	spscMEMORY_BARRIER();
+
+	/* Notificar sólo si el consumidor ya había leído todo lo previo
+	 * (transición de vacío a no vacío). El índice de lectura se lee
+	 * después de publicar, así el consumidor o bien ve los datos nuevos
+	 * antes de bloquearse o bien recibe la notificación */
+	return ( pxRing->ulTail == ulHead ) && ( pxRing->xConsumer != NULL );
+}
+
+/*! \fn BaseType_t xSpscRingPutFromISR( SpscRing_t *pxRing, const uint8_t *pucData, uint32_t ulLength, BaseType_t *pxHigherPriorityTaskWoken )
+	\brief Escribir bytes desde el productor (ISR).
+*/
+BaseType_t xSpscRingPutFromISR( SpscRing_t *pxRing, const uint8_t *pucData,
+	uint32_t ulLength, BaseType_t *pxHigherPriorityTaskWoken )
+{
+	BaseType_t xNotify = prvSpscRingWrite( pxRing, pucData, ulLength );
+
+	if ( xNotify < 0 ) {
+		return pdFAIL;
+	}
+	if ( xNotify == pdTRUE ) {
+		vTaskNotifyGiveFromISR( pxRing->xConsumer, pxHigherPriorityTaskWoken );
+	}
+	return pdPASS;
+}
+
+/*! \fn BaseType_t xSpscRingPut( SpscRing_t *pxRing, const uint8_t *pucData, uint32_t ulLength )
+	\brief Escribir bytes desde el productor (tarea).
+*/
+BaseType_t xSpscRingPut( SpscRing_t *pxRing, const uint8_t *pucData, uint32_t ulLength )
+{
+	BaseType_t xNotify = prvSpscRingWrite( pxRing, pucData, ulLength );
+
+	if ( xNotify < 0 ) {
+		return pdFAIL;
+	}
+	if ( xNotify == pdTRUE ) {
+		xTaskNotifyGive( pxRing->xConsumer );
+	}
+	return pdPASS;
+}
+
+/*! \fn uint32_t ulSpscRingGet( SpscRing_t *pxRing, uint8_t *pucData, uint32_t ulMaxLength )
+	\brief Leer los bytes disponibles sin bloquear (consumidor).
+*/
+uint32_t ulSpscRingGet( SpscRing_t *pxRing, uint8_t *pucData, uint32_t ulMaxLength )
+{
+	uint32_t ulTail = pxRing->ulTail;
+	uint32_t ulCount = pxRing->ulHead - ulTail;
+
+	if ( ulCount > ulMaxLength ) {
+		ulCount = ulMaxLength;
+	}
+
+	/* Los datos se leen después de haber leído el índice de escritura */
+	spscMEMORY_BARRIER();
+	for ( uint32_t i=0; i<ulCount; i++ ) {
+		pucData[i] = pxRing->pucBuffer[ ( ulTail + i ) & pxRing->ulMask ];
+	}
+
+	/* Liberar el espacio una vez copiados los datos */
+	spscMEMORY_BARRIER();
+	pxRing->ulTail = ulTail + ulCount;
+	spscMEMORY_BARRIER();
+
+	return ulCount;
+}
+
+/*! \fn uint32_t ulSpscRingReceive( SpscRing_t *pxRing, uint8_t *pucData, uint32_t ulMaxLength, TickType_t xTicksToWait )
+	\brief Leer bytes bloqueando hasta que haya al menos uno
+	(consumidor).
+*/
+uint32_t ulSpscRingReceive( SpscRing_t *pxRing, uint8_t *pucData,
+	uint32_t ulMaxLength, TickType_t xTicksToWait )
+{
+	uint32_t ulCount;
+
+	/* Registro de la tarea consumidora */
+	if ( pxRing->xConsumer == NULL ) {
+		pxRing->xConsumer = xTaskGetCurrentTaskHandle();
+		spscMEMORY_BARRIER();
+	}
+
+	for ( ;; ) {
+		ulCount = ulSpscRingGet( pxRing, pucData, ulMaxLength );
+		if ( ulCount > 0 ) {
+			return ulCount;
+		}
+		/* Buffer vacío, esperar notificación del productor. Una
+		 * notificación sobrante sólo provoca una vuelta extra */
+		if ( ulTaskNotifyTake( pdTRUE, xTicksToWait ) == 0 ) {
+			return ulSpscRingGet( pxRing, pucData, ulMaxLength );
+		}
+	}
+}
@@ -9,6 +9,7 @@
 /* Utilidades includes */
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
 
 /* EDU-CIAA firmware_v3 includes */
 #include "sapi.h"
@@ -17,14 +18,19 @@
 #include "stepper.h"
 #include "driver_uln2003.h"
 #include "uart.h"
+#include "ptr_queue.h"
+#include "dualcore.h"
+#include "power.h"
+#include "barrier.h"
+#include "encoder.h"
 
 /* FreeRTOS includes */
 #include "FreeRTOSPriorities.h"
+#include "FreeRTOSMemory.h"
 #include "task.h"
 #include "timers.h"
 #include "queue.h"
 #include "semphr.h"
-#include "event_groups.h"
 
 /*! \def stepperANGLE_TO_STEPS( X )
     \brief Macro para convertir ángulos en cantidad de pasos del motor.
@@ -42,6 +48,8 @@
 typedef struct xStepperData {
 	/* Conjunto de entradas al driver correspondiente */
 	DriverIn_t pxDriverInput[4];
+	/* Entradas agrupadas por puerto para escribirlas a la vez */
+	gpioMask_t xDriverMask;
     /* Estado actual de entradas al driver */
     char cDriverState;
     /* Cantidad de pasos pendientes */
@@ -49,10 +57,11 @@ typedef struct xStepperData {
     /* Dirección en que se deben realizar los
     pasos pendientes */
     StepperDir_t xDir;
-    /* Bit asociado en el grupo de eventos (igual a ID) */
-    uint8_t cEventGroupBit;
+    /* Parte asociada en la barrera de finalización (igual a ID) */
+    uint8_t cBarrierParty;
     /* LED asociado al motor como indicador visual */
     gpioMap_t xLed;
+    gpioFast_t xLedFast;
 } StepperData_t;
 
 /*! \var TaskHandle_t xStepperControlTaskHandle
@@ -76,16 +85,60 @@ TimerHandle_t xStepperTimer[stepperAPP_NUM];
 */
 StepperData_t xStepperDataID[stepperAPP_NUM];
 
-/*! \var QueueHandle_t xStepperSetPointQueue
+/*! \var PtrQueueHandle_t xStepperSetPointQueue
     \brief Cola de consignas recibidas a ejecutar.
 */
-QueueHandle_t xStepperSetPointQueue;
+PtrQueueHandle_t xStepperSetPointQueue;
 
-/*! \var EventGroupHandle_t xStepperEventGroup
-	\brief Grupo de eventos para detectar que todos los
-	motores detuvieron su movimiento (final de consigna).
+/*! \var Barrier_t xStepperBarrier
+	\brief Barrera para detectar que todos los motores
+	detuvieron su movimiento (final de consigna).
 */
-EventGroupHandle_t xStepperEventGroup;
+static Barrier_t xStepperBarrier;
+
+/*! \var char pcStepperLateMsg[stepperAPP_NUM][]
+	\brief Aviso de motor que no finalizó la consigna en el tiempo
+	esperado. vUartSendMsg no copia el string.
+*/
+static char pcStepperLateMsg[stepperAPP_NUM][ sizeof( "SCT:LATE" ) + 1 ];
+
+/*! \var char pcStepperTimerName[stepperAPP_NUM][configMAX_TASK_NAME_LEN]
+	\brief Nombre de cada timer. FreeRTOS guarda sólo el puntero,
+	por lo que el string debe existir mientras exista el timer.
+*/
+static char pcStepperTimerName[stepperAPP_NUM][configMAX_TASK_NAME_LEN];
+
+/*! \var typedef struct xStepperJog StepperJog_t
+	\brief Consigna relativa pendiente de un motor.
+*/
+typedef struct xStepperJog {
+	/* Mensaje de consigna encolado */
+	char pcMsg[ stepperJOG_MSG_LENGTH ];
+	/* Ángulo acumulado con signo */
+	int32_t lAngle;
+	/* Mensaje en la cola sin leer por la tarea de control */
+	BaseType_t xPending;
+} StepperJog_t;
+
+/*! \var StepperJog_t pxStepperJog[stepperAPP_NUM]
+	\brief Consigna relativa pendiente de cada motor.
+*/
+static StepperJog_t pxStepperJog[stepperAPP_NUM];
+
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+/*! \var xStepperMemory
+	\brief Memoria estática de tarea, cola y timers del módulo.
+*/
+static struct {
+	StaticTask_t xControlTaskTCB;
+	StackType_t puxControlTaskStack[ stackStepperControlTask ];
+	StaticPtrQueue_t xSetPointQueue;
+	void *pvSetPointQueueStorage[ stepperMAX_SETPOINT_QUEUE_LENGTH ];
+	StaticTimer_t xTimer[ stepperAPP_NUM ];
+} xStepperMemory memPLACE( memBANK_STEPPER );
+
+memMODULE( xStepperMemoryModule, "Stepper", memBANK_STEPPER, memBUDGET_STEPPER, xStepperMemory );
+#endif
 
 /*! \fn uint32_t ulStepperGetAngle( uint8_t ucStepperIndex )
 	\brief Obtener ángulo pendiente de motor paso a paso.
@@ -98,6 +151,13 @@ uint32_t ulStepperGetAngle( uint8_t ucStepperIndex )
 	StepperData_t* xStepperDataID;
 	xStepperDataID = ( StepperData_t * ) pvTimerGetTimerID( xStepperTimer[ucStepperIndex] );
 
+#if ( appUSE_DUAL_CORE == 1 )
+	/* Con el M0 en funcionamiento los pasos pendientes los publica él */
+	if ( xDualCoreRunning() ) {
+		return ulDualCoreGetPendingSteps( xStepperDataID->cBarrierParty ) * 360/4096;
+	}
+#endif
+
 	/* Devolver pasos pendientes en forma de ángulo */
 	return xStepperDataID->ulPendingSteps * 360/4096;
 }
@@ -109,7 +169,7 @@ uint32_t ulStepperGetAngle( uint8_t ucStepperIndex )
 void vStepperSendMsg( char *pcMsg)
 {
 	/* Escribir mensaje en cola de transmisión */
-	xQueueSendToBack(
+	xPtrQueueSendToBack(
 		/* Handle de la cola a escribir */
 		xStepperSetPointQueue,
 		/* Puntero al dato a escribir */
@@ -119,6 +179,75 @@ void vStepperSendMsg( char *pcMsg)
 	);
 }
 
+/*! \fn void vStepperJog( uint8_t ucStepperIndex, int32_t lAngle )
+	\brief Mover el motor lAngle grados relativos a la posición
+	actual, actualizando la consigna pendiente si la hay.
+*/
+void vStepperJog( uint8_t ucStepperIndex, int32_t lAngle )
+{
+	StepperJog_t *pxJog = &pxStepperJog[ucStepperIndex];
+	char pcMsg[ stepperJOG_MSG_LENGTH ] = { 0 };
+	BaseType_t xPending, xDone;
+	int32_t lTotal;
+
+	do {
+		/* Si la consigna anterior sigue en la cola se acumula */
+		xPending = pxJog->xPending;
+		lTotal = xPending ? pxJog->lAngle + lAngle : lAngle;
+		/* La consigna acumulada tampoco supera el máximo de una
+		 * consigna del encoder */
+		if ( lTotal > encoderJOG_MAX_ANGLE ) {
+			lTotal = encoderJOG_MAX_ANGLE;
+		} else if ( lTotal < -encoderJOG_MAX_ANGLE ) {
+			lTotal = -encoderJOG_MAX_ANGLE;
+		}
+		snprintf( pcMsg, stepperJOG_MSG_LENGTH, ":S%uD%uA%03ld", ucStepperIndex,
+			( lTotal < 0 ) ? stepperDIR_NEGATIVE : stepperDIR_POSITIVE,
+			labs( lTotal ) );
+
+		/* Sólo la tarea de control modifica xPending (al leer la
+		 * consigna); si lo hizo mientras tanto se vuelve a armar */
+		taskENTER_CRITICAL();
+		{
+			xDone = ( pxJog->xPending == xPending );
+			if ( xDone ) {
+				memcpy( pxJog->pcMsg, pcMsg, stepperJOG_MSG_LENGTH );
+				pxJog->lAngle = lTotal;
+				pxJog->xPending = pdTRUE;
+			}
+		}
+		taskEXIT_CRITICAL();
+	} while ( !xDone );
+
+	if ( !xPending ) {
+		vStepperSendMsg( pxJog->pcMsg );
+	}
+}
+
+/*! \fn static char *prvStepperJogTake( char *pcSetPoint, char *pcBuffer )
+	\brief Si la consigna recibida es la consigna relativa pendiente
+	de un motor, copiarla y liberarla para que las próximas se
+	encolen de nuevo.
+	\param pcSetPoint Consigna leída de la cola.
+	\param pcBuffer Destino de la copia (stepperJOG_MSG_LENGTH).
+	\return Consigna a procesar.
+*/
+static char *prvStepperJogTake( char *pcSetPoint, char *pcBuffer )
+{
+	for ( uint8_t i=0; i<stepperAPP_NUM; i++ ) {
+		if ( pcSetPoint == pxStepperJog[i].pcMsg ) {
+			taskENTER_CRITICAL();
+			{
+				memcpy( pcBuffer, pxStepperJog[i].pcMsg, stepperJOG_MSG_LENGTH );
+				pxStepperJog[i].xPending = pdFALSE;
+			}
+			taskEXIT_CRITICAL();
+			return pcBuffer;
+		}
+	}
+	return pcSetPoint;
+}
+
 /*! \fn void vStepperRelativeSetPoint( TimerHandle_t xStepperTimer, int32_t lRelativeSetPoint )
     \brief Setear una nueva consigna en motor stepper relativa a la posición actual.
     \param xStepperTimer Handle del timer asociado al motor que se desea asignar la nueva consigna.
@@ -134,6 +263,22 @@ BaseType_t xStepperRelativeSetPoint( TimerHandle_t xStepperTimer, uint32_t ulRel
     /* Seteo de consigna como pasos pendientes y dirección */
     xStepperDataID->ulPendingSteps = ulRelativeSetPoint;
     xStepperDataID->xDir = xStepperDir;
+
+#if ( appUSE_DUAL_CORE == 1 )
+    if ( xDualCoreRunning() ) {
+    	/* Los pasos los genera el M0, con el período actual del timer */
+    	IpcCommand_t xCommand = {
+    		.ucType = ipcCMD_STEPPER_MOVE,
+			.ucChannel = xStepperDataID->cBarrierParty,
+			.ucDir = xStepperDir,
+			.ucPeriod = ( xTimerGetPeriod( xStepperTimer ) * dualTICK_RATE_HZ ) /
+				configTICK_RATE_HZ,
+			.ulValue = ulRelativeSetPoint
+    	};
+    	vDualCoreSendCommand( &xCommand );
+    	return pdPASS;
+    }
+#endif
     /* Inicialización de timer */
     return xTimerStart( xStepperTimer, portMAX_DELAY );
 }
@@ -148,22 +293,17 @@ static void prvStepperTimerCallback( TimerHandle_t xStepperTimer )
     xStepperDataID = ( StepperData_t * ) pvTimerGetTimerID( xStepperTimer );
 
     /* LED indicador visual ON */
-    gpioWrite( xStepperDataID->xLed, ON );
+    gpioFastWrite( &xStepperDataID->xLedFast, ON );
 
     /* Verificación de existencia de pasos pendientes */
     if ( xStepperDataID->ulPendingSteps == 0 ) {
     	/* LED indicador visual OFF */
-		gpioWrite( xStepperDataID->xLed, OFF );
+		gpioFastWrite( &xStepperDataID->xLedFast, OFF );
 
     	/* Detener timer si no existen pasos pendientes */
         xTimerStop( xStepperTimer, 0 );
-        /* Setear bit de evento asociado al motor */
-        xEventGroupSetBits(
-        	/* Handle del grupo de eventos */
-			xStepperEventGroup,
-			/* Bits a setear */
-			( 1 << xStepperDataID->cEventGroupBit )
-        );
+        /* Finalización de la parte asociada al motor */
+        vBarrierArrive( &xStepperBarrier, xStepperDataID->cBarrierParty );
         return;
     }
     /* Cálculo de nuevo estado del driver según dirección */
@@ -181,7 +321,7 @@ static void prvStepperTimerCallback( TimerHandle_t xStepperTimer )
         }
     }
     /* Actualización del driver */
-    vDriverUpdate( xStepperDataID->pxDriverInput,
+    vDriverUpdate( &xStepperDataID->xDriverMask,
     	xStepperDataID->cDriverState );
     /* Decremento de pasos pendientes a realizar */
     xStepperDataID->ulPendingSteps--;
@@ -189,6 +329,44 @@ static void prvStepperTimerCallback( TimerHandle_t xStepperTimer )
     vTimerSetTimerID( xStepperTimer, ( void * ) xStepperDataID );
 }
 
+/*! \fn void vStepperDoneFromISR( uint8_t ucStepperIndex, BaseType_t *pxHigherPriorityTaskWoken )
+	\brief Indicar desde una ISR que el motor completó su consigna
+	(evento del M0 en modo de doble núcleo).
+*/
+void vStepperDoneFromISR( uint8_t ucStepperIndex, BaseType_t *pxHigherPriorityTaskWoken )
+{
+	if ( ucStepperIndex >= stepperAPP_NUM ) {
+		return;
+	}
+	/* Notificación directa a la tarea de control, sin pasar por la
+	 * cola del timer service que usan los timers de los motores */
+	vBarrierArriveFromISR( &xStepperBarrier,
+		xStepperDataID[ucStepperIndex].cBarrierParty, pxHigherPriorityTaskWoken );
+}
+
+/*! \fn static void prvStepperResync( uint32_t ulLate )
+	\brief Dar por finalizados los motores demorados que ya no tienen
+	pasos pendientes. Con el M0, un evento de fin descartado por
+	buffer de eventos lleno (ulEventDropped) no vuelve a señalizarse.
+	\param ulLate Partes demoradas (bit i para el motor i).
+*/
+static void prvStepperResync( uint32_t ulLate )
+{
+#if ( appUSE_DUAL_CORE == 1 )
+	if ( xDualCoreRunning() == pdFALSE ) {
+		return;
+	}
+	for ( uint8_t i=0; i<stepperAPP_NUM; i++ ) {
+		if ( ( ulLate & ( 1 << xStepperDataID[i].cBarrierParty ) ) &&
+			( ulDualCoreGetPendingSteps( xStepperDataID[i].cBarrierParty ) == 0 ) ) {
+			vBarrierArrive( &xStepperBarrier, xStepperDataID[i].cBarrierParty );
+		}
+	}
+#else
+	( void ) ulLate;
+#endif
+}
+
 /*! \fn void vStepperControlTask( void *pvParameters )
     \brief Tarea encargada del control en el flujo de trabajo de los motores stepper, gestionando consignas y todo procesamiento relacionado con ellos.
 */
@@ -196,6 +374,10 @@ void vStepperControlTask( void *pvParameters )
 {
     /* Puntero a consignas recibidas */
     char *pcReceivedSetPoint;
+    /* Copia de la consigna relativa pendiente de un motor */
+    char pcJogSetPoint[stepperJOG_MSG_LENGTH];
+    /* Copia de la consigna recibida por UART */
+    char pcSetPoint[uartLINE_LENGTH];
 
     /* ID y velocidad del motor recibida */
     uint8_t cID, cVel;
@@ -204,11 +386,17 @@ void vStepperControlTask( void *pvParameters )
     /* Ángulo a realizar */
     uint32_t ulAngle;
     /* Variable para gestión de errores en mensaje */
-    uint8_t cErrorHandle = 0;
+    uint8_t cErrorHandle;
+    /* Algún motor inició su movimiento en esta consigna */
+    BaseType_t xStarted;
+    /* Duración esperada del movimiento más largo en ticks */
+    TickType_t xExpectedTicks;
+    /* Motores que no finalizaron en el tiempo esperado */
+    uint32_t ulLate;
 
     for ( ;; ) {
     	/* Lectura de cola de consignas */
-        xQueueReceive(
+        xPtrQueueReceive(
             /* Handle de la cola a leer */
             xStepperSetPointQueue,
             /* Elemento donde guardar información leída */
@@ -216,8 +404,21 @@ void vStepperControlTask( void *pvParameters )
             /* Máxima cantidad de tiempo a esperar por una lectura */
             portMAX_DELAY
         );
+        pcReceivedSetPoint = prvStepperJogTake( pcReceivedSetPoint, pcJogSetPoint );
+        pcReceivedSetPoint = pcUartTakeCmd( pcReceivedSetPoint, pcSetPoint );
+
+        /* Armado de la barrera antes de iniciar los movimientos */
+        vBarrierArm( &xStepperBarrier );
+        xExpectedTicks = 0;
+        cErrorHandle = 0;
+        xStarted = pdFALSE;
 
         for ( uint8_t i=0; i<stepperAPP_NUM; i++ ) {
+			/* Consigna de menos motores (consigna relativa de un
+			 * motor desde el encoder) */
+			if ( ( i > 0 ) && ( pcReceivedSetPoint[i*8+1] == '\0' ) ) {
+				break;
+			}
         	/* Lectura de ID del motor a setear */
 			cID = atoi( &pcReceivedSetPoint[i*8+2] );
 			/* Verificación de ID válida */
@@ -271,7 +472,12 @@ void vStepperControlTask( void *pvParameters )
 				}
 				/* Seteo de consigna */
 				ulAngle = stepperANGLE_TO_STEPS( ulAngle );
+				if ( ulAngle * xTimerGetPeriod( xStepperTimer[cID] ) > xExpectedTicks ) {
+					xExpectedTicks = ulAngle * xTimerGetPeriod( xStepperTimer[cID] );
+				}
+				vBarrierExpect( &xStepperBarrier, cID );
 				xStepperRelativeSetPoint( xStepperTimer[cID], ulAngle, xDir );
+				xStarted = pdTRUE;
 			} else {
 				/* Código error por ANG erróneo */
 				cErrorHandle = stepperERROR_NOTIF_ANG;
@@ -289,30 +495,49 @@ void vStepperControlTask( void *pvParameters )
 				de notificación en la tarea que recibe */
 				eSetBits
 			);
-			continue;
+			/* Los motores de los bloques anteriores al error ya
+			 * iniciaron: se espera su finalización igual que sin error */
+			if ( !xStarted ) {
+				continue;
+			}
         }
+		/* Mantener el tick durante el movimiento */
+		vPowerMotionBegin();
 		/* Enviar mensaje de inicio de consigna */
         vUartSendMsg( "SCT:BGN" );
 
         /* Esperar finalización de ejecución de consigna */
-		xEventGroupWaitBits(
-			/* Handle de evento a leer */
-			xStepperEventGroup,
-			/* Bits que se epera */
-			( 1 << 0 ) | ( 1 << 1 ),
-			/* Clear de los bits setados si se cumple condición */
-			pdTRUE,
-			/* Condición de AND (esperar todos los bits) */
-			pdTRUE,
-			/* Bloquearse indefinidamente */
-			portMAX_DELAY
-		);
+		ulLate = ulBarrierWait( &xStepperBarrier,
+			xExpectedTicks + pdMS_TO_TICKS( stepperDONE_MARGIN_MS ) );
+		if ( ulLate ) {
+			/* Aviso de los motores demorados y espera en intervalos
+			 * de stepperDONE_MARGIN_MS hasta que finalicen */
+			for ( uint8_t i=0; i<stepperAPP_NUM; i++ ) {
+				if ( ulLate & ( 1 << i ) ) {
+					vUartSendMsg( pcStepperLateMsg[i] );
+				}
+			}
+			while ( ulLate ) {
+				prvStepperResync( ulLate );
+				ulLate = ulBarrierWait( &xStepperBarrier,
+					pdMS_TO_TICKS( stepperDONE_MARGIN_MS ) );
+			}
+		}
 
+		vPowerMotionEnd();
 		/* Enviar mensaje de finalización de consigna */
 		vUartSendMsg( "SCT:END" );
     }
 }
 
+/*! \fn void vStepperReport( void )
+	\brief Imprimir el registro de finalización de cada motor.
+*/
+void vStepperReport( void )
+{
+	vBarrierReport( &xStepperBarrier, "STP" );
+}
+
 /*! \fn BaseType_t xStepperInit( void )
     \brief Inicialización de motores de la aplicación.
 */
@@ -320,13 +545,20 @@ BaseType_t xStepperInit( void )
 {
     /* Creación de tarea de control de flujo de trabajo de los motores stepper */
     BaseType_t xStatus;
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+    xStepperControlTaskHandle = xTaskCreateStatic( vStepperControlTask,
+    	( const char * ) "StepperControlTask", stackStepperControlTask, NULL,
+		priorityStepperControlTask, xStepperMemory.puxControlTaskStack,
+		&xStepperMemory.xControlTaskTCB );
+    xStatus = ( xStepperControlTaskHandle != NULL ) ? pdPASS : pdFAIL;
+#else
     xStatus = xTaskCreate(
         /* Puntero a la función que implementa la tarea */
         vStepperControlTask,
         /* Nombre de la tarea amigable para el usuario */
         ( const char * ) "StepperControlTask",
         /* Tamaño de stack de la tarea */
-        configMINIMAL_STACK_SIZE*2,
+        stackStepperControlTask,
         /* Parámetros de la tarea */
         NULL,
         /* Prioridad de la tarea */
@@ -334,35 +566,38 @@ BaseType_t xStepperInit( void )
         /* Handle de la tarea creada */
         &xStepperControlTaskHandle
     );
+#endif
 
     if ( xStatus == pdFAIL ) {
         return pdFAIL;
     }
     
     /* Creación de cola de consignas recibidas a ejecutar */
-	xStepperSetPointQueue = xQueueCreate(
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+	xStepperSetPointQueue = xPtrQueueCreateStatic( stepperMAX_SETPOINT_QUEUE_LENGTH,
+		xStepperMemory.pvSetPointQueueStorage, &xStepperMemory.xSetPointQueue );
+#else
+	xStepperSetPointQueue = xPtrQueueCreate(
 		/* Longitud máxima de la cola */
-		stepperMAX_SETPOINT_QUEUE_LENGTH,
-		/* Tamaño de elementos a guardar en cola */
-		sizeof( char * )
+		stepperMAX_SETPOINT_QUEUE_LENGTH
 	);
+#endif
 	/* Verificación de cola creada con éxito */
 	configASSERT( xStepperSetPointQueue != NULL );
 
 	/* Array de LED indicadores visuales */
 	gpioMap_t xLedArray[3] = { LED1, LED2, LED3 };
 
-	/* Creación de grupo de eventos para detectar final de consigna */
-	xStepperEventGroup = xEventGroupCreate();
+	/* Barrera para detectar final de consigna, una parte por motor */
+	vBarrierInit( &xStepperBarrier, stepperAPP_NUM, 0 );
 
-    char pcAuxTimerName[15];
     for (uint8_t i=0; i<stepperAPP_NUM; i++) {
         /* String identificadora para debug */
-    	strcpy( pcAuxTimerName, "StepperTimer" );
-        strcat( pcAuxTimerName, "0" + i );
+    	strcpy( pcStepperTimerName[i], "StepperTimer" );
+    	pcStepperTimerName[i][strlen( pcStepperTimerName[i] )] = '0' + i;
 
         /* Inicialización de driver del stepper */
-		vDriverInit( pxDriver[i], driverINPUT_NUM );
+		vDriverInit( pxDriver[i], &xStepperDataID[i].xDriverMask, driverINPUT_NUM );
 
         /* Vinculación con drivers */
 		for ( uint8_t j=0; j<driverINPUT_NUM; j++) {
@@ -371,14 +606,29 @@ BaseType_t xStepperInit( void )
 
 		/* LED indicador asociado */
 		xStepperDataID[i].xLed = xLedArray[i];
+		gpioFastInit( xLedArray[i], &xStepperDataID[i].xLedFast );
+
+		/* Parte de la barrera */
+		xStepperDataID[i].cBarrierParty = i;
+		strcpy( pcStepperLateMsg[i], "SCT:LATE" );
+		pcStepperLateMsg[i][strlen( pcStepperLateMsg[i] )] = '0' + i;
 
-		/* Bit de grupo de evento */
-		xStepperDataID[i].cEventGroupBit = i;
+#if ( appUSE_DUAL_CORE == 1 )
+		/* Pines para el motor de pasos del M0 */
+		vDualCoreSetStepperPins( i, xStepperDataID[i].pxDriverInput,
+			xStepperDataID[i].xLed );
+#endif
 
         /* Creación de los software timers */
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+        xStepperTimer[i] = xTimerCreateStatic( (const char *)pcStepperTimerName[i],
+        	pdMS_TO_TICKS( stepperTIMER_PERIOD ), pdTRUE,
+			( void * ) &xStepperDataID[i], prvStepperTimerCallback,
+			&xStepperMemory.xTimer[i] );
+#else
         xStepperTimer[i] = xTimerCreate(
             /* Nombre descriptivo del timer */
-            (const char *)pcAuxTimerName,
+            (const char *)pcStepperTimerName[i],
             /* Periodo del timer especificado en ticks */
             pdMS_TO_TICKS( stepperTIMER_PERIOD ),
             /* pdTRUE para timer tipo auto-reload y pdFALSE para tipo one-shoot */
@@ -388,10 +638,7 @@ BaseType_t xStepperInit( void )
             /* Función de callback del timer */
             prvStepperTimerCallback
         );
-
-        /* Si saco este printf para tres motores no funciona,
-         * para dos motores si (?????????????????) */
-        printf("---");
+#endif
 
         if ( xStepperTimer[i] == NULL ) {
             /* Error al crear timer */
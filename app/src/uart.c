@@ -7,23 +7,63 @@
 */
 
 #include "uart.h"
+#include <string.h>
+#include "spsc_ring.h"
+#include "ptr_queue.h"
+#include "FreeRTOSMemory.h"
+#include "latency.h"
 
-/*! \var QueueHandle_t xUartTxQueue
-	\brief Declaración global de cola de recepción de
-	caracteres por UART
+/*! \var SpscRing_t xUartRxRing
+	\brief Buffer circular de caracteres recibidos por UART
+	(ISR productora, tarea de recepción consumidora).
 */
-QueueHandle_t xUartRxQueue;
+SpscRing_t xUartRxRing;
 
-/*! \var QueueHandle_t xUartTxQueue
+/*! \var PtrQueueHandle_t xUartTxQueue
 	\brief Declaración global de cola de transmisión de
 	caracteres por UART
 */
-QueueHandle_t xUartTxQueue;
+PtrQueueHandle_t xUartTxQueue;
 
-/*! \var QueueHandle_t xMsgQueue
+/*! \var PtrQueueHandle_t xMsgQueue
     \brief Cola de mensajes recibidos.
 */
-extern QueueHandle_t xMsgQueue;
+extern PtrQueueHandle_t xMsgQueue;
+
+/*! \var uint8_t pucUartRxStorage[uartRING_RX_LENGTH]
+	\brief Memoria del buffer circular de recepción.
+*/
+static uint8_t pucUartRxStorage[uartRING_RX_LENGTH];
+
+/*! \var char pcUartLinePool[uartLINE_POOL_LENGTH][uartLINE_LENGTH]
+	\brief Buffers de líneas recibidas. Cada comando viaja por las
+	colas de punteros en su propio buffer hasta que el consumidor
+	lo libera.
+*/
+static char pcUartLinePool[uartLINE_POOL_LENGTH][uartLINE_LENGTH];
+
+/*! \var PtrQueueHandle_t xUartLineQueue
+	\brief Lista de buffers de línea libres.
+*/
+static PtrQueueHandle_t xUartLineQueue;
+
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+/*! \var xUartMemory
+	\brief Memoria estática de tareas y colas del módulo.
+*/
+static struct {
+	StaticTask_t xRxTaskTCB;
+	StackType_t puxRxTaskStack[ stackUartRxTask ];
+	StaticTask_t xTxTaskTCB;
+	StackType_t puxTxTaskStack[ stackUartTxTask ];
+	StaticPtrQueue_t xTxQueue;
+	void *pvTxQueueStorage[ uartQUEUE_TX_LENGTH ];
+	StaticPtrQueue_t xLineQueue;
+	void *pvLineQueueStorage[ uartLINE_POOL_LENGTH ];
+} xUartMemory memPLACE( memBANK_UART );
+
+memMODULE( xUartMemoryModule, "UART", memBANK_UART, memBUDGET_UART, xUartMemory );
+#endif
 
 /*! \fn void vUartSendMsg( char *pcMsg )
 	\brief Enviar mensaje a la cola de transmisión.
@@ -32,7 +72,7 @@ extern QueueHandle_t xMsgQueue;
 void vUartSendMsg( char *pcMsg )
 {
 	/* Escribir mensaje en cola de transmisión */
-	xQueueSendToBack(
+	xPtrQueueSendToBack(
 		/* Handle de la cola a escribir */
 		xUartTxQueue,
 		/* Puntero al dato a escribir */
@@ -42,6 +82,51 @@ void vUartSendMsg( char *pcMsg )
 	);
 }
 
+/*! \fn void vUartReleaseCmd( char *pcCmd )
+	\brief Devolver al pool una línea recibida por UART. Cualquier
+	otro puntero (literales, mensajes de otros módulos) se ignora.
+	\param pcCmd Puntero al mensaje.
+*/
+void vUartReleaseCmd( char *pcCmd )
+{
+	if ( ( pcCmd >= pcUartLinePool[0] ) &&
+		( pcCmd < pcUartLinePool[uartLINE_POOL_LENGTH] ) ) {
+		xPtrQueueSendToBack( xUartLineQueue, &pcCmd, 0 );
+	}
+}
+
+/*! \fn char *pcUartAllocLine( TickType_t xTicksToWait )
+	\brief Tomar una línea libre del pool para un mensaje generado
+	por otro módulo.
+	\param xTicksToWait Máximo tiempo a esperar una línea libre.
+	\return Línea tomada o NULL si no se liberó ninguna.
+*/
+char *pcUartAllocLine( TickType_t xTicksToWait )
+{
+	char *pcLine = NULL;
+
+	xPtrQueueReceive( xUartLineQueue, &pcLine, xTicksToWait );
+	return pcLine;
+}
+
+/*! \fn char *pcUartTakeCmd( char *pcCmd, char *pcBuffer )
+	\brief Si pcCmd es una línea del pool, copiarla en pcBuffer
+	y liberarla para que la recepción no quede esperando.
+	\param pcCmd Mensaje leído de la cola.
+	\param pcBuffer Destino de la copia (uartLINE_LENGTH).
+	\return Mensaje a procesar.
+*/
+char *pcUartTakeCmd( char *pcCmd, char *pcBuffer )
+{
+	if ( ( pcCmd >= pcUartLinePool[0] ) &&
+		( pcCmd < pcUartLinePool[uartLINE_POOL_LENGTH] ) ) {
+		memcpy( pcBuffer, pcCmd, uartLINE_LENGTH );
+		vUartReleaseCmd( pcCmd );
+		return pcBuffer;
+	}
+	return pcCmd;
+}
+
 /*! \fn void vSendCmd( char* pcBuffer, uint8_t cLength )
 	\brief Enviar comando a cola de mensajes recibidos.
 	\param pcBuffer Puntero al inicio del buffer.
@@ -54,7 +139,7 @@ void vSendCmd( char* pcBuffer, uint8_t cLength )
     pcMsg[cLength] = '\0';
 
     /* Escribir caracter en cola de recepción */
-	xQueueSendToBack(
+	xPtrQueueSendToBack(
 		/* Handle de la cola a escribir */
 		xMsgQueue,
 		/* Puntero al dato a escribir */
@@ -72,38 +157,39 @@ void vUartRxTask( void* pvParameters )
 {
     /* Índice de buffer */
     uint8_t cIndex = 0;
-    /* Variable que contendrá el caracter recibido */
-    char cRx;
-    /* Buffer de caracteres acumulados */
-    char pcBufferRx[50];
+    /* Caracteres recibidos en una misma lectura */
+    uint8_t pucRx[uartRING_RX_LENGTH];
+    uint32_t ulCount;
+    /* Buffer de la línea en curso, tomado del pool */
+    char *pcBufferRx;
 
-    BaseType_t xStatus;
+    xPtrQueueReceive( xUartLineQueue, &pcBufferRx, portMAX_DELAY );
 
     for ( ;; ) {
-        /* Lectura de cola de recepción */
-        xQueueReceive(
-            /* Handle de la cola a leer */
-            xUartRxQueue,
-            /* Puntero a la memoria donde guardar lectura */
-            &cRx,
-            /* Máximo tiempo que la tarea puede estar bloqueada
-            esperando que haya información a leer */
-            portMAX_DELAY // Tiempo de espera indefinido
-        );
-        
-		if ( cRx == '\n' ) {
-			// Rutina de comunicación de comando
-			vSendCmd( pcBufferRx, cIndex );
-			cIndex = 0;
-		} else {
-			// Guardar dato en buffer
-			pcBufferRx[cIndex] = cRx;
-			cIndex++;
-			if ( cIndex >= uartBUFFER_RX_LENGTH ) {
-				// TO DO: Warning buffer lleno (sobreescritura)
+        /* Lectura de todos los caracteres disponibles en el buffer
+        circular, bloqueando mientras esté vacío */
+        ulCount = ulSpscRingReceive( &xUartRxRing, pucRx, sizeof( pucRx ),
+        	portMAX_DELAY ); // Tiempo de espera indefinido
+        latencyTASK_RESUME( latencySRC_UART_RX );
+
+        for ( uint32_t i=0; i<ulCount; i++ ) {
+			if ( pucRx[i] == '\n' ) {
+				// Rutina de comunicación de comando
+				vSendCmd( pcBufferRx, cIndex );
 				cIndex = 0;
+				// Próximo buffer libre: si todos están en uso se
+				// espera, y el buffer circular retiene lo recibido
+				xPtrQueueReceive( xUartLineQueue, &pcBufferRx, portMAX_DELAY );
+			} else {
+				// Guardar dato en buffer
+				pcBufferRx[cIndex] = pucRx[i];
+				cIndex++;
+				if ( cIndex >= uartBUFFER_RX_LENGTH ) {
+					// TO DO: Warning buffer lleno (sobreescritura)
+					cIndex = 0;
+				}
 			}
-		}
+        }
     }
 }
 
@@ -113,23 +199,31 @@ void vUartRxTask( void* pvParameters )
 */
 void vUartTxTask( void* pvParameters )
 {
-    /* Variable que contendrá el string a enviar */
-    char *pcMsgToSend;
+    /* Strings a enviar leídos en una misma sección crítica */
+    char *pcMsgToSend[uartTX_BATCH_LENGTH];
+    UBaseType_t uxCount;
 
     for ( ;; ) {
-        /* Lectura de cola de transmisión */
-        xQueueReceive(
+        /* Lectura de todos los mensajes pendientes en la cola de
+        transmisión (hasta uartTX_BATCH_LENGTH) */
+        uxCount = uxPtrQueueReceiveBulk(
             /* Handle de la cola a leer */
             xUartTxQueue,
-            /* Puntero a la memoria donde guardar lectura */
-            &pcMsgToSend,
+            /* Arreglo donde guardar los punteros leídos */
+            ( void ** ) pcMsgToSend,
+            /* Máxima cantidad de mensajes a leer */
+            uartTX_BATCH_LENGTH,
             /* Máximo tiempo que la tarea puede estar bloqueada
             esperando que haya información a leer */
             portMAX_DELAY // Tiempo de espera indefinido
         );
-        
-        /* Envío del mensaje */
-        printf( "%s\n", pcMsgToSend );
+
+        /* Envío de los mensajes */
+        for ( UBaseType_t i=0; i<uxCount; i++ ) {
+        	printf( "%s\n", pcMsgToSend[i] );
+        	/* Las líneas recibidas con error terminan aquí */
+        	vUartReleaseCmd( pcMsgToSend[i] );
+        }
     }
 }
 
@@ -138,31 +232,51 @@ void vUartTxTask( void* pvParameters )
 */
 void vUartRxISR( void* pvParameters )
 {
+    latencyISR_ENTRY( latencySRC_UART_RX );
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    /* Lectura de caracter recibido */
-    char cRx = uartRxRead( UART_USB );
-    /* Escribir caracter en cola de recepción */
-    xQueueSendToBackFromISR(
-    	/* Handle de la cola a escribir */
-        xUartRxQueue,
-		/* Puntero a dato a escribir */
-        &cRx,
-        &xHigherPriorityTaskWoken
-    );
-    /* Si durante la ejecución de la API xQueueSendToBackFromISR
+    /* Caracteres leídos de la FIFO de recepción */
+    uint8_t pucRx[16];
+    uint32_t ulCount = 0;
+    /* Lectura de todos los caracteres presentes en la FIFO */
+    do {
+    	pucRx[ulCount++] = uartRxRead( UART_USB );
+    } while ( ( ulCount < sizeof( pucRx ) ) && uartRxReady( UART_USB ) );
+    /* Escribir caracteres en el buffer circular con una única
+    notificación a la tarea de recepción */
+    xSpscRingPutFromISR( &xUartRxRing, pucRx, ulCount,
+    	&xHigherPriorityTaskWoken );
+    /* Si durante la ejecución de la API xSpscRingPutFromISR
     una tarea abandona su estado bloqueado, y su prioridad es mayor
     que el de la tarea en estado Running, entonces 
     xHigherPriorityTaskWoken se setea a pdTRUE. Si ese es el caso,
     portYIELD_FROM_ISR solicita el cambio de contesto.
     */
+    latencyISR_YIELD( latencySRC_UART_RX );
     portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
 }
 
+/*! \fn static void prvUartLinePoolInit( void )
+	\brief Cargar todos los buffers de línea en la lista de libres.
+*/
+static void prvUartLinePoolInit( void )
+{
+	char *pcLine;
+
+	for ( uint8_t i=0; i<uartLINE_POOL_LENGTH; i++ ) {
+		pcLine = pcUartLinePool[i];
+		xPtrQueueSendToBack( xUartLineQueue, &pcLine, 0 );
+	}
+}
+
 /*! \fn BaseType_t uartAppInit(void)
 	\brief Inicialización de módulo UART con sus respectivas colas.
 */
 BaseType_t xUartInit( void )
 {
+    /* Inicialización del buffer circular de recepción antes de
+    habilitar la interrupción */
+    vSpscRingInit( &xUartRxRing, pucUartRxStorage, uartRING_RX_LENGTH );
+
     /* Inicialización de UART_USB junto con las interrupciones de Tx y Rx */
     uartConfig(UART_USB, 115200);     
     /* Seteo de callback al evento de recepcion y habilitación de interrupcion */
@@ -170,41 +284,52 @@ BaseType_t xUartInit( void )
     /* Habilitación de todas las interrupciones de UART_USB */
     uartInterrupt(UART_USB, true);
 
-    /* Creación de cola de recepción */
-    xUartRxQueue = xQueueCreate(
-		/* Longitud de la cola */
-		uartQUEUE_RX_LENGTH,
-		/* Tamaño en bytes del tipo de información a guardar en la cola */
-        sizeof( char )
-    );
-    /* Verificación de cola creada con éxito */
-	configASSERT( xUartRxQueue != NULL );
-    
+#if ( appUSE_STATIC_ALLOCATION == 1 )
+    /* Creación de cola de transmisión en memoria estática */
+    xUartTxQueue = xPtrQueueCreateStatic( uartQUEUE_TX_LENGTH,
+    	xUartMemory.pvTxQueueStorage, &xUartMemory.xTxQueue );
+    xUartLineQueue = xPtrQueueCreateStatic( uartLINE_POOL_LENGTH,
+    	xUartMemory.pvLineQueueStorage, &xUartMemory.xLineQueue );
+    prvUartLinePoolInit();
+
+    /* Creación de tareas gatekeeper en memoria estática */
+    xTaskCreateStatic( vUartRxTask, (const char *)"UartRxTask",
+    	stackUartRxTask, NULL, priorityUartRxTask,
+		xUartMemory.puxRxTaskStack, &xUartMemory.xRxTaskTCB );
+    xTaskCreateStatic( vUartTxTask, (const char *)"UartTxTask",
+    	stackUartTxTask, NULL, priorityUartTxTask,
+		xUartMemory.puxTxTaskStack, &xUartMemory.xTxTaskTCB );
+#else
     /* Creación de cola de mensajes a enviar */
-    xUartTxQueue = xQueueCreate( uartQUEUE_TX_LENGTH, sizeof( char * ) );
+    xUartTxQueue = xPtrQueueCreate( uartQUEUE_TX_LENGTH );
     /* Verificación de cola creada con éxito */
 	configASSERT( xUartTxQueue != NULL );
+    /* Creación de lista de buffers de línea libres */
+    xUartLineQueue = xPtrQueueCreate( uartLINE_POOL_LENGTH );
+	configASSERT( xUartLineQueue != NULL );
 
-    /* Verificación de colas creadas con éxito */
-    if ( (xUartRxQueue != NULL) && ( xUartTxQueue != NULL ) ) {
+    /* Verificación de cola creada con éxito */
+    if ( ( xUartTxQueue != NULL ) && ( xUartLineQueue != NULL ) ) {
+    	prvUartLinePoolInit();
         /* Creación de tarea gatekeeper para recepción */
     	xTaskCreate(
             vUartRxTask,                 // Funcion de la tarea a ejecutar
             (const char *)"UartRxTask", // Nombre de la tarea como String amigable para el usuario
-            configMINIMAL_STACK_SIZE*2, // Cantidad de stack de la tarea
+            stackUartRxTask,            // Cantidad de stack de la tarea
             NULL,                       // Parametros de tarea
 			priorityUartRxTask,         // Prioridad de la tarea
             NULL                        // Puntero a la tarea creada en el sistema
         );
     	/* Creación de tarea gatekeeper para transmisión */
         xTaskCreate( vUartTxTask, (const char *)"UartTxTask",
-            configMINIMAL_STACK_SIZE*2, NULL,
+            stackUartTxTask, NULL,
 			priorityUartTxTask, NULL );
         
     } else {
-        /* Error al crear colas de UART */
+        /* Error al crear cola de UART */
         return pdFAIL;
     }
+#endif
     /* Inicialización de UART con éxito */
     return pdPASS;
 }
@@ -0,0 +1,22 @@
+/*! \file sapi_datatypes.h
+    \brief Tipos de sAPI para compilar sapi_circularBuffer.c en el
+    host, sin los headers de la placa.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+#ifndef _SAPI_DATATYPES_H_
+#define _SAPI_DATATYPES_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FALSE	0
+#define TRUE	( !FALSE )
+
+typedef uint8_t bool_t;
+
+typedef void ( *callBackFuncPtr_t )( void * );
+
+#endif /* _SAPI_DATATYPES_H_ */
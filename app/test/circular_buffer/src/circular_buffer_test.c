@@ -0,0 +1,431 @@
+/*! \file circular_buffer_test.c
+    \brief Pruebas y benchmark del buffer circular de sAPI
+    (sapi_circularBuffer.c).
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Se verifican el rechazo de un buffer sin elementos, el orden de
+    los datos con los índices libres pasando por 0xFFFFFFFF, elementos
+    de más de un byte sin escribir fuera de la memoria, el acceso
+    Peek/Commit partido en el final de la memoria y los callbacks de
+    buffer vacío y lleno. El benchmark mueve los mismos datos con la
+    implementación anterior (copia byte a byte e índices en bytes con
+    módulo) y con la actual, elemento a elemento y por arreglos, e
+    imprime ns por elemento (CB:BENCH).
+*/
+
+/* Utilidades includes */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+/* EDU-CIAA firmware_v3 includes */
+#include "sapi_circularBuffer.h"
+
+/* Pruebas includes */
+#include "minut.h"
+
+/*! \def testGUARD
+	\brief Bytes de guarda después de la memoria del buffer.
+*/
+#define testGUARD			16
+
+/*! \def testGUARD_BYTE
+	\brief Valor de los bytes de guarda.
+*/
+#define testGUARD_BYTE		0xA5
+
+/*! \def benchELEMENTS
+	\brief Elementos movidos por cada implementación en el benchmark.
+*/
+#define benchELEMENTS		( 1UL << 22 )
+
+/*! \def benchCAPACITY
+	\brief Elementos del buffer del benchmark.
+*/
+#define benchCAPACITY		256
+
+/*! \def benchBLOCK
+	\brief Elementos escritos y leídos por vez en el benchmark.
+*/
+#define benchBLOCK			64
+
+/*! \var pucMemory
+	\brief Memoria de los buffers de prueba, seguida de la guarda.
+*/
+static uint8_t pucMemory[ 16 * 12 + testGUARD ];
+
+/*! \var xCallbacks
+	\brief Llamadas a los callbacks y buffer recibido.
+*/
+static struct {
+	uint32_t ulEmpty;
+	uint32_t ulFull;
+	void *pvBuffer;
+} xCallbacks;
+
+/*! \var typedef struct xLegacyBuffer LegacyBuffer_t
+	\brief Buffer circular anterior: índices en bytes con módulo y un
+	elemento sin usar para distinguir lleno de vacío.
+*/
+typedef struct xLegacyBuffer {
+	uint8_t *memoryAddress;
+	uint32_t amountOfElements;
+	uint32_t elementSize;
+	uint32_t readIndex;
+	uint32_t writeIndex;
+	circularBufferStatus_t status;
+} LegacyBuffer_t;
+
+static void prvLegacyInit( LegacyBuffer_t *buffer, uint8_t *bufferMemory,
+	uint32_t amountOfElements, uint32_t elementSize )
+{
+	buffer->memoryAddress = bufferMemory;
+	buffer->amountOfElements = amountOfElements + 1;
+	buffer->elementSize = elementSize;
+	buffer->readIndex = 0;
+	buffer->writeIndex = 0;
+	buffer->status = CIRCULAR_BUFFER_EMPTY;
+}
+
+/* Lazo byte a byte de circularBufferRead() anterior, sin callbacks */
+static circularBufferStatus_t prvLegacyRead( LegacyBuffer_t *buffer, uint8_t *dataByte )
+{
+	uint8_t i = 0;
+
+	if ( ( buffer->readIndex ) == ( buffer->writeIndex ) ) {
+		buffer->status = CIRCULAR_BUFFER_EMPTY;
+	} else {
+		buffer->status = CIRCULAR_BUFFER_NORMAL;
+		for ( i=0; i<( buffer->elementSize ); i++ ) {
+			dataByte[i] = ( buffer->memoryAddress )[ buffer->readIndex + i ];
+		}
+		buffer->readIndex = ( buffer->readIndex + buffer->elementSize ) %
+			( buffer->amountOfElements * buffer->elementSize );
+	}
+	return buffer->status;
+}
+
+/* Lazo byte a byte de circularBufferWrite() anterior, sin callbacks */
+static circularBufferStatus_t prvLegacyWrite( LegacyBuffer_t *buffer, uint8_t *dataByte )
+{
+	uint8_t i = 0;
+
+	if ( ( ( buffer->writeIndex + buffer->elementSize ) %
+		( buffer->amountOfElements * buffer->elementSize ) ) == ( buffer->readIndex ) ) {
+		buffer->status = CIRCULAR_BUFFER_FULL;
+	} else {
+		buffer->status = CIRCULAR_BUFFER_NORMAL;
+		for ( i=0; i<( buffer->elementSize ); i++ ) {
+			( buffer->memoryAddress )[ buffer->writeIndex + i ] = dataByte[i];
+		}
+		buffer->writeIndex = ( buffer->writeIndex + buffer->elementSize ) %
+			( buffer->amountOfElements * buffer->elementSize );
+	}
+	return buffer->status;
+}
+
+/*! \fn static uint64_t prvNow( void )
+	\brief Instante en ns.
+*/
+static uint64_t prvNow( void )
+{
+	struct timespec xNow;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	return ( uint64_t ) xNow.tv_sec * 1000000000ULL + xNow.tv_nsec;
+}
+
+static void prvEmpty( void *pvBuffer )
+{
+	xCallbacks.ulEmpty++;
+	xCallbacks.pvBuffer = pvBuffer;
+}
+
+static void prvFull( void *pvBuffer )
+{
+	xCallbacks.ulFull++;
+	xCallbacks.pvBuffer = pvBuffer;
+}
+
+/*! \fn static bool prvGuardIntact( uint32_t ulUsed )
+	\brief Ningún byte escrito después de los ulUsed bytes del buffer.
+*/
+static bool prvGuardIntact( uint32_t ulUsed )
+{
+	for ( uint32_t i=ulUsed; i<ulUsed + testGUARD; i++ ) {
+		if ( pucMemory[i] != testGUARD_BYTE ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*! \fn static void prvGuardSet( void )
+	\brief Memoria de prueba con el valor de guarda.
+*/
+static void prvGuardSet( void )
+{
+	memset( pucMemory, testGUARD_BYTE, sizeof( pucMemory ) );
+}
+
+int main( void )
+{
+	MINUT( true );
+	return 0;
+}
+
+/* Sin elementos, sin memoria o con elementos de 0 bytes se rechaza y
+ * el buffer queda sin lugar; el resto se redondea a potencia de 2 */
+TEST( init_rejects_empty )
+{
+	circularBuffer_t xBuffer;
+	uint8_t ucByte = 1;
+	bool_t xZero, xNull, xSize, xRounded;
+	bool xNoRoom;
+
+	prvGuardSet();
+	xZero = circularBuffer_Init( &xBuffer, pucMemory, 0, 1 );
+	xNoRoom = ( circularBufferElements( &xBuffer ) == 0 ) &&
+		( circularBufferFreeElements( &xBuffer ) == 0 ) &&
+		( circularBufferWrite( &xBuffer, &ucByte ) == CIRCULAR_BUFFER_FULL ) &&
+		( circularBufferWriteArray( &xBuffer, pucMemory, 4 ) == 0 ) &&
+		( circularBufferRead( &xBuffer, &ucByte ) == CIRCULAR_BUFFER_EMPTY ) &&
+		prvGuardIntact( 0 );
+	xNull = circularBuffer_Init( &xBuffer, NULL, 8, 1 );
+	xSize = circularBuffer_Init( &xBuffer, pucMemory, 8, 0 );
+	xRounded = circularBuffer_Init( &xBuffer, pucMemory, 10, 1 );
+
+	ASSERT_EQ( true, !xZero && !xNull && !xSize && xNoRoom && xRounded &&
+		( xBuffer.amountOfElements == 8 ) && ( xBuffer.mask == 7 ) &&
+		( circularBufferFreeElements( &xBuffer ) == 8 ) );
+}
+
+/* Orden de los datos con escrituras y lecturas desfasadas y los
+ * índices libres pasando por 0xFFFFFFFF */
+TEST( wraparound )
+{
+	circularBuffer_t xBuffer;
+	uint8_t pucBlock[5];
+	uint8_t ucWrite = 0, ucRead = 0;
+	bool xOk = true;
+
+	prvGuardSet();
+	circularBuffer_Init( &xBuffer, pucMemory, 8, 1 );
+	xBuffer.readIndex = xBuffer.writeIndex = 0xFFFFFFF0;
+
+	for ( uint32_t ulRound=0; ulRound<100; ulRound++ ) {
+		for ( uint32_t i=0; i<5; i++ ) {
+			pucBlock[i] = ucWrite++;
+		}
+		xOk = xOk && ( circularBufferWriteArray( &xBuffer, pucBlock, 5 ) == 5 ) &&
+			( circularBufferElements( &xBuffer ) == 5 ) &&
+			( circularBufferFreeElements( &xBuffer ) == 3 );
+		/* Una lectura de a un elemento y el resto por arreglo */
+		xOk = xOk && ( circularBufferRead( &xBuffer, &pucBlock[0] ) == CIRCULAR_BUFFER_NORMAL ) &&
+			( circularBufferReadArray( &xBuffer, &pucBlock[1], 4 ) == 4 );
+		for ( uint32_t i=0; i<5; i++ ) {
+			xOk = xOk && ( pucBlock[i] == ucRead++ );
+		}
+	}
+	/* Lleno: se escriben los 8 elementos y ninguno más */
+	xOk = xOk && ( circularBufferWriteArray( &xBuffer, pucMemory + 64, 9 ) == 8 ) &&
+		( circularBufferFreeElements( &xBuffer ) == 0 );
+
+	ASSERT_EQ( true, xOk && ( xBuffer.writeIndex < 0xFFFFFFF0 ) && prvGuardIntact( 8 ) );
+}
+
+/* Elementos de 12 bytes: cada elemento entero y en orden, sin escribir
+ * fuera de la memoria */
+TEST( element_size )
+{
+	circularBuffer_t xBuffer;
+	uint32_t pulWrite[7][3], pulRead[5][3];
+	uint32_t ulWrite = 0, ulRead = 0, ulStored = 0, ulMoved;
+	bool xOk = true;
+
+	prvGuardSet();
+	circularBuffer_Init( &xBuffer, pucMemory, 16, sizeof( pulWrite[0] ) );
+
+	for ( uint32_t ulRound=0; ulRound<200; ulRound++ ) {
+		for ( uint32_t i=0; i<7; i++ ) {
+			pulWrite[i][0] = ulWrite + i;
+			pulWrite[i][1] = ~( ulWrite + i );
+			pulWrite[i][2] = ( ulWrite + i ) * 3;
+		}
+		ulMoved = circularBufferWriteArray( &xBuffer, pulWrite, 7 );
+		xOk = xOk && ( ulMoved == ( ( 16 - ulStored < 7 ) ? 16 - ulStored : 7 ) );
+		ulWrite += ulMoved;
+		ulStored += ulMoved;
+
+		ulMoved = circularBufferReadArray( &xBuffer, pulRead, 5 );
+		for ( uint32_t i=0; i<ulMoved; i++ ) {
+			xOk = xOk && ( pulRead[i][0] == ulRead ) && ( pulRead[i][1] == ~ulRead ) &&
+				( pulRead[i][2] == ulRead * 3 );
+			ulRead++;
+		}
+		ulStored -= ulMoved;
+	}
+
+	/* Se escriben 2 más de los que se leen: termina lleno menos una lectura */
+	ASSERT_EQ( true, xOk && ( ulStored == circularBufferElements( &xBuffer ) ) &&
+		( ulStored == 16 - 5 ) && ( ulRead == ulWrite - ulStored ) &&
+		prvGuardIntact( 16 * 12 ) );
+}
+
+/* Peek/Commit en el final de la memoria: sólo la parte contigua, y
+ * el resto desde el comienzo de la memoria */
+TEST( peek_commit_split )
+{
+	circularBuffer_t xBuffer;
+	uint8_t *pucData;
+	uint8_t pucSix[6] = { 0 };
+	uint32_t pulCount[6];
+
+	prvGuardSet();
+	circularBuffer_Init( &xBuffer, pucMemory, 8, 4 );
+	circularBufferWriteArray( &xBuffer, pucMemory + 64, 6 );
+	circularBufferReadArray( &xBuffer, pucMemory + 64, 6 );
+
+	/* Escritura: 2 elementos hasta el final, luego 6 desde el comienzo */
+	pulCount[0] = circularBufferWritePeek( &xBuffer, &pucData );
+	memset( pucData, 0x11, pulCount[0] * 4 );
+	circularBufferWriteCommit( &xBuffer, pulCount[0] );
+	pulCount[1] = ( pucData == pucMemory + 6 * 4 ) ?
+		circularBufferWritePeek( &xBuffer, &pucData ) : 0;
+	memset( pucData, 0x22, 4 );
+	circularBufferWriteCommit( &xBuffer, 1 );
+
+	/* Lectura: 2 hasta el final, uno confirmado por vez */
+	pulCount[2] = circularBufferReadPeek( &xBuffer, &pucData );
+	pucSix[0] = ( pucData == pucMemory + 6 * 4 ) && ( pucData[0] == 0x11 );
+	circularBufferReadCommit( &xBuffer, 1 );
+	pulCount[3] = circularBufferReadPeek( &xBuffer, &pucData );
+	pucSix[1] = ( pucData == pucMemory + 7 * 4 ) && ( pucData[3] == 0x11 );
+	circularBufferReadCommit( &xBuffer, 1 );
+	pulCount[4] = circularBufferReadPeek( &xBuffer, &pucData );
+	pucSix[2] = ( pucData == pucMemory ) && ( pucData[0] == 0x22 );
+	circularBufferReadCommit( &xBuffer, 1 );
+	pulCount[5] = circularBufferReadPeek( &xBuffer, &pucData );
+
+	ASSERT_EQ( true, ( pulCount[0] == 2 ) && ( pulCount[1] == 6 ) &&
+		( pulCount[2] == 2 ) && ( pulCount[3] == 1 ) && ( pulCount[4] == 1 ) &&
+		( pulCount[5] == 0 ) && pucSix[0] && pucSix[1] && pucSix[2] &&
+		prvGuardIntact( 8 * 4 ) );
+}
+
+/* Callbacks con el buffer como parámetro: sólo cuando una lectura no
+ * encuentra todos los elementos o una escritura no encuentra lugar */
+TEST( callbacks )
+{
+	circularBuffer_t xBuffer;
+	uint8_t pucData[8] = { 0 };
+	uint8_t ucByte = 0;
+	uint32_t ulEmptyAfterRead, ulFullAfterWrite, ulSuccess;
+
+	prvGuardSet();
+	memset( &xCallbacks, 0, sizeof( xCallbacks ) );
+	circularBuffer_Init( &xBuffer, pucMemory, 4, 1 );
+	circularBufferEmptyBufferCallbackSet( &xBuffer, prvEmpty );
+	circularBufferFullBufferCallbackSet( &xBuffer, prvFull );
+
+	circularBufferRead( &xBuffer, &ucByte );
+	ulEmptyAfterRead = xCallbacks.ulEmpty;
+	circularBufferWriteArray( &xBuffer, pucData, 3 );
+	circularBufferWrite( &xBuffer, &ucByte );
+	circularBufferReadArray( &xBuffer, pucData, 2 );
+	circularBufferWriteArray( &xBuffer, pucData, 2 );
+	ulSuccess = xCallbacks.ulEmpty + xCallbacks.ulFull;
+	/* Lleno: la escritura parcial también llama al callback */
+	circularBufferWriteArray( &xBuffer, pucData, 2 );
+	ulFullAfterWrite = xCallbacks.ulFull;
+	circularBufferReadArray( &xBuffer, pucData, 8 );
+
+	ASSERT_EQ( true, ( ulEmptyAfterRead == 1 ) && ( ulSuccess == 1 ) &&
+		( ulFullAfterWrite == 1 ) && ( xCallbacks.ulEmpty == 2 ) &&
+		( xCallbacks.ulFull == 1 ) && ( xCallbacks.pvBuffer == &xBuffer ) );
+}
+
+/*! \fn static void prvBench( uint32_t ulElementSize )
+	\brief Mover benchELEMENTS elementos de ulElementSize bytes en
+	bloques de benchBLOCK con cada implementación. Los datos leídos se
+	suman para verificar que todas leen lo mismo.
+	\return true si las tres sumas coinciden.
+*/
+static bool prvBench( uint32_t ulElementSize )
+{
+	static uint8_t pucLegacyMemory[ ( benchCAPACITY + 1 ) * 16 ];
+	static uint8_t pucRingMemory[ benchCAPACITY * 16 ];
+	static uint8_t pucBlock[ benchBLOCK * 16 ];
+	uint64_t pullNs[3], ullStart;
+	uint32_t pulSum[3] = { 0 };
+	LegacyBuffer_t xLegacy;
+	circularBuffer_t xRing;
+
+	for ( uint32_t i=0; i<sizeof( pucBlock ); i++ ) {
+		pucBlock[i] = i * 7;
+	}
+
+	prvLegacyInit( &xLegacy, pucLegacyMemory, benchCAPACITY, ulElementSize );
+	ullStart = prvNow();
+	for ( uint32_t n=0; n<benchELEMENTS; n+=benchBLOCK ) {
+		for ( uint32_t i=0; i<benchBLOCK; i++ ) {
+			prvLegacyWrite( &xLegacy, &pucBlock[ i * ulElementSize ] );
+		}
+		for ( uint32_t i=0; i<benchBLOCK; i++ ) {
+			prvLegacyRead( &xLegacy, &pucBlock[ i * ulElementSize ] );
+		}
+		pulSum[0] += pucBlock[ n % sizeof( pucBlock ) ];
+	}
+	pullNs[0] = prvNow() - ullStart;
+
+	circularBuffer_Init( &xRing, pucRingMemory, benchCAPACITY, ulElementSize );
+	ullStart = prvNow();
+	for ( uint32_t n=0; n<benchELEMENTS; n+=benchBLOCK ) {
+		for ( uint32_t i=0; i<benchBLOCK; i++ ) {
+			circularBufferWrite( &xRing, &pucBlock[ i * ulElementSize ] );
+		}
+		for ( uint32_t i=0; i<benchBLOCK; i++ ) {
+			circularBufferRead( &xRing, &pucBlock[ i * ulElementSize ] );
+		}
+		pulSum[1] += pucBlock[ n % sizeof( pucBlock ) ];
+	}
+	pullNs[1] = prvNow() - ullStart;
+
+	circularBuffer_Init( &xRing, pucRingMemory, benchCAPACITY, ulElementSize );
+	ullStart = prvNow();
+	for ( uint32_t n=0; n<benchELEMENTS; n+=benchBLOCK ) {
+		circularBufferWriteArray( &xRing, pucBlock, benchBLOCK );
+		circularBufferReadArray( &xRing, pucBlock, benchBLOCK );
+		pulSum[2] += pucBlock[ n % sizeof( pucBlock ) ];
+	}
+	pullNs[2] = prvNow() - ullStart;
+
+	printf( "CB:BENCH size %2u legacy %.2f element %.2f array %.2f ns/element\n",
+		( unsigned ) ulElementSize,
+		( double ) pullNs[0] / benchELEMENTS, ( double ) pullNs[1] / benchELEMENTS,
+		( double ) pullNs[2] / benchELEMENTS );
+
+	return ( pulSum[0] == pulSum[1] ) && ( pulSum[1] == pulSum[2] );
+}
+
+/* Benchmark frente al lazo byte a byte anterior */
+TEST( bench_legacy )
+{
+	bool xOk = prvBench( 1 );
+
+	xOk = prvBench( 4 ) && xOk;
+	xOk = prvBench( 16 ) && xOk;
+	ASSERT_EQ( true, xOk );
+}
+
+MINUT_BEG
+	RUN( init_rejects_empty() );
+	RUN( wraparound() );
+	RUN( element_size() );
+	RUN( peek_commit_split() );
+	RUN( callbacks() );
+	RUN( bench_legacy() );
+MINUT_END
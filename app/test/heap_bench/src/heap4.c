@@ -0,0 +1,15 @@
+/*! \file heap4.c
+    \brief heap_4 de FreeRTOS con nombres propios, para reproducir la
+    misma traza que heap_tlsf en el mismo programa.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+#define pvPortMalloc						pvHeap4Malloc
+#define vPortFree							vHeap4Free
+#define xPortGetFreeHeapSize				xHeap4GetFreeHeapSize
+#define xPortGetMinimumEverFreeHeapSize		xHeap4GetMinimumEverFreeHeapSize
+#define vPortInitialiseBlocks				vHeap4InitialiseBlocks
+
+#include "heap_4.c"
@@ -0,0 +1,311 @@
+/*! \file heap_bench.c
+    \brief Comparación de heap_tlsf frente a heap_4 con una traza de
+    asignaciones reproducida en el host.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    La traza es pseudoaleatoria y determinística, con la forma de los
+    buffers dinámicos de la aplicación: muchos mensajes cortos de vida
+    breve (líneas de comando y del display) y algunos buffers grandes
+    de vida larga que fragmentan el heap. Cada bloque se llena con un
+    patrón propio que se verifica al liberarlo, para detectar bloques
+    solapados. Se imprime el tiempo medio y máximo de pvPortMalloc y
+    vPortFree en ns, las asignaciones fallidas y la fragmentación al
+    final de la traza (porcentaje de la memoria libre que no está en
+    el mayor bloque libre).
+*/
+
+/* Utilidades includes */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Pruebas includes */
+#include "minut.h"
+
+/*! \def benchOPERATIONS
+	\brief Cantidad de operaciones de la traza.
+*/
+#define benchOPERATIONS		20000
+
+/*! \def benchSLOTS
+	\brief Máxima cantidad de bloques asignados a la vez.
+*/
+#define benchSLOTS			96
+
+/* Funciones de heap_4 y heap_tlsf renombradas (heap4.c y tlsf.c) */
+void *pvHeap4Malloc( size_t xWantedSize );
+void vHeap4Free( void *pv );
+size_t xHeap4GetFreeHeapSize( void );
+size_t xHeap4GetMinimumEverFreeHeapSize( void );
+void *pvTlsfMalloc( size_t xWantedSize );
+void vTlsfFree( void *pv );
+size_t xTlsfGetFreeHeapSize( void );
+size_t xTlsfGetMinimumEverFreeHeapSize( void );
+
+extern UBaseType_t uxSchedulerSuspended;
+
+/*! \var typedef struct xBenchOp BenchOp_t
+	\brief Operación de la traza: asignar xSize bytes en el slot o,
+	con xSize 0, liberar el bloque del slot.
+*/
+typedef struct xBenchOp {
+	uint16_t usSlot;
+	uint16_t usSize;
+} BenchOp_t;
+
+/*! \var typedef struct xBenchHeap BenchHeap_t
+	\brief Heap a comparar y resultados de la traza.
+*/
+typedef struct xBenchHeap {
+	const char *pcName;
+	void *( *pvMalloc )( size_t );
+	void ( *vFree )( void * );
+	size_t ( *xFree )( void );
+	size_t ( *xMinimumEverFree )( void );
+	/* Resultados */
+	uint32_t ulMallocs;
+	uint32_t ulFrees;
+	uint32_t ulFailures;
+	uint32_t ulCorrupted;
+	uint64_t ullMallocNs;
+	uint64_t ullFreeNs;
+	uint32_t ulMallocMaxNs;
+	uint32_t ulFreeMaxNs;
+	size_t xMinimumFree;
+	size_t xFreeEnd;
+	size_t xLargestEnd;
+	size_t xFreeReleased;
+	size_t xLargestReleased;
+} BenchHeap_t;
+
+static BenchOp_t pxTrace[ benchOPERATIONS ];
+
+static BenchHeap_t xHeap4 = { "heap_4", pvHeap4Malloc, vHeap4Free,
+	xHeap4GetFreeHeapSize, xHeap4GetMinimumEverFreeHeapSize };
+static BenchHeap_t xTlsf = { "tlsf", pvTlsfMalloc, vTlsfFree,
+	xTlsfGetFreeHeapSize, xTlsfGetMinimumEverFreeHeapSize };
+
+/*! \fn static uint32_t prvRandom( void )
+	\brief Generador congruencial lineal, misma traza en cada ejecución.
+*/
+static uint32_t prvRandom( void )
+{
+	static uint32_t ulSeed = 2020;
+
+	ulSeed = ulSeed * 1664525UL + 1013904223UL;
+	return ulSeed >> 8;
+}
+
+/*! \fn static void prvTraceBuild( void )
+	\brief Generar la traza: 80 % mensajes de 8 a 64 bytes y el resto
+	buffers de 128 a 1024 bytes, que se liberan con menor frecuencia.
+*/
+static void prvTraceBuild( void )
+{
+	bool pxUsed[ benchSLOTS ] = { false };
+	uint16_t usSlot, usSize;
+
+	for ( uint32_t i=0; i<benchOPERATIONS; i++ ) {
+		usSlot = prvRandom() % benchSLOTS;
+		if ( pxUsed[ usSlot ] ) {
+			/* Los buffers grandes viven más */
+			if ( ( usSlot >= benchSLOTS - 16 ) && ( prvRandom() % 8 ) ) {
+				i--;
+				continue;
+			}
+			usSize = 0;
+		} else if ( usSlot >= benchSLOTS - 16 ) {
+			usSize = 128 + prvRandom() % 897;
+		} else {
+			usSize = 8 + prvRandom() % 57;
+		}
+		pxUsed[ usSlot ] = ( usSize != 0 );
+		pxTrace[i].usSlot = usSlot;
+		pxTrace[i].usSize = usSize;
+	}
+}
+
+/*! \fn static uint32_t prvNow( void )
+	\brief Instante en ns.
+*/
+static uint64_t prvNow( void )
+{
+	struct timespec xNow;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	return ( uint64_t ) xNow.tv_sec * 1000000000ULL + xNow.tv_nsec;
+}
+
+/*! \fn static size_t prvLargestFree( BenchHeap_t *pxHeap )
+	\brief Mayor asignación posible, por búsqueda binaria (heap_4 no
+	la informa).
+*/
+static size_t prvLargestFree( BenchHeap_t *pxHeap )
+{
+	size_t xLow = 0, xHigh = pxHeap->xFree(), xMid;
+	void *pv;
+
+	while ( xLow < xHigh ) {
+		xMid = ( xLow + xHigh + 1 ) / 2;
+		pv = pxHeap->pvMalloc( xMid );
+		if ( pv != NULL ) {
+			pxHeap->vFree( pv );
+			xLow = xMid;
+		} else {
+			xHigh = xMid - 1;
+		}
+	}
+	return xLow;
+}
+
+/*! \fn static bool prvBlockCheck( uint8_t *pucBlock, uint16_t usSize, uint16_t usSlot )
+	\brief Verificar el patrón del slot en el bloque.
+*/
+static bool prvBlockCheck( uint8_t *pucBlock, uint16_t usSize, uint16_t usSlot )
+{
+	for ( uint16_t i=0; i<usSize; i++ ) {
+		if ( pucBlock[i] != ( uint8_t ) ( usSlot + i ) ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*! \fn static void prvTraceReplay( BenchHeap_t *pxHeap )
+	\brief Reproducir la traza en el heap, liberar los bloques que
+	quedan e imprimir los resultados.
+*/
+static void prvTraceReplay( BenchHeap_t *pxHeap )
+{
+	uint8_t *pucBlock[ benchSLOTS ] = { NULL };
+	uint16_t pusSize[ benchSLOTS ] = { 0 };
+	uint64_t ullStart;
+	uint32_t ulNs;
+	uint16_t usSlot;
+
+	for ( uint32_t i=0; i<benchOPERATIONS; i++ ) {
+		usSlot = pxTrace[i].usSlot;
+		if ( pxTrace[i].usSize == 0 ) {
+			if ( pucBlock[ usSlot ] == NULL ) {
+				/* Su asignación falló */
+				continue;
+			}
+			if ( !prvBlockCheck( pucBlock[ usSlot ], pusSize[ usSlot ], usSlot ) ) {
+				pxHeap->ulCorrupted++;
+			}
+			ullStart = prvNow();
+			pxHeap->vFree( pucBlock[ usSlot ] );
+			ulNs = prvNow() - ullStart;
+			pxHeap->ulFrees++;
+			pxHeap->ullFreeNs += ulNs;
+			pxHeap->ulFreeMaxNs = ( ulNs > pxHeap->ulFreeMaxNs ) ? ulNs : pxHeap->ulFreeMaxNs;
+			pucBlock[ usSlot ] = NULL;
+			continue;
+		}
+
+		ullStart = prvNow();
+		pucBlock[ usSlot ] = pxHeap->pvMalloc( pxTrace[i].usSize );
+		ulNs = prvNow() - ullStart;
+		pxHeap->ulMallocs++;
+		pxHeap->ullMallocNs += ulNs;
+		pxHeap->ulMallocMaxNs = ( ulNs > pxHeap->ulMallocMaxNs ) ? ulNs : pxHeap->ulMallocMaxNs;
+		if ( pucBlock[ usSlot ] == NULL ) {
+			pxHeap->ulFailures++;
+			continue;
+		}
+		pusSize[ usSlot ] = pxTrace[i].usSize;
+		for ( uint16_t j=0; j<pusSize[ usSlot ]; j++ ) {
+			pucBlock[ usSlot ][j] = ( uint8_t ) ( usSlot + j );
+		}
+	}
+
+	/* Antes de las asignaciones de prueba de prvLargestFree() */
+	pxHeap->xMinimumFree = pxHeap->xMinimumEverFree();
+	pxHeap->xFreeEnd = pxHeap->xFree();
+	pxHeap->xLargestEnd = prvLargestFree( pxHeap );
+
+	for ( usSlot=0; usSlot<benchSLOTS; usSlot++ ) {
+		if ( pucBlock[ usSlot ] != NULL ) {
+			if ( !prvBlockCheck( pucBlock[ usSlot ], pusSize[ usSlot ], usSlot ) ) {
+				pxHeap->ulCorrupted++;
+			}
+			pxHeap->vFree( pucBlock[ usSlot ] );
+		}
+	}
+	pxHeap->xFreeReleased = pxHeap->xFree();
+	pxHeap->xLargestReleased = prvLargestFree( pxHeap );
+
+	printf( "HEAP:BENCH %-6s malloc n %u avg %u max %u ns, free n %u avg %u max %u ns, "
+		"fail %u, min free %u, end free %u largest %u frag %u%%\r\n", pxHeap->pcName,
+		( unsigned ) pxHeap->ulMallocs, ( unsigned ) ( pxHeap->ullMallocNs / pxHeap->ulMallocs ),
+		( unsigned ) pxHeap->ulMallocMaxNs,
+		( unsigned ) pxHeap->ulFrees, ( unsigned ) ( pxHeap->ullFreeNs / pxHeap->ulFrees ),
+		( unsigned ) pxHeap->ulFreeMaxNs, ( unsigned ) pxHeap->ulFailures,
+		( unsigned ) pxHeap->xMinimumFree, ( unsigned ) pxHeap->xFreeEnd,
+		( unsigned ) pxHeap->xLargestEnd,
+		( unsigned ) ( 100 - pxHeap->xLargestEnd * 100 / pxHeap->xFreeEnd ) );
+}
+
+int main( void )
+{
+	prvTraceBuild();
+	MINUT( true );
+	return 0;
+}
+
+/* La traza completa no corrompe bloques en heap_4 */
+TEST( heap4_trace )
+{
+	prvTraceReplay( &xHeap4 );
+	ASSERT_EQ( 0, xHeap4.ulCorrupted );
+}
+
+/* Ni en TLSF, que además sirve todas las asignaciones que sirve heap_4 */
+TEST( tlsf_trace )
+{
+	prvTraceReplay( &xTlsf );
+	ASSERT_EQ( true, ( xTlsf.ulCorrupted == 0 ) &&
+		( xTlsf.ulFailures <= xHeap4.ulFailures ) &&
+		( uxSchedulerSuspended == 0 ) );
+}
+
+/* Liberados todos los bloques, TLSF vuelve a un único bloque libre */
+TEST( tlsf_coalesce )
+{
+	ASSERT_EQ( true, ( xTlsf.xLargestReleased == xTlsf.xFreeReleased ) &&
+		( ulPortGetHeapFragmentation() == 0 ) );
+}
+
+/* El mayor bloque libre informado se puede asignar */
+TEST( tlsf_largest_request )
+{
+	void *pv = pvTlsfMalloc( xPortGetLargestFreeBlockSize() );
+
+	vTlsfFree( pv );
+	ASSERT_EQ( true, pv != NULL );
+}
+
+/* Fragmentación informada por TLSF frente a la medida */
+TEST( tlsf_fragmentation_report )
+{
+	HeapTlsfStats_t xStats;
+
+	vPortGetHeapTlsfStats( &xStats );
+	ASSERT_EQ( true, ( xStats.xLargestFreeBlock == xPortGetLargestFreeBlockSize() ) &&
+		( xStats.xFreeBytes == xTlsf.xFreeReleased ) && ( xStats.xUsedBlocks == 0 ) );
+}
+
+MINUT_BEG
+	RUN( heap4_trace() );
+	RUN( tlsf_trace() );
+	RUN( tlsf_coalesce() );
+	RUN( tlsf_largest_request() );
+	RUN( tlsf_fragmentation_report() );
+MINUT_END
@@ -0,0 +1,15 @@
+/*! \file tlsf.c
+    \brief heap_tlsf con nombres propios, para reproducir la misma
+    traza que heap_4 en el mismo programa.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+#define pvPortMalloc						pvTlsfMalloc
+#define vPortFree							vTlsfFree
+#define xPortGetFreeHeapSize				xTlsfGetFreeHeapSize
+#define xPortGetMinimumEverFreeHeapSize		xTlsfGetMinimumEverFreeHeapSize
+#define vPortInitialiseBlocks				vTlsfInitialiseBlocks
+
+#include "heap_tlsf.c"
@@ -0,0 +1,92 @@
+/*! \file chip.h
+    \brief Controlador I2C0 (lpc_open), NVIC, PRIMASK y contador de
+    ciclos que usa sapi_i2c.c, reemplazados por el modelo de
+    i2c_controller.c para la prueba en el host (i2c_mock).
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+#ifndef CHIP_H_
+#define CHIP_H_
+
+#include <stdint.h>
+
+/* Estados de I2CM_XFER_T (i2cm_18xx_43xx.h) */
+#define I2CM_STATUS_OK				0x00
+#define I2CM_STATUS_ERROR			0x01
+#define I2CM_STATUS_NAK				0x02
+#define I2CM_STATUS_BUS_ERROR		0x03
+#define I2CM_STATUS_SLAVE_NAK		0x04
+#define I2CM_STATUS_ARBLOST			0x05
+#define I2CM_STATUS_BUSY			0xFF
+
+/*! \var typedef struct I2CM_XFER_T
+	\brief Transferencia del controlador, igual que en lpc_open.
+*/
+typedef struct {
+	uint8_t slaveAddr;
+	uint8_t options;
+	uint16_t status;
+	uint16_t txSz;
+	uint16_t rxSz;
+	const uint8_t *txBuff;
+	uint8_t *rxBuff;
+} I2CM_XFER_T;
+
+typedef struct {
+	uint32_t ulUnused;
+} LPC_I2C_T;
+
+typedef void ( *I2C_EVENTHANDLER_T )( int, int );
+
+extern LPC_I2C_T xMockI2c0;
+#define LPC_I2C0						( &xMockI2c0 )
+#define I2C0_STANDARD_FAST_MODE			1
+#define Chip_I2C_EventHandlerPolling	( ( I2C_EVENTHANDLER_T ) 0 )
+
+void Chip_SCU_I2C0PinConfig( uint32_t ulMode );
+void Chip_I2C_Init( int lId );
+void Chip_I2C_SetClockRate( int lId, uint32_t ulClockRate );
+void Chip_I2C_SetMasterEventHandler( int lId, I2C_EVENTHANDLER_T pxHandler );
+
+void Chip_I2CM_Xfer( LPC_I2C_T *pI2C, I2CM_XFER_T *xfer );
+uint32_t Chip_I2CM_XferHandler( LPC_I2C_T *pI2C, I2CM_XFER_T *xfer );
+uint32_t Chip_I2CM_XferBlocking( LPC_I2C_T *pI2C, I2CM_XFER_T *xfer );
+void Chip_I2CM_ClearSI( LPC_I2C_T *pI2C );
+void Chip_I2CM_SendStop( LPC_I2C_T *pI2C );
+void Chip_I2CM_ResetControl( LPC_I2C_T *pI2C );
+
+/* NVIC y PRIMASK */
+typedef enum {
+	I2C0_IRQn = 18
+} IRQn_Type;
+
+void NVIC_SetPriority( IRQn_Type xIrq, uint32_t ulPriority );
+void NVIC_ClearPendingIRQ( IRQn_Type xIrq );
+void NVIC_EnableIRQ( IRQn_Type xIrq );
+
+extern uint32_t ulMockPrimask;
+#define __get_PRIMASK()					( ulMockPrimask )
+#define __set_PRIMASK( x )				( ulMockPrimask = ( x ) )
+#define __disable_irq()					( ulMockPrimask = 1 )
+
+/* Contador de ciclos DWT */
+typedef struct {
+	uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+	uint32_t CTRL;
+	uint32_t CYCCNT;
+} DWT_Type;
+
+extern CoreDebug_Type xMockCoreDebug;
+extern DWT_Type xMockDwt;
+
+#define CoreDebug						( &xMockCoreDebug )
+#define DWT								( &xMockDwt )
+#define CoreDebug_DEMCR_TRCENA_Msk		( 1UL << 24 )
+#define DWT_CTRL_CYCCNTENA_Msk			( 1UL << 0 )
+
+#endif /* CHIP_H_ */
@@ -0,0 +1,92 @@
+/*! \file i2c_controller.h
+    \brief Modelo del controlador I2C0 y de los dispositivos del bus
+    para la prueba de la cola de transacciones de sapi_i2c en el host.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Cada llamada a I2C0_IRQHandler() es un evento del bus: start,
+    dirección, un byte escrito o leído, y Chip_I2CM_XferHandler()
+    avanza la transferencia como el de lpc_open. Los dispositivos son
+    memorias de 256 bytes: el primer byte escrito es la dirección de
+    memoria y los siguientes se escriben desde ahí; la lectura sigue
+    desde la última dirección.
+*/
+
+#ifndef I2C_CONTROLLER_H_
+#define I2C_CONTROLLER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip.h"
+
+/*! \def mockDEVICE_NUM
+	\brief Dispositivos del bus.
+*/
+#define mockDEVICE_NUM			2
+
+/*! \def mockCYCLES_PER_EVENT
+	\brief Ciclos del contador entre dos eventos del bus (un byte a
+	100 kHz con el núcleo a 204 MHz).
+*/
+#define mockCYCLES_PER_EVENT	18360
+
+/*! \var typedef enum MockPhase_t
+	\brief Fase de la transferencia en el bus.
+*/
+typedef enum {
+	mockPHASE_START,
+	/* Primer byte escrito: dirección de memoria */
+	mockPHASE_POINTER,
+	mockPHASE_WRITE,
+	mockPHASE_RESTART,
+	mockPHASE_READ
+} MockPhase_t;
+
+/*! \var typedef struct xMockDevice MockDevice_t
+	\brief Dispositivo del bus.
+*/
+typedef struct xMockDevice {
+	uint8_t ucAddress;
+	/* No responde a su dirección (desconectado) */
+	bool xAbsent;
+	uint8_t pucMemory[256];
+	uint8_t ucPointer;
+} MockDevice_t;
+
+/*! \var typedef struct xMockController MockController_t
+	\brief Estado del controlador y contadores de la prueba.
+*/
+typedef struct xMockController {
+	MockDevice_t pxDevice[ mockDEVICE_NUM ];
+	/* Transferencia en el bus, NULL si está libre */
+	I2CM_XFER_T *pxXfer;
+	MockDevice_t *pxTarget;
+	MockPhase_t xPhase;
+	bool xIrqEnabled;
+	bool xIrqPending;
+	/* Starts con otra transferencia en el bus (deben ser 0) */
+	uint32_t ulOverlaps;
+	uint32_t ulStarts;
+	uint32_t ulStops;
+	uint32_t ulAborts;
+	uint32_t ulEvents;
+} MockController_t;
+
+extern MockController_t xMock;
+
+/*! \fn void vMockReset( void )
+	\brief Bus libre, dispositivos en 0x50 y 0x68 con la memoria en 0 y
+	contadores en 0.
+*/
+void vMockReset( void );
+
+/*! \fn uint32_t ulMockRun( uint32_t ulMaxEvents )
+	\brief Atender la interrupción del bus mientras esté pendiente y
+	habilitada, hasta ulMaxEvents eventos.
+	\return Eventos atendidos.
+*/
+uint32_t ulMockRun( uint32_t ulMaxEvents );
+
+#endif /* I2C_CONTROLLER_H_ */
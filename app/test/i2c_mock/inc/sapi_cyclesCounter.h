@@ -0,0 +1,15 @@
+/*! \file sapi_cyclesCounter.h
+    \brief Lectura del contador de ciclos simulado (xMockDwt).
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+#ifndef _SAPI_CYCLES_COUNTER_H_
+#define _SAPI_CYCLES_COUNTER_H_
+
+#include "chip.h"
+
+#define cyclesCounterRead()		( DWT->CYCCNT )
+
+#endif /* _SAPI_CYCLES_COUNTER_H_ */
@@ -0,0 +1,23 @@
+/*! \file sapi_datatypes.h
+    \brief Tipos de sAPI para compilar sus módulos en el host, sin los
+    headers de la placa.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+#ifndef _SAPI_DATATYPES_H_
+#define _SAPI_DATATYPES_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "chip.h"
+
+#define FALSE	0
+#define TRUE	( !FALSE )
+
+typedef uint8_t bool_t;
+typedef uint64_t tick_t;
+
+#endif /* _SAPI_DATATYPES_H_ */
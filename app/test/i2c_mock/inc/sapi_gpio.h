@@ -0,0 +1,11 @@
+/*! \file sapi_gpio.h
+    \brief Sin uso en el camino de I2C por hardware de sapi_i2c.c.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+#ifndef _SAPI_GPIO_H_
+#define _SAPI_GPIO_H_
+
+#endif /* _SAPI_GPIO_H_ */
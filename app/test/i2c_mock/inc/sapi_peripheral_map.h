@@ -0,0 +1,15 @@
+/*! \file sapi_peripheral_map.h
+    \brief Periféricos de la placa que usa sapi_i2c.c en el host.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+#ifndef _SAPI_PERIPHERALMAP_H_
+#define _SAPI_PERIPHERALMAP_H_
+
+typedef enum {
+	I2C0
+} i2cMap_t;
+
+#endif /* _SAPI_PERIPHERALMAP_H_ */
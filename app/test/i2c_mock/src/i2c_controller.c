@@ -0,0 +1,169 @@
+/*! \file i2c_controller.c
+    \brief Modelo del controlador I2C0 y de los dispositivos del bus.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+/* Utilidades includes */
+#include <string.h>
+
+/* Pruebas includes */
+#include "i2c_controller.h"
+
+MockController_t xMock;
+LPC_I2C_T xMockI2c0;
+uint32_t ulMockPrimask;
+CoreDebug_Type xMockCoreDebug;
+DWT_Type xMockDwt;
+
+/* I2C0_IRQHandler() de sapi_i2c.c */
+void I2C0_IRQHandler( void );
+
+void vMockReset( void )
+{
+	memset( &xMock, 0, sizeof( xMock ) );
+	xMock.pxDevice[0].ucAddress = 0x50;
+	xMock.pxDevice[1].ucAddress = 0x68;
+}
+
+uint32_t ulMockRun( uint32_t ulMaxEvents )
+{
+	uint32_t ulEvents = 0;
+
+	while ( xMock.xIrqEnabled && xMock.xIrqPending && ( ulMockPrimask == 0 ) &&
+		( ulEvents < ulMaxEvents ) ) {
+		xMockDwt.CYCCNT += mockCYCLES_PER_EVENT;
+		I2C0_IRQHandler();
+		ulEvents++;
+	}
+	return ulEvents;
+}
+
+/*! \fn static MockDevice_t *prvMockFind( uint8_t ucAddress )
+	\brief Dispositivo que responde a la dirección.
+*/
+static MockDevice_t *prvMockFind( uint8_t ucAddress )
+{
+	for ( uint32_t i=0; i<mockDEVICE_NUM; i++ ) {
+		if ( ( xMock.pxDevice[i].ucAddress == ucAddress ) && !xMock.pxDevice[i].xAbsent ) {
+			return &xMock.pxDevice[i];
+		}
+	}
+	return NULL;
+}
+
+void Chip_SCU_I2C0PinConfig( uint32_t ulMode ) { }
+void Chip_I2C_Init( int lId ) { }
+void Chip_I2C_SetClockRate( int lId, uint32_t ulClockRate ) { }
+void Chip_I2C_SetMasterEventHandler( int lId, I2C_EVENTHANDLER_T pxHandler ) { }
+
+void NVIC_SetPriority( IRQn_Type xIrq, uint32_t ulPriority ) { }
+
+void NVIC_ClearPendingIRQ( IRQn_Type xIrq )
+{
+	xMock.xIrqPending = false;
+}
+
+void NVIC_EnableIRQ( IRQn_Type xIrq )
+{
+	xMock.xIrqEnabled = true;
+}
+
+/* Start: la primera interrupción es el start en el bus */
+void Chip_I2CM_Xfer( LPC_I2C_T *pI2C, I2CM_XFER_T *xfer )
+{
+	if ( xMock.pxXfer != NULL ) {
+		xMock.ulOverlaps++;
+	}
+	xfer->status = I2CM_STATUS_BUSY;
+	xMock.pxXfer = xfer;
+	xMock.pxTarget = NULL;
+	xMock.xPhase = mockPHASE_START;
+	xMock.ulStarts++;
+	xMock.xIrqPending = true;
+}
+
+/* Un evento del bus por llamada, con la misma secuencia de estados
+ * que el handler de lpc_open */
+uint32_t Chip_I2CM_XferHandler( LPC_I2C_T *pI2C, I2CM_XFER_T *xfer )
+{
+	MockDevice_t *pxDevice;
+
+	xMock.ulEvents++;
+	xMock.xIrqPending = true;
+
+	switch ( xMock.xPhase ) {
+	case mockPHASE_START:
+	case mockPHASE_RESTART:
+		/* Dirección después del start (o del start repetido) */
+		pxDevice = prvMockFind( xfer->slaveAddr );
+		if ( pxDevice == NULL ) {
+			xfer->status = ( xfer->txSz == 0 ) ? I2CM_STATUS_SLAVE_NAK : I2CM_STATUS_NAK;
+			break;
+		}
+		xMock.pxTarget = pxDevice;
+		xMock.xPhase = ( xfer->txSz == 0 ) ? mockPHASE_READ : mockPHASE_POINTER;
+		if ( ( xfer->txSz == 0 ) && ( xfer->rxSz == 0 ) ) {
+			/* Sólo la dirección (probe): stop después del ACK */
+			break;
+		}
+		return 0;
+	case mockPHASE_POINTER:
+		xMock.pxTarget->ucPointer = *xfer->txBuff++;
+		xfer->txSz--;
+		xMock.xPhase = mockPHASE_WRITE;
+		break;
+	case mockPHASE_WRITE:
+		xMock.pxTarget->pucMemory[ xMock.pxTarget->ucPointer++ ] = *xfer->txBuff++;
+		xfer->txSz--;
+		break;
+	case mockPHASE_READ:
+		*xfer->rxBuff++ = xMock.pxTarget->pucMemory[ xMock.pxTarget->ucPointer++ ];
+		xfer->rxSz--;
+		break;
+	}
+
+	if ( xfer->status == I2CM_STATUS_BUSY ) {
+		if ( ( xMock.xPhase != mockPHASE_READ ) && ( xfer->txSz == 0 ) && ( xfer->rxSz != 0 ) ) {
+			/* Fin de la escritura: start repetido para leer */
+			xMock.xPhase = mockPHASE_RESTART;
+			return 0;
+		}
+		if ( ( xfer->txSz != 0 ) || ( xfer->rxSz != 0 ) ) {
+			return 0;
+		}
+		xfer->status = I2CM_STATUS_OK;
+	}
+
+	/* Stop: bus libre y sin interrupción hasta el próximo start */
+	xMock.ulStops++;
+	xMock.pxXfer = NULL;
+	xMock.xIrqPending = false;
+	return 1;
+}
+
+uint32_t Chip_I2CM_XferBlocking( LPC_I2C_T *pI2C, I2CM_XFER_T *xfer )
+{
+	Chip_I2CM_Xfer( pI2C, xfer );
+	while ( Chip_I2CM_XferHandler( pI2C, xfer ) == 0 );
+	return xfer->status == I2CM_STATUS_OK;
+}
+
+void Chip_I2CM_ClearSI( LPC_I2C_T *pI2C )
+{
+	xMock.xIrqPending = false;
+}
+
+void Chip_I2CM_SendStop( LPC_I2C_T *pI2C )
+{
+	xMock.ulStops++;
+}
+
+/* Cancelación de la transferencia en curso */
+void Chip_I2CM_ResetControl( LPC_I2C_T *pI2C )
+{
+	xMock.ulAborts++;
+	xMock.pxXfer = NULL;
+	xMock.xIrqPending = false;
+}
@@ -0,0 +1,344 @@
+/*! \file i2c_mock_test.c
+    \brief Prueba de la cola de transacciones I2C por interrupción de
+    sapi_i2c sobre un modelo del controlador (i2c_controller.c).
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Se compila sapi_i2c.c sin cambios y cada evento del bus es una
+    llamada a I2C0_IRQHandler(). Se verifican los datos escritos y
+    leídos con start repetido, el orden de la cola, que nunca se
+    inicie una transferencia con otra en el bus, los errores por NAK,
+    la cancelación, las transacciones encoladas desde el callback
+    (como el expansor del LCD) y los contadores de i2cGetStats().
+    i2cRead() e i2cWrite() se ejecutan por la cola con un
+    i2cBlockingTransfer_t que atiende el bus hasta el final.
+*/
+
+/* Utilidades includes */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* EDU-CIAA firmware_v3 includes */
+#include "sapi_i2c.h"
+
+/* Pruebas includes */
+#include "minut.h"
+#include "i2c_controller.h"
+
+/*! \def testMAX_EVENTS
+	\brief Eventos máximos de una prueba antes de darla por bloqueada.
+*/
+#define testMAX_EVENTS			100000
+
+/*! \def testCHAIN_LENGTH
+	\brief Transacciones encoladas desde el callback.
+*/
+#define testCHAIN_LENGTH		50
+
+/*! \var xDone
+	\brief Callbacks recibidos, en orden (param de cada transacción).
+*/
+static struct {
+	uint32_t ulCount;
+	uintptr_t puxOrder[ 2 * testCHAIN_LENGTH ];
+} xDone;
+
+/*! \var pxTransaction
+	\brief Transacciones de las pruebas.
+*/
+static i2cTransaction_t pxTransaction[ I2C_QUEUE_LENGTH + 2 ];
+
+/*! \fn static void prvDone( i2cTransaction_t *pxDone )
+	\brief Callback: registrar el orden de finalización.
+*/
+static void prvDone( i2cTransaction_t *pxDone )
+{
+	if ( xDone.ulCount < 2 * testCHAIN_LENGTH ) {
+		xDone.puxOrder[ xDone.ulCount ] = ( uintptr_t ) pxDone->param;
+	}
+	xDone.ulCount++;
+}
+
+/*! \fn static void prvTransaction( i2cTransaction_t *pxT, uint8_t ucAddress, const uint8_t *pucTx, uint16_t usTxSize, uint8_t *pucRx, uint16_t usRxSize, uintptr_t uxId )
+	\brief Completar una transacción con prvDone como callback.
+*/
+static void prvTransaction( i2cTransaction_t *pxT, uint8_t ucAddress,
+	const uint8_t *pucTx, uint16_t usTxSize, uint8_t *pucRx, uint16_t usRxSize,
+	uintptr_t uxId )
+{
+	pxT->slaveAddress = ucAddress;
+	pxT->txBuffer = pucTx;
+	pxT->txSize = usTxSize;
+	pxT->rxBuffer = pucRx;
+	pxT->rxSize = usRxSize;
+	pxT->callback = prvDone;
+	pxT->param = ( void * ) uxId;
+}
+
+/*! \var ulBlockingCalls
+	\brief Transacciones de i2cRead() e i2cWrite() recibidas por
+	prvBlocking().
+*/
+static uint32_t ulBlockingCalls;
+
+/*! \fn static bool_t prvBlocking( i2cTransaction_t *pxT )
+	\brief Transacción bloqueante: encolar y atender el bus hasta que
+	finalice, como la espera de una tarea.
+*/
+static bool_t prvBlocking( i2cTransaction_t *pxT )
+{
+	ulBlockingCalls++;
+	if ( !i2cTransactionStart( I2C0, pxT ) ) {
+		return FALSE;
+	}
+	ulMockRun( testMAX_EVENTS );
+	return pxT->status == I2CM_STATUS_OK;
+}
+
+/*! \fn static void prvSetup( void )
+	\brief Bus libre y sin callbacks registrados.
+*/
+static void prvSetup( void )
+{
+	uint32_t ulCycles = xMockDwt.CYCCNT;
+	bool xEnabled = xMock.xIrqEnabled;
+
+	vMockReset();
+	xMock.xIrqEnabled = xEnabled;
+	xMockDwt.CYCCNT = ulCycles;
+	memset( &xDone, 0, sizeof( xDone ) );
+	memset( pxTransaction, 0, sizeof( pxTransaction ) );
+}
+
+int main( void )
+{
+	vMockReset();
+	MINUT( true );
+	return 0;
+}
+
+/* Sin inicializar o con argumentos inválidos no se encola, e
+ * i2cRead() e i2cWrite() inválidos vuelven sin esperar */
+TEST( init_and_arguments )
+{
+	static const uint8_t pucTx[] = { 0x00 };
+	bool_t xBeforeInit, xNoTx, xNoRx, xWrite, xRead;
+
+	prvSetup();
+	prvTransaction( &pxTransaction[0], 0x50, pucTx, 1, NULL, 0, 0 );
+	xBeforeInit = i2cTransactionStart( I2C0, &pxTransaction[0] );
+
+	i2cAsyncInit( I2C0, 100000 );
+	prvTransaction( &pxTransaction[0], 0x50, NULL, 1, NULL, 0, 0 );
+	xNoTx = i2cTransactionStart( I2C0, &pxTransaction[0] );
+	prvTransaction( &pxTransaction[0], 0x50, pucTx, 1, NULL, 1, 0 );
+	xNoRx = i2cTransactionStart( I2C0, &pxTransaction[0] );
+	/* Sin i2cBlockingTransfer_t: la espera activa nunca termina si se
+	 * queda esperando una transacción que no se encoló */
+	xWrite = i2cWrite( I2C0, 0x50, NULL, 1, TRUE );
+	xRead = i2cRead( I2C0, 0x50, ( uint8_t * ) pucTx, 1, FALSE, NULL, 1, TRUE );
+
+	ASSERT_EQ( true, !xBeforeInit && !xNoTx && !xNoRx && !xWrite && !xRead &&
+		xMock.xIrqEnabled && ( xMock.ulStarts == 0 ) );
+}
+
+/* i2cRead() e i2cWrite() por la cola: probe de dirección, stop
+ * después de la escritura como dos transacciones, start repetido
+ * sin él, y rechazo de lo que la cola no puede terminar sin stop */
+TEST( blocking_api )
+{
+	static uint8_t pucWrite[] = { 0x30, 0x11, 0x22 };
+	uint8_t pucPointer[] = { 0x30 };
+	uint8_t pucRead[2] = { 0 }, pucRestart[2] = { 0 };
+	bool_t xProbe, xAbsent, xWrite, xSplit, xRestart, xNoWriteStop, xNoReadStop;
+	uint32_t ulSplitStarts, ulRestartStarts;
+
+	prvSetup();
+	ulBlockingCalls = 0;
+	i2cAsyncSetBlockingTransfer( I2C0, prvBlocking );
+	xMock.pxDevice[1].xAbsent = true;
+
+	xProbe = i2cWrite( I2C0, 0x50, NULL, 0, TRUE );
+	xAbsent = i2cWrite( I2C0, 0x68, NULL, 0, TRUE );
+	xWrite = i2cWrite( I2C0, 0x50, pucWrite, sizeof( pucWrite ), TRUE );
+	ulSplitStarts = xMock.ulStarts;
+	xSplit = i2cRead( I2C0, 0x50, pucPointer, 1, TRUE, pucRead, 2, TRUE );
+	ulSplitStarts = xMock.ulStarts - ulSplitStarts;
+	ulRestartStarts = xMock.ulStarts;
+	xRestart = i2cRead( I2C0, 0x50, pucPointer, 1, FALSE, pucRestart, 2, TRUE );
+	ulRestartStarts = xMock.ulStarts - ulRestartStarts;
+	xNoWriteStop = i2cWrite( I2C0, 0x50, pucWrite, sizeof( pucWrite ), FALSE );
+	xNoReadStop = i2cRead( I2C0, 0x50, pucPointer, 1, FALSE, pucRead, 2, FALSE );
+
+	i2cAsyncSetBlockingTransfer( I2C0, NULL );
+	ASSERT_EQ( true, xProbe && !xAbsent && xWrite && xSplit && xRestart &&
+		!xNoWriteStop && !xNoReadStop &&
+		( ulSplitStarts == 2 ) && ( ulRestartStarts == 1 ) &&
+		( memcmp( pucRead, &pucWrite[1], 2 ) == 0 ) &&
+		( memcmp( pucRestart, &pucWrite[1], 2 ) == 0 ) &&
+		( ulBlockingCalls == 6 ) && ( xMock.ulOverlaps == 0 ) );
+}
+
+/* Escritura y lectura con start repetido de la misma memoria */
+TEST( write_then_read )
+{
+	static const uint8_t pucWrite[] = { 0x10, 0xA1, 0xB2, 0xC3 };
+	static const uint8_t pucPointer[] = { 0x10 };
+	uint8_t pucRead[3] = { 0 };
+	bool_t xWrite, xRead;
+
+	prvSetup();
+	prvTransaction( &pxTransaction[0], 0x50, pucWrite, sizeof( pucWrite ), NULL, 0, 1 );
+	prvTransaction( &pxTransaction[1], 0x50, pucPointer, 1, pucRead, sizeof( pucRead ), 2 );
+	xWrite = i2cTransactionStart( I2C0, &pxTransaction[0] );
+	xRead = i2cTransactionStart( I2C0, &pxTransaction[1] );
+	ulMockRun( testMAX_EVENTS );
+
+	ASSERT_EQ( true, xWrite && xRead &&
+		( pxTransaction[0].status == I2CM_STATUS_OK ) &&
+		( pxTransaction[1].status == I2CM_STATUS_OK ) &&
+		( memcmp( pucRead, &pucWrite[1], sizeof( pucRead ) ) == 0 ) &&
+		( memcmp( &xMock.pxDevice[0].pucMemory[0x10], &pucWrite[1], 3 ) == 0 ) &&
+		( xDone.ulCount == 2 ) && ( xDone.puxOrder[0] == 1 ) && ( xDone.puxOrder[1] == 2 ) &&
+		( xMock.ulStarts == 2 ) && ( xMock.ulStops == 2 ) && ( xMock.pxXfer == NULL ) );
+}
+
+/* La cola acepta I2C_QUEUE_LENGTH transacciones además de la que está
+ * en el bus, las ejecuta en orden y de a una */
+TEST( queue_fifo )
+{
+	static uint8_t pucPointer[ I2C_QUEUE_LENGTH + 2 ];
+	uint8_t pucRead[ I2C_QUEUE_LENGTH + 2 ];
+	uint32_t ulAccepted = 0;
+	i2cStats_t xStats;
+	bool xOrder = true;
+
+	prvSetup();
+	for ( uint32_t i=0; i<I2C_QUEUE_LENGTH + 2; i++ ) {
+		pucPointer[i] = i;
+		xMock.pxDevice[1].pucMemory[i] = 0x80 + i;
+		prvTransaction( &pxTransaction[i], 0x68, &pucPointer[i], 1, &pucRead[i], 1, i );
+		ulAccepted += i2cTransactionStart( I2C0, &pxTransaction[i] ) ? 1 : 0;
+	}
+	ulMockRun( testMAX_EVENTS );
+	i2cGetStats( I2C0, &xStats );
+
+	for ( uint32_t i=0; i<I2C_QUEUE_LENGTH + 1; i++ ) {
+		xOrder = xOrder && ( xDone.puxOrder[i] == i ) && ( pucRead[i] == 0x80 + i );
+	}
+	ASSERT_EQ( true, ( ulAccepted == I2C_QUEUE_LENGTH + 1 ) && xOrder &&
+		( xDone.ulCount == I2C_QUEUE_LENGTH + 1 ) && ( xMock.ulOverlaps == 0 ) &&
+		( xStats.maxQueued == I2C_QUEUE_LENGTH ) );
+}
+
+/* Sin respuesta a la dirección: NAK al escribir o leer, error en los
+ * contadores y el bus sigue con la próxima transacción */
+TEST( nak_then_next )
+{
+	static const uint8_t pucTx[] = { 0x00, 0x55 };
+	uint8_t ucRx = 0;
+	i2cStats_t xBefore, xAfter;
+
+	prvSetup();
+	xMock.pxDevice[1].xAbsent = true;
+	i2cGetStats( I2C0, &xBefore );
+	prvTransaction( &pxTransaction[0], 0x68, pucTx, sizeof( pucTx ), NULL, 0, 0 );
+	prvTransaction( &pxTransaction[1], 0x68, NULL, 0, &ucRx, 1, 1 );
+	prvTransaction( &pxTransaction[2], 0x50, pucTx, sizeof( pucTx ), NULL, 0, 2 );
+	for ( uint32_t i=0; i<3; i++ ) {
+		i2cTransactionStart( I2C0, &pxTransaction[i] );
+	}
+	ulMockRun( testMAX_EVENTS );
+	i2cGetStats( I2C0, &xAfter );
+
+	ASSERT_EQ( true, ( pxTransaction[0].status == I2CM_STATUS_NAK ) &&
+		( pxTransaction[1].status == I2CM_STATUS_SLAVE_NAK ) &&
+		( pxTransaction[2].status == I2CM_STATUS_OK ) &&
+		( xMock.pxDevice[0].pucMemory[0] == 0x55 ) && ( xDone.ulCount == 3 ) &&
+		( xAfter.errors - xBefore.errors == 2 ) &&
+		( xAfter.transactions - xBefore.transactions == 3 ) );
+}
+
+/* Cancelación de una transacción encolada y de la que está en el bus:
+ * sin callback, el resto en orden y con el bus libre para la próxima */
+TEST( cancel )
+{
+	static const uint8_t pucTx[] = { 0x20, 0x01, 0x02, 0x03, 0x04 };
+	bool_t xQueued, xCurrent, xCompleted;
+
+	prvSetup();
+	for ( uint32_t i=0; i<4; i++ ) {
+		prvTransaction( &pxTransaction[i], 0x50, pucTx, sizeof( pucTx ), NULL, 0, i );
+		i2cTransactionStart( I2C0, &pxTransaction[i] );
+	}
+	/* La primera en el bus, a mitad de la escritura */
+	ulMockRun( 2 );
+	xQueued = i2cTransactionCancel( I2C0, &pxTransaction[2] );
+	xCurrent = i2cTransactionCancel( I2C0, &pxTransaction[0] );
+	ulMockRun( testMAX_EVENTS );
+	xCompleted = i2cTransactionCancel( I2C0, &pxTransaction[1] );
+
+	ASSERT_EQ( true, xQueued && xCurrent && !xCompleted &&
+		( pxTransaction[0].status == I2CM_STATUS_ERROR ) &&
+		( pxTransaction[2].status == I2CM_STATUS_ERROR ) &&
+		( pxTransaction[1].status == I2CM_STATUS_OK ) &&
+		( pxTransaction[3].status == I2CM_STATUS_OK ) &&
+		( xDone.ulCount == 2 ) && ( xDone.puxOrder[0] == 1 ) && ( xDone.puxOrder[1] == 3 ) &&
+		( xMock.ulAborts == 1 ) && ( xMock.ulOverlaps == 0 ) && ( xMock.ulStarts == 3 ) );
+}
+
+/*! \fn static void prvChainDone( i2cTransaction_t *pxDone )
+	\brief Callback que encola el próximo lote desde la interrupción,
+	como el expansor del LCD.
+*/
+static void prvChainDone( i2cTransaction_t *pxDone )
+{
+	prvDone( pxDone );
+	if ( xDone.ulCount < testCHAIN_LENGTH ) {
+		pxDone->param = ( void * ) ( uintptr_t ) xDone.ulCount;
+		i2cTransactionStart( I2C0, pxDone );
+	}
+}
+
+/* Transacciones encoladas desde el callback, con los contadores de
+ * bytes y de ocupación del bus */
+TEST( chained_from_callback )
+{
+	static const uint8_t pucBatch[] = { 0x00, 1, 2, 3, 4, 5, 6, 7, 8 };
+	i2cStats_t xBefore, xAfter;
+	uint32_t ulEvents;
+	bool xOrder = true;
+
+	prvSetup();
+	i2cGetStats( I2C0, &xBefore );
+	prvTransaction( &pxTransaction[0], 0x50, pucBatch, sizeof( pucBatch ), NULL, 0, 0 );
+	pxTransaction[0].callback = prvChainDone;
+	i2cTransactionStart( I2C0, &pxTransaction[0] );
+	ulEvents = ulMockRun( testMAX_EVENTS );
+	i2cGetStats( I2C0, &xAfter );
+
+	for ( uint32_t i=0; i<testCHAIN_LENGTH; i++ ) {
+		xOrder = xOrder && ( xDone.puxOrder[i] == i );
+	}
+	printf( "I2C: %u transactions %u bytes %u events %u busy cycles\n",
+		( unsigned ) ( xAfter.transactions - xBefore.transactions ),
+		( unsigned ) ( xAfter.bytes - xBefore.bytes ), ( unsigned ) ulEvents,
+		( unsigned ) ( xAfter.busyCycles - xBefore.busyCycles ) );
+	ASSERT_EQ( true, xOrder && ( xDone.ulCount == testCHAIN_LENGTH ) &&
+		( xMock.ulStarts == testCHAIN_LENGTH ) && ( xMock.ulOverlaps == 0 ) &&
+		( xAfter.transactions - xBefore.transactions == testCHAIN_LENGTH ) &&
+		( xAfter.bytes - xBefore.bytes == testCHAIN_LENGTH * sizeof( pucBatch ) ) &&
+		( xAfter.busyCycles - xBefore.busyCycles == ulEvents * mockCYCLES_PER_EVENT ) );
+}
+
+MINUT_BEG
+	RUN( init_and_arguments() );
+	RUN( blocking_api() );
+	RUN( write_then_read() );
+	RUN( queue_fifo() );
+	RUN( nak_then_next() );
+	RUN( cancel() );
+	RUN( chained_from_callback() );
+MINUT_END
@@ -0,0 +1,201 @@
+/*! \file ipc_mailbox_test.c
+    \brief Prueba del mailbox entre el M4 y el M0 con un hilo por
+    núcleo.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    El hilo "M4" escribe comandos numerados y lee eventos; el hilo
+    "M0" lee cada comando y responde con un evento con el mismo
+    número, como el fin de un movimiento. El M4 reintenta con el
+    buffer lleno y el M0 espera lugar antes de escribir, por lo que
+    cada comando y cada evento deben llegar una única vez y en orden. Las barreras se reemplazan por
+    __sync_synchronize (ver ipc_mailbox_CFLAGS en el Makefile).
+*/
+
+/* Utilidades includes */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+/* Aplicación includes */
+#include "ipc_mailbox.h"
+
+/* Pruebas includes */
+#include "minut.h"
+
+/*! \def testMESSAGES
+	\brief Cantidad de comandos (y eventos) de la prueba de dos hilos.
+*/
+#define testMESSAGES		200000UL
+
+/*! \var xMailbox
+	\brief Mailbox compartido por ambos hilos.
+*/
+static IpcMailbox_t xMailbox;
+
+/*! \var xResult
+	\brief Resultado de la prueba de dos hilos.
+*/
+static struct {
+	/* Comandos leídos por el M0 fuera de orden o con datos erróneos */
+	uint32_t ulCommandErrors;
+	/* Eventos leídos por el M4 fuera de orden o con datos erróneos */
+	uint32_t ulEventErrors;
+	uint32_t ulCommands;
+	uint32_t ulEvents;
+	/* Mayor ocupación observada de cada buffer */
+	uint32_t ulCommandMax;
+	uint32_t ulEventMax;
+} xResult;
+
+/*! \fn static void *prvM0Thread( void *pvParameters )
+	\brief Lectura de comandos y respuesta con un evento por comando.
+*/
+static void *prvM0Thread( void *pvParameters )
+{
+	IpcCommand_t xCommand;
+	IpcEvent_t xEvent;
+	uint32_t ulUsed;
+
+	while ( xResult.ulCommands < testMESSAGES ) {
+		if ( lIpcCommandGet( &xMailbox, &xCommand ) == 0 ) {
+			sched_yield();
+			continue;
+		}
+		if ( ( xCommand.ulValue != xResult.ulCommands ) ||
+			( xCommand.ucChannel != xCommand.ulValue % ipcSTEPPER_NUM ) ||
+			( xCommand.ucType != ipcCMD_STEPPER_MOVE ) ) {
+			xResult.ulCommandErrors++;
+		}
+		xResult.ulCommands++;
+
+		memset( &xEvent, 0, sizeof( xEvent ) );
+		xEvent.ucType = ipcEVT_STEPPER_DONE;
+		xEvent.ucChannel = xCommand.ucChannel;
+		xEvent.ulValue = xCommand.ulValue;
+		/* Esperar lugar: cada escritura con el buffer lleno se cuenta
+		como evento descartado */
+		while ( xMailbox.ulEventHead - xMailbox.ulEventTail >= ipcRING_LENGTH ) {
+			sched_yield();
+		}
+		lIpcEventPut( &xMailbox, &xEvent );
+		ulUsed = xMailbox.ulEventHead - xMailbox.ulEventTail;
+		if ( ( ulUsed <= ipcRING_LENGTH ) && ( ulUsed > xResult.ulEventMax ) ) {
+			xResult.ulEventMax = ulUsed;
+		}
+	}
+	return NULL;
+}
+
+/*! \fn static void prvM4Drain( void )
+	\brief Lectura de todos los eventos disponibles.
+*/
+static void prvM4Drain( void )
+{
+	IpcEvent_t xEvent;
+
+	while ( lIpcEventGet( &xMailbox, &xEvent ) ) {
+		if ( ( xEvent.ulValue != xResult.ulEvents ) ||
+			( xEvent.ucChannel != xEvent.ulValue % ipcSTEPPER_NUM ) ||
+			( xEvent.ucType != ipcEVT_STEPPER_DONE ) ) {
+			xResult.ulEventErrors++;
+		}
+		xResult.ulEvents++;
+	}
+}
+
+/*! \fn static void prvTwoThreadRun( void )
+	\brief Hilo M4: escribir los comandos y leer los eventos mientras
+	el hilo M0 los procesa.
+*/
+static void prvTwoThreadRun( void )
+{
+	pthread_t xM0;
+	IpcCommand_t xCommand;
+	uint32_t ulUsed;
+
+	memset( &xResult, 0, sizeof( xResult ) );
+	vIpcMailboxInit( &xMailbox );
+	pthread_create( &xM0, NULL, prvM0Thread, NULL );
+
+	for ( uint32_t i=0; i<testMESSAGES; i++ ) {
+		memset( &xCommand, 0, sizeof( xCommand ) );
+		xCommand.ucType = ipcCMD_STEPPER_MOVE;
+		xCommand.ucChannel = i % ipcSTEPPER_NUM;
+		xCommand.ulValue = i;
+		while ( lIpcCommandPut( &xMailbox, &xCommand ) == 0 ) {
+			/* Buffer lleno: leer eventos para que el M0 avance */
+			prvM4Drain();
+			sched_yield();
+		}
+		ulUsed = xMailbox.ulCommandHead - xMailbox.ulCommandTail;
+		if ( ( ulUsed <= ipcRING_LENGTH ) && ( ulUsed > xResult.ulCommandMax ) ) {
+			xResult.ulCommandMax = ulUsed;
+		}
+		prvM4Drain();
+	}
+	while ( xResult.ulEvents < testMESSAGES ) {
+		prvM4Drain();
+		sched_yield();
+	}
+	pthread_join( xM0, NULL );
+
+	printf( "IPC: %u commands %u events max %u/%u in use\n",
+		( unsigned ) xResult.ulCommands, ( unsigned ) xResult.ulEvents,
+		( unsigned ) xResult.ulCommandMax, ( unsigned ) xResult.ulEventMax );
+}
+
+int main( void )
+{
+	prvTwoThreadRun();
+	MINUT( true );
+	return 0;
+}
+
+/* Todos los comandos llegan al M0 una vez y en orden */
+TEST( commands_in_order )
+{
+	ASSERT_EQ( true, ( xResult.ulCommands == testMESSAGES ) &&
+		( xResult.ulCommandErrors == 0 ) );
+}
+
+/* Todos los eventos llegan al M4 una vez y en orden */
+TEST( events_in_order )
+{
+	ASSERT_EQ( true, ( xResult.ulEvents == testMESSAGES ) &&
+		( xResult.ulEventErrors == 0 ) && ( xMailbox.ulEventDropped == 0 ) );
+}
+
+/* Ningún buffer supera su longitud */
+TEST( ring_bounds )
+{
+	ASSERT_EQ( true, ( xResult.ulCommandMax <= ipcRING_LENGTH ) &&
+		( xResult.ulEventMax <= ipcRING_LENGTH ) );
+}
+
+/* Con el buffer de eventos lleno el evento se descarta y se cuenta */
+TEST( event_dropped_when_full )
+{
+	IpcEvent_t xEvent = { ipcEVT_STEPPER_DONE, 0, 0, 0 };
+	int32_t lWritten = 0;
+
+	vIpcMailboxInit( &xMailbox );
+	for ( uint32_t i=0; i<ipcRING_LENGTH; i++ ) {
+		lWritten += lIpcEventPut( &xMailbox, &xEvent );
+	}
+	ASSERT_EQ( true, ( lWritten == ipcRING_LENGTH ) &&
+		( lIpcEventPut( &xMailbox, &xEvent ) == 0 ) &&
+		( xMailbox.ulEventDropped == 1 ) &&
+		( lIpcEventGet( &xMailbox, &xEvent ) == 1 ) &&
+		( lIpcEventPut( &xMailbox, &xEvent ) == 1 ) );
+}
+
+MINUT_BEG
+	RUN( commands_in_order() );
+	RUN( events_in_order() );
+	RUN( ring_bounds() );
+	RUN( event_dropped_when_full() );
+MINUT_END
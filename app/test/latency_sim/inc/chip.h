@@ -0,0 +1,42 @@
+/*! \file chip.h
+    \brief Registros del núcleo que usa latency.c, reemplazados por
+    variables para la simulación en el host (latency_sim).
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+#ifndef CHIP_H_
+#define CHIP_H_
+
+#include <stdint.h>
+
+typedef struct {
+	uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+	uint32_t CTRL;
+	uint32_t CYCCNT;
+} DWT_Type;
+
+extern CoreDebug_Type xSimCoreDebug;
+extern DWT_Type xSimDwt;
+extern uint32_t SystemCoreClock;
+
+#define CoreDebug						( &xSimCoreDebug )
+#define DWT								( &xSimDwt )
+#define CoreDebug_DEMCR_TRCENA_Msk		( 1UL << 24 )
+#define DWT_CTRL_CYCCNTENA_Msk			( 1UL << 0 )
+
+/*! \var ulSimCycles
+	\brief Contador de ciclos simulado (latencyTIMESTAMP()).
+*/
+extern volatile uint32_t ulSimCycles;
+
+/*! \fn void vSimMarker( uint32_t ulLevel )
+	\brief Pin marcador simulado (latencyMARKER_SET/CLEAR()).
+*/
+void vSimMarker( uint32_t ulLevel );
+
+#endif /* CHIP_H_ */
@@ -0,0 +1,23 @@
+/*! \file sapi.h
+    \brief GPIO de sAPI que usa latency.c, sin efecto en la
+    simulación en el host (latency_sim).
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+#ifndef SAPI_H_
+#define SAPI_H_
+
+#include <stdint.h>
+
+typedef enum { LEDG = 0 } gpioMap_t;
+
+#define GPIO_OUTPUT		1
+#define ON				1
+#define OFF				0
+
+#define gpioConfig( xPin, xMode )	( ( void ) ( xPin ), ( void ) ( xMode ) )
+#define gpioWrite( xPin, xValue )	( ( void ) ( xPin ), ( void ) ( xValue ) )
+
+#endif /* SAPI_H_ */
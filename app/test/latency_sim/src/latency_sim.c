@@ -0,0 +1,390 @@
+/*! \file latency_sim.c
+    \brief Ejecución de la medición de latencia (latency.c) en el host
+    con interrupciones simuladas.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Simulación de eventos discretos a 204 MHz con el contador de
+    ciclos DWT reemplazado por ulSimCycles. El encoder genera flancos
+    aislados y la UART ráfagas de bytes a 115200 baudios; cada
+    interrupción ejecuta la ISR y despierta a su tarea consumidora,
+    que se ejecuta luego de un cambio de contexto y, con cierta
+    probabilidad, de la carga de los motores (tareas de mayor
+    prioridad). El simulador calcula por su cuenta la latencia de cada
+    activación (desde la primera interrupción no atendida) y se
+    compara con las tablas del módulo. El contador empieza cerca de
+    su desborde para recorrer la vuelta de 32 bits, y al final se
+    imprime el reporte ":L" de la simulación.
+*/
+
+/* Utilidades includes */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Módulo probado, incluido para leer sus tablas */
+#include "latency.c"
+
+/* Pruebas includes */
+#include "minut.h"
+
+/*! \def simINTERRUPTS
+	\brief Cantidad de interrupciones simuladas.
+*/
+#define simINTERRUPTS		20000
+
+/*! \def simCYCLES_START
+	\brief Valor inicial del contador de ciclos.
+*/
+#define simCYCLES_START		0xFFF00000UL
+
+/*! \def simUART_BYTE_CYCLES
+	\brief Ciclos entre bytes de una ráfaga (115200 baudios, 10 bits
+	por byte, a 204 MHz).
+*/
+#define simUART_BYTE_CYCLES	17708
+
+/* Registros y reloj simulados (chip.h) */
+CoreDebug_Type xSimCoreDebug;
+DWT_Type xSimDwt;
+uint32_t SystemCoreClock = configCPU_CLOCK_HZ;
+volatile uint32_t ulSimCycles;
+
+/*! \var typedef struct xSimSource SimSource_t
+	\brief Estado simulado de una fuente y de su tarea consumidora.
+*/
+typedef struct xSimSource {
+	const char *pcTaskName;
+	UBaseType_t uxPriority;
+	/* Número de TCB de la tarea (hooks de trace) */
+	uint32_t ulTaskNumber;
+	/* Próxima interrupción */
+	uint64_t ullNextIrq;
+	/* Bytes restantes de la ráfaga (UART) */
+	uint32_t ulBurst;
+	/* Tarea despertada y su instante de ejecución */
+	bool xTaskReady;
+	uint64_t ullTaskRun;
+	/* Primera interrupción no atendida */
+	bool xPending;
+	uint64_t ullPendingEntry;
+	/* Valores esperados */
+	uint32_t ulIrqs;
+	uint64_t ullIsrSum;
+	uint32_t ulIsrMin, ulIsrMax;
+	uint32_t ulRuns;
+	uint64_t ullTaskSum;
+	uint32_t ulTaskMin, ulTaskMax;
+	uint32_t pulHistogram[latencyHIST_BINS];
+	uint32_t ulWcet;
+} SimSource_t;
+
+/*! \var pxSim
+	\brief Fuentes simuladas, en el orden de LatencySource_t.
+*/
+static SimSource_t pxSim[latencySRC_NUM] = {
+	{ .pcTaskName = "EncoderTask", .uxPriority = 4, .ulTaskNumber = 1 },
+	{ .pcTaskName = "UartRxTask", .uxPriority = 5, .ulTaskNumber = 2 },
+};
+
+/*! \var ullSimNow
+	\brief Instante simulado en ciclos, sin desborde.
+*/
+static uint64_t ullSimNow;
+
+/*! \var ulSimSeed
+	\brief Estado del generador pseudoaleatorio.
+*/
+static uint32_t ulSimSeed = 12345;
+
+/*! \var ulSimMarkerEdges
+	\brief Flancos de subida del pin marcador, medidos y esperados
+	(interrupción sin ninguna fuente pendiente).
+*/
+static uint32_t ulSimMarkerEdges;
+static uint32_t ulSimMarkerLevel;
+static uint32_t ulSimMarkerExpected;
+
+void vSimMarker( uint32_t ulLevel )
+{
+	if ( ulLevel && !ulSimMarkerLevel ) {
+		ulSimMarkerEdges++;
+	}
+	ulSimMarkerLevel = ulLevel;
+}
+
+/* Funciones del kernel que usa el reporte */
+char *pcTaskGetName( TaskHandle_t xTaskToQuery )
+{
+	return ( char * ) ( ( SimSource_t * ) xTaskToQuery )->pcTaskName;
+}
+
+UBaseType_t uxTaskPriorityGet( const TaskHandle_t xTask )
+{
+	return ( ( SimSource_t * ) xTask )->uxPriority;
+}
+
+/*! \fn static uint32_t prvSimRandom( uint32_t ulMin, uint32_t ulMax )
+	\brief Valor pseudoaleatorio en [ulMin, ulMax].
+*/
+static uint32_t prvSimRandom( uint32_t ulMin, uint32_t ulMax )
+{
+	ulSimSeed = ulSimSeed * 1103515245UL + 12345UL;
+	return ulMin + ( ulSimSeed >> 8 ) % ( ulMax - ulMin + 1 );
+}
+
+/*! \fn static void prvSimSetTime( uint64_t ullTime )
+	\brief Avanzar el reloj simulado. Un evento que ocurre con la CPU
+	ocupada se atiende al terminar.
+*/
+static void prvSimSetTime( uint64_t ullTime )
+{
+	if ( ullTime > ullSimNow ) {
+		ullSimNow = ullTime;
+	}
+	ulSimCycles = ( uint32_t ) ullSimNow;
+}
+
+/*! \fn static void prvSimNextIrq( LatencySource_t xSource )
+	\brief Programar la próxima interrupción de la fuente.
+*/
+static void prvSimNextIrq( LatencySource_t xSource )
+{
+	SimSource_t *pxSource = &pxSim[xSource];
+
+	if ( xSource == latencySRC_ENCODER ) {
+		pxSource->ullNextIrq += prvSimRandom( 20000, 400000 );
+		return;
+	}
+	/* UART: bytes seguidos dentro de la ráfaga, luego una pausa */
+	if ( pxSource->ulBurst > 0 ) {
+		pxSource->ulBurst--;
+		pxSource->ullNextIrq += simUART_BYTE_CYCLES;
+	} else {
+		pxSource->ulBurst = prvSimRandom( 0, 23 );
+		pxSource->ullNextIrq += prvSimRandom( 200000, 2000000 );
+	}
+}
+
+/*! \fn static void prvSimIrq( LatencySource_t xSource )
+	\brief Interrupción: ISR instrumentada y tarea despertada.
+*/
+static void prvSimIrq( LatencySource_t xSource )
+{
+	SimSource_t *pxSource = &pxSim[xSource];
+	uint32_t ulIsrCycles = ( xSource == latencySRC_ENCODER ) ?
+		prvSimRandom( 150, 400 ) : prvSimRandom( 300, 800 );
+
+	prvSimSetTime( pxSource->ullNextIrq );
+	if ( !pxSim[0].xPending && !pxSim[1].xPending ) {
+		ulSimMarkerExpected++;
+	}
+	vLatencyIsrEntry( xSource );
+	if ( !pxSource->xPending ) {
+		pxSource->xPending = true;
+		pxSource->ullPendingEntry = ullSimNow;
+	}
+
+	prvSimSetTime( ullSimNow + ulIsrCycles );
+	vLatencyIsrYield( xSource );
+	pxSource->ulIrqs++;
+	pxSource->ullIsrSum += ulIsrCycles;
+	if ( ( pxSource->ulIrqs == 1 ) || ( ulIsrCycles < pxSource->ulIsrMin ) ) {
+		pxSource->ulIsrMin = ulIsrCycles;
+	}
+	if ( ulIsrCycles > pxSource->ulIsrMax ) {
+		pxSource->ulIsrMax = ulIsrCycles;
+	}
+
+	/* Cambio de contexto y, a veces, carga de los motores */
+	if ( !pxSource->xTaskReady ) {
+		pxSource->xTaskReady = true;
+		pxSource->ullTaskRun = ullSimNow + prvSimRandom( 100, 200 );
+		if ( prvSimRandom( 0, 9 ) < 3 ) {
+			pxSource->ullTaskRun += prvSimRandom( 0, 60000 );
+		}
+	}
+	prvSimNextIrq( xSource );
+}
+
+/*! \fn static void prvSimTask( LatencySource_t xSource )
+	\brief Ejecución de la tarea consumidora hasta bloquearse.
+*/
+static void prvSimTask( LatencySource_t xSource )
+{
+	SimSource_t *pxSource = &pxSim[xSource];
+	uint32_t ulCycles, ulWork = prvSimRandom( 800, 4000 );
+	uint8_t ucBin = 0;
+
+	prvSimSetTime( pxSource->ullTaskRun );
+	vLatencyTaskSwitchedIn( pxSource, pxSource->ulTaskNumber );
+	vLatencyTaskResume( xSource );
+	pxSource->xTaskReady = false;
+
+	ulCycles = ( uint32_t ) ( ullSimNow - pxSource->ullPendingEntry );
+	pxSource->xPending = false;
+	pxSource->ulRuns++;
+	pxSource->ullTaskSum += ulCycles;
+	if ( ( pxSource->ulRuns == 1 ) || ( ulCycles < pxSource->ulTaskMin ) ) {
+		pxSource->ulTaskMin = ulCycles;
+	}
+	if ( ulCycles > pxSource->ulTaskMax ) {
+		pxSource->ulTaskMax = ulCycles;
+	}
+	while ( ( ucBin < latencyHIST_BINS - 1 ) &&
+		( ( ulCycles >> ( latencyHIST_FIRST_BIT + 1 + ucBin ) ) != 0 ) ) {
+		ucBin++;
+	}
+	pxSource->pulHistogram[ucBin]++;
+
+	prvSimSetTime( ullSimNow + ulWork );
+	vLatencyTaskSwitchedOut( pxSource->ulTaskNumber, 1 );
+	if ( ulWork > pxSource->ulWcet ) {
+		pxSource->ulWcet = ulWork;
+	}
+}
+
+/*! \fn static void prvSimRun( void )
+	\brief Procesar en orden temporal las interrupciones y las
+	ejecuciones de tareas de ambas fuentes.
+*/
+static void prvSimRun( void )
+{
+	uint32_t ulIrqs = 0;
+	uint64_t ullNext;
+	int32_t lSource;
+	bool xIsTask;
+
+	ullSimNow = simCYCLES_START;
+	ulSimCycles = simCYCLES_START;
+	vLatencyInit();
+	for ( uint8_t i=0; i<latencySRC_NUM; i++ ) {
+		pxSim[i].ullNextIrq = simCYCLES_START + prvSimRandom( 1000, 50000 );
+	}
+
+	while ( ( ulIrqs < simINTERRUPTS ) || pxSim[0].xTaskReady || pxSim[1].xTaskReady ) {
+		ullNext = UINT64_MAX;
+		lSource = -1;
+		xIsTask = false;
+		for ( uint8_t i=0; i<latencySRC_NUM; i++ ) {
+			if ( pxSim[i].xTaskReady && ( pxSim[i].ullTaskRun < ullNext ) ) {
+				ullNext = pxSim[i].ullTaskRun;
+				lSource = i;
+				xIsTask = true;
+			}
+			if ( ( ulIrqs < simINTERRUPTS ) && ( pxSim[i].ullNextIrq < ullNext ) ) {
+				ullNext = pxSim[i].ullNextIrq;
+				lSource = i;
+				xIsTask = false;
+			}
+		}
+		if ( xIsTask ) {
+			prvSimTask( ( LatencySource_t ) lSource );
+		} else {
+			prvSimIrq( ( LatencySource_t ) lSource );
+			ulIrqs++;
+		}
+	}
+}
+
+int main( void )
+{
+	prvSimRun();
+	MINUT( true );
+	return 0;
+}
+
+/* El contador de ciclos dio la vuelta durante la simulación */
+TEST( cycle_counter_wrapped )
+{
+	ASSERT_EQ( true, ( ullSimNow > 0xFFFFFFFFULL ) &&
+		( xSimDwt.CTRL & DWT_CTRL_CYCCNTENA_Msk ) );
+}
+
+/* Cantidad, mínimo, promedio y máximo de la ISR */
+TEST( isr_stats )
+{
+	bool xOk = true;
+
+	for ( uint8_t i=0; i<latencySRC_NUM; i++ ) {
+		LatencyStats_t *pxStats = &pxLatencyData[i].xIsr;
+		xOk = xOk && ( pxStats->ulCount == pxSim[i].ulIrqs ) &&
+			( pxStats->ulMin == pxSim[i].ulIsrMin ) &&
+			( pxStats->ulMax == pxSim[i].ulIsrMax ) &&
+			( pxStats->ullSum == pxSim[i].ullIsrSum );
+	}
+	ASSERT_EQ( true, xOk );
+}
+
+/* Latencia total desde la primera interrupción no atendida */
+TEST( task_latency_stats )
+{
+	bool xOk = true;
+
+	for ( uint8_t i=0; i<latencySRC_NUM; i++ ) {
+		LatencyStats_t *pxStats = &pxLatencyData[i].xTask;
+		xOk = xOk && ( pxSim[i].ulRuns > 0 ) &&
+			( pxStats->ulCount == pxSim[i].ulRuns ) &&
+			( pxStats->ulMin == pxSim[i].ulTaskMin ) &&
+			( pxStats->ulMax == pxSim[i].ulTaskMax ) &&
+			( pxStats->ullSum == pxSim[i].ullTaskSum );
+	}
+	ASSERT_EQ( true, xOk );
+}
+
+/* Las ráfagas UART agrupan varias interrupciones por activación */
+TEST( uart_bursts_coalesced )
+{
+	ASSERT_EQ( true, pxSim[latencySRC_UART_RX].ulRuns < pxSim[latencySRC_UART_RX].ulIrqs );
+}
+
+/* Histograma en potencias de 2 */
+TEST( histogram )
+{
+	ASSERT_EQ( 0, memcmp( pxLatencyData[0].pulHistogram, pxSim[0].pulHistogram,
+		sizeof( pxSim[0].pulHistogram ) ) | memcmp( pxLatencyData[1].pulHistogram,
+		pxSim[1].pulHistogram, sizeof( pxSim[1].pulHistogram ) ) );
+}
+
+/* Marcador en alto mientras alguna fuente tenga una interrupción
+ * no atendida, en bajo al terminar */
+TEST( marker_pulses )
+{
+	ASSERT_EQ( true, ( ulSimMarkerEdges == ulSimMarkerExpected ) &&
+		( ulSimMarkerEdges < pxSim[0].ulRuns + pxSim[1].ulRuns ) &&
+		( ulSimMarkerLevel == 0 ) );
+}
+
+/* Tiempo de ejecución de peor caso de cada tarea (hooks de trace) */
+TEST( task_wcet )
+{
+	bool xOk = true;
+
+	for ( uint8_t i=0; i<latencySRC_NUM; i++ ) {
+		LatencyTask_t *pxTask = &pxLatencyTask[pxSim[i].ulTaskNumber];
+		xOk = xOk && ( pxTask->ulJobs == pxSim[i].ulRuns ) &&
+			( pxTask->ulWcet == pxSim[i].ulWcet );
+	}
+	ASSERT_EQ( true, xOk );
+}
+
+/* Reporte ":L" de la simulación, que reinicia las tablas */
+TEST( report_resets )
+{
+	vLatencyReport();
+	ASSERT_EQ( true, ( pxLatencyData[0].xTask.ulCount == 0 ) &&
+		( pxLatencyData[1].xIsr.ulCount == 0 ) &&
+		( pxLatencyTask[pxSim[0].ulTaskNumber].ulJobs == 0 ) );
+}
+
+MINUT_BEG
+	RUN( cycle_counter_wrapped() );
+	RUN( isr_stats() );
+	RUN( task_latency_stats() );
+	RUN( uart_bursts_coalesced() );
+	RUN( histogram() );
+	RUN( marker_pulses() );
+	RUN( task_wcet() );
+	RUN( report_resets() );
+MINUT_END
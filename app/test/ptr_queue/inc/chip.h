@@ -0,0 +1,15 @@
+/*! \file chip.h
+    \brief ptr_queue.c sólo usa los registros del núcleo en la
+    comparación del comando ":B" (APP_LATENCY), que no se compila en
+    la prueba del host (ptr_queue).
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+#ifndef CHIP_H_
+#define CHIP_H_
+
+#include <stdint.h>
+
+#endif /* CHIP_H_ */
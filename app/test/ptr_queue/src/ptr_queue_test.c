@@ -0,0 +1,462 @@
+/*! \file ptr_queue_test.c
+    \brief Pruebas de la cola de punteros (ptr_queue.c).
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Los semáforos binarios de la cola se reemplazan por un contador
+    que registra cada señalización y cada espera, y el tiempo por un
+    contador de ticks simulado. Una espera sobre un semáforo sin
+    señalizar ejecuta, si está configurada, la tarea del otro extremo
+    de la cola (prvOtherTask) antes de volver, como haría el
+    scheduler al bloquear a quien llama; si el semáforo sigue sin
+    señalizar se cumple el timeout. Se verifica el orden FIFO de las
+    escrituras y lecturas de N punteros a través de la vuelta del
+    arreglo, que los semáforos sólo se señalicen en las transiciones
+    vacía -> no vacía y llena -> no llena (más el pase de la señal de
+    un productor o consumidor que estuvo bloqueado), y los timeouts.
+*/
+
+/* Utilidades includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Aplicación includes */
+#include "ptr_queue.h"
+
+/* Pruebas includes */
+#include "minut.h"
+
+/*! \def testLENGTH
+	\brief Longitud de las colas de las pruebas.
+*/
+#define testLENGTH			4
+
+/*! \def testITEMS
+	\brief Elementos distintos que pasan por la cola en la prueba de
+	orden.
+*/
+#define testITEMS			1000
+
+/*! \def testMAX_SEMAPHORES
+	\brief Semáforos creados en una prueba (dos por cola).
+*/
+#define testMAX_SEMAPHORES	4
+
+/*! \var typedef struct xHostSemaphore HostSemaphore_t
+	\brief Estado de un semáforo binario.
+*/
+typedef struct xHostSemaphore {
+	QueueHandle_t xHandle;
+	UBaseType_t uxCount;
+	/* Llamadas a xSemaphoreGive() y xSemaphoreGiveFromISR() */
+	uint32_t ulGiven;
+	/* Esperas que encontraron el semáforo sin señalizar */
+	uint32_t ulBlocked;
+} HostSemaphore_t;
+
+/*! \var xKernel
+	\brief Semáforos creados y contador de ticks.
+*/
+static struct {
+	HostSemaphore_t pxSemaphore[ testMAX_SEMAPHORES ];
+	UBaseType_t uxSemaphores;
+	TickType_t xTickCount;
+} xKernel;
+
+/*! \var pxItems
+	\brief Elementos apuntados por los punteros de las pruebas.
+*/
+static uint32_t pxItems[ testITEMS ];
+
+/*! \var xQueueBuffer
+	\brief Memoria de la cola estática de las pruebas.
+*/
+static StaticPtrQueue_t xQueueBuffer;
+static void *pvQueueStorage[ testLENGTH ];
+
+/*! \var xOther
+	\brief Tarea del otro extremo de la cola, que se ejecuta mientras
+	quien llama espera un semáforo sin señalizar.
+*/
+static struct {
+	PtrQueueHandle_t xQueue;
+	/* Punteros que lee (consumidor) o escribe (productor) cada vez que
+	 * se ejecuta, 0 si no hay otra tarea */
+	UBaseType_t uxCount;
+	BaseType_t xProducer;
+	/* Próximo elemento a escribir o a leer */
+	uint32_t ulNext;
+	uint32_t ulRuns;
+	uint32_t ulOutOfOrder;
+} xOther;
+
+/* Kernel: semáforos binarios y ticks simulados */
+
+QueueHandle_t xQueueGenericCreateStatic( const UBaseType_t uxQueueLength,
+	const UBaseType_t uxItemSize, uint8_t *pucQueueStorage, StaticQueue_t *pxStaticQueue,
+	const uint8_t ucQueueType )
+{
+	HostSemaphore_t *pxSemaphore = &xKernel.pxSemaphore[ xKernel.uxSemaphores++ ];
+
+	configASSERT( xKernel.uxSemaphores <= testMAX_SEMAPHORES );
+	configASSERT( ucQueueType == queueQUEUE_TYPE_BINARY_SEMAPHORE );
+	pxSemaphore->xHandle = ( QueueHandle_t ) pxStaticQueue;
+	pxSemaphore->uxCount = 0;
+	return pxSemaphore->xHandle;
+}
+
+/*! \fn static HostSemaphore_t *prvSemaphore( QueueHandle_t xHandle )
+	\brief Estado del semáforo de un handle.
+*/
+static HostSemaphore_t *prvSemaphore( QueueHandle_t xHandle )
+{
+	for ( UBaseType_t i=0; i<xKernel.uxSemaphores; i++ ) {
+		if ( xKernel.pxSemaphore[i].xHandle == xHandle ) {
+			return &xKernel.pxSemaphore[i];
+		}
+	}
+	configASSERT( 0 );
+	return NULL;
+}
+
+BaseType_t xQueueGenericSend( QueueHandle_t xQueue, const void * const pvItemToQueue,
+	TickType_t xTicksToWait, const BaseType_t xCopyPosition )
+{
+	HostSemaphore_t *pxSemaphore = prvSemaphore( xQueue );
+
+	pxSemaphore->ulGiven++;
+	if ( pxSemaphore->uxCount == 1 ) {
+		return errQUEUE_FULL;
+	}
+	pxSemaphore->uxCount = 1;
+	return pdPASS;
+}
+
+BaseType_t xQueueGiveFromISR( QueueHandle_t xQueue, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+	BaseType_t xResult = xQueueGenericSend( xQueue, NULL, 0, queueSEND_TO_BACK );
+
+	if ( xResult == pdPASS ) {
+		*pxHigherPriorityTaskWoken = pdTRUE;
+	}
+	return xResult;
+}
+
+/*! \fn static void prvOtherTask( void )
+	\brief Leer o escribir xOther.uxCount punteros sin bloquear.
+*/
+static void prvOtherTask( void )
+{
+	void *pvRead[ testLENGTH ], *pvWrite[ testLENGTH ];
+	UBaseType_t uxCount;
+
+	xOther.ulRuns++;
+	if ( xOther.xProducer ) {
+		for ( UBaseType_t i=0; i<xOther.uxCount; i++ ) {
+			pvWrite[i] = &pxItems[ xOther.ulNext + i ];
+		}
+		xOther.ulNext += uxPtrQueueSendToBackBulk( xOther.xQueue, pvWrite, xOther.uxCount, 0 );
+	} else {
+		uxCount = uxPtrQueueReceiveBulk( xOther.xQueue, pvRead, xOther.uxCount, 0 );
+		for ( UBaseType_t i=0; i<uxCount; i++ ) {
+			if ( pvRead[i] != &pxItems[ xOther.ulNext++ ] ) {
+				xOther.ulOutOfOrder++;
+			}
+		}
+	}
+}
+
+BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue, TickType_t xTicksToWait )
+{
+	HostSemaphore_t *pxSemaphore = prvSemaphore( xQueue );
+
+	if ( pxSemaphore->uxCount == 0 ) {
+		pxSemaphore->ulBlocked++;
+		if ( xOther.uxCount > 0 ) {
+			prvOtherTask();
+		}
+	}
+	if ( pxSemaphore->uxCount == 0 ) {
+		/* Sin otra tarea la espera termina por timeout */
+		configASSERT( xTicksToWait != portMAX_DELAY );
+		xKernel.xTickCount += xTicksToWait;
+		return pdFALSE;
+	}
+	pxSemaphore->uxCount = 0;
+	return pdTRUE;
+}
+
+void vTaskSetTimeOutState( TimeOut_t * const pxTimeOut )
+{
+	pxTimeOut->xOverflowCount = 0;
+	pxTimeOut->xTimeOnEntering = xKernel.xTickCount;
+}
+
+BaseType_t xTaskCheckForTimeOut( TimeOut_t * const pxTimeOut, TickType_t * const pxTicksToWait )
+{
+	TickType_t xElapsed = xKernel.xTickCount - pxTimeOut->xTimeOnEntering;
+
+	if ( *pxTicksToWait == portMAX_DELAY ) {
+		return pdFALSE;
+	}
+	if ( xElapsed < *pxTicksToWait ) {
+		*pxTicksToWait -= xElapsed;
+		vTaskSetTimeOutState( pxTimeOut );
+		return pdFALSE;
+	}
+	*pxTicksToWait = 0;
+	return pdTRUE;
+}
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+	return malloc( xWantedSize );
+}
+
+/*! \fn static PtrQueueHandle_t prvSetup( void )
+	\brief Cola estática de testLENGTH punteros vacía, sin otra tarea
+	y con los elementos numerados.
+*/
+static PtrQueueHandle_t prvSetup( void )
+{
+	memset( &xKernel, 0, sizeof( xKernel ) );
+	memset( &xOther, 0, sizeof( xOther ) );
+	for ( uint32_t i=0; i<testITEMS; i++ ) {
+		pxItems[i] = i;
+	}
+	xOther.xQueue = xPtrQueueCreateStatic( testLENGTH, pvQueueStorage, &xQueueBuffer );
+	return xOther.xQueue;
+}
+
+/*! \fn static HostSemaphore_t *prvItems( PtrQueueHandle_t xQueue )
+	\brief Semáforo de cola no vacía.
+*/
+static HostSemaphore_t *prvItems( PtrQueueHandle_t xQueue )
+{
+	return prvSemaphore( xQueue->xItemsAvailable );
+}
+
+/*! \fn static HostSemaphore_t *prvSpace( PtrQueueHandle_t xQueue )
+	\brief Semáforo de cola no llena.
+*/
+static HostSemaphore_t *prvSpace( PtrQueueHandle_t xQueue )
+{
+	return prvSemaphore( xQueue->xSpaceAvailable );
+}
+
+int main( void )
+{
+	MINUT( true );
+	return 0;
+}
+
+/* Escrituras y lecturas de 1 a N punteros, de tarea y de ISR, en
+ * orden a través de la vuelta del arreglo y sin esperar semáforos */
+TEST( bulk_fifo_wrap )
+{
+	PtrQueueHandle_t xQueue;
+	void *pvWrite[ 7 ], *pvRead[ 7 ], *pvItem;
+	uint32_t ulSent = 0, ulReceived = 0, ulOutOfOrder = 0, ulWrongCount = 0;
+	UBaseType_t uxCount, uxLength = 7;
+	BaseType_t xWoken = pdFALSE;
+
+	memset( &xKernel, 0, sizeof( xKernel ) );
+	xQueue = xPtrQueueCreate( uxLength );
+
+	for ( uint32_t i=0; ulReceived<testITEMS; i++ ) {
+		/* Escritura de 1 a 5 punteros, recortada al lugar libre */
+		uxCount = 1 + i % 5;
+		if ( uxCount > testITEMS - ulSent ) {
+			uxCount = testITEMS - ulSent;
+		}
+		if ( i % 3 == 2 ) {
+			uxCount = ( uxCount > 0 ) &&
+				( xPtrQueueSendToBackFromISR( xQueue, &( void * ) { &pxItems[ ulSent ] },
+					&xWoken ) == pdPASS ) ? 1 : 0;
+		} else {
+			for ( UBaseType_t j=0; j<uxCount; j++ ) {
+				pvWrite[j] = &pxItems[ ulSent + j ];
+			}
+			uxCount = uxPtrQueueSendToBackBulk( xQueue, pvWrite, uxCount, 0 );
+		}
+		ulSent += uxCount;
+
+		/* Lectura de 1 a 4 punteros */
+		if ( i % 4 == 3 ) {
+			uxCount = ( xPtrQueueReceiveFromISR( xQueue, &pvItem, &xWoken ) == pdPASS ) ? 1 : 0;
+			pvRead[0] = pvItem;
+		} else if ( i % 4 == 2 ) {
+			uxCount = ( xPtrQueueReceive( xQueue, &pvItem, 0 ) == pdPASS ) ? 1 : 0;
+			pvRead[0] = pvItem;
+		} else {
+			uxCount = uxPtrQueueReceiveBulk( xQueue, pvRead, 1 + i % 4, 0 );
+		}
+		for ( UBaseType_t j=0; j<uxCount; j++ ) {
+			if ( pvRead[j] != &pxItems[ ulReceived++ ] ) {
+				ulOutOfOrder++;
+			}
+		}
+		if ( uxPtrQueueMessagesWaiting( xQueue ) != ulSent - ulReceived ) {
+			ulWrongCount++;
+		}
+	}
+
+	ASSERT_EQ( true, ( ulSent == testITEMS ) && ( ulOutOfOrder == 0 ) &&
+		( ulWrongCount == 0 ) && ( prvItems( xQueue )->ulBlocked == 0 ) &&
+		( prvSpace( xQueue )->ulBlocked == 0 ) && ( xKernel.xTickCount == 0 ) );
+	free( xQueue );
+}
+
+/* Semáforos señalizados sólo al pasar de vacía a no vacía y de llena
+ * a no llena, desde tarea y desde ISR */
+TEST( signal_transitions )
+{
+	PtrQueueHandle_t xQueue = prvSetup();
+	void *pvWrite[ testLENGTH ], *pvRead[ testLENGTH ], *pvItem;
+	uint32_t ulItemsBurst, ulSpaceFill, ulSpaceBurst, ulItemsDrain;
+	BaseType_t xFull, xEmpty, xInOrder = pdTRUE;
+	BaseType_t xWokenBurst = pdFALSE, xWokenDrain = pdFALSE, xWokenEmpty = pdFALSE,
+		xWokenFull = pdFALSE;
+	UBaseType_t uxOver;
+
+	for ( UBaseType_t i=0; i<testLENGTH; i++ ) {
+		pvWrite[i] = &pxItems[i];
+	}
+
+	/* Vacía -> no vacía una vez en cuatro escrituras */
+	xPtrQueueSendToBack( xQueue, &pvWrite[0], 0 );
+	uxPtrQueueSendToBackBulk( xQueue, &pvWrite[1], 2, 0 );
+	xPtrQueueSendToBackFromISR( xQueue, &pvWrite[3], &xWokenBurst );
+	ulItemsBurst = prvItems( xQueue )->ulGiven;
+	ulSpaceFill = prvSpace( xQueue )->ulGiven;
+	xFull = xPtrQueueSendToBack( xQueue, &pvWrite[0], 0 );
+
+	/* Llena -> no llena una vez en cuatro lecturas */
+	xPtrQueueReceive( xQueue, &pvRead[0], 0 );
+	uxPtrQueueReceiveBulk( xQueue, &pvRead[1], 2, 0 );
+	xPtrQueueReceiveFromISR( xQueue, &pvRead[3], &xWokenDrain );
+	ulSpaceBurst = prvSpace( xQueue )->ulGiven;
+	ulItemsDrain = prvItems( xQueue )->ulGiven;
+	xEmpty = xPtrQueueReceive( xQueue, &pvItem, 0 );
+	for ( UBaseType_t i=0; i<testLENGTH; i++ ) {
+		if ( pvRead[i] != pvWrite[i] ) {
+			xInOrder = pdFALSE;
+		}
+	}
+
+	/* Desde ISR sobre la cola vacía, y de nuevo llena desde ISR, con
+	 * las señales anteriores ya tomadas por tareas en espera */
+	prvItems( xQueue )->uxCount = 0;
+	prvSpace( xQueue )->uxCount = 0;
+	xPtrQueueSendToBackFromISR( xQueue, &pvWrite[0], &xWokenEmpty );
+	uxOver = uxPtrQueueSendToBackBulk( xQueue, pvWrite, testLENGTH, 0 );
+	xPtrQueueReceiveFromISR( xQueue, &pvItem, &xWokenFull );
+
+	ASSERT_EQ( true, ( ulItemsBurst == 1 ) && ( ulSpaceFill == 0 ) &&
+		( xFull == errQUEUE_FULL ) && ( ulSpaceBurst == 1 ) && ( ulItemsDrain == 1 ) &&
+		( xEmpty == errQUEUE_EMPTY ) && xInOrder && ( xWokenBurst == pdFALSE ) &&
+		( xWokenDrain == pdFALSE ) && ( xWokenEmpty == pdTRUE ) && ( xWokenFull == pdTRUE ) &&
+		( uxOver == testLENGTH - 1 ) && ( prvItems( xQueue )->ulGiven == 2 ) &&
+		( prvSpace( xQueue )->ulGiven == 2 ) );
+}
+
+/* Un productor que escribe más punteros que la longitud espera a que
+ * el consumidor lea, y pasa la señal de lugar si al terminar sobra */
+TEST( blocked_producer )
+{
+	PtrQueueHandle_t xQueue = prvSetup();
+	void *pvWrite[ 11 ];
+	UBaseType_t uxSent, uxHandover;
+	uint32_t ulRuns, ulSpaceGiven;
+
+	for ( UBaseType_t i=0; i<11; i++ ) {
+		pvWrite[i] = &pxItems[i];
+	}
+	/* 10 punteros en una cola de 4: el consumidor lee 3 cada vez que
+	 * el productor espera lugar */
+	xOther.uxCount = 3;
+	uxSent = uxPtrQueueSendToBackBulk( xQueue, pvWrite, 10, portMAX_DELAY );
+	ulRuns = xOther.ulRuns;
+	ulSpaceGiven = prvSpace( xQueue )->ulGiven;
+
+	/* Con la cola llena escribe 1 de los 3 lugares liberados y deja la
+	 * señal para otro productor */
+	uxHandover = uxPtrQueueSendToBackBulk( xQueue, &pvWrite[10], 1, portMAX_DELAY );
+
+	ASSERT_EQ( true, ( uxSent == 10 ) && ( ulRuns == 2 ) && ( ulSpaceGiven == 2 ) &&
+		( uxHandover == 1 ) && ( xOther.ulRuns == 3 ) && ( xOther.ulOutOfOrder == 0 ) &&
+		( xOther.ulNext == 9 ) && ( prvSpace( xQueue )->ulBlocked == 3 ) &&
+		( prvSpace( xQueue )->ulGiven == 4 ) && ( prvSpace( xQueue )->uxCount == 1 ) &&
+		( uxPtrQueueMessagesWaiting( xQueue ) == 2 ) );
+}
+
+/* Un consumidor sobre la cola vacía espera al productor, y pasa la
+ * señal de elementos si no lee todos */
+TEST( blocked_consumer )
+{
+	PtrQueueHandle_t xQueue = prvSetup();
+	void *pvRead[ 8 ];
+	UBaseType_t uxFirst, uxSecond;
+	uint32_t ulItemsGiven;
+	BaseType_t xInOrder;
+
+	xOther.xProducer = pdTRUE;
+	xOther.uxCount = 3;
+	uxFirst = uxPtrQueueReceiveBulk( xQueue, pvRead, 8, portMAX_DELAY );
+	xInOrder = ( pvRead[0] == &pxItems[0] ) && ( pvRead[2] == &pxItems[2] );
+	ulItemsGiven = prvItems( xQueue )->ulGiven;
+
+	/* Lee 2 de los 3 escritos y deja la señal para otro consumidor */
+	uxSecond = uxPtrQueueReceiveBulk( xQueue, pvRead, 2, portMAX_DELAY );
+	xInOrder = xInOrder && ( pvRead[0] == &pxItems[3] ) && ( pvRead[1] == &pxItems[4] );
+
+	ASSERT_EQ( true, ( uxFirst == 3 ) && ( ulItemsGiven == 1 ) && ( uxSecond == 2 ) &&
+		xInOrder && ( xOther.ulRuns == 2 ) && ( prvItems( xQueue )->ulBlocked == 2 ) &&
+		( prvItems( xQueue )->ulGiven == 3 ) && ( prvItems( xQueue )->uxCount == 1 ) &&
+		( uxPtrQueueMessagesWaiting( xQueue ) == 1 ) );
+}
+
+/* Sin otra tarea las esperas se cumplen en xTicksToWait ticks y una
+ * escritura de N punteros devuelve los que entraron */
+TEST( timeouts )
+{
+	PtrQueueHandle_t xQueue = prvSetup();
+	void *pvWrite[ 6 ], *pvRead[ 6 ];
+	BaseType_t xFull, xEmpty;
+	UBaseType_t uxFullBulk, uxPartial;
+	TickType_t xFullTicks, xEmptyTicks;
+
+	for ( UBaseType_t i=0; i<6; i++ ) {
+		pvWrite[i] = &pxItems[i];
+	}
+	uxPtrQueueSendToBackBulk( xQueue, pvWrite, testLENGTH, 0 );
+	xFull = xPtrQueueSendToBack( xQueue, &pvWrite[4], 10 );
+	uxFullBulk = uxPtrQueueSendToBackBulk( xQueue, &pvWrite[4], 2, 5 );
+	xFullTicks = xKernel.xTickCount;
+
+	uxPtrQueueReceiveBulk( xQueue, pvRead, testLENGTH, 0 );
+	xEmpty = xPtrQueueReceive( xQueue, &pvRead[0], 7 );
+	xEmptyTicks = xKernel.xTickCount;
+
+	uxPartial = uxPtrQueueSendToBackBulk( xQueue, pvWrite, 6, 5 );
+
+	ASSERT_EQ( true, ( xFull == errQUEUE_FULL ) && ( uxFullBulk == 0 ) &&
+		( xFullTicks == 15 ) && ( xEmpty == errQUEUE_EMPTY ) && ( xEmptyTicks == 22 ) &&
+		( uxPartial == testLENGTH ) && ( xKernel.xTickCount == 27 ) );
+}
+
+MINUT_BEG
+	RUN( bulk_fifo_wrap() );
+	RUN( signal_transitions() );
+	RUN( blocked_producer() );
+	RUN( blocked_consumer() );
+	RUN( timeouts() );
+MINUT_END
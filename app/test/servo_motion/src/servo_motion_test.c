@@ -0,0 +1,335 @@
+/*! \file servo_motion_test.c
+    \brief Pruebas de los cálculos del servomotor (servo_motion.c).
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    El ancho de pulso de cada grado se compara con la interpolación
+    en punto flotante para las calibraciones por defecto, del rango
+    completo del SG90 y los límites de ":XC", con el SCT a 204 MHz y
+    a otras frecuencias. La rampa se ejecuta frame a frame con los
+    límites de ":XV" convertidos como en prvServoSetAngle y se
+    verifican la velocidad, la aceleración (incluido el frenado final),
+    la llegada sin pasar el destino y la duración que espera servo.c.
+*/
+
+/* Utilidades includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+/* Aplicación includes */
+#include "servo_motion.h"
+
+/* Pruebas includes */
+#include "minut.h"
+
+/*! \def testTICKS_PER_FRAME
+	\brief Ticks del SCT en un frame de 20 ms a 204 MHz.
+*/
+#define testTICKS_PER_FRAME		4080000UL
+
+/*! \var pxCalibration
+	\brief Pulsos de 0° y 180° en us.
+*/
+static const uint32_t pxCalibration[][2] = {
+	{ 1000, 2000 },		/* servoPULSE_MIN_US, servoPULSE_MAX_US */
+	{ 500, 2400 },		/* ":XC500,2400" */
+	{ 400, 2600 },		/* servoPULSE_LIMIT_MIN_US, servoPULSE_LIMIT_MAX_US */
+	{ 1500, 1501 },		/* rango mínimo */
+};
+
+/*! \var pulFrameTicks
+	\brief Ticks por frame del SCT a 204, 96 y 12 MHz y un contador
+	que usa los 32 bits.
+*/
+static const uint32_t pulFrameTicks[] = {
+	testTICKS_PER_FRAME, 1920000UL, 240000UL, 0xFFFFFFFFUL
+};
+
+/*! \def testSPAN_TICKS
+	\brief Ticks del recorrido completo con la calibración por defecto
+	(1000 a 2000 us) a 204 MHz.
+*/
+#define testSPAN_TICKS			204000L
+
+/*! \def testFRAME_LIMIT
+	\brief Frames máximos de una rampa antes de darla por bloqueada.
+*/
+#define testFRAME_LIMIT			1000000UL
+
+/*! \var plVelocityDps
+	\brief Velocidades de ":XV" en °/s, hasta servoVELOCITY_LIMIT_DPS.
+*/
+static const int32_t plVelocityDps[] = { 1, 30, 180, 1000 };
+
+/*! \var plAccelDps2
+	\brief Aceleraciones de ":XV" en °/s², hasta servoACCEL_LIMIT_DPS2.
+*/
+static const int32_t plAccelDps2[] = { 1, 100, 1000, 10000 };
+
+/*! \var plDistance
+	\brief Recorridos en ticks: de un tick al recorrido completo en
+	ambos sentidos.
+*/
+static const int32_t plDistance[] = {
+	0, 1, 2, 3, 204, 1133, testSPAN_TICKS / 2, testSPAN_TICKS,
+	-1, -204, -testSPAN_TICKS
+};
+
+/*! \var typedef struct xRampStats RampStats_t
+	\brief Resultado de una rampa simulada.
+*/
+typedef struct xRampStats {
+	uint32_t ulFrames;
+	/* Mayor desplazamiento y mayor cambio de desplazamiento por frame */
+	int32_t lSpeedMax;
+	int32_t lAccelMax;
+	/* Mayor distancia más allá del destino */
+	int32_t lOvershoot;
+	BaseType_t xArrived;
+} RampStats_t;
+
+#define testARRAY_LENGTH( x )	( sizeof( x ) / sizeof( ( x )[0] ) )
+
+/*! \fn static double prvReference( uint32_t ulAngle, uint32_t ulMinUs, uint32_t ulMaxUs, uint32_t ulFrame )
+	\brief Ancho de pulso exacto en ticks (sin redondear).
+*/
+static double prvReference( uint32_t ulAngle, uint32_t ulMinUs, uint32_t ulMaxUs,
+	uint32_t ulFrame )
+{
+	double dPulseUs = ulMinUs + ( double ) ( ulMaxUs - ulMinUs ) * ulAngle / servoANGLE_MAX;
+
+	return dPulseUs * ulFrame / ( servoPWM_PERIOD * 1000.0 );
+}
+
+/*! \fn static void prvRampLimits( int32_t lVelocityDps, int32_t lAccelDps2, ServoRamp_t *pxRamp )
+	\brief Límites de la rampa en ticks como en prvServoSetAngle.
+*/
+static void prvRampLimits( int32_t lVelocityDps, int32_t lAccelDps2, ServoRamp_t *pxRamp )
+{
+	int32_t lRate = 1000 / servoPWM_PERIOD;
+
+	pxRamp->lVelocityMax = ( int64_t ) testSPAN_TICKS * lVelocityDps / ( servoANGLE_MAX * lRate );
+	pxRamp->lAccel = ( int64_t ) testSPAN_TICKS * lAccelDps2 / ( servoANGLE_MAX * lRate * lRate );
+	pxRamp->lVelocityMax = ( pxRamp->lVelocityMax == 0 ) ? 1 : pxRamp->lVelocityMax;
+	pxRamp->lAccel = ( pxRamp->lAccel == 0 ) ? 1 : pxRamp->lAccel;
+}
+
+/*! \fn static void prvRampRun( ServoRamp_t *pxRamp, uint32_t ulFrames, RampStats_t *pxStats )
+	\brief Avanzar la rampa hasta la llegada o ulFrames frames. El
+	desplazamiento de cada frame es la velocidad aplicada y tras la
+	llegada es cero.
+*/
+static void prvRampRun( ServoRamp_t *pxRamp, uint32_t ulFrames, RampStats_t *pxStats )
+{
+	int32_t lMove, lPrevious;
+	int32_t lStart = pxRamp->lPosition;
+	int32_t lLastMove = pxRamp->lVelocity;
+	int32_t lPast;
+
+	while ( ( pxStats->xArrived == pdFALSE ) && ( ulFrames-- > 0 ) ) {
+		lPrevious = pxRamp->lPosition;
+		pxStats->xArrived = xServoRampStep( pxRamp );
+		pxStats->ulFrames++;
+
+		lMove = pxRamp->lPosition - lPrevious;
+		if ( labs( lMove ) > pxStats->lSpeedMax ) {
+			pxStats->lSpeedMax = labs( lMove );
+		}
+		if ( labs( lMove - lLastMove ) > pxStats->lAccelMax ) {
+			pxStats->lAccelMax = labs( lMove - lLastMove );
+		}
+		lLastMove = lMove;
+
+		lPast = ( pxRamp->lTarget >= lStart ) ? pxRamp->lPosition - pxRamp->lTarget :
+			pxRamp->lTarget - pxRamp->lPosition;
+		if ( lPast > pxStats->lOvershoot ) {
+			pxStats->lOvershoot = lPast;
+		}
+	}
+	/* Frenado a cero después del último frame */
+	if ( pxStats->xArrived && ( labs( lLastMove ) > pxStats->lAccelMax ) ) {
+		pxStats->lAccelMax = labs( lLastMove );
+	}
+}
+
+int main( void )
+{
+	MINUT( true );
+	return 0;
+}
+
+/* Cada grado queda a menos de medio tick del pulso exacto */
+TEST( every_degree_rounded )
+{
+	double dError, dMaxError = 0;
+
+	for ( uint32_t c=0; c<testARRAY_LENGTH( pxCalibration ); c++ ) {
+		for ( uint32_t f=0; f<testARRAY_LENGTH( pulFrameTicks ); f++ ) {
+			for ( uint32_t a=servoANGLE_MIN; a<=servoANGLE_MAX; a++ ) {
+				dError = fabs( ulServoAngleToTicks( a, pxCalibration[c][0],
+					pxCalibration[c][1], pulFrameTicks[f] ) -
+					prvReference( a, pxCalibration[c][0], pxCalibration[c][1],
+					pulFrameTicks[f] ) );
+				if ( dError > dMaxError ) {
+					dMaxError = dError;
+				}
+			}
+		}
+	}
+	printf( "SRV: max error %.4f ticks\n", dMaxError );
+	ASSERT_EQ( true, dMaxError <= 0.5 );
+}
+
+/* Los extremos son exactamente los pulsos calibrados */
+TEST( endpoints_exact )
+{
+	bool xOk = true;
+
+	for ( uint32_t c=0; c<testARRAY_LENGTH( pxCalibration ); c++ ) {
+		xOk = xOk && ( ulServoAngleToTicks( servoANGLE_MIN, pxCalibration[c][0],
+			pxCalibration[c][1], testTICKS_PER_FRAME ) == pxCalibration[c][0] * 204 ) &&
+			( ulServoAngleToTicks( servoANGLE_MAX, pxCalibration[c][0],
+			pxCalibration[c][1], testTICKS_PER_FRAME ) == pxCalibration[c][1] * 204 );
+	}
+	ASSERT_EQ( true, xOk );
+}
+
+/* A 204 MHz cada grado mueve el pulso (sin cuantizar el ángulo) */
+TEST( strictly_increasing )
+{
+	bool xOk = true;
+	uint32_t ulPrevious, ulTicks;
+
+	for ( uint32_t c=0; c<testARRAY_LENGTH( pxCalibration ) - 1; c++ ) {
+		ulPrevious = ulServoAngleToTicks( servoANGLE_MIN, pxCalibration[c][0],
+			pxCalibration[c][1], testTICKS_PER_FRAME );
+		for ( uint32_t a=servoANGLE_MIN + 1; a<=servoANGLE_MAX; a++ ) {
+			ulTicks = ulServoAngleToTicks( a, pxCalibration[c][0],
+				pxCalibration[c][1], testTICKS_PER_FRAME );
+			xOk = xOk && ( ulTicks > ulPrevious );
+			ulPrevious = ulTicks;
+		}
+	}
+	ASSERT_EQ( true, xOk );
+}
+
+/* El pulso por defecto a 90° es 1.5 ms */
+TEST( default_center )
+{
+	ASSERT_EQ( 1500UL * 204, ulServoAngleToTicks( 90, 1000, 2000, testTICKS_PER_FRAME ) );
+}
+
+/* Desde reposo: velocidad y aceleración dentro de los límites, sin
+ * pasar el destino y en los frames que espera prvServoSetAngle */
+TEST( ramp_from_rest )
+{
+	bool xOk = true;
+	ServoRamp_t xRamp;
+	RampStats_t xStats;
+	uint32_t ulBound;
+
+	for ( uint32_t v=0; v<testARRAY_LENGTH( plVelocityDps ); v++ ) {
+		for ( uint32_t a=0; a<testARRAY_LENGTH( plAccelDps2 ); a++ ) {
+			for ( uint32_t d=0; d<testARRAY_LENGTH( plDistance ); d++ ) {
+				memset( &xRamp, 0, sizeof( xRamp ) );
+				memset( &xStats, 0, sizeof( xStats ) );
+				prvRampLimits( plVelocityDps[v], plAccelDps2[a], &xRamp );
+				xRamp.lTarget = plDistance[d];
+				prvRampRun( &xRamp, testFRAME_LIMIT, &xStats );
+
+				/* Sin el frame de latencia de prvServoSetAngle */
+				ulBound = labs( plDistance[d] ) / xRamp.lVelocityMax +
+					xRamp.lVelocityMax / xRamp.lAccel + 1;
+				xOk = xOk && xStats.xArrived && ( xRamp.lPosition == xRamp.lTarget ) &&
+					( xRamp.lVelocity == 0 ) &&
+					( xStats.lSpeedMax <= xRamp.lVelocityMax ) &&
+					( xStats.lAccelMax <= xRamp.lAccel ) &&
+					( xStats.lOvershoot == 0 ) && ( xStats.ulFrames <= ulBound );
+			}
+		}
+	}
+	ASSERT_EQ( true, xOk );
+}
+
+/* Nuevo destino en sentido contrario durante el movimiento: puede
+ * pasar el destino pero nunca supera los límites */
+TEST( ramp_retarget )
+{
+	bool xOk = true;
+	ServoRamp_t xRamp;
+	RampStats_t xStats;
+
+	for ( uint32_t v=0; v<testARRAY_LENGTH( plVelocityDps ); v++ ) {
+		for ( uint32_t a=0; a<testARRAY_LENGTH( plAccelDps2 ); a++ ) {
+			for ( uint32_t f=1; f<=64; f*=4 ) {
+				memset( &xRamp, 0, sizeof( xRamp ) );
+				memset( &xStats, 0, sizeof( xStats ) );
+				prvRampLimits( plVelocityDps[v], plAccelDps2[a], &xRamp );
+				xRamp.lTarget = testSPAN_TICKS;
+				prvRampRun( &xRamp, f, &xStats );
+				xRamp.lTarget = xRamp.lPosition / 2;
+				xStats.xArrived = pdFALSE;
+				prvRampRun( &xRamp, testFRAME_LIMIT, &xStats );
+
+				xOk = xOk && xStats.xArrived && ( xRamp.lPosition == xRamp.lTarget ) &&
+					( xStats.lSpeedMax <= xRamp.lVelocityMax ) &&
+					( xStats.lAccelMax <= xRamp.lAccel );
+			}
+		}
+	}
+	ASSERT_EQ( true, xOk );
+}
+
+/* Velocidad máxima reducida durante el movimiento: frena con la
+ * aceleración hasta el nuevo límite */
+TEST( ramp_limit_lowered )
+{
+	ServoRamp_t xRamp;
+	RampStats_t xStats;
+	int32_t lVelocityMax;
+	int32_t lPrevious = 0;
+	bool xOk = true;
+
+	memset( &xRamp, 0, sizeof( xRamp ) );
+	memset( &xStats, 0, sizeof( xStats ) );
+	prvRampLimits( 1000, 100, &xRamp );
+	xRamp.lTarget = testSPAN_TICKS * 10;
+	prvRampRun( &xRamp, 100, &xStats );
+	lVelocityMax = xRamp.lVelocityMax;
+	prvRampLimits( 30, 100, &xRamp );
+
+	for ( uint32_t i=0; ( i<1000 ) && xOk; i++ ) {
+		lPrevious = xRamp.lVelocity;
+		xServoRampStep( &xRamp );
+		xOk = ( lPrevious - xRamp.lVelocity <= xRamp.lAccel ) &&
+			( ( xRamp.lVelocity <= xRamp.lVelocityMax ) ||
+			( xRamp.lVelocity == lPrevious - xRamp.lAccel ) );
+	}
+	ASSERT_EQ( true, xOk && ( lVelocityMax > xRamp.lVelocityMax ) &&
+		( xRamp.lVelocity == xRamp.lVelocityMax ) );
+}
+
+/* Sin límites: salto al destino en un frame */
+TEST( ramp_no_limits )
+{
+	ServoRamp_t xRamp = { 0, 0, testSPAN_TICKS, 0, 0, pdTRUE };
+	BaseType_t xArrived = xServoRampStep( &xRamp );
+
+	ASSERT_EQ( true, xArrived && ( xRamp.lPosition == testSPAN_TICKS ) &&
+		( xRamp.lVelocity == 0 ) );
+}
+
+MINUT_BEG
+	RUN( every_degree_rounded() );
+	RUN( endpoints_exact() );
+	RUN( strictly_increasing() );
+	RUN( default_center() );
+	RUN( ramp_from_rest() );
+	RUN( ramp_retarget() );
+	RUN( ramp_limit_lowered() );
+	RUN( ramp_no_limits() );
+MINUT_END
@@ -0,0 +1,329 @@
+/*! \file spsc_ring_test.c
+    \brief Prueba del buffer circular de un productor y un consumidor
+    (spsc_ring.c) con un hilo productor y un hilo consumidor.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+
+    Las notificaciones de tarea se reemplazan por un contador con
+    mutex y variable de condición por hilo, con la misma semántica
+    que ulTaskNotifyTake() y vTaskNotifyGiveFromISR(). Se verifica que
+    el consumidor reciba cada byte una vez y en orden mientras los
+    índices pasan por 0xFFFFFFFF, que nunca quede bloqueado con datos
+    en el buffer (notificación perdida), que sólo se notifique en la
+    transición de vacío a no vacío y que una escritura sin lugar no
+    escriba nada.
+*/
+
+/* Utilidades includes */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Aplicación includes */
+#include "spsc_ring.h"
+
+/* Pruebas includes */
+#include "minut.h"
+
+/*! \def testRING_SIZE
+	\brief Tamaño del buffer: chico, para que productor y consumidor
+	lo encuentren lleno y vacío a menudo.
+*/
+#define testRING_SIZE		64
+
+/*! \def testBYTES
+	\brief Bytes que pasan del productor al consumidor.
+*/
+#define testBYTES			( 1UL << 22 )
+
+/*! \def testINDEX_START
+	\brief Índices iniciales, para pasar por 0xFFFFFFFF.
+*/
+#define testINDEX_START		0xFFFFF000UL
+
+/*! \def testWAIT_MS
+	\brief Espera máxima del consumidor. El productor sólo deja de
+	escribir esperando que el consumidor vacíe el buffer, así que
+	cumplirla es una notificación perdida.
+*/
+#define testWAIT_MS			500
+
+/*! \def testDRAIN_BLOCKS
+	\brief Bloques escritos entre dos esperas del productor a que el
+	consumidor vacíe el buffer, para que el consumidor se bloquee con
+	el buffer vacío y dependa de la notificación.
+*/
+#define testDRAIN_BLOCKS	64
+
+/*! \var typedef struct xHostTask HostTask_t
+	\brief Valor de notificación de un hilo.
+*/
+typedef struct xHostTask {
+	pthread_mutex_t xMutex;
+	pthread_cond_t xCond;
+	uint32_t ulValue;
+	/* Notificaciones recibidas */
+	uint32_t ulGiven;
+	/* Esperas que terminaron por timeout */
+	uint32_t ulTimedOut;
+} HostTask_t;
+
+/*! \var xConsumerTask
+	\brief Tarea del hilo consumidor, y del hilo principal en las
+	pruebas de un solo hilo.
+*/
+static HostTask_t xConsumerTask = {
+	PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0, 0
+};
+
+/*! \var xRing
+	\brief Buffer circular de las pruebas.
+*/
+static SpscRing_t xRing;
+static uint8_t pucRingBuffer[ testRING_SIZE ];
+
+/*! \var xThreads
+	\brief Resultado del productor y del consumidor.
+*/
+static struct {
+	/* Bytes rechazados por buffer lleno */
+	uint32_t ulRejected;
+	uint32_t ulReceived;
+	uint32_t ulOutOfOrder;
+	/* Esperas cumplidas con el productor activo (aunque al cumplirse
+	 * ulSpscRingReceive() encuentre los datos) */
+	uint32_t ulTimeouts;
+	volatile bool xProducerDone;
+	/* Prueba abortada por una notificación perdida */
+	volatile bool xStop;
+} xThreads;
+
+/* Kernel: un único consumidor, el hilo que llama es xConsumerTask */
+
+TaskHandle_t xTaskGetCurrentTaskHandle( void )
+{
+	return &xConsumerTask;
+}
+
+BaseType_t xTaskGenericNotify( TaskHandle_t xTaskToNotify, uint32_t ulValue,
+	eNotifyAction eAction, uint32_t *pulPreviousNotificationValue )
+{
+	HostTask_t *pxTask = xTaskToNotify;
+
+	pthread_mutex_lock( &pxTask->xMutex );
+	pxTask->ulValue++;
+	pxTask->ulGiven++;
+	pthread_cond_signal( &pxTask->xCond );
+	pthread_mutex_unlock( &pxTask->xMutex );
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR( TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken )
+{
+	xTaskGenericNotify( xTaskToNotify, 0, eIncrement, NULL );
+	*pxHigherPriorityTaskWoken = pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait )
+{
+	HostTask_t *pxTask = &xConsumerTask;
+	struct timespec xDeadline;
+	uint32_t ulValue;
+
+	clock_gettime( CLOCK_REALTIME, &xDeadline );
+	xDeadline.tv_sec += xTicksToWait / configTICK_RATE_HZ;
+	xDeadline.tv_nsec += ( xTicksToWait % configTICK_RATE_HZ ) * ( 1000000000L / configTICK_RATE_HZ );
+	if ( xDeadline.tv_nsec >= 1000000000L ) {
+		xDeadline.tv_sec++;
+		xDeadline.tv_nsec -= 1000000000L;
+	}
+
+	pthread_mutex_lock( &pxTask->xMutex );
+	while ( pxTask->ulValue == 0 ) {
+		if ( pthread_cond_timedwait( &pxTask->xCond, &pxTask->xMutex, &xDeadline ) == ETIMEDOUT ) {
+			pxTask->ulTimedOut++;
+			break;
+		}
+	}
+	ulValue = pxTask->ulValue;
+	if ( ulValue > 0 ) {
+		pxTask->ulValue = xClearCountOnExit ? 0 : ulValue - 1;
+	}
+	pthread_mutex_unlock( &pxTask->xMutex );
+	return ulValue;
+}
+
+/*! \fn static void prvSetup( void )
+	\brief Buffer vacío con los índices en testINDEX_START y sin
+	notificaciones pendientes.
+*/
+static void prvSetup( void )
+{
+	vSpscRingInit( &xRing, pucRingBuffer, sizeof( pucRingBuffer ) );
+	xRing.ulHead = xRing.ulTail = testINDEX_START;
+	xConsumerTask.ulValue = 0;
+	xConsumerTask.ulGiven = 0;
+	xConsumerTask.ulTimedOut = 0;
+	memset( &xThreads, 0, sizeof( xThreads ) );
+}
+
+/*! \fn static void *prvProducer( void *pvParameters )
+	\brief Escribir testBYTES bytes numerados en bloques de 1 a 7,
+	alternando escritura de tarea y de ISR, y reintentar los bloques
+	rechazados. Cada testDRAIN_BLOCKS bloques espera que el consumidor
+	vacíe el buffer.
+*/
+static void *prvProducer( void *pvParameters )
+{
+	uint8_t pucBlock[7];
+	uint32_t ulSent = 0, ulLength, ulBlocks = 0;
+	BaseType_t xWoken = pdFALSE, xOk;
+
+	while ( ( ulSent < testBYTES ) && !xThreads.xStop ) {
+		ulLength = 1 + ( ulSent % 7 );
+		if ( ulLength > testBYTES - ulSent ) {
+			ulLength = testBYTES - ulSent;
+		}
+		for ( uint32_t i=0; i<ulLength; i++ ) {
+			pucBlock[i] = ( uint8_t ) ( ulSent + i );
+		}
+		if ( ulSent & 1 ) {
+			xOk = xSpscRingPutFromISR( &xRing, pucBlock, ulLength, &xWoken );
+		} else {
+			xOk = xSpscRingPut( &xRing, pucBlock, ulLength );
+		}
+		if ( xOk == pdPASS ) {
+			ulSent += ulLength;
+			if ( ++ulBlocks % testDRAIN_BLOCKS == 0 ) {
+				while ( ( xRing.ulTail != xRing.ulHead ) && !xThreads.xStop ) {
+					sched_yield();
+				}
+			}
+		} else {
+			xThreads.ulRejected += ulLength;
+			sched_yield();
+		}
+	}
+	xThreads.xProducerDone = true;
+	return NULL;
+}
+
+/*! \fn static void *prvConsumer( void *pvParameters )
+	\brief Recibir bloqueado hasta completar testBYTES bytes y
+	verificar su orden.
+*/
+static void *prvConsumer( void *pvParameters )
+{
+	uint8_t pucData[ testRING_SIZE ];
+	uint32_t ulCount;
+
+	while ( xThreads.ulReceived < testBYTES ) {
+		ulCount = ulSpscRingReceive( &xRing, pucData, 1 + ( xThreads.ulReceived % sizeof( pucData ) ),
+			pdMS_TO_TICKS( testWAIT_MS ) );
+		for ( uint32_t i=0; i<ulCount; i++ ) {
+			if ( pucData[i] != ( uint8_t ) xThreads.ulReceived ) {
+				xThreads.ulOutOfOrder++;
+			}
+			xThreads.ulReceived++;
+		}
+		if ( ( xConsumerTask.ulTimedOut > 0 ) && !xThreads.xProducerDone ) {
+			xThreads.ulTimeouts = xConsumerTask.ulTimedOut;
+			xThreads.xStop = true;
+			break;
+		}
+	}
+	return NULL;
+}
+
+int main( void )
+{
+	MINUT( true );
+	return 0;
+}
+
+/* Productor y consumidor en hilos: cada byte una vez y en orden, los
+ * índices pasan por 0xFFFFFFFF y el consumidor nunca espera con datos
+ * en el buffer */
+TEST( threads_ordering )
+{
+	pthread_t xProducer, xConsumer;
+
+	prvSetup();
+	pthread_create( &xConsumer, NULL, prvConsumer, NULL );
+	pthread_create( &xProducer, NULL, prvProducer, NULL );
+	pthread_join( xProducer, NULL );
+	pthread_join( xConsumer, NULL );
+
+	printf( "SPSC: %u bytes %u rejected %u notifications\n",
+		( unsigned ) xThreads.ulReceived, ( unsigned ) xThreads.ulRejected,
+		( unsigned ) xConsumerTask.ulGiven );
+	ASSERT_EQ( true, ( xThreads.ulReceived == testBYTES ) &&
+		( xThreads.ulOutOfOrder == 0 ) && ( xThreads.ulTimeouts == 0 ) &&
+		( xRing.ulHead == xRing.ulTail ) &&
+		( xRing.ulHead == ( uint32_t ) ( testINDEX_START + testBYTES ) ) &&
+		( xRing.ulDropped == xThreads.ulRejected ) );
+}
+
+/* Una notificación por transición de vacío a no vacío, no por
+ * escritura, y ninguna sin consumidor registrado */
+TEST( notify_on_empty_only )
+{
+	static const uint8_t pucData[] = { 1, 2, 3 };
+	uint8_t pucRead[ testRING_SIZE ];
+	uint32_t ulUnregistered, ulBurst, ulRead, ulAfterRead;
+	BaseType_t xWoken = pdFALSE;
+
+	prvSetup();
+	xSpscRingPut( &xRing, pucData, sizeof( pucData ) );
+	ulUnregistered = xConsumerTask.ulGiven;
+	ulSpscRingGet( &xRing, pucRead, sizeof( pucRead ) );
+
+	xRing.xConsumer = xTaskGetCurrentTaskHandle();
+	for ( uint32_t i=0; i<5; i++ ) {
+		xSpscRingPut( &xRing, pucData, sizeof( pucData ) );
+	}
+	ulBurst = xConsumerTask.ulGiven;
+	ulRead = ulSpscRingReceive( &xRing, pucRead, sizeof( pucRead ), 0 );
+	xSpscRingPutFromISR( &xRing, pucData, 1, &xWoken );
+	ulAfterRead = xConsumerTask.ulGiven;
+
+	ASSERT_EQ( true, ( ulUnregistered == 0 ) && ( ulBurst == 1 ) &&
+		( ulRead == 5 * sizeof( pucData ) ) && ( ulAfterRead == 2 ) &&
+		( xWoken == pdTRUE ) );
+}
+
+/* Sin lugar para todos los bytes no se escribe ninguno */
+TEST( all_or_nothing )
+{
+	uint8_t pucData[ testRING_SIZE ];
+	uint8_t pucRead[ testRING_SIZE ];
+	BaseType_t xFill, xOver, xFit;
+	uint32_t ulRead;
+
+	prvSetup();
+	for ( uint32_t i=0; i<sizeof( pucData ); i++ ) {
+		pucData[i] = i;
+	}
+	xFill = xSpscRingPut( &xRing, pucData, testRING_SIZE - 2 );
+	xOver = xSpscRingPut( &xRing, pucData, 3 );
+	xFit = xSpscRingPut( &xRing, &pucData[ testRING_SIZE - 2 ], 2 );
+	ulRead = ulSpscRingGet( &xRing, pucRead, sizeof( pucRead ) );
+
+	ASSERT_EQ( true, ( xFill == pdPASS ) && ( xOver == pdFAIL ) && ( xFit == pdPASS ) &&
+		( xRing.ulDropped == 3 ) && ( ulRead == testRING_SIZE ) &&
+		( memcmp( pucRead, pucData, testRING_SIZE ) == 0 ) );
+}
+
+MINUT_BEG
+	RUN( threads_ordering() );
+	RUN( notify_on_empty_only() );
+	RUN( all_or_nothing() );
+MINUT_END
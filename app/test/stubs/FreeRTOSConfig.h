@@ -0,0 +1,31 @@
+/*! \file FreeRTOSConfig.h
+    \brief Configuración del kernel para las pruebas en el host
+    (app/test), sin scheduler.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <assert.h>
+
+#define configUSE_PREEMPTION					1
+#define configUSE_IDLE_HOOK						0
+#define configUSE_TICK_HOOK						0
+#define configCPU_CLOCK_HZ						( 204000000UL )
+#define configTICK_RATE_HZ						( ( TickType_t ) 1000 )
+#define configMAX_PRIORITIES					( 7 )
+#define configMINIMAL_STACK_SIZE				( ( unsigned short ) 128 )
+#define configTOTAL_HEAP_SIZE					( ( size_t ) ( 16 * 1024 ) )
+#define configMAX_TASK_NAME_LEN					( 16 )
+#define configUSE_16_BIT_TICKS					0
+#define configUSE_MUTEXES						1
+#define configSUPPORT_STATIC_ALLOCATION			1
+#define configSUPPORT_DYNAMIC_ALLOCATION		1
+#define configUSE_MALLOC_FAILED_HOOK			0
+
+#define configASSERT( x )						assert( x )
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,29 @@
+/*! \file task_host.c
+    \brief Funciones del kernel que usan los módulos probados en el
+    host (app/test), sin scheduler: un único hilo de ejecución.
+    \author Gonzalo G. Fernández
+    \version 1.0
+    \date Octubre 2020
+*/
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*! \var uxSchedulerSuspended
+	\brief Anidamiento de vTaskSuspendAll(), para verificar que cada
+	suspensión tiene su reanudación.
+*/
+UBaseType_t uxSchedulerSuspended = 0;
+
+void vTaskSuspendAll( void )
+{
+	uxSchedulerSuspended++;
+}
+
+BaseType_t xTaskResumeAll( void )
+{
+	configASSERT( uxSchedulerSuspended > 0 );
+	uxSchedulerSuspended--;
+	return pdFALSE;
+}
@@ -0,0 +1,116 @@
+/* Copyright 2020, Gonzalo G. Fernandez.
+ * All rights reserved.
+ *
+ * This file is part sAPI library for microcontrollers.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Date: 2020-10-19 */
+
+/* Continuous sampling of CH1, CH2 and CH3 at 30 kHz each with DMA, the
+ * total rate being above the minimum of the ADC clock divider (about
+ * 72 kS/s). CH1 is decimated to 100 Hz, CH2 to 1 kHz and CH3 to 10 kHz. The
+ * callback keeps the last sample and the amount of samples of each channel.
+ * The CPU only runs once per 5 ms block, not once per conversion. */
+
+/*==================[inclusions]=============================================*/
+
+#include "sapi.h"    // <= sAPI header
+
+/*==================[macros and definitions]=================================*/
+
+#define SAMPLE_RATE    30000
+#define CHANNELS       3
+
+// Two halves of 5 ms of conversions
+#define BUFFER_SIZE    (2 * CHANNELS * SAMPLE_RATE / 200)
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static uint32_t buffer[BUFFER_SIZE];
+
+static volatile uint16_t lastSample[CHANNELS];
+static volatile uint32_t samplesAmount[CHANNELS];
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+static void blockReady( const adcStreamSample_t* samples, uint32_t amount,
+                        void* param )
+{
+   uint32_t i = 0;
+
+   for( i=0; i<amount; i++ ) {
+      lastSample[samples[i].channel] = samples[i].value;
+      samplesAmount[samples[i].channel]++;
+   }
+}
+
+/*==================[external functions definition]==========================*/
+
+/* FUNCION PRINCIPAL, PUNTO DE ENTRADA AL PROGRAMA LUEGO DE RESET. */
+int main(void){
+uint32_t i = 0;
+
+   /* ------------- INICIALIZACIONES ------------- */
+
+   boardConfig();
+   uartConfig( UART_USB, 115200 );
+   adcConfig( ADC_ENABLE );
+
+   adcStreamSetDecimation( CH1, 300 );
+   adcStreamSetDecimation( CH2, 30 );
+   adcStreamSetDecimation( CH3, 3 );
+   if( !adcStreamStart( (1 << CH1) | (1 << CH2) | (1 << CH3), SAMPLE_RATE,
+                        buffer, BUFFER_SIZE, blockReady, NULL ) ) {
+      stdioPrintf( UART_USB, "ADC stream error\r\n" );
+      while(1);
+   }
+
+   /* ------------- REPETIR POR SIEMPRE ------------- */
+   while(1) {
+      for( i=0; i<CHANNELS; i++ ) {
+         stdioPrintf( UART_USB, "CH%d: %d (%d samples) ", i + 1,
+                      lastSample[i], samplesAmount[i] );
+      }
+      stdioPrintf( UART_USB, "overruns %d\r\n", adcStreamOverruns() );
+      gpioToggle( LEDB );
+      delay( 1000 );
+   }
+
+   /* NO DEBE LLEGAR NUNCA AQUI, debido a que a este programa no es llamado
+      por ningun S.O. */
+   return 0 ;
+}
+
+/*==================[end of file]============================================*/
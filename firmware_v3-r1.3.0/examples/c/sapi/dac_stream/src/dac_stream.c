@@ -0,0 +1,148 @@
+/* Copyright 2020, Gonzalo G. Fernandez.
+ * All rights reserved.
+ *
+ * This file is part sAPI library for microcontrollers.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Date: 2020-10-19 */
+/* DAC waveforms played with DMA at 4 kHz, with the levels of
+ * control/pf4_reference_generator_dac and control/pf8_noise_generator_dac.
+ * At start a 10 Hz square reference between 356 and 666 is played in a loop
+ * with no interrupts. TEC1 switches to random noise between 356 and 666 held
+ * for 4 ms, each 25 ms half refilled from the DMA callback, and back. The
+ * CPU does not run once per sample in any of them. */
+
+/*==================[inclusions]=============================================*/
+
+#include "sapi.h"    // <= sAPI header
+#include <stdlib.h>
+
+/*==================[macros and definitions]=================================*/
+
+#define SAMPLE_RATE       4000
+
+#define LEVEL_LOW         356
+#define LEVEL_HIGH        666
+
+// One period of the 10 Hz reference
+#define REFERENCE_SIZE    (SAMPLE_RATE / 10)
+
+// Noise value held 4 ms and two halves of 25 ms
+#define NOISE_HOLD        (SAMPLE_RATE / 250)
+#define NOISE_SIZE        (2 * SAMPLE_RATE / 40)
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static uint32_t reference[REFERENCE_SIZE];
+static uint32_t noise[NOISE_SIZE];
+
+static volatile uint32_t refills = 0;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+static void noiseFill( uint32_t* samples, uint32_t amount, void* param )
+{
+   uint32_t word = 0;
+   uint32_t i = 0;
+
+   for( i=0; i<amount; i++ ) {
+      if( (i % NOISE_HOLD) == 0 ) {
+         word = DAC_STREAM_WORD( LEVEL_LOW +
+                                 rand() % (LEVEL_HIGH - LEVEL_LOW + 1) );
+      }
+      samples[i] = word;
+   }
+   refills++;
+}
+
+static void noiseRefill( uint32_t* samples, uint32_t amount, void* param )
+{
+   noiseFill( samples, amount, param );
+   gpioToggle( LED1 );
+}
+
+static bool_t streamReference( void )
+{
+   uint32_t i = 0;
+
+   for( i=0; i<REFERENCE_SIZE; i++ ) {
+      reference[i] = DAC_STREAM_WORD( i < REFERENCE_SIZE / 2 ? LEVEL_HIGH
+                                                             : LEVEL_LOW );
+   }
+   return dacStreamStart( SAMPLE_RATE, reference, REFERENCE_SIZE, NULL, NULL );
+}
+
+static bool_t streamNoise( void )
+{
+   noiseFill( noise, NOISE_SIZE, NULL );
+   return dacStreamStart( SAMPLE_RATE, noise, NOISE_SIZE, noiseRefill, NULL );
+}
+
+/*==================[external functions definition]==========================*/
+
+/* FUNCION PRINCIPAL, PUNTO DE ENTRADA AL PROGRAMA LUEGO DE RESET. */
+int main(void){
+bool_t noiseMode = FALSE;
+bool_t ok = FALSE;
+
+   /* ------------- INICIALIZACIONES ------------- */
+
+   boardConfig();
+   uartConfig( UART_USB, 115200 );
+   dacConfig( DAC_ENABLE );
+
+   ok = streamReference();
+
+   /* ------------- REPETIR POR SIEMPRE ------------- */
+   while(1) {
+      if( !gpioRead( TEC1 ) ) {
+         dacStreamStop();
+         noiseMode = !noiseMode;
+         ok = noiseMode ? streamNoise() : streamReference();
+         while( !gpioRead( TEC1 ) );
+      }
+      stdioPrintf( UART_USB, "%s %s, refills %d\r\n",
+                   noiseMode ? "Noise" : "Reference",
+                   ok ? "streaming" : "error", refills );
+      gpioToggle( LEDB );
+      delay( 500 );
+   }
+
+   /* NO DEBE LLEGAR NUNCA AQUI, debido a que a este programa no es llamado
+      por ningun S.O. */
+   return 0 ;
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,139 @@
+/* Copyright 2020, Gonzalo G. Fernandez.
+ * All rights reserved.
+ *
+ * This file is part sAPI library for microcontrollers.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Date: 2020-10-19 */
+
+/* Throughput of SPI0 (SSP1) at the maximum bit rate (PCLK/2): polled
+ * spiWrite()/spiRead() against GPDMA spiTransfer(), and CPU cycles left
+ * free while a spiTransferStart() transfer is in progress. Connect MOSI to
+ * MISO to also check the received data. */
+
+/*==================[inclusions]=============================================*/
+
+#include "sapi.h"    // <= sAPI header
+#include <string.h>
+
+/*==================[macros and definitions]=================================*/
+
+// More than DMA_MAX_TRANSFER_SIZE to use a scatter-gather list
+#define BENCH_SIZE   4096
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static uint8_t txBuffer[BENCH_SIZE];
+static uint8_t rxBuffer[BENCH_SIZE];
+
+static volatile uint32_t doneCycles = 0;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+static void printResult( const char* name, uint32_t cycles )
+{
+   uint32_t kBps = (uint32_t)( (uint64_t)BENCH_SIZE * EDU_CIAA_NXP_CLOCK_SPEED /
+                               cycles / 1000 );
+
+   stdioPrintf( UART_USB, "%s: %d cycles, %d kB/s\r\n", name, cycles, kBps );
+}
+
+static void transferDone( spiMap_t spi, bool_t ok, void* param )
+{
+   doneCycles = cyclesCounterRead();
+}
+
+/*==================[external functions definition]==========================*/
+
+/* FUNCION PRINCIPAL, PUNTO DE ENTRADA AL PROGRAMA LUEGO DE RESET. */
+int main(void){
+uint32_t freeLoops = 0;
+uint32_t i = 0;
+spiSegment_t segment = { txBuffer, rxBuffer, BENCH_SIZE };
+
+   /* ------------- INICIALIZACIONES ------------- */
+
+   boardConfig();
+   uartConfig( UART_USB, 115200 );
+   cyclesCounterConfig( EDU_CIAA_NXP_CLOCK_SPEED );
+
+   spiInit( SPI0 );
+   Chip_SSP_SetBitRate( LPC_SSP1, Chip_Clock_GetRate(CLK_MX_SSP1) / 2 );
+   if( !spiDmaInit( SPI0 ) ) {
+      stdioPrintf( UART_USB, "No free DMA channels\r\n" );
+      while(1);
+   }
+
+   for( i=0; i<BENCH_SIZE; i++ ) {
+      txBuffer[i] = (uint8_t) i;
+   }
+
+   /* ------------- REPETIR POR SIEMPRE ------------- */
+   while(1) {
+      cyclesCounterReset();
+      spiWrite( SPI0, txBuffer, BENCH_SIZE );
+      printResult( "spiWrite (polled)", cyclesCounterRead() );
+
+      cyclesCounterReset();
+      spiRead( SPI0, rxBuffer, BENCH_SIZE );
+      printResult( "spiRead (polled)", cyclesCounterRead() );
+
+      memset( rxBuffer, 0, BENCH_SIZE );
+      cyclesCounterReset();
+      spiTransfer( SPI0, txBuffer, rxBuffer, BENCH_SIZE );
+      printResult( "spiTransfer (DMA)", cyclesCounterRead() );
+      stdioPrintf( UART_USB, "loopback: %s\r\n",
+                   memcmp( txBuffer, rxBuffer, BENCH_SIZE ) ? "no" : "ok" );
+
+      // Count loops of a free CPU until the completion callback
+      freeLoops = 0;
+      cyclesCounterReset();
+      spiTransferStart( SPI0, &segment, 1, transferDone, NULL );
+      while( spiTransferBusy( SPI0 ) ) {
+         freeLoops++;
+      }
+      printResult( "spiTransferStart (DMA)", doneCycles );
+      stdioPrintf( UART_USB, "CPU loops while busy: %d\r\n\r\n", freeLoops );
+
+      gpioToggle( LEDB );
+      delay( 2000 );
+   }
+
+   /* NO DEBE LLEGAR NUNCA AQUI, debido a que a este programa no es llamado
+      por ningun S.O. */
+   return 0 ;
+}
+
+/*==================[end of file]============================================*/
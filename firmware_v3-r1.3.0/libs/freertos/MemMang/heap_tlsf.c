@@ -0,0 +1,712 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * A TLSF (two-level segregated fit) implementation of pvPortMalloc() and
+ * vPortFree().  Free blocks are kept in a matrix of segregated lists indexed
+ * by a first level (power of two of the block size) and a second level (a
+ * linear subdivision of that power of two).  Two bitmaps record which lists
+ * are non-empty, so both allocation and free execute in bounded time: no list
+ * is traversed, only bit scans (CLZ/CTZ on Cortex-M3/M4) and a constant
+ * number of pointer updates.  Adjacent free blocks are coalesced on free as in
+ * heap_4.c.  The only exception is a request that no rounded up size class
+ * can serve, where the list of its own size class is walked before failing.
+ *
+ * The allocator also keeps per size class statistics and can report the size
+ * of the largest free block and a fragmentation metric - see
+ * vPortGetHeapTlsfStats() and xPortGetHeapTlsfClassStats().
+ *
+ * Select it by setting FREERTOS_HEAP_TYPE=tlsf in the program config.mk.
+ *
+ * See heap_1.c, heap_2.c, heap_3.c, heap_4.c and heap_5.c for alternative
+ * implementations, and the memory management pages of http://www.FreeRTOS.org
+ * for more information.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+#if( portBYTE_ALIGNMENT != 8 )
+	#error heap_tlsf.c assumes portBYTE_ALIGNMENT is 8
+#endif
+
+/* log2 of the number of second level lists per first level class.  8 lists
+per power of two bounds the internal fragmentation to 12.5%. */
+#ifndef configTLSF_SL_INDEX_COUNT_LOG2
+	#define configTLSF_SL_INDEX_COUNT_LOG2	3
+#endif
+
+/* Largest block (log2) the allocator can manage.  The default covers any
+heap up to 1MB, well above the RAM of the supported boards. */
+#ifndef configTLSF_FL_INDEX_MAX
+	#define configTLSF_FL_INDEX_MAX			20
+#endif
+
+#define heapALIGN_SIZE_LOG2			3
+#define heapSL_INDEX_COUNT			( 1UL << configTLSF_SL_INDEX_COUNT_LOG2 )
+#define heapFL_INDEX_SHIFT			( configTLSF_SL_INDEX_COUNT_LOG2 + heapALIGN_SIZE_LOG2 )
+#define heapFL_INDEX_COUNT			( configTLSF_FL_INDEX_MAX - heapFL_INDEX_SHIFT + 1 )
+#define heapSMALL_BLOCK_SIZE		( ( size_t ) 1 << heapFL_INDEX_SHIFT )
+
+/* The two low bits of xSize are free because sizes are multiples of 8. */
+#define heapBLOCK_FREE_BIT			( ( size_t ) 1 )
+#define heapPREV_FREE_BIT			( ( size_t ) 2 )
+#define heapBLOCK_FLAG_MASK			( heapBLOCK_FREE_BIT | heapPREV_FREE_BIT )
+
+/* Bit scans.  Both compile to a single instruction on ARMv7-M. */
+#define heapFLS( x )				( 31 - __builtin_clz( ( uint32_t ) ( x ) ) )
+#define heapFFS( x )				( __builtin_ctz( ( uint32_t ) ( x ) ) )
+
+/* Allocate the memory for the heap. */
+#if( configAPPLICATION_ALLOCATED_HEAP == 1 )
+	/* The application writer has already defined the array used for the RTOS
+	heap - probably so it can be placed in a special segment or address. */
+	extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#else
+	static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#endif /* configAPPLICATION_ALLOCATED_HEAP */
+
+/* Header of every block.  Only pxPrevPhysBlock and xSize are overhead for a
+block owned by the application, the free list links live in the payload and
+are only valid while the block is free. */
+typedef struct A_TLSF_BLOCK
+{
+	struct A_TLSF_BLOCK *pxPrevPhysBlock;	/*<< The block physically before this one. */
+	size_t xSize;							/*<< Payload size, plus the free flags in the two low bits. */
+	struct A_TLSF_BLOCK *pxNextFree;		/*<< Next block in the same segregated list. */
+	struct A_TLSF_BLOCK *pxPrevFree;		/*<< Previous block in the same segregated list. */
+} TlsfBlock_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Compute the first and second level indexes of the list a block of xSize
+ * bytes belongs to.
+ */
+static void prvMappingInsert( size_t xSize, UBaseType_t *puxFl, UBaseType_t *puxSl );
+
+/*
+ * Same as prvMappingInsert(), but rounds xSize up so any block in the
+ * resulting list is big enough (good fit instead of exhaustive search).
+ */
+static void prvMappingSearch( size_t xSize, UBaseType_t *puxFl, UBaseType_t *puxSl );
+
+/*
+ * Bitmap lookup of the first non-empty list that can satisfy a request in
+ * list ( uxFl, uxSl ).  Returns NULL if there is none.
+ */
+static TlsfBlock_t *prvSearchSuitableBlock( UBaseType_t *puxFl, UBaseType_t *puxSl );
+
+/*
+ * Fallback when prvSearchSuitableBlock() fails: the good fit rounding skips
+ * the list xSize itself maps to, which may still hold a block big enough
+ * (e.g. a request of xPortGetLargestFreeBlockSize() bytes).  Only that list
+ * is walked, so the bound is the number of blocks of a single size class.
+ */
+static TlsfBlock_t *prvSearchExactClass( size_t xSize );
+
+static void prvInsertFreeBlock( TlsfBlock_t *pxBlock );
+static void prvRemoveFreeBlock( TlsfBlock_t *pxBlock );
+
+/*
+ * Percentage of xFree that cannot be handed out in a single request, given
+ * the largest free block: 0 means all the free memory is contiguous.
+ */
+static uint32_t prvFragmentation( size_t xFree, size_t xLargest );
+
+/*
+ * Called automatically to setup the required heap structures the first time
+ * pvPortMalloc() is called.
+ */
+static void prvHeapInit( void );
+
+/*-----------------------------------------------------------*/
+
+/* Bytes of overhead in front of every payload. */
+static const size_t xHeapStructSize = offsetof( TlsfBlock_t, pxNextFree );
+
+/* Smallest payload, enough to hold the free list links. */
+static const size_t xMinimumPayload = sizeof( TlsfBlock_t ) - offsetof( TlsfBlock_t, pxNextFree );
+
+/* First and second level bitmaps, and the segregated list heads. */
+static uint32_t ulFlBitmap = 0;
+static uint32_t ulSlBitmap[ heapFL_INDEX_COUNT ];
+static TlsfBlock_t *pxFreeLists[ heapFL_INDEX_COUNT ][ heapSL_INDEX_COUNT ];
+
+/* Zero sized, permanently used block at the end of the heap that stops the
+coalescing of the last block. */
+static TlsfBlock_t *pxEnd = NULL;
+
+/* Keeps track of the number of free bytes remaining. */
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+
+/* Statistics. */
+static size_t xFreeBlocks = 0U;
+static size_t xUsedBlocks = 0U;
+static uint32_t ulMallocFailures = 0U;
+static HeapTlsfClassStats_t xClassStats[ heapFL_INDEX_COUNT ];
+
+/*-----------------------------------------------------------*/
+
+static portFORCE_INLINE size_t prvBlockSize( const TlsfBlock_t *pxBlock )
+{
+	return pxBlock->xSize & ~heapBLOCK_FLAG_MASK;
+}
+/*-----------------------------------------------------------*/
+
+static portFORCE_INLINE TlsfBlock_t *prvNextPhysBlock( const TlsfBlock_t *pxBlock )
+{
+	return ( TlsfBlock_t * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize + prvBlockSize( pxBlock ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xSize, UBaseType_t *puxFl, UBaseType_t *puxSl )
+{
+UBaseType_t uxFl, uxSl;
+
+	if( xSize < heapSMALL_BLOCK_SIZE )
+	{
+		/* Small blocks are linearly spread over the first level 0 lists. */
+		uxFl = 0;
+		uxSl = ( UBaseType_t ) ( xSize / ( heapSMALL_BLOCK_SIZE / heapSL_INDEX_COUNT ) );
+	}
+	else
+	{
+		uxFl = ( UBaseType_t ) heapFLS( xSize );
+		uxSl = ( UBaseType_t ) ( xSize >> ( uxFl - configTLSF_SL_INDEX_COUNT_LOG2 ) ) ^ heapSL_INDEX_COUNT;
+		uxFl -= ( heapFL_INDEX_SHIFT - 1 );
+	}
+
+	*puxFl = uxFl;
+	*puxSl = uxSl;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingSearch( size_t xSize, UBaseType_t *puxFl, UBaseType_t *puxSl )
+{
+	if( xSize >= heapSMALL_BLOCK_SIZE )
+	{
+		xSize += ( ( size_t ) 1 << ( heapFLS( xSize ) - configTLSF_SL_INDEX_COUNT_LOG2 ) ) - 1;
+	}
+
+	prvMappingInsert( xSize, puxFl, puxSl );
+}
+/*-----------------------------------------------------------*/
+
+static TlsfBlock_t *prvSearchSuitableBlock( UBaseType_t *puxFl, UBaseType_t *puxSl )
+{
+UBaseType_t uxFl = *puxFl;
+uint32_t ulSlMap, ulFlMap;
+
+	if( uxFl >= heapFL_INDEX_COUNT )
+	{
+		return NULL;
+	}
+
+	/* First look for a list of the same first level, at or above the second
+	level index. */
+	ulSlMap = ulSlBitmap[ uxFl ] & ( ~0UL << *puxSl );
+
+	if( ulSlMap == 0 )
+	{
+		/* None there, so take the smallest non-empty larger first level. */
+		if( ( uxFl + 1 ) >= 32 )
+		{
+			return NULL;
+		}
+
+		ulFlMap = ulFlBitmap & ( ~0UL << ( uxFl + 1 ) );
+
+		if( ulFlMap == 0 )
+		{
+			/* Out of memory. */
+			return NULL;
+		}
+
+		uxFl = ( UBaseType_t ) heapFFS( ulFlMap );
+		ulSlMap = ulSlBitmap[ uxFl ];
+	}
+
+	*puxFl = uxFl;
+	*puxSl = ( UBaseType_t ) heapFFS( ulSlMap );
+
+	return pxFreeLists[ uxFl ][ *puxSl ];
+}
+/*-----------------------------------------------------------*/
+
+static TlsfBlock_t *prvSearchExactClass( size_t xSize )
+{
+UBaseType_t uxFl, uxSl;
+TlsfBlock_t *pxBlock;
+
+	prvMappingInsert( xSize, &uxFl, &uxSl );
+
+	if( uxFl >= heapFL_INDEX_COUNT )
+	{
+		return NULL;
+	}
+
+	for( pxBlock = pxFreeLists[ uxFl ][ uxSl ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+	{
+		if( prvBlockSize( pxBlock ) >= xSize )
+		{
+			break;
+		}
+	}
+
+	return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( TlsfBlock_t *pxBlock )
+{
+UBaseType_t uxFl, uxSl;
+TlsfBlock_t *pxHead;
+
+	prvMappingInsert( prvBlockSize( pxBlock ), &uxFl, &uxSl );
+	configASSERT( uxFl < heapFL_INDEX_COUNT );
+
+	pxHead = pxFreeLists[ uxFl ][ uxSl ];
+	pxBlock->pxNextFree = pxHead;
+	pxBlock->pxPrevFree = NULL;
+
+	if( pxHead != NULL )
+	{
+		pxHead->pxPrevFree = pxBlock;
+	}
+
+	pxFreeLists[ uxFl ][ uxSl ] = pxBlock;
+	ulFlBitmap |= ( 1UL << uxFl );
+	ulSlBitmap[ uxFl ] |= ( 1UL << uxSl );
+
+	xFreeBlocks++;
+	xClassStats[ uxFl ].xFreeBlocks++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( TlsfBlock_t *pxBlock )
+{
+UBaseType_t uxFl, uxSl;
+
+	prvMappingInsert( prvBlockSize( pxBlock ), &uxFl, &uxSl );
+
+	if( pxBlock->pxNextFree != NULL )
+	{
+		pxBlock->pxNextFree->pxPrevFree = pxBlock->pxPrevFree;
+	}
+
+	if( pxBlock->pxPrevFree != NULL )
+	{
+		pxBlock->pxPrevFree->pxNextFree = pxBlock->pxNextFree;
+	}
+	else
+	{
+		/* The block was the list head. */
+		pxFreeLists[ uxFl ][ uxSl ] = pxBlock->pxNextFree;
+
+		if( pxBlock->pxNextFree == NULL )
+		{
+			/* The list is now empty. */
+			ulSlBitmap[ uxFl ] &= ~( 1UL << uxSl );
+
+			if( ulSlBitmap[ uxFl ] == 0 )
+			{
+				ulFlBitmap &= ~( 1UL << uxFl );
+			}
+		}
+	}
+
+	xFreeBlocks--;
+	xClassStats[ uxFl ].xFreeBlocks--;
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+TlsfBlock_t *pxBlock, *pxNewBlock, *pxNextBlock;
+UBaseType_t uxFl, uxSl;
+void *pvReturn = NULL;
+
+	vTaskSuspendAll();
+	{
+		/* If this is the first call to malloc then the heap will require
+		initialisation to setup the segregated lists. */
+		if( pxEnd == NULL )
+		{
+			prvHeapInit();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( ( xWantedSize > 0 ) && ( xWantedSize <= xFreeBytesRemaining ) )
+		{
+			/* Ensure that payloads are always aligned to the required number
+			of bytes, and can hold the free list links once released. */
+			xWantedSize = ( xWantedSize + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+			if( xWantedSize < xMinimumPayload )
+			{
+				xWantedSize = xMinimumPayload;
+			}
+
+			prvMappingSearch( xWantedSize, &uxFl, &uxSl );
+			pxBlock = prvSearchSuitableBlock( &uxFl, &uxSl );
+
+			if( pxBlock == NULL )
+			{
+				pxBlock = prvSearchExactClass( xWantedSize );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( pxBlock != NULL )
+			{
+				configASSERT( prvBlockSize( pxBlock ) >= xWantedSize );
+				prvRemoveFreeBlock( pxBlock );
+				pxNextBlock = prvNextPhysBlock( pxBlock );
+
+				/* If the block is larger than required it can be split into
+				two, the remainder going back to the segregated lists. */
+				if( prvBlockSize( pxBlock ) >= ( xWantedSize + xHeapStructSize + xMinimumPayload ) )
+				{
+					pxNewBlock = ( TlsfBlock_t * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize + xWantedSize );
+					configASSERT( ( ( ( size_t ) pxNewBlock ) & portBYTE_ALIGNMENT_MASK ) == 0 );
+
+					/* The remainder is free, and the block in front of it is
+					about to be allocated. */
+					pxNewBlock->xSize = ( prvBlockSize( pxBlock ) - xWantedSize - xHeapStructSize ) | heapBLOCK_FREE_BIT;
+					pxNewBlock->pxPrevPhysBlock = pxBlock;
+					pxNextBlock->pxPrevPhysBlock = pxNewBlock;
+					pxBlock->xSize = xWantedSize | ( pxBlock->xSize & heapPREV_FREE_BIT );
+
+					/* The header of the remainder is taken from the free
+					bytes. */
+					xFreeBytesRemaining -= xHeapStructSize;
+					prvInsertFreeBlock( pxNewBlock );
+				}
+				else
+				{
+					/* The whole block is handed out, so the block behind it
+					no longer has a free neighbour. */
+					pxNextBlock->xSize &= ~heapPREV_FREE_BIT;
+				}
+
+				/* The block now belongs to the application. */
+				pxBlock->xSize &= ~heapBLOCK_FREE_BIT;
+				xFreeBytesRemaining -= prvBlockSize( pxBlock );
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				prvMappingInsert( prvBlockSize( pxBlock ), &uxFl, &uxSl );
+				xClassStats[ uxFl ].ulAllocations++;
+				xClassStats[ uxFl ].xUsedBlocks++;
+				xUsedBlocks++;
+
+				pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( pvReturn == NULL )
+		{
+			ulMallocFailures++;
+		}
+
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	( void ) xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif
+
+	configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+TlsfBlock_t *pxBlock, *pxNeighbour;
+UBaseType_t uxFl, uxSl;
+
+	if( pv != NULL )
+	{
+		/* The memory being freed will have a block header immediately before
+		it. */
+		pxBlock = ( TlsfBlock_t * ) ( ( ( uint8_t * ) pv ) - xHeapStructSize );
+
+		/* Check the block is actually allocated. */
+		configASSERT( ( pxBlock->xSize & heapBLOCK_FREE_BIT ) == 0 );
+
+		if( ( pxBlock->xSize & heapBLOCK_FREE_BIT ) == 0 )
+		{
+			vTaskSuspendAll();
+			{
+				traceFREE( pv, prvBlockSize( pxBlock ) );
+
+				prvMappingInsert( prvBlockSize( pxBlock ), &uxFl, &uxSl );
+				xClassStats[ uxFl ].xUsedBlocks--;
+				xUsedBlocks--;
+
+				xFreeBytesRemaining += prvBlockSize( pxBlock );
+				pxBlock->xSize |= heapBLOCK_FREE_BIT;
+
+				/* Merge with the block in front if it is free. */
+				if( ( pxBlock->xSize & heapPREV_FREE_BIT ) != 0 )
+				{
+					pxNeighbour = pxBlock->pxPrevPhysBlock;
+					prvRemoveFreeBlock( pxNeighbour );
+					pxNeighbour->xSize += xHeapStructSize + prvBlockSize( pxBlock );
+					xFreeBytesRemaining += xHeapStructSize;
+					pxBlock = pxNeighbour;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				/* Merge with the block behind if it is free.  The end marker
+				is never free, so this always stops at the end of the heap. */
+				pxNeighbour = prvNextPhysBlock( pxBlock );
+
+				if( ( pxNeighbour->xSize & heapBLOCK_FREE_BIT ) != 0 )
+				{
+					prvRemoveFreeBlock( pxNeighbour );
+					pxBlock->xSize += xHeapStructSize + prvBlockSize( pxNeighbour );
+					xFreeBytesRemaining += xHeapStructSize;
+					pxNeighbour = prvNextPhysBlock( pxBlock );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				/* Let the following block know it has a free neighbour. */
+				pxNeighbour->pxPrevPhysBlock = pxBlock;
+				pxNeighbour->xSize |= heapPREV_FREE_BIT;
+
+				prvInsertFreeBlock( pxBlock );
+			}
+			( void ) xTaskResumeAll();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvFragmentation( size_t xFree, size_t xLargest )
+{
+	if( xFree == 0 )
+	{
+		return 0;
+	}
+
+	return ( uint32_t ) ( 100U - ( ( xLargest * 100U ) / xFree ) );
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetLargestFreeBlockSize( void )
+{
+UBaseType_t uxFl, uxSl;
+TlsfBlock_t *pxBlock;
+size_t xLargest = 0;
+
+	vTaskSuspendAll();
+	{
+		if( ulFlBitmap != 0 )
+		{
+			/* The largest block lives in the highest non-empty list.  Blocks
+			in a list are not sorted, but the list is bounded to a single
+			size class so only that one is walked. */
+			uxFl = ( UBaseType_t ) heapFLS( ulFlBitmap );
+			uxSl = ( UBaseType_t ) heapFLS( ulSlBitmap[ uxFl ] );
+
+			for( pxBlock = pxFreeLists[ uxFl ][ uxSl ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+			{
+				if( prvBlockSize( pxBlock ) > xLargest )
+				{
+					xLargest = prvBlockSize( pxBlock );
+				}
+			}
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	return xLargest;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulPortGetHeapFragmentation( void )
+{
+	return prvFragmentation( xFreeBytesRemaining, xPortGetLargestFreeBlockSize() );
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapTlsfStats( HeapTlsfStats_t *pxStats )
+{
+	pxStats->xLargestFreeBlock = xPortGetLargestFreeBlockSize();
+
+	vTaskSuspendAll();
+	{
+		pxStats->xFreeBytes = xFreeBytesRemaining;
+		pxStats->xMinimumEverFreeBytes = xMinimumEverFreeBytesRemaining;
+		pxStats->xFreeBlocks = xFreeBlocks;
+		pxStats->xUsedBlocks = xUsedBlocks;
+		pxStats->ulMallocFailures = ulMallocFailures;
+	}
+	( void ) xTaskResumeAll();
+
+	pxStats->ulFragmentation = prvFragmentation( pxStats->xFreeBytes, pxStats->xLargestFreeBlock );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortGetHeapTlsfClassCount( void )
+{
+	return ( UBaseType_t ) heapFL_INDEX_COUNT;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortGetHeapTlsfClassStats( UBaseType_t uxClass, HeapTlsfClassStats_t *pxStats )
+{
+	if( uxClass >= heapFL_INDEX_COUNT )
+	{
+		return pdFAIL;
+	}
+
+	vTaskSuspendAll();
+	{
+		*pxStats = xClassStats[ uxClass ];
+	}
+	( void ) xTaskResumeAll();
+
+	/* Class 0 holds every block below heapSMALL_BLOCK_SIZE, class n the
+	blocks in [ 2^(n + shift - 1), 2^(n + shift) ). */
+	pxStats->xMinSize = ( uxClass == 0 ) ? 0 : ( ( size_t ) 1 << ( uxClass + heapFL_INDEX_SHIFT - 1 ) );
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+TlsfBlock_t *pxFirstBlock;
+size_t uxAddress;
+size_t xTotalHeapSize = configTOTAL_HEAP_SIZE;
+
+	/* Ensure the heap starts on a correctly aligned boundary. */
+	uxAddress = ( size_t ) ucHeap;
+
+	if( ( uxAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
+	{
+		uxAddress += ( portBYTE_ALIGNMENT - 1 );
+		uxAddress &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+		xTotalHeapSize -= uxAddress - ( size_t ) ucHeap;
+	}
+
+	xTotalHeapSize &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+	/* A single free block spans the whole heap, minus its own header and the
+	end marker header. */
+	pxFirstBlock = ( TlsfBlock_t * ) uxAddress;
+	pxFirstBlock->pxPrevPhysBlock = NULL;
+	pxFirstBlock->xSize = ( xTotalHeapSize - ( 2 * xHeapStructSize ) ) | heapBLOCK_FREE_BIT;
+
+	/* pxEnd is used to mark the end of the heap.  It is never free, so the
+	last block is never coalesced past it. */
+	pxEnd = prvNextPhysBlock( pxFirstBlock );
+	pxEnd->pxPrevPhysBlock = pxFirstBlock;
+	pxEnd->xSize = heapPREV_FREE_BIT;
+
+	prvInsertFreeBlock( pxFirstBlock );
+
+	xFreeBytesRemaining = prvBlockSize( pxFirstBlock );
+	xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
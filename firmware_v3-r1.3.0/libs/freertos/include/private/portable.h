@@ -132,6 +132,34 @@ void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Statistics only provided by heap_tlsf.c.
+ */
+typedef struct xHEAP_TLSF_STATS
+{
+	size_t xFreeBytes;				/* Total bytes available for allocation. */
+	size_t xMinimumEverFreeBytes;	/* Low water mark of xFreeBytes. */
+	size_t xLargestFreeBlock;		/* Largest request that can currently succeed. */
+	size_t xFreeBlocks;				/* Number of free blocks. */
+	size_t xUsedBlocks;				/* Number of blocks owned by the application. */
+	uint32_t ulFragmentation;		/* Percentage of xFreeBytes not in xLargestFreeBlock. */
+	uint32_t ulMallocFailures;		/* Number of pvPortMalloc() calls that returned NULL. */
+} HeapTlsfStats_t;
+
+typedef struct xHEAP_TLSF_CLASS_STATS
+{
+	size_t xMinSize;				/* Smallest payload size in the class. */
+	size_t xFreeBlocks;				/* Free blocks currently in the class. */
+	size_t xUsedBlocks;				/* Allocated blocks currently in the class. */
+	uint32_t ulAllocations;			/* Total allocations served from the class. */
+} HeapTlsfClassStats_t;
+
+void vPortGetHeapTlsfStats( HeapTlsfStats_t *pxStats ) PRIVILEGED_FUNCTION;
+UBaseType_t uxPortGetHeapTlsfClassCount( void ) PRIVILEGED_FUNCTION;
+BaseType_t xPortGetHeapTlsfClassStats( UBaseType_t uxClass, HeapTlsfClassStats_t *pxStats ) PRIVILEGED_FUNCTION;
+size_t xPortGetLargestFreeBlockSize( void ) PRIVILEGED_FUNCTION;
+uint32_t ulPortGetHeapFragmentation( void ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
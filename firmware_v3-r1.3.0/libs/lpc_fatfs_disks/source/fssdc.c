@@ -32,6 +32,10 @@
 
 #include "fssdc.h"
 
+#ifdef FSSDC_USE_DMA
+#include "sapi_spi.h"
+#endif
+
 /*  ELM-Chan Says:
  
     On Initialization: Set SPI clock rate between 100 kHz and 400 kHz.
@@ -61,6 +65,11 @@
 #define FSSDC_SPI_FAST_CLOCK            15000000
 #endif
 
+// #define FSSDC_USE_DMA: transfer data blocks with GPDMA (sapi_spi)
+#ifdef FSSDC_USE_DMA
+static bool_t g_spiDma = FALSE;
+#endif
+
 
 /* Definitions for MMC/SDC command */
 #define CMD0_	(0x40+0)	 /* GO_IDLE_STATE */
@@ -279,6 +288,16 @@ BOOL rcvr_datablock (
         return FALSE;               /* If not valid data token, retutn with error */
     }
 
+#ifdef FSSDC_USE_DMA
+    if (g_spiDma)
+    {
+        if (!spiTransfer(SPI0, NULL, buff, btr))
+        {
+            return FALSE;
+        }
+    }
+    else
+#endif
 	do                              /* Receive the data block into buffer */
     {							
 		rcvr_spi_m(buff++);
@@ -315,6 +334,17 @@ BOOL xmit_datablock (
 	xmit_spi(token);					/* Xmit data token */
 	if (token != 0xFD)                  /* Is data token */
     {                                   
+#ifdef FSSDC_USE_DMA
+        if (g_spiDma)
+        {
+            if (!spiTransfer(SPI0, buff, NULL, 512))
+            {
+                return FALSE;
+            }
+        }
+        else
+#endif
+        {
 		wc = 0;
 		do                              /* Xmit the 512 byte data block to MMC */
         {							
@@ -322,6 +352,7 @@ BOOL xmit_datablock (
 			xmit_spi(*buff++);
 		}
         while (--wc);
+        }
         
 		xmit_spi(0xFF);					/* CRC (Dummy) */
 		xmit_spi(0xFF);
@@ -807,6 +838,9 @@ void FSSDC_InitSPI ()
                          SSP_CLOCK_CPHA0_CPOL0);
     FCLK_SLOW           ();
     Chip_SSP_Enable     (LPC_SSP1);
+#ifdef FSSDC_USE_DMA
+    g_spiDma = spiDmaInit (SPI0);
+#endif
     
     // PLEASE NOTE: muxing and direction of CS signal on FSSDC_CS_{PIN/PORT}
     //              must be configured beforehand!
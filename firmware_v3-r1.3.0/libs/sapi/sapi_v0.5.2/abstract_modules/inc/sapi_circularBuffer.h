@@ -50,23 +50,26 @@ extern "C" {
 
 #define circularBufferConfig circularBufferInit
 
-#define circularBufferNew( buffName, elementSize, amountOfElements )   circularBuffer_t buffName; \
-   uint8_t buffName##_BufferMemory[ ((amountOfElements) + 1) * (elementSize) ];
+// Barrier between element data and indexes (DMB on Cortex-M)
+#ifndef CIRCULAR_BUFFER_BARRIER
+   #define CIRCULAR_BUFFER_BARRIER()   __sync_synchronize()
+#endif
 
-/*
-#define circularBufferNew( buffName, elementsSize, amountOfElements )   uint8_t buffName##_BufferMemory[ ((amountOfElements) + 1) * (elementsSize) ]; \
-   circularBuffer_t buffName = { .memoryAddress    = (buffName##_BufferMemory), \
-                                 .amountOfElements = ((amountOfElements) + 1),  \
-                                 .elementSize      = (elementsSize),            \
-                                 .readIndex        = 0,                         \
-                                 .writeIndex       = 0,                         \
-                                 .status           = CIRCULAR_BUFFER_EMPTY      \
-   }
- */
+// Amount of elements rounded up to a power of 2 (constant expression)
+#define CIRCULAR_BUFFER_SMEAR1(n)    ((n) | ((n) >> 1))
+#define CIRCULAR_BUFFER_SMEAR2(n)    (CIRCULAR_BUFFER_SMEAR1(n) | (CIRCULAR_BUFFER_SMEAR1(n) >> 2))
+#define CIRCULAR_BUFFER_SMEAR4(n)    (CIRCULAR_BUFFER_SMEAR2(n) | (CIRCULAR_BUFFER_SMEAR2(n) >> 4))
+#define CIRCULAR_BUFFER_SMEAR8(n)    (CIRCULAR_BUFFER_SMEAR4(n) | (CIRCULAR_BUFFER_SMEAR4(n) >> 8))
+#define CIRCULAR_BUFFER_SMEAR16(n)   (CIRCULAR_BUFFER_SMEAR8(n) | (CIRCULAR_BUFFER_SMEAR8(n) >> 16))
+#define CIRCULAR_BUFFER_CAPACITY(amountOfElements) \
+   (CIRCULAR_BUFFER_SMEAR16((uint32_t)(amountOfElements) - 1) + 1)
+
+#define circularBufferNew( buffName, elementSize, amountOfElements )   circularBuffer_t buffName; \
+   uint8_t buffName##_BufferMemory[ CIRCULAR_BUFFER_CAPACITY(amountOfElements) * (elementSize) ];
 
 #define circularBufferUse( buffName );   extern circularBuffer_t buffName;
 
-#define circularBufferInit( buffName, elementSize, amountOfElements );   circularBuffer_Init( &(buffName), buffName##_BufferMemory, amountOfElements, elementSize );
+#define circularBufferInit( buffName, elementSize, amountOfElements );   circularBuffer_Init( &(buffName), buffName##_BufferMemory, CIRCULAR_BUFFER_CAPACITY(amountOfElements), elementSize );
 
 /*==================[typedef]================================================*/
 
@@ -76,43 +79,74 @@ typedef enum {
    CIRCULAR_BUFFER_FULL
 } circularBufferStatus_t;
 
-
+/* Ring of a power of 2 amount of elements. readIndex and writeIndex are free
+ * running element counters masked on access, so all the elements are used
+ * and the amount stored is writeIndex - readIndex. Lock-free with a single
+ * producer (only writes writeIndex) and a single consumer (only writes
+ * readIndex), each of them in a task or in an ISR. */
 typedef struct {
    uint8_t* memoryAddress;
-   uint32_t amountOfElements;
+   uint32_t amountOfElements;       // Power of 2
+   uint32_t mask;
    uint32_t elementSize;
-   uint32_t readIndex;
-   uint32_t writeIndex;
-   circularBufferStatus_t status;
+   volatile uint32_t readIndex;
+   volatile uint32_t writeIndex;
    callBackFuncPtr_t emptyBufferCallback;
    callBackFuncPtr_t fullBufferCalback;
 } circularBuffer_t;
 
 /*==================[external functions declaration]=========================*/
 
-void circularBuffer_Init(
+// amountOfElements is rounded down to a power of 2. Returns FALSE, leaving a
+// buffer where every read is empty and every write full, if bufferMemory is
+// NULL or amountOfElements or elementSize are 0
+bool_t circularBuffer_Init(
    circularBuffer_t* buffer,    // buffer structure
    uint8_t* bufferMemory,       // buffer array of memory
    uint32_t amountOfElements,   // amount of elements in buffer
    uint32_t elementSize         // each element size in bytes
 );
 
+// Called with the buffer as parameter when a read finds it empty
 void circularBufferEmptyBufferCallbackSet(
    circularBuffer_t* buffer,              // buffer structure
    callBackFuncPtr_t emptyBufferCallback  // pointer to emptyBuffer function
 );
 
+// Called with the buffer as parameter when a write finds it full
 void circularBufferFullBufferCallbackSet(
    circularBuffer_t* buffer,              // buffer structure
    callBackFuncPtr_t fullBufferCalback    // pointer to fullBuffer function
 );
 
+// Elements stored and free
+uint32_t circularBufferElements( circularBuffer_t* buffer );
+uint32_t circularBufferFreeElements( circularBuffer_t* buffer );
+
 circularBufferStatus_t circularBufferRead( circularBuffer_t* buffer,
       uint8_t *dataByte );
 
 circularBufferStatus_t circularBufferWrite( circularBuffer_t* buffer,
       uint8_t *dataByte );
 
+// Read or write up to amount elements, return the amount moved
+uint32_t circularBufferReadArray( circularBuffer_t* buffer,
+                                  void* data, uint32_t amount );
+
+uint32_t circularBufferWriteArray( circularBuffer_t* buffer,
+                                   const void* data, uint32_t amount );
+
+/* Zero-copy access: Peek gives the address and the amount of contiguous
+ * elements that can be read (or written) in place, then Commit releases
+ * (or publishes) the amount of them actually used */
+uint32_t circularBufferReadPeek( circularBuffer_t* buffer, uint8_t** data );
+
+void circularBufferReadCommit( circularBuffer_t* buffer, uint32_t amount );
+
+uint32_t circularBufferWritePeek( circularBuffer_t* buffer, uint8_t** data );
+
+void circularBufferWriteCommit( circularBuffer_t* buffer, uint32_t amount );
+
 /*==================[example]==============================================*/
 
 /*
@@ -122,11 +156,11 @@ circularBufferStatus_t circularBufferWrite( circularBuffer_t* buffer,
    #define UART_DEBUG UART_USB
 #endif
 
-void emptyBuff( void ){
+void emptyBuff( void* buffer ){
    uartWriteString( UART_DEBUG, "Buffer vacio.\r\n" );
 }
 
-void fullBuff( void ){
+void fullBuff( void* buffer ){
    uartWriteString( UART_DEBUG, "Buffer lleno.\r\n" );
 }
 
@@ -151,10 +185,10 @@ int main( void ){
    circularBufferNew( myBuff, 1, 8 );
    circularBufferInit( myBuff, 1, 8 );
 
-   circularBufferSetEmptyBufferCallback( &myBuff,     // buffer structure
+   circularBufferEmptyBufferCallbackSet( &myBuff,     // buffer structure
 	                                     emptyBuff ); // pointer to emptyBuffer function
 
-   circularBufferSetFullBufferCallback( &myBuff,      // buffer structure
+   circularBufferFullBufferCallbackSet( &myBuff,      // buffer structure
 		                                fullBuff );   // pointer to fullBuffer function
 
    // ---------- REPETIR POR SIEMPRE --------------------------
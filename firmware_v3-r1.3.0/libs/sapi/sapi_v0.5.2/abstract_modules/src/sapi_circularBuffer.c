@@ -33,6 +33,7 @@
 /*==================[inclusions]=============================================*/
 
 #include "sapi_circularBuffer.h"   // <= own header
+#include <string.h>
 
 /*==================[macros and definitions]=================================*/
 
@@ -42,13 +43,28 @@
 
 /*==================[internal data definition]===============================*/
 
-static bool_t isSetEmptyBufferCallback = FALSE;
-static bool_t isSetFullBufferCallback  = FALSE;
-
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
 
+// Address of the element at a free running index
+static inline uint8_t* circularBufferElement( circularBuffer_t* buffer,
+                                              uint32_t index )
+{
+   return buffer->memoryAddress + (index & buffer->mask) * buffer->elementSize;
+}
+
+// One element, byte buffers (UART) without the memcpy call
+static inline void circularBufferElementCopy( uint8_t* destination,
+      const uint8_t* source, uint32_t elementSize )
+{
+   if( elementSize == 1 ) {
+      *destination = *source;
+   } else {
+      memcpy( destination, source, elementSize );
+   }
+}
+
 /*==================[external functions definition]==========================*/
 
 /*
@@ -80,20 +96,38 @@ void PLC_IL_ST(void* newValue, PLC_WORD lenght, PLC_EnumModifiers modifier)
 }
 */
 
-void circularBuffer_Init(
+bool_t circularBuffer_Init(
    circularBuffer_t* buffer,    // buffer structure
    uint8_t* bufferMemory,       // buffer array of memory
    uint32_t amountOfElements,   // amount of elements in buffer
    uint32_t elementSize         // each element size in bytes
 )
 {
+   bool_t retVal = TRUE;
+
+   // Without elements the mask would be 0xFFFFFFFF and every access would
+   // fall outside bufferMemory: leave a buffer with no room instead
+   if( (bufferMemory == NULL) || (amountOfElements == 0) || (elementSize == 0) ) {
+      bufferMemory     = NULL;
+      amountOfElements = 0;
+      retVal           = FALSE;
+   }
+
+   // Largest power of 2 that fits in bufferMemory
+   while( amountOfElements & (amountOfElements - 1) ) {
+      amountOfElements &= amountOfElements - 1;
+   }
 
-   buffer->memoryAddress    = bufferMemory;
-   buffer->amountOfElements = amountOfElements + 1;
-   buffer->elementSize      = elementSize;
-   buffer->readIndex        = 0;
-   buffer->writeIndex       = 0;
-   buffer->status           = CIRCULAR_BUFFER_EMPTY;
+   buffer->memoryAddress       = bufferMemory;
+   buffer->amountOfElements    = amountOfElements;
+   buffer->mask                = retVal ? amountOfElements - 1 : 0;
+   buffer->elementSize         = elementSize;
+   buffer->readIndex           = 0;
+   buffer->writeIndex          = 0;
+   buffer->emptyBufferCallback = 0;
+   buffer->fullBufferCalback   = 0;
+
+   return retVal;
 }
 
 
@@ -102,12 +136,7 @@ void circularBufferEmptyBufferCallbackSet(
    callBackFuncPtr_t emptyBufferCallback  // pointer to emptyBuffer function
 )
 {
-
-   // Empty buffer callback
-   if( emptyBufferCallback != 0 ) {
-      buffer->emptyBufferCallback = emptyBufferCallback;
-      isSetEmptyBufferCallback = TRUE;
-   }
+   buffer->emptyBufferCallback = emptyBufferCallback;
 }
 
 
@@ -116,80 +145,162 @@ void circularBufferFullBufferCallbackSet(
    callBackFuncPtr_t fullBufferCalback    // pointer to fullBuffer function
 )
 {
-   // Full buffer callback
-   if( fullBufferCalback != 0 ) {
-      buffer->fullBufferCalback = fullBufferCalback;
-      isSetFullBufferCallback = TRUE;
-   }
+   buffer->fullBufferCalback = fullBufferCalback;
+}
+
+
+uint32_t circularBufferElements( circularBuffer_t* buffer )
+{
+   return buffer->writeIndex - buffer->readIndex;
+}
+
+
+uint32_t circularBufferFreeElements( circularBuffer_t* buffer )
+{
+   return buffer->amountOfElements - (buffer->writeIndex - buffer->readIndex);
 }
 
 
 circularBufferStatus_t circularBufferRead( circularBuffer_t* buffer,
       uint8_t *dataByte )
 {
+   uint32_t readIndex = buffer->readIndex;
 
-   uint8_t i = 0;
+   // One element never crosses the end of the memory: no Peek loop
+   if( buffer->writeIndex == readIndex ) {
+      if( buffer->emptyBufferCallback != 0 ) {
+         (* (buffer->emptyBufferCallback) )( buffer );
+      }
+      return CIRCULAR_BUFFER_EMPTY;
+   }
+   CIRCULAR_BUFFER_BARRIER();
+   circularBufferElementCopy( dataByte,
+                              circularBufferElement( buffer, readIndex ),
+                              buffer->elementSize );
+   CIRCULAR_BUFFER_BARRIER();
+   buffer->readIndex = readIndex + 1;
+   return CIRCULAR_BUFFER_NORMAL;
+}
 
-   // Is Empty?
-   if ( (buffer->readIndex) == (buffer->writeIndex) ) {
 
-      // Error, empty buffer
-      buffer->status = CIRCULAR_BUFFER_EMPTY;
+circularBufferStatus_t circularBufferWrite( circularBuffer_t* buffer,
+      uint8_t *dataByte )
+{
+   uint32_t writeIndex = buffer->writeIndex;
 
-      // Execute emptyBufferCallback
-      if( isSetEmptyBufferCallback ) {
-         (* (buffer->emptyBufferCallback) )(0);
+   if( writeIndex - buffer->readIndex == buffer->amountOfElements ) {
+      if( buffer->fullBufferCalback != 0 ) {
+         (* (buffer->fullBufferCalback) )( buffer );
       }
+      return CIRCULAR_BUFFER_FULL;
+   }
+   CIRCULAR_BUFFER_BARRIER();
+   circularBufferElementCopy( circularBufferElement( buffer, writeIndex ),
+                              dataByte, buffer->elementSize );
+   CIRCULAR_BUFFER_BARRIER();
+   buffer->writeIndex = writeIndex + 1;
+   return CIRCULAR_BUFFER_NORMAL;
+}
 
-   } else {
-
-      buffer->status = CIRCULAR_BUFFER_NORMAL;
 
-      // TODO:
-      for( i=0; i<(buffer->elementSize); i++ ) {
-         dataByte[i] = (buffer->memoryAddress)[ buffer->readIndex + i ];
+uint32_t circularBufferReadArray( circularBuffer_t* buffer,
+                                  void* data, uint32_t amount )
+{
+   uint8_t* source = NULL;
+   uint32_t contiguous = 0;
+   uint32_t done = 0;
+
+   // At most two copies, before and after the end of the memory
+   while( done < amount ) {
+      contiguous = circularBufferReadPeek( buffer, &source );
+      if( contiguous == 0 ) {
+         break;
+      }
+      if( contiguous > amount - done ) {
+         contiguous = amount - done;
       }
+      memcpy( (uint8_t*) data + done * buffer->elementSize, source,
+              contiguous * buffer->elementSize );
+      circularBufferReadCommit( buffer, contiguous );
+      done += contiguous;
+   }
+
+   if( (done < amount) && (buffer->emptyBufferCallback != 0) ) {
+      (* (buffer->emptyBufferCallback) )( buffer );
+   }
+   return done;
+}
 
-      // Increment readIndex (circular)
-      buffer->readIndex = (buffer->readIndex + buffer->elementSize) % (buffer->amountOfElements * buffer->elementSize);
 
+uint32_t circularBufferWriteArray( circularBuffer_t* buffer,
+                                   const void* data, uint32_t amount )
+{
+   uint8_t* destination = NULL;
+   uint32_t contiguous = 0;
+   uint32_t done = 0;
+
+   while( done < amount ) {
+      contiguous = circularBufferWritePeek( buffer, &destination );
+      if( contiguous == 0 ) {
+         break;
+      }
+      if( contiguous > amount - done ) {
+         contiguous = amount - done;
+      }
+      memcpy( destination, (const uint8_t*) data + done * buffer->elementSize,
+              contiguous * buffer->elementSize );
+      circularBufferWriteCommit( buffer, contiguous );
+      done += contiguous;
    }
 
-   return buffer->status;
+   if( (done < amount) && (buffer->fullBufferCalback != 0) ) {
+      (* (buffer->fullBufferCalback) )( buffer );
+   }
+   return done;
 }
 
 
-circularBufferStatus_t circularBufferWrite( circularBuffer_t* buffer,
-      uint8_t *dataByte )
+uint32_t circularBufferReadPeek( circularBuffer_t* buffer, uint8_t** data )
 {
+   uint32_t readIndex = buffer->readIndex;
+   uint32_t stored = buffer->writeIndex - readIndex;
+   uint32_t toEnd = buffer->amountOfElements - (readIndex & buffer->mask);
 
-   uint8_t i = 0;
+   // Elements published by the producer before writeIndex
+   CIRCULAR_BUFFER_BARRIER();
 
-   // Is Full?
-   if( ((buffer->writeIndex + buffer->elementSize) % (buffer->amountOfElements * buffer->elementSize) ) == (buffer->readIndex) ) {
+   *data = circularBufferElement( buffer, readIndex );
+   return stored < toEnd ? stored : toEnd;
+}
 
-      // Error, full buffer
-      buffer->status = CIRCULAR_BUFFER_FULL;
 
-      // Execute fullBufferCalback
-      if( isSetFullBufferCallback ) {
-         (* (buffer->fullBufferCalback) )(0);
-      }
+void circularBufferReadCommit( circularBuffer_t* buffer, uint32_t amount )
+{
+   // Elements read before the producer can reuse them
+   CIRCULAR_BUFFER_BARRIER();
+   buffer->readIndex += amount;
+}
 
-   } else {
 
-      buffer->status = CIRCULAR_BUFFER_NORMAL;
+uint32_t circularBufferWritePeek( circularBuffer_t* buffer, uint8_t** data )
+{
+   uint32_t writeIndex = buffer->writeIndex;
+   uint32_t space = buffer->amountOfElements - (writeIndex - buffer->readIndex);
+   uint32_t toEnd = buffer->amountOfElements - (writeIndex & buffer->mask);
 
-      // TODO:
-      for( i=0; i<(buffer->elementSize); i++ ) {
-         (buffer->memoryAddress)[ buffer->writeIndex + i ] = dataByte[i];
-      }
+   // Elements released by the consumer before readIndex
+   CIRCULAR_BUFFER_BARRIER();
+
+   *data = circularBufferElement( buffer, writeIndex );
+   return space < toEnd ? space : toEnd;
+}
 
-      // Increment writeIndex (circular)
-      buffer->writeIndex = (buffer->writeIndex + buffer->elementSize) % (buffer->amountOfElements * buffer->elementSize);
-   }
 
-   return buffer->status;
+void circularBufferWriteCommit( circularBuffer_t* buffer, uint32_t amount )
+{
+   // Elements written before the consumer can see them
+   CIRCULAR_BUFFER_BARRIER();
+   buffer->writeIndex += amount;
 }
 
 /*==================[end of file]============================================*/
@@ -50,6 +50,7 @@
 #include "sapi_uart.h"                   // Use UART peripherals
 #include "sapi_adc.h"                    // Use ADC0 peripheral
 #include "sapi_dac.h"                    // Use DAC peripheral
+#include "sapi_dma.h"                    // Use GPDMA peripheral
 #include "sapi_i2c.h"                    // Use I2C0 peripheral
 #include "sapi_spi.h"                    // Use SPI0 peripheral
 #include "sapi_rtc.h"                    // Use RTC peripheral
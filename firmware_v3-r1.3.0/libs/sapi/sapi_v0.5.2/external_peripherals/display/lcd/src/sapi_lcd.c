@@ -61,6 +61,11 @@ static uint8_t lcdEnStatus = OFF;
 static uint8_t lcdRsStatus = OFF;
 static uint8_t lcdBacklightStatus = 0;
 
+#ifndef LCD_HD44780_I2C_PCF8574T
+// D4-D7 written together by lcdSendNibble()
+static gpioMask_t lcdDataPins;
+#endif
+
 static void lcdI2cWritePins( uint8_t _data );
 static void lcdPinSet( uint8_t pin, bool_t status );
 
@@ -185,10 +190,15 @@ static void lcdEnablePulse( void )
 
 static void lcdSendNibble( uint8_t nibble )
 {
+#ifdef LCD_HD44780_I2C_PCF8574T
    lcdPinSet( LCD_HD44780_D7, ( nibble & 0x80 ) );
    lcdPinSet( LCD_HD44780_D6, ( nibble & 0x40 ) );
    lcdPinSet( LCD_HD44780_D5, ( nibble & 0x20 ) );
    lcdPinSet( LCD_HD44780_D4, ( nibble & 0x10 ) );
+#else
+   // Bit i of the nibble is D(4+i)
+   gpioWriteMask( &lcdDataPins, nibble >> 4 );
+#endif
 }
 
 /*==================[definiciones de funciones externas]=====================*/
@@ -244,6 +254,11 @@ void lcdInit( uint16_t lineWidth, uint16_t amountOfLines,
    lcdInitPinAsOutput( LCD_HD44780_D5 );
    lcdInitPinAsOutput( LCD_HD44780_D6 );
    lcdInitPinAsOutput( LCD_HD44780_D7 );
+
+   const gpioMap_t lcdDataPinsMap[] = {
+      LCD_HD44780_D4, LCD_HD44780_D5, LCD_HD44780_D6, LCD_HD44780_D7
+   };
+   gpioMaskInit( &lcdDataPins, lcdDataPinsMap, 4 );
 #endif
 
    // Configure LCD for 4-bit mode
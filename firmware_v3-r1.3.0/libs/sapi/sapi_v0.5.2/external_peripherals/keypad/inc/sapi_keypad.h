@@ -37,6 +37,7 @@
 
 #include "sapi_datatypes.h"
 #include "sapi_peripheral_map.h"
+#include "sapi_gpio.h"
 
 /*==================[c++]====================================================*/
 #ifdef __cplusplus
@@ -54,6 +55,7 @@ typedef struct {
    uint8_t keypadRowSize;
    const gpioMap_t* keypadColPins;
    uint8_t keypadColSize;
+   gpioMask_t keypadRowMask; // Rows written together while scanning
 } keypad_t;
 
 /*==================[external functions declaration]=========================*/
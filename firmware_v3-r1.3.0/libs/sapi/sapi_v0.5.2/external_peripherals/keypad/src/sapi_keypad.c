@@ -84,6 +84,9 @@ bool_t keypadInit( keypad_t* keypad,
    for( i=0; i<keypadRowSize; i++ ) {
       gpioInit( keypad->keypadRowPins[i], GPIO_OUTPUT );
    }
+   if( !gpioMaskInit( &keypad->keypadRowMask, keypadRowPins, keypadRowSize ) ) {
+      retVal = FALSE;
+   }
 
    // Configure Columns as Inputs with pull-up resistors enable
    for( i=0; i<keypadColSize; i++ ) {
@@ -105,9 +108,7 @@ bool_t keypadRead( keypad_t* keypad, uint16_t* key )
    uint8_t c = 0; // Columns
 
    // Put all Rows in LOW state
-   for( r=0; r<keypad->keypadRowSize; r++ ) {
-      gpioWrite( keypad->keypadRowPins[r], LOW );
-   }
+   gpioWriteMask( &keypad->keypadRowMask, 0 );
 
    // Check all Columns to search if any key is pressed
    for( c=0; c<keypad->keypadColSize; c++ ) {
@@ -117,19 +118,11 @@ bool_t keypadRead( keypad_t* keypad, uint16_t* key )
 
          delay( 50 ); // Debounce 50 ms
 
-         // Put all Rows in HIGH state except first one
-         for( r=1; r<keypad->keypadRowSize; r++ ) {
-            gpioWrite( keypad->keypadRowPins[r], HIGH );
-         }
-
          // Search what key are pressed
          for( r=0; r<keypad->keypadRowSize; r++ ) {
 
-            // Put the Row[r-1] in HIGH state and the Row[r] in LOW state
-            if( r>0 ) { // Prevents negative index in array
-               gpioWrite( keypad->keypadRowPins[r-1], HIGH );
-            }
-            gpioWrite( keypad->keypadRowPins[r], LOW );
+            // Put only the Row[r] in LOW state, all Rows change at once
+            gpioWriteMask( &keypad->keypadRowMask, ~(1UL << r) );
 
             // Check Columns[c] at Row[r] to search if the key is pressed
             // if that key is pressed (LOW state) then retuns the key
@@ -40,6 +40,7 @@
 
 #include "sapi_datatypes.h"
 #include "sapi_peripheral_map.h"
+#include "sapi_dma.h"
 
 /*==================[c++]====================================================*/
 #ifdef __cplusplus
@@ -50,18 +51,56 @@ extern "C" {
 
 #define adcConfig adcInit
 
+// ADC0 inputs of a stream, indexed by LPC channel number
+#define ADC_STREAM_CHANNELS   8
+#define ADC_STREAM_MAX_DECIMATION  1024
+
 /*==================[typedef]================================================*/
 
 typedef enum {
    ADC_ENABLE, ADC_DISABLE
 } adcInit_t;
 
+/* Decimated sample of a stream. The samples of a block are written over the
+ * raw DMA words of the same half buffer, so it must keep their size */
+typedef struct {
+   uint16_t value;     // Average of the decimated conversions
+   uint8_t  channel;   // adcMap_t
+   uint8_t  overrun;   // TRUE if a conversion of the average was lost
+} adcStreamSample_t;
+
+/* Block callback, called from DMA_IRQHandler() while DMA fills the other
+ * half buffer */
+typedef void (*adcStreamCallback_t)( const adcStreamSample_t* samples,
+                                     uint32_t amount, void* param );
+
 /*==================[external functions declaration]=========================*/
 
 void adcInit( adcInit_t config );
 
 uint16_t adcRead( adcMap_t analogInput );
 
+/* After adcInit( ADC_ENABLE ), start continuous burst conversions of the
+ * channels in channelsMask (bit n for adcMap_t n) at sampleRate per channel,
+ * moved by DMA into the two halves of buffer (bufferSize words, each half up
+ * to DMA_MAX_TRANSFER_SIZE). The callback gets the decimated samples of each
+ * completed half. While streaming adcRead() returns the last sample.
+ * sampleRate times the amount of channels must be at least PCLK_ADC0 /
+ * (256 * 11), about 72 kS/s at 204 MHz, the slowest burst the ADC clock
+ * divider allows; it returns FALSE otherwise. Lower rates per channel are
+ * obtained with adcStreamSetDecimation() */
+bool_t adcStreamStart( uint32_t channelsMask, uint32_t sampleRate,
+                       uint32_t* buffer, uint32_t bufferSize,
+                       adcStreamCallback_t callback, void* param );
+
+/* Average factor conversions of the channel into each sample (1 by default) */
+bool_t adcStreamSetDecimation( adcMap_t analogInput, uint16_t factor );
+
+void adcStreamStop( void );
+
+/* Conversions lost because DMA did not read them in time */
+uint32_t adcStreamOverruns( void );
+
 /*==================[c++]====================================================*/
 #ifdef __cplusplus
 }
@@ -40,6 +40,7 @@
 
 #include "sapi_datatypes.h"
 #include "sapi_peripheral_map.h"
+#include "sapi_dma.h"
 
 /*==================[c++]====================================================*/
 #ifdef __cplusplus
@@ -50,12 +51,20 @@ extern "C" {
 
 #define dacConfig dacInit
 
+// Stream buffer word of a 10 bit value, with the bias of dacInit()
+#define DAC_STREAM_WORD(value)   (DAC_VALUE(value) | DAC_BIAS_EN)
+
 /*==================[typedef]================================================*/
 
 typedef enum {
    DAC_ENABLE, DAC_DISABLE
 } dacInit_t;
 
+/* Refill callback, called from DMA_IRQHandler() with the half buffer just
+ * played while DMA plays the other half */
+typedef void (*dacStreamCallback_t)( uint32_t* samples, uint32_t amount,
+                                     void* param );
+
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -64,6 +73,18 @@ void dacInit( dacInit_t config );
 
 void dacWrite( dacMap_t analogOutput, uint16_t value );
 
+/* After dacInit( DAC_ENABLE ), play buffer (bufferSize DAC_STREAM_WORD()
+ * words, even, each half up to DMA_MAX_TRANSFER_SIZE) at sampleRate, paced
+ * by the DAC counter (from the DAC clock / 65536 up to 400 kHz). Without
+ * callback the buffer is played in a loop with no interrupts. With callback
+ * each played half is passed to it to be refilled. dacWrite() is ignored
+ * while streaming */
+bool_t dacStreamStart( uint32_t sampleRate, uint32_t* buffer,
+                       uint32_t bufferSize, dacStreamCallback_t callback,
+                       void* param );
+
+void dacStreamStop( void );
+
 /*==================[c++]====================================================*/
 #ifdef __cplusplus
 }
@@ -0,0 +1,100 @@
+/* Copyright 2020, Gonzalo G. Fernandez.
+ * All rights reserved.
+ *
+ * This file is part sAPI library for microcontrollers.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Date: 2020-10-19 */
+
+#ifndef _SAPI_DMA_H_
+#define _SAPI_DMA_H_
+
+/*==================[inclusions]=============================================*/
+
+#include "sapi_datatypes.h"
+
+/*==================[c++]====================================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros]=================================================*/
+
+// GPDMA interrupt priority, inside the FreeRTOS syscall range so the
+// completion callbacks may use the FromISR API
+#ifndef DMA_IRQ_PRIORITY
+#define DMA_IRQ_PRIORITY   5
+#endif
+
+// Maximum transfer size of a single GPDMA descriptor
+#define DMA_MAX_TRANSFER_SIZE   0xFFF
+
+/*==================[typedef]================================================*/
+
+typedef DMA_TransferDescriptor_t dmaDescriptor_t;
+
+/* Called from DMA_IRQHandler() when the channel reaches the terminal count
+ * of a descriptor with interrupt enabled (ok = TRUE) or on a bus error
+ * (ok = FALSE) */
+typedef void (*dmaCallback_t)( uint8_t channel, bool_t ok, void* param );
+
+/*==================[external functions declaration]=========================*/
+
+/* Power up the GPDMA and enable its interrupt. Can be called more than once,
+ * only the first call initializes the controller */
+bool_t dmaInit( void );
+
+/* Reserve a free channel for the peripheral connection (GPDMA_CONN_x) and
+ * attach the callback. Returns the channel number or -1 if all channels are
+ * in use */
+int8_t dmaChannelAlloc( uint32_t connection, dmaCallback_t callback,
+                        void* param );
+
+/* Stop the channel and release it */
+void dmaChannelFree( uint8_t channel );
+
+/* Start a linked list of descriptors prepared with
+ * Chip_GPDMA_PrepareDescriptor(). connection is the GPDMA_CONN_x of the
+ * peripheral side of the transfer type */
+bool_t dmaStart( uint8_t channel, const dmaDescriptor_t* first,
+                 uint32_t connection, GPDMA_FLOW_CONTROL_T transferType );
+
+/* Stop the channel, keeping it reserved */
+void dmaStop( uint8_t channel );
+
+/* TRUE while the channel is transferring */
+bool_t dmaIsBusy( uint8_t channel );
+
+/*==================[c++]====================================================*/
+#ifdef __cplusplus
+}
+#endif
+
+/*==================[end of file]============================================*/
+#endif /* _SAPI_DMA_H_ */
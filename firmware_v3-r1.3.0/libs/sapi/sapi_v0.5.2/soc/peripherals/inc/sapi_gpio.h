@@ -54,6 +54,20 @@ extern "C" {
 #define pinValueGet gpioRead
 #define pinValueSet gpioWrite
 
+/* Compile-time resolved GPIO access for constant GPIO port and pin numbers
+ * (third column of gpioPinsInit[] in sapi_gpio.c). Each one is a single
+ * load or store to the GPIO byte pin or toggle registers. */
+#define GPIO_FAST_WRITE( gpioPort, gpioPin, value ) \
+   ( LPC_GPIO_PORT->B[(gpioPort)][(gpioPin)] = (value) )
+#define GPIO_FAST_READ( gpioPort, gpioPin ) \
+   ( (bool_t) LPC_GPIO_PORT->B[(gpioPort)][(gpioPin)] )
+#define GPIO_FAST_TOGGLE( gpioPort, gpioPin ) \
+   ( LPC_GPIO_PORT->NOT[(gpioPort)] = ( 1UL << (gpioPin) ) )
+
+/* Limits of a gpioMask_t handle */
+#define GPIO_MASK_MAX_PINS    16
+#define GPIO_MASK_MAX_PORTS   8  // LPC43xx GPIO ports 0 to 7
+
 /*==================[typedef]================================================*/
 
 /* Pin modes */
@@ -88,6 +102,27 @@ typedef struct {
 
 /* ------ End Pin Init Structs NXP LPC4337 ------ */
 
+/* Pre-resolved GPIO handle for gpioFastWrite(), gpioFastRead() and
+ * gpioFastToggle(). gpioFastInit() looks up the pin once; after that every
+ * access is a single register load or store without table lookups. */
+typedef struct {
+   volatile uint8_t*  pinReg;    // Byte pin register B[port][pin]
+   volatile uint32_t* toggleReg; // Toggle register NOT[port]
+   uint32_t           mask;      // Pin bit in the port
+} gpioFast_t;
+
+/* Set of pins written together by gpioWriteMask(). gpioMaskInit() groups the
+ * pins by GPIO port, so every write is one masked store (MPIN) per port and
+ * all pins of a port change at the same time. */
+typedef struct {
+   uint8_t  pinsAmount;
+   uint8_t  portsAmount;
+   uint8_t  port[GPIO_MASK_MAX_PORTS];        // GPIO port number
+   uint32_t portMask[GPIO_MASK_MAX_PORTS];    // Pins of the set in the port
+   uint8_t  pinPortIndex[GPIO_MASK_MAX_PINS]; // Index in port[] of each pin
+   uint32_t pinMask[GPIO_MASK_MAX_PINS];      // Bit of each pin in its port
+} gpioMask_t;
+
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -97,6 +132,34 @@ bool_t gpioRead( gpioMap_t pin );
 bool_t gpioWrite( gpioMap_t pin, bool_t value );
 bool_t gpioToggle( gpioMap_t pin );
 
+/* Resolve pin into handle. VCC and GND return FALSE and leave handle
+ * pointing to a dummy register, so the fast functions are harmless. */
+bool_t gpioFastInit( gpioMap_t pin, gpioFast_t* handle );
+
+/* Resolve pins into handle. Bit i of the value written by gpioWriteMask()
+ * is the state of pins[i]. VCC and GND entries are ignored. Returns FALSE
+ * if pinsAmount is greater than GPIO_MASK_MAX_PINS. */
+bool_t gpioMaskInit( gpioMask_t* handle,
+                     const gpioMap_t* pins, uint8_t pinsAmount );
+
+/* Write all the pins of handle, one masked store per GPIO port */
+void gpioWriteMask( const gpioMask_t* handle, uint32_t value );
+
+static inline void gpioFastWrite( const gpioFast_t* handle, bool_t value )
+{
+   *handle->pinReg = value;
+}
+
+static inline bool_t gpioFastRead( const gpioFast_t* handle )
+{
+   return (bool_t) *handle->pinReg;
+}
+
+static inline void gpioFastToggle( const gpioFast_t* handle )
+{
+   *handle->toggleReg = handle->mask;
+}
+
 /*==================[c++]====================================================*/
 #ifdef __cplusplus
 }
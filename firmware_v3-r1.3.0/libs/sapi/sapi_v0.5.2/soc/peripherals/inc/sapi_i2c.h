@@ -69,6 +69,13 @@ extern "C" {
 
 #define i2cConfig i2cInit
 
+// Interrupt driven transactions (hardware I2C only)
+#ifndef I2C_IRQ_PRIORITY
+#define I2C_IRQ_PRIORITY       5     // FreeRTOS syscall range
+#endif
+
+#define I2C_QUEUE_LENGTH       8     // Pending transactions (power of 2)
+
 /*==================[typedef]================================================*/
 
 #if( I2C_SOFTWARE == 1 )
@@ -83,6 +90,44 @@ typedef enum {
 } I2C_Software_ack_t;
 #endif
 
+#if( I2C_SOFTWARE == 0 )
+typedef struct i2cTransaction_t i2cTransaction_t;
+
+/* Completion callback, called from I2C0_IRQHandler() */
+typedef void (*i2cCallback_t)( i2cTransaction_t* transaction );
+
+/* Write txSize bytes and then, with a repeated start, read rxSize bytes.
+ * Either size can be 0; with both 0 only the address is sent (probe). The
+ * transaction and its buffers are owned by the caller and must remain valid
+ * until completion */
+struct i2cTransaction_t {
+   uint8_t           slaveAddress;
+   const uint8_t*    txBuffer;
+   uint16_t          txSize;
+   uint8_t*          rxBuffer;
+   uint16_t          rxSize;
+   i2cCallback_t     callback;   // NULL to poll status
+   void*             param;
+   // I2CM_STATUS_BUSY while queued or in progress, then I2CM_STATUS_OK or
+   // the error (I2CM_STATUS_NAK, I2CM_STATUS_SLAVE_NAK, ...)
+   volatile uint32_t status;
+};
+
+/* Runs a transaction of the blocking i2cRead() and i2cWrite() to completion
+ * (i2cTransactionStart() and the wait) and returns TRUE if the status is
+ * I2CM_STATUS_OK. Lets an RTOS block the calling task until the callback */
+typedef bool_t (*i2cBlockingTransfer_t)( i2cTransaction_t* transaction );
+
+/* Bus usage since i2cAsyncInit() */
+typedef struct {
+   uint32_t transactions;
+   uint32_t errors;
+   uint32_t bytes;
+   uint32_t busyCycles;          // Cycles counter (DWT) with the bus busy
+   uint32_t maxQueued;
+} i2cStats_t;
+#endif
+
 /*==================[external functions declaration]=========================*/
 
 bool_t i2cInit( i2cMap_t i2cNumber, uint32_t clockRateHz );
@@ -102,6 +147,29 @@ bool_t i2cWrite( i2cMap_t  i2cNumber,
                  uint16_t transmitDataBufferSize,
                  bool_t   sendWriteStop );
 
+#if( I2C_SOFTWARE == 0 )
+/* Initialize the bus for interrupt driven transactions. i2cRead() and
+ * i2cWrite() are queued with them afterwards, so both can be mixed. Every
+ * transaction ends with a stop: i2cRead() with sendWriteStop queues the write
+ * and the read as two transactions, and a write (alone) or a read without
+ * the stop is rejected */
+bool_t i2cAsyncInit( i2cMap_t i2cNumber, uint32_t clockRateHz );
+
+/* Run the blocking i2cRead() and i2cWrite() through transfer instead of
+ * spinning on the transaction status. NULL restores the spin */
+void i2cAsyncSetBlockingTransfer( i2cMap_t i2cNumber,
+                                  i2cBlockingTransfer_t transfer );
+
+/* Queue a transaction. Returns FALSE if the queue is full or the transaction
+ * is invalid (NULL buffer with a size, bus not initialized) */
+bool_t i2cTransactionStart( i2cMap_t i2cNumber, i2cTransaction_t* transaction );
+
+/* Remove a queued transaction or abort it with a stop condition if it is in
+ * progress. Its callback is not called. Returns FALSE if already completed */
+bool_t i2cTransactionCancel( i2cMap_t i2cNumber, i2cTransaction_t* transaction );
+
+void i2cGetStats( i2cMap_t i2cNumber, i2cStats_t* stats );
+#endif
 
 // Software Master I2C
 
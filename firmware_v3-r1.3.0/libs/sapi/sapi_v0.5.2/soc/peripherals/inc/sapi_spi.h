@@ -39,6 +39,7 @@
 
 #include "sapi_datatypes.h"
 #include "sapi_peripheral_map.h"
+#include "sapi_dma.h"
 
 /*==================[c++]====================================================*/
 #ifdef __cplusplus
@@ -49,6 +50,23 @@ extern "C" {
 
 #define spiConfig spiInit
 
+// Maximum number of GPDMA descriptors of a transfer in each direction. Each
+// segment takes one descriptor every DMA_MAX_TRANSFER_SIZE bytes
+#define SPI_DMA_MAX_DESCRIPTORS   16
+
+/*==================[typedef]================================================*/
+
+/* Segment of a DMA transfer. All segments of a transfer are shifted back to
+ * back in full duplex, in a single scatter-gather DMA list */
+typedef struct {
+   const uint8_t* txBuffer; // NULL to transmit 0xFF
+   uint8_t*       rxBuffer; // NULL to discard the received bytes
+   uint32_t       size;
+} spiSegment_t;
+
+/* Completion callback, called from DMA_IRQHandler() */
+typedef void (*spiCallback_t)( spiMap_t spi, bool_t ok, void* param );
+
 /*==================[external functions definition]==========================*/
 
 bool_t spiInit( spiMap_t spi );
@@ -57,6 +75,24 @@ bool_t spiRead( spiMap_t spi, uint8_t* buffer, uint32_t bufferSize );
 
 bool_t spiWrite( spiMap_t spi, uint8_t* buffer, uint32_t bufferSize);
 
+/* Reserve the GPDMA channels (TX and RX) of the SPI. Call after spiInit() */
+bool_t spiDmaInit( spiMap_t spi );
+
+/* Start a non-blocking full duplex DMA transfer of the segments. Returns
+ * FALSE if a transfer is in progress or the segments need more than
+ * SPI_DMA_MAX_DESCRIPTORS descriptors. The buffers must remain valid until
+ * the callback (it can be NULL and completion polled with spiTransferBusy) */
+bool_t spiTransferStart( spiMap_t spi,
+                         const spiSegment_t* segments, uint8_t segmentsAmount,
+                         spiCallback_t callback, void* param );
+
+/* TRUE while a DMA transfer is in progress */
+bool_t spiTransferBusy( spiMap_t spi );
+
+/* Blocking full duplex DMA transfer of a single buffer pair */
+bool_t spiTransfer( spiMap_t spi, const uint8_t* txBuffer, uint8_t* rxBuffer,
+                    uint32_t size );
+
 /*==================[c++]====================================================*/
 #ifdef __cplusplus
 }
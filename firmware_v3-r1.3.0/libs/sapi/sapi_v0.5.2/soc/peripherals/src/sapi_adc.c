@@ -40,16 +40,126 @@
 
 /*==================[macros and definitions]=================================*/
 
+// Fields of the ADC global data register moved by DMA
+#define ADC_GDR_CHANNEL(n)   (((n) >> 24) & 0x7)
+#define ADC_GDR_OVERRUN      (1UL << 30)
+
+// ADC clocks of a 10 bit burst conversion and range of the 8 bit CLKDIV
+// field computed by Chip_ADC_SetSampleRate()
+#define ADC_STREAM_CONV_CLOCKS   11
+#define ADC_STREAM_MAX_CLKDIV    255
+
+typedef struct {
+   uint32_t sum;
+   uint16_t count;
+   uint16_t factor;
+   bool_t   overrun;
+} adcDecimator_t;
+
 /*==================[internal data declaration]==============================*/
 
 /*==================[internal functions declaration]=========================*/
 
+static void adcStreamDmaCallback( uint8_t channel, bool_t ok, void* param );
+
 /*==================[internal data definition]===============================*/
 
+// Samples are decoded in place over the raw words
+typedef char adcStreamSampleSizeCheck[
+   (sizeof(adcStreamSample_t) == sizeof(uint32_t)) ? 1 : -1 ];
+
+static struct {
+   volatile bool_t     running;
+   int8_t              dmaChannel;
+   uint32_t            channels;      // Mask of LPC channels
+   uint32_t*           buffer;
+   uint32_t            halfSize;
+   adcStreamCallback_t callback;
+   void*               param;
+   dmaDescriptor_t     list[2];       // Circular ping-pong list
+   adcDecimator_t      decimator[ADC_STREAM_CHANNELS];
+   volatile uint16_t   last[ADC_STREAM_CHANNELS];
+   volatile uint32_t   overruns;
+} adcStream = { FALSE, -1 };
+
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
 
+// Decimate a completed half buffer and pass it to the callback
+static void adcStreamProcess( uint32_t* words, uint32_t amount )
+{
+   adcStreamSample_t* samples = (adcStreamSample_t*) words;
+   adcDecimator_t* decimator = NULL;
+   uint32_t produced = 0;
+   uint32_t word = 0;
+   uint32_t i = 0;
+   uint8_t ch = 0;
+
+   for( i=0; i<amount; i++ ) {
+      word = words[i];
+      ch = ADC_GDR_CHANNEL( word );
+      if( !(adcStream.channels & (1UL << ch)) ) {
+         continue;
+      }
+      decimator = &adcStream.decimator[ch];
+      decimator->sum += ADC_DR_RESULT( word );
+      decimator->count++;
+      if( word & ADC_GDR_OVERRUN ) {
+         decimator->overrun = TRUE;
+         adcStream.overruns++;
+      }
+      if( decimator->count < decimator->factor ) {
+         continue;
+      }
+
+      // produced <= i: the word has already been read
+      samples[produced].value   = decimator->sum / decimator->count;
+      samples[produced].channel = ch - 1;
+      samples[produced].overrun = decimator->overrun;
+      adcStream.last[ch] = samples[produced].value;
+      produced++;
+
+      decimator->sum     = 0;
+      decimator->count   = 0;
+      decimator->overrun = FALSE;
+   }
+
+   if( (produced > 0) && (adcStream.callback != NULL) ) {
+      adcStream.callback( samples, produced, adcStream.param );
+   }
+}
+
+// Total rates below PCLK_ADC0 / (256 * 11), about 72 kS/s at 204 MHz, need a
+// divider that Chip_ADC_SetSampleRate() truncates to 8 bits, which would
+// silently run the ADC much faster than requested
+static bool_t adcStreamRateFits( uint32_t totalRate )
+{
+   uint32_t fullRate = totalRate * ADC_STREAM_CONV_CLOCKS;
+   uint32_t pclk = Chip_Clock_GetRate( CLK_APB3_ADC0 );
+
+   // Same rounding as getClkDiv(): (2 * A + B) / (2 * B) - 1
+   return ( (2 * pclk + fullRate) / (2 * fullRate) - 1 ) <= ADC_STREAM_MAX_CLKDIV;
+}
+
+static void adcStreamDmaCallback( uint8_t channel, bool_t ok, void* param )
+{
+   uint32_t next = LPC_GPDMA->CH[channel].LLI;
+
+   if( !adcStream.running || !ok ) {
+      return;
+   }
+
+   // The channel has already loaded the descriptor of the other half, whose
+   // link points back to the half just completed
+   if( next == (uint32_t) &adcStream.list[0] ) {
+      adcStreamProcess( adcStream.buffer, adcStream.halfSize );
+   } else {
+      adcStreamProcess( adcStream.buffer + adcStream.halfSize,
+                        adcStream.halfSize );
+   }
+}
+
 /*==================[external functions definition]==========================*/
 
 /*
@@ -134,6 +244,10 @@ uint16_t adcRead( adcMap_t analogInput )
    uint8_t lpcAdcChannel = analogInput + 1;
    uint16_t analogValue = 0;
 
+   if( adcStream.running ) {
+      return adcStream.last[lpcAdcChannel];
+   }
+
    // Enable channel
    Chip_ADC_EnableChannel(LPC_ADC0, lpcAdcChannel, ENABLE);
 
@@ -154,4 +268,125 @@ uint16_t adcRead( adcMap_t analogInput )
    return analogValue;
 }
 
+
+bool_t adcStreamStart( uint32_t channelsMask, uint32_t sampleRate,
+                       uint32_t* buffer, uint32_t bufferSize,
+                       adcStreamCallback_t callback, void* param )
+{
+   ADC_CLOCK_SETUP_T adcSetup = { ADC_MAX_SAMPLE_RATE, ADC_10BITS, true };
+   uint32_t channelsAmount = 0;
+   uint8_t ch = 0;
+
+   if( adcStream.running || (buffer == NULL) || (sampleRate == 0) ||
+       (bufferSize < 2) || (bufferSize / 2 > DMA_MAX_TRANSFER_SIZE) ) {
+      return FALSE;
+   }
+
+   // adcMap_t n is LPC channel n + 1
+   adcStream.channels = (channelsMask << 1) & ((1UL << ADC_STREAM_CHANNELS) - 2);
+   for( ch=0; ch<ADC_STREAM_CHANNELS; ch++ ) {
+      if( adcStream.channels & (1UL << ch) ) {
+         channelsAmount++;
+      }
+   }
+   if( (channelsAmount == 0) ||
+       (sampleRate * channelsAmount > ADC_MAX_SAMPLE_RATE) ||
+       !adcStreamRateFits( sampleRate * channelsAmount ) ) {
+      return FALSE;
+   }
+
+   if( adcStream.dmaChannel < 0 ) {
+      dmaInit();
+      adcStream.dmaChannel = dmaChannelAlloc( GPDMA_CONN_ADC_0,
+                                              adcStreamDmaCallback, NULL );
+      if( adcStream.dmaChannel < 0 ) {
+         return FALSE;
+      }
+   }
+
+   adcStream.buffer   = buffer;
+   adcStream.halfSize = bufferSize / 2;
+   adcStream.callback = callback;
+   adcStream.param    = param;
+   adcStream.overruns = 0;
+   for( ch=0; ch<ADC_STREAM_CHANNELS; ch++ ) {
+      adcStream.decimator[ch].sum     = 0;
+      adcStream.decimator[ch].count   = 0;
+      adcStream.decimator[ch].overrun = FALSE;
+      if( adcStream.decimator[ch].factor == 0 ) {
+         adcStream.decimator[ch].factor = 1;
+      }
+      adcStream.last[ch] = 0;
+   }
+
+   // Both halves interrupt on terminal count and link to each other
+   Chip_GPDMA_PrepareDescriptor( LPC_GPDMA, &adcStream.list[0],
+      GPDMA_CONN_ADC_0, (uint32_t) buffer, adcStream.halfSize,
+      GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA, &adcStream.list[1] );
+   Chip_GPDMA_PrepareDescriptor( LPC_GPDMA, &adcStream.list[1],
+      GPDMA_CONN_ADC_0, (uint32_t) (buffer + adcStream.halfSize),
+      adcStream.halfSize, GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA,
+      &adcStream.list[0] );
+   adcStream.list[0].ctrl |= GPDMA_DMACCxControl_I;
+   adcStream.list[1].ctrl |= GPDMA_DMACCxControl_I;
+
+   // A DMA request for each conversion of the enabled channels
+   Chip_ADC_SetBurstCmd( LPC_ADC0, DISABLE );
+   for( ch=1; ch<ADC_STREAM_CHANNELS; ch++ ) {
+      bool_t enabled = (adcStream.channels & (1UL << ch)) != 0;
+      Chip_ADC_EnableChannel( LPC_ADC0, ch, enabled ? ENABLE : DISABLE );
+      Chip_ADC_Int_SetChannelCmd( LPC_ADC0, ch, enabled ? ENABLE : DISABLE );
+   }
+   Chip_ADC_SetSampleRate( LPC_ADC0, &adcSetup, sampleRate * channelsAmount );
+
+   adcStream.running = TRUE;
+   if( !dmaStart( adcStream.dmaChannel, &adcStream.list[0], GPDMA_CONN_ADC_0,
+                  GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA ) ) {
+      adcStreamStop();
+      return FALSE;
+   }
+   // Burst conversions paced by the ADC clock
+   Chip_ADC_SetBurstCmd( LPC_ADC0, ENABLE );
+
+   return TRUE;
+}
+
+
+bool_t adcStreamSetDecimation( adcMap_t analogInput, uint16_t factor )
+{
+   uint8_t lpcAdcChannel = analogInput + 1;
+
+   if( (lpcAdcChannel >= ADC_STREAM_CHANNELS) || (factor == 0) ||
+       (factor > ADC_STREAM_MAX_DECIMATION) ) {
+      return FALSE;
+   }
+   adcStream.decimator[lpcAdcChannel].factor = factor;
+
+   return TRUE;
+}
+
+
+void adcStreamStop( void )
+{
+   uint8_t ch = 0;
+
+   Chip_ADC_SetBurstCmd( LPC_ADC0, DISABLE );
+   adcStream.running = FALSE;
+   if( adcStream.dmaChannel >= 0 ) {
+      dmaStop( adcStream.dmaChannel );
+   }
+
+   // Back to single conversions of adcRead()
+   for( ch=1; ch<ADC_STREAM_CHANNELS; ch++ ) {
+      Chip_ADC_EnableChannel( LPC_ADC0, ch, DISABLE );
+      Chip_ADC_Int_SetChannelCmd( LPC_ADC0, ch, DISABLE );
+   }
+}
+
+
+uint32_t adcStreamOverruns( void )
+{
+   return adcStream.overruns;
+}
+
 /*==================[end of file]============================================*/
@@ -40,16 +40,49 @@
 
 /*==================[macros and definitions]=================================*/
 
+#define DAC_STREAM_MAX_RATE   400000
+
 /*==================[internal data declaration]==============================*/
 
 /*==================[internal functions declaration]=========================*/
 
+static void dacStreamDmaCallback( uint8_t channel, bool_t ok, void* param );
+
 /*==================[internal data definition]===============================*/
 
+static struct {
+   volatile bool_t     running;
+   int8_t              dmaChannel;
+   uint32_t*           buffer;
+   uint32_t            halfSize;
+   dacStreamCallback_t callback;
+   void*               param;
+   dmaDescriptor_t     list[2];       // Circular ping-pong list
+} dacStream = { FALSE, -1 };
+
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
 
+static void dacStreamDmaCallback( uint8_t channel, bool_t ok, void* param )
+{
+   uint32_t next = LPC_GPDMA->CH[channel].LLI;
+
+   if( !dacStream.running || !ok || (dacStream.callback == NULL) ) {
+      return;
+   }
+
+   // The channel has already loaded the descriptor of the other half, whose
+   // link points back to the half just played
+   if( next == (uint32_t) &dacStream.list[0] ) {
+      dacStream.callback( dacStream.buffer, dacStream.halfSize,
+                          dacStream.param );
+   } else {
+      dacStream.callback( dacStream.buffer + dacStream.halfSize,
+                          dacStream.halfSize, dacStream.param );
+   }
+}
+
 /*==================[external functions definition]==========================*/
 
 /*
@@ -93,7 +126,7 @@ void dacInit( dacInit_t config )
  */
 void dacWrite( dacMap_t analogOutput, uint16_t value )
 {
-   if( analogOutput == 0 ) {
+   if( (analogOutput == 0) && !dacStream.running ) {
       if( value > 1023 ) {
          value = 1023;
       }
@@ -101,4 +134,80 @@ void dacWrite( dacMap_t analogOutput, uint16_t value )
    }
 }
 
+
+bool_t dacStreamStart( uint32_t sampleRate, uint32_t* buffer,
+                       uint32_t bufferSize, dacStreamCallback_t callback,
+                       void* param )
+{
+   uint32_t period = 0;
+   uint8_t i = 0;
+
+   if( dacStream.running || (buffer == NULL) || (sampleRate == 0) ||
+       (sampleRate > DAC_STREAM_MAX_RATE) ||
+       (bufferSize < 2) || (bufferSize % 2) ||
+       (bufferSize / 2 > DMA_MAX_TRANSFER_SIZE) ) {
+      return FALSE;
+   }
+
+   // DMA request each time the 16 bit counter reaches 0
+   period = Chip_Clock_GetRate( CLK_APB3_DAC ) / sampleRate;
+   if( period > 0xFFFF ) {
+      return FALSE;
+   }
+
+   if( dacStream.dmaChannel < 0 ) {
+      dmaInit();
+      dacStream.dmaChannel = dmaChannelAlloc( GPDMA_CONN_DAC,
+                                              dacStreamDmaCallback, NULL );
+      if( dacStream.dmaChannel < 0 ) {
+         return FALSE;
+      }
+   }
+
+   dacStream.buffer   = buffer;
+   dacStream.halfSize = bufferSize / 2;
+   dacStream.callback = callback;
+   dacStream.param    = param;
+
+   Chip_GPDMA_PrepareDescriptor( LPC_GPDMA, &dacStream.list[0],
+      (uint32_t) buffer, GPDMA_CONN_DAC, dacStream.halfSize,
+      GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, &dacStream.list[1] );
+   Chip_GPDMA_PrepareDescriptor( LPC_GPDMA, &dacStream.list[1],
+      (uint32_t) (buffer + dacStream.halfSize), GPDMA_CONN_DAC,
+      dacStream.halfSize, GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA,
+      &dacStream.list[0] );
+   // Interrupts only to refill
+   for( i=0; i<2; i++ ) {
+      if( callback != NULL ) {
+         dacStream.list[i].ctrl |= GPDMA_DMACCxControl_I;
+      } else {
+         dacStream.list[i].ctrl &= ~GPDMA_DMACCxControl_I;
+      }
+   }
+
+   dacStream.running = TRUE;
+   Chip_DAC_SetDMATimeOut( LPC_DAC, period );
+   if( !dmaStart( dacStream.dmaChannel, &dacStream.list[0], GPDMA_CONN_DAC,
+                  GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA ) ) {
+      dacStreamStop();
+      return FALSE;
+   }
+   // Samples are moved to the output when the counter reaches 0
+   Chip_DAC_ConfigDAConverterControl( LPC_DAC,
+                                      DAC_DBLBUF_ENA | DAC_CNT_ENA | DAC_DMA_ENA );
+
+   return TRUE;
+}
+
+
+void dacStreamStop( void )
+{
+   // Back to the direct writes of dacWrite()
+   Chip_DAC_ConfigDAConverterControl( LPC_DAC, DAC_DMA_ENA );
+   if( dacStream.dmaChannel >= 0 ) {
+      dmaStop( dacStream.dmaChannel );
+   }
+   dacStream.running = FALSE;
+}
+
 /*==================[end of file]============================================*/
@@ -0,0 +1,187 @@
+/* Copyright 2020, Gonzalo G. Fernandez.
+ * All rights reserved.
+ *
+ * This file is part sAPI library for microcontrollers.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Date: 2020-10-19 */
+
+/*==================[inclusions]=============================================*/
+
+#include "sapi_dma.h"
+
+/*==================[macros and definitions]=================================*/
+
+typedef struct {
+   bool_t        inUse;
+   dmaCallback_t callback;
+   void*         param;
+} dmaChannel_t;
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+static dmaChannel_t dmaChannels[GPDMA_NUMBER_CHANNELS];
+static bool_t dmaInitialized = FALSE;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+
+bool_t dmaInit( void )
+{
+   if( dmaInitialized ) {
+      return TRUE;
+   }
+
+   Chip_GPDMA_Init( LPC_GPDMA );
+   NVIC_SetPriority( DMA_IRQn, DMA_IRQ_PRIORITY );
+   NVIC_ClearPendingIRQ( DMA_IRQn );
+   NVIC_EnableIRQ( DMA_IRQn );
+   dmaInitialized = TRUE;
+
+   return TRUE;
+}
+
+
+int8_t dmaChannelAlloc( uint32_t connection, dmaCallback_t callback,
+                        void* param )
+{
+   uint8_t channel = 0;
+
+   if( !dmaInitialized ) {
+      return -1;
+   }
+
+   // Chip_GPDMA_GetFreeChannel() returns 0 also when there is no free
+   // channel, so an already reserved channel means none is left
+   channel = Chip_GPDMA_GetFreeChannel( LPC_GPDMA, connection );
+   if( dmaChannels[channel].inUse ) {
+      return -1;
+   }
+
+   dmaChannels[channel].callback = callback;
+   dmaChannels[channel].param    = param;
+   dmaChannels[channel].inUse    = TRUE;
+
+   return (int8_t) channel;
+}
+
+
+void dmaChannelFree( uint8_t channel )
+{
+   if( channel >= GPDMA_NUMBER_CHANNELS ) {
+      return;
+   }
+
+   Chip_GPDMA_Stop( LPC_GPDMA, channel );
+   dmaChannels[channel].inUse    = FALSE;
+   dmaChannels[channel].callback = NULL;
+   dmaChannels[channel].param    = NULL;
+}
+
+
+bool_t dmaStart( uint8_t channel, const dmaDescriptor_t* first,
+                 uint32_t connection, GPDMA_FLOW_CONTROL_T transferType )
+{
+   dmaDescriptor_t head = *first;
+
+   if( (channel >= GPDMA_NUMBER_CHANNELS) || !dmaChannels[channel].inUse ) {
+      return FALSE;
+   }
+
+   // Chip_GPDMA_SGTransfer() resolves the peripheral side of the first
+   // descriptor from its connection number instead of its address
+   switch( transferType ) {
+   case GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA:
+   case GPDMA_TRANSFERTYPE_M2P_CONTROLLER_PERIPHERAL:
+      head.dst = connection;
+      break;
+   case GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA:
+   case GPDMA_TRANSFERTYPE_P2M_CONTROLLER_PERIPHERAL:
+      head.src = connection;
+      break;
+   case GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA:
+      break;
+   default:
+      return FALSE;
+   }
+
+   return Chip_GPDMA_SGTransfer( LPC_GPDMA, channel, &head, transferType )
+          == SUCCESS;
+}
+
+
+void dmaStop( uint8_t channel )
+{
+   if( channel >= GPDMA_NUMBER_CHANNELS ) {
+      return;
+   }
+
+   Chip_GPDMA_ChannelCmd( LPC_GPDMA, channel, DISABLE );
+   Chip_GPDMA_ClearIntPending( LPC_GPDMA, GPDMA_STATCLR_INTTC, channel );
+   Chip_GPDMA_ClearIntPending( LPC_GPDMA, GPDMA_STATCLR_INTERR, channel );
+}
+
+
+bool_t dmaIsBusy( uint8_t channel )
+{
+   return Chip_GPDMA_IntGetStatus( LPC_GPDMA, GPDMA_STAT_ENABLED_CH, channel )
+          == SET;
+}
+
+/*==================[ISR external functions definition]======================*/
+
+void DMA_IRQHandler( void )
+{
+   uint32_t status = LPC_GPDMA->INTSTAT;
+   uint32_t tc     = LPC_GPDMA->INTTCSTAT & status;
+   uint32_t err    = LPC_GPDMA->INTERRSTAT & status;
+   uint8_t channel = 0;
+
+   LPC_GPDMA->INTTCCLEAR = tc;
+   LPC_GPDMA->INTERRCLR  = err;
+
+   for( channel=0; channel<GPDMA_NUMBER_CHANNELS; channel++ ) {
+      if( !(status & (1UL << channel)) ) {
+         continue;
+      }
+      if( dmaChannels[channel].callback != NULL ) {
+         dmaChannels[channel].callback( channel, !(err & (1UL << channel)),
+                                        dmaChannels[channel].param );
+      }
+   }
+}
+
+/*==================[end of file]============================================*/
@@ -45,6 +45,10 @@
 
 /*==================[internal data definition]===============================*/
 
+/* Target of gpioFast_t handles of VCC and GND pins */
+static volatile uint8_t  gpioFastDummyPin    = 0;
+static volatile uint32_t gpioFastDummyToggle = 0;
+
 const pinInitGpioLpc4337_t gpioPinsInit[] = {
 
    //{ {PinNamePortN ,PinNamePinN}, PinFUNC, {GpioPortN, GpioPinN} }
@@ -355,7 +359,39 @@ bool_t gpioWrite( gpioMap_t pin, bool_t value )
 
 bool_t gpioToggle( gpioMap_t pin )
 {
-   return gpioWrite( pin, !gpioRead(pin) );
+   if( pin == VCC ){
+      return FALSE;
+   }
+   if( pin == GND ){
+      return FALSE;
+   }
+
+   // Single lookup and a write to the toggle register instead of a
+   // read-modify-write of the pin
+   Chip_GPIO_SetPortToggle( LPC_GPIO_PORT, gpioPinsInit[pin].gpio.port,
+                            1 << gpioPinsInit[pin].gpio.pin );
+
+   return TRUE;
+}
+
+
+bool_t gpioFastInit( gpioMap_t pin, gpioFast_t* handle )
+{
+   if( (pin == VCC) || (pin == GND) ){
+      handle->pinReg    = &gpioFastDummyPin;
+      handle->toggleReg = &gpioFastDummyToggle;
+      handle->mask      = 0;
+      return FALSE;
+   }
+
+   int8_t gpioPort = gpioPinsInit[pin].gpio.port;
+   int8_t gpioPin  = gpioPinsInit[pin].gpio.pin;
+
+   handle->pinReg    = &LPC_GPIO_PORT->B[gpioPort][gpioPin];
+   handle->toggleReg = &LPC_GPIO_PORT->NOT[gpioPort];
+   handle->mask      = 1UL << gpioPin;
+
+   return TRUE;
 }
 
 
@@ -386,4 +422,79 @@ bool_t gpioRead( gpioMap_t pin )
    return ret_val;
 }
 
+
+
+bool_t gpioMaskInit( gpioMask_t* handle,
+                     const gpioMap_t* pins, uint8_t pinsAmount )
+{
+   uint8_t i = 0;
+   uint8_t p = 0;
+
+   handle->pinsAmount  = 0;
+   handle->portsAmount = 0;
+
+   if( pinsAmount > GPIO_MASK_MAX_PINS ){
+      return FALSE;
+   }
+
+   for( i=0; i<pinsAmount; i++ ) {
+      handle->pinPortIndex[i] = GPIO_MASK_MAX_PORTS; // Not connected
+      handle->pinMask[i]      = 0;
+
+      if( (pins[i] == VCC) || (pins[i] == GND) ){
+         continue;
+      }
+
+      int8_t gpioPort = gpioPinsInit[pins[i]].gpio.port;
+      int8_t gpioPin  = gpioPinsInit[pins[i]].gpio.pin;
+
+      // Find the port of the pin or add it
+      for( p=0; p<handle->portsAmount; p++ ) {
+         if( handle->port[p] == gpioPort ){
+            break;
+         }
+      }
+      if( p == handle->portsAmount ){
+         handle->port[p]     = gpioPort;
+         handle->portMask[p] = 0;
+         handle->portsAmount++;
+      }
+
+      handle->pinPortIndex[i] = p;
+      handle->pinMask[i]      = 1UL << gpioPin;
+      handle->portMask[p]    |= 1UL << gpioPin;
+   }
+   handle->pinsAmount = pinsAmount;
+
+   return TRUE;
+}
+
+
+void gpioWriteMask( const gpioMask_t* handle, uint32_t value )
+{
+   uint32_t portValue[GPIO_MASK_MAX_PORTS + 1] = { 0 };
+   uint32_t primask;
+   uint8_t i = 0;
+
+   // Spread the value bits over the ports (index GPIO_MASK_MAX_PORTS
+   // collects the VCC and GND entries)
+   for( i=0; i<handle->pinsAmount; i++ ) {
+      if( value & (1UL << i) ){
+         portValue[handle->pinPortIndex[i]] |= handle->pinMask[i];
+      }
+   }
+
+   // MASK and MPIN of a port must not be interleaved with another masked
+   // write to the same port; only the MPIN store changes the pins
+   for( i=0; i<handle->portsAmount; i++ ) {
+      primask = __get_PRIMASK();
+      __disable_irq();
+      Chip_GPIO_SetPortMask( LPC_GPIO_PORT, handle->port[i],
+                             ~handle->portMask[i] );
+      Chip_GPIO_SetMaskedPortValue( LPC_GPIO_PORT, handle->port[i],
+                                    portValue[i] );
+      __set_PRIMASK( primask );
+   }
+}
+
 /*==================[end of file]============================================*/
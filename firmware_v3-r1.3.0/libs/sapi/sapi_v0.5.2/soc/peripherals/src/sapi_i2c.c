@@ -47,6 +47,7 @@
 #include "sapi_i2c.h"
 #include "sapi_gpio.h"
 #include "sapi_delay.h"
+#include "sapi_cyclesCounter.h"
 
 /*==================[macros and definitions]=================================*/
 
@@ -96,10 +97,36 @@ static bool_t i2cHardwareWrite( i2cMap_t  i2cNumber,
                                 uint16_t transmitDataBufferSize,
                                 bool_t   sendWriteStop );
 
+static bool_t i2cHardwareTransfer( uint8_t  i2cSlaveAddress,
+                                   uint8_t* transmitDataBuffer,
+                                   uint16_t transmitDataBufferSize,
+                                   uint8_t* receiveDataBuffer,
+                                   uint16_t receiveDataBufferSize );
+
+static bool_t i2cTransactionValid( i2cTransaction_t* transaction );
+
+static void i2cAsyncStartNext( void );
+
 #endif
 
 /*==================[internal data definition]===============================*/
 
+#if( I2C_SOFTWARE == 0 )
+// Transaction queue of I2C0. Only I2C0_IRQHandler() advances the transaction
+// in progress; queue and current transaction change with interrupts disabled
+static struct {
+   bool_t                     initialized;
+   i2cTransaction_t*          queue[I2C_QUEUE_LENGTH];
+   uint8_t                    head;
+   uint8_t                    tail;
+   i2cTransaction_t* volatile current;
+   I2CM_XFER_T                xfer;
+   uint32_t                   startCycles;
+   i2cStats_t                 stats;
+   i2cBlockingTransfer_t      blockingTransfer;
+} i2cAsync;
+#endif
+
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
@@ -288,6 +315,28 @@ static bool_t i2cHardwareRead( i2cMap_t  i2cNumber,
 
    I2CM_XFER_T i2cData;
 
+   if( i2cAsync.initialized ) {
+      // Every queued transaction ends with a stop
+      if( ((receiveDataBufferSize > 0) && !sendReadStop) ||
+          ((receiveDataBufferSize == 0) && (dataToReadBufferSize > 0) &&
+           !sendWriteStop) ) {
+         return FALSE;
+      }
+      // Stop after the write: the read is a second transaction
+      if( sendWriteStop && (dataToReadBufferSize > 0) &&
+          (receiveDataBufferSize > 0) ) {
+         if( !i2cHardwareTransfer( i2cSlaveAddress,
+                                   dataToReadBuffer, dataToReadBufferSize,
+                                   NULL, 0 ) ) {
+            return FALSE;
+         }
+         dataToReadBufferSize = 0;
+      }
+      return i2cHardwareTransfer( i2cSlaveAddress,
+                                  dataToReadBuffer, dataToReadBufferSize,
+                                  receiveDataBuffer, receiveDataBufferSize );
+   }
+
    i2cData.slaveAddr = i2cSlaveAddress;
    i2cData.options   = 0;
    i2cData.status    = 0;
@@ -318,6 +367,16 @@ static bool_t i2cHardwareWrite( i2cMap_t  i2cNumber,
       return FALSE;
    }
 
+   if( i2cAsync.initialized ) {
+      // A write without stop only starts a read: use i2cRead()
+      if( !sendWriteStop ) {
+         return FALSE;
+      }
+      return i2cHardwareTransfer( i2cSlaveAddress,
+                                  transmitDataBuffer, transmitDataBufferSize,
+                                  NULL, 0 );
+   }
+
    // Prepare the i2cData register
    i2cData.slaveAddr = i2cSlaveAddress;
    i2cData.options   = 0;
@@ -350,6 +409,85 @@ static bool_t i2cHardwareWrite( i2cMap_t  i2cNumber,
    return TRUE;
 }
 
+// Blocking transfer through the transaction queue
+static bool_t i2cHardwareTransfer( uint8_t  i2cSlaveAddress,
+                                   uint8_t* transmitDataBuffer,
+                                   uint16_t transmitDataBufferSize,
+                                   uint8_t* receiveDataBuffer,
+                                   uint16_t receiveDataBufferSize )
+{
+   i2cTransaction_t transaction;
+
+   transaction.slaveAddress = i2cSlaveAddress;
+   transaction.txBuffer     = transmitDataBuffer;
+   transaction.txSize       = transmitDataBufferSize;
+   transaction.rxBuffer     = receiveDataBuffer;
+   transaction.rxSize       = receiveDataBufferSize;
+   transaction.callback     = NULL;
+   transaction.param        = NULL;
+
+   // Rejected arguments would never be queued: spin only on a full queue
+   if( !i2cTransactionValid( &transaction ) ) {
+      return FALSE;
+   }
+   if( i2cAsync.blockingTransfer != NULL ) {
+      return i2cAsync.blockingTransfer( &transaction );
+   }
+
+   while( !i2cTransactionStart( I2C0, &transaction ) );
+   while( transaction.status == I2CM_STATUS_BUSY );
+
+   return transaction.status == I2CM_STATUS_OK;
+}
+
+// Buffers for the sizes. Both sizes 0 is an address probe
+static bool_t i2cTransactionValid( i2cTransaction_t* transaction )
+{
+   return (transaction != NULL) &&
+          ((transaction->txSize == 0) || (transaction->txBuffer != NULL)) &&
+          ((transaction->rxSize == 0) || (transaction->rxBuffer != NULL));
+}
+
+static void i2cAsyncStartNext( void )
+{
+   i2cTransaction_t* transaction = NULL;
+   uint32_t primask = __get_PRIMASK();
+
+   __disable_irq();
+   if( (i2cAsync.current == NULL) && (i2cAsync.tail != i2cAsync.head) ) {
+      transaction = i2cAsync.queue[ i2cAsync.tail & (I2C_QUEUE_LENGTH - 1) ];
+      i2cAsync.tail++;
+      i2cAsync.current = transaction;
+
+      i2cAsync.xfer.slaveAddr = transaction->slaveAddress;
+      i2cAsync.xfer.options   = 0;
+      i2cAsync.xfer.txBuff    = transaction->txBuffer;
+      i2cAsync.xfer.txSz      = transaction->txSize;
+      i2cAsync.xfer.rxBuff    = transaction->rxBuffer;
+      i2cAsync.xfer.rxSz      = transaction->rxSize;
+      i2cAsync.startCycles    = cyclesCounterRead();
+      Chip_I2CM_Xfer( LPC_I2C0, &i2cAsync.xfer );
+   }
+   __set_PRIMASK( primask );
+}
+
+// Account the transaction in progress (interrupts disabled)
+static void i2cAsyncEnd( uint32_t status )
+{
+   i2cTransaction_t* transaction = i2cAsync.current;
+
+   i2cAsync.stats.transactions++;
+   if( status != I2CM_STATUS_OK ) {
+      i2cAsync.stats.errors++;
+   }
+   i2cAsync.stats.bytes += (transaction->txSize - i2cAsync.xfer.txSz) +
+                           (transaction->rxSize - i2cAsync.xfer.rxSz);
+   i2cAsync.stats.busyCycles += cyclesCounterRead() - i2cAsync.startCycles;
+
+   i2cAsync.current = NULL;
+   transaction->status = status;
+}
+
 #endif
 
 
@@ -445,6 +583,125 @@ bool_t i2cWrite( i2cMap_t  i2cNumber,
 }
 
 
+#if( I2C_SOFTWARE == 0 )
+
+bool_t i2cAsyncInit( i2cMap_t i2cNumber, uint32_t clockRateHz )
+{
+   if( i2cNumber != I2C0 ) {
+      return FALSE;
+   }
+   if( i2cAsync.initialized ) {
+      return TRUE;
+   }
+
+   i2cHardwareInit( i2cNumber, clockRateHz );
+
+   // Cycles counter for busy time, without resetting it
+   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+   DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+   NVIC_SetPriority( I2C0_IRQn, I2C_IRQ_PRIORITY );
+   NVIC_ClearPendingIRQ( I2C0_IRQn );
+   NVIC_EnableIRQ( I2C0_IRQn );
+   i2cAsync.initialized = TRUE;
+
+   return TRUE;
+}
+
+
+void i2cAsyncSetBlockingTransfer( i2cMap_t i2cNumber,
+                                  i2cBlockingTransfer_t transfer )
+{
+   if( i2cNumber == I2C0 ) {
+      i2cAsync.blockingTransfer = transfer;
+   }
+}
+
+
+bool_t i2cTransactionStart( i2cMap_t i2cNumber, i2cTransaction_t* transaction )
+{
+   uint8_t queued = 0;
+   uint32_t primask = 0;
+
+   if( (i2cNumber != I2C0) || !i2cAsync.initialized ||
+       !i2cTransactionValid( transaction ) ) {
+      return FALSE;
+   }
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+   queued = i2cAsync.head - i2cAsync.tail;
+   if( queued >= I2C_QUEUE_LENGTH ) {
+      __set_PRIMASK( primask );
+      return FALSE;
+   }
+   transaction->status = I2CM_STATUS_BUSY;
+   i2cAsync.queue[ i2cAsync.head & (I2C_QUEUE_LENGTH - 1) ] = transaction;
+   i2cAsync.head++;
+   if( queued + 1 > i2cAsync.stats.maxQueued ) {
+      i2cAsync.stats.maxQueued = queued + 1;
+   }
+   __set_PRIMASK( primask );
+
+   i2cAsyncStartNext();
+
+   return TRUE;
+}
+
+
+bool_t i2cTransactionCancel( i2cMap_t i2cNumber, i2cTransaction_t* transaction )
+{
+   bool_t retVal = FALSE;
+   uint8_t i = 0;
+   uint32_t primask = 0;
+
+   if( (i2cNumber != I2C0) || (transaction == NULL) ) {
+      return FALSE;
+   }
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+   if( i2cAsync.current == transaction ) {
+      // Release the bus and leave the controller ready for the next start
+      Chip_I2CM_SendStop( LPC_I2C0 );
+      Chip_I2CM_ResetControl( LPC_I2C0 );
+      i2cAsyncEnd( I2CM_STATUS_ERROR );
+      retVal = TRUE;
+   } else {
+      // Remove it from the queue keeping the order of the rest
+      for( i=i2cAsync.tail; i!=i2cAsync.head; i++ ) {
+         if( retVal ) {
+            i2cAsync.queue[ (uint8_t)(i - 1) & (I2C_QUEUE_LENGTH - 1) ] =
+               i2cAsync.queue[ i & (I2C_QUEUE_LENGTH - 1) ];
+         } else if( i2cAsync.queue[ i & (I2C_QUEUE_LENGTH - 1) ] == transaction ) {
+            transaction->status = I2CM_STATUS_ERROR;
+            retVal = TRUE;
+         }
+      }
+      if( retVal ) {
+         i2cAsync.head--;
+      }
+   }
+   __set_PRIMASK( primask );
+
+   i2cAsyncStartNext();
+
+   return retVal;
+}
+
+
+void i2cGetStats( i2cMap_t i2cNumber, i2cStats_t* stats )
+{
+   uint32_t primask = __get_PRIMASK();
+
+   __disable_irq();
+   *stats = i2cAsync.stats;
+   __set_PRIMASK( primask );
+}
+
+#endif
+
+
 #if( I2C_SOFTWARE == 1 )
 // Software Master I2C
 
@@ -787,4 +1044,30 @@ void i2cSoftwareMasterPinTest( void )
 
 /*==================[ISR external functions definition]======================*/
 
+#if( I2C_SOFTWARE == 0 )
+void I2C0_IRQHandler( void )
+{
+   i2cTransaction_t* transaction = NULL;
+   uint32_t primask = __get_PRIMASK();
+
+   // Short state step, atomic with i2cTransactionCancel()
+   __disable_irq();
+   if( i2cAsync.current == NULL ) {
+      Chip_I2CM_ClearSI( LPC_I2C0 );
+   } else if( Chip_I2CM_XferHandler( LPC_I2C0, &i2cAsync.xfer ) ) {
+      transaction = i2cAsync.current;
+      i2cAsyncEnd( i2cAsync.xfer.status );
+   }
+   __set_PRIMASK( primask );
+
+   if( transaction != NULL ) {
+      // Keep the bus busy before running the callback
+      i2cAsyncStartNext();
+      if( transaction->callback != NULL ) {
+         transaction->callback( transaction );
+      }
+   }
+}
+#endif
+
 /*==================[end of file]============================================*/
@@ -50,10 +50,114 @@
 
 /*==================[internal data definition]===============================*/
 
+// DMA state of SPI0 (SSP1)
+static struct {
+   int8_t                txChannel;
+   int8_t                rxChannel;
+   volatile bool_t       busy;
+   volatile bool_t       ok;
+   spiCallback_t         callback;
+   void*                 param;
+   dmaDescriptor_t       txList[SPI_DMA_MAX_DESCRIPTORS];
+   dmaDescriptor_t       rxList[SPI_DMA_MAX_DESCRIPTORS];
+} spiDma = { -1, -1, FALSE, FALSE, NULL, NULL };
+
+// Source of transmitted bytes and sink of discarded bytes (no increment)
+static const uint8_t spiDmaDummyTx = 0xFF;
+static uint8_t spiDmaDummyRx;
+
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
 
+static void spiDmaFinish( bool_t ok )
+{
+   dmaStop( spiDma.txChannel );
+   dmaStop( spiDma.rxChannel );
+   Chip_SSP_DMA_Disable( LPC_SSP1 );
+   spiDma.ok   = ok;
+   spiDma.busy = FALSE;
+
+   if( spiDma.callback != NULL ) {
+      spiDma.callback( SPI0, ok, spiDma.param );
+   }
+}
+
+// The last RX descriptor is the only one with terminal count interrupt: all
+// bytes have been shifted in both directions when it arrives
+static void spiDmaRxCallback( uint8_t channel, bool_t ok, void* param )
+{
+   if( spiDma.busy ) {
+      spiDmaFinish( ok );
+   }
+}
+
+// TX descriptors have no terminal count interrupt, only errors arrive here
+static void spiDmaTxCallback( uint8_t channel, bool_t ok, void* param )
+{
+   if( spiDma.busy && !ok ) {
+      spiDmaFinish( FALSE );
+   }
+}
+
+// Build the TX and RX descriptor lists. Returns the number of descriptors
+// of each list or 0 if they do not fit
+static uint8_t spiDmaBuildLists( const spiSegment_t* segments,
+                                 uint8_t segmentsAmount )
+{
+   uint32_t count = 0;
+   uint8_t n = 0;
+   uint8_t i = 0;
+   uint32_t offset = 0;
+   uint32_t chunk = 0;
+
+   // Descriptors needed, rejected as soon as they do not fit so a large
+   // segment can not wrap the sum
+   for( i=0; i<segmentsAmount; i++ ) {
+      count += segments[i].size / DMA_MAX_TRANSFER_SIZE +
+               ( segments[i].size % DMA_MAX_TRANSFER_SIZE != 0 );
+      if( count > SPI_DMA_MAX_DESCRIPTORS ) {
+         return 0;
+      }
+   }
+   if( count == 0 ) {
+      return 0;
+   }
+
+   for( i=0; i<segmentsAmount; i++ ) {
+      for( offset=0; offset<segments[i].size; offset+=chunk ) {
+         bool_t last = ( n + 1U == count );
+         chunk = segments[i].size - offset;
+         if( chunk > DMA_MAX_TRANSFER_SIZE ) {
+            chunk = DMA_MAX_TRANSFER_SIZE;
+         }
+
+         Chip_GPDMA_PrepareDescriptor( LPC_GPDMA, &spiDma.txList[n],
+            segments[i].txBuffer ? (uint32_t) &segments[i].txBuffer[offset]
+                                 : (uint32_t) &spiDmaDummyTx,
+            GPDMA_CONN_SSP1_Tx, chunk, GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA,
+            last ? NULL : &spiDma.txList[n + 1] );
+         Chip_GPDMA_PrepareDescriptor( LPC_GPDMA, &spiDma.rxList[n],
+            GPDMA_CONN_SSP1_Rx,
+            segments[i].rxBuffer ? (uint32_t) &segments[i].rxBuffer[offset]
+                                 : (uint32_t) &spiDmaDummyRx,
+            chunk, GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA,
+            last ? NULL : &spiDma.rxList[n + 1] );
+
+         spiDma.txList[n].ctrl &= ~GPDMA_DMACCxControl_I;
+         if( segments[i].txBuffer == NULL ) {
+            spiDma.txList[n].ctrl &= ~GPDMA_DMACCxControl_SI;
+         }
+         if( segments[i].rxBuffer == NULL ) {
+            spiDma.rxList[n].ctrl &= ~GPDMA_DMACCxControl_DI;
+         }
+         n++;
+      }
+   }
+
+   return count;
+}
+
 /*==================[external functions definition]==========================*/
 
 bool_t spiInit( spiMap_t spi )
@@ -145,6 +249,89 @@ bool_t spiWrite( spiMap_t spi, uint8_t* buffer, uint32_t bufferSize)
 }
 
 
+bool_t spiDmaInit( spiMap_t spi )
+{
+   if( spi != SPI0 ) {
+      return FALSE;
+   }
+   if( spiDma.rxChannel >= 0 ) {
+      return TRUE;
+   }
+
+   dmaInit();
+   spiDma.rxChannel = dmaChannelAlloc( GPDMA_CONN_SSP1_Rx, spiDmaRxCallback,
+                                       NULL );
+   spiDma.txChannel = dmaChannelAlloc( GPDMA_CONN_SSP1_Tx, spiDmaTxCallback,
+                                       NULL );
+   if( (spiDma.rxChannel < 0) || (spiDma.txChannel < 0) ) {
+      if( spiDma.rxChannel >= 0 ) {
+         dmaChannelFree( spiDma.rxChannel );
+      }
+      if( spiDma.txChannel >= 0 ) {
+         dmaChannelFree( spiDma.txChannel );
+      }
+      spiDma.rxChannel = -1;
+      spiDma.txChannel = -1;
+      return FALSE;
+   }
+
+   return TRUE;
+}
+
+
+bool_t spiTransferStart( spiMap_t spi,
+                         const spiSegment_t* segments, uint8_t segmentsAmount,
+                         spiCallback_t callback, void* param )
+{
+   if( (spi != SPI0) || (spiDma.rxChannel < 0) || spiDma.busy ) {
+      return FALSE;
+   }
+   if( spiDmaBuildLists( segments, segmentsAmount ) == 0 ) {
+      return FALSE;
+   }
+
+   spiDma.callback = callback;
+   spiDma.param    = param;
+   spiDma.busy     = TRUE;
+
+   // Discard stale bytes and start RX first so no byte is lost
+   Chip_SSP_Int_FlushData( LPC_SSP1 );
+   Chip_SSP_DMA_Enable( LPC_SSP1 );
+   if( !dmaStart( spiDma.rxChannel, &spiDma.rxList[0], GPDMA_CONN_SSP1_Rx,
+                  GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA ) ||
+       !dmaStart( spiDma.txChannel, &spiDma.txList[0], GPDMA_CONN_SSP1_Tx,
+                  GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA ) ) {
+      dmaStop( spiDma.txChannel );
+      dmaStop( spiDma.rxChannel );
+      Chip_SSP_DMA_Disable( LPC_SSP1 );
+      spiDma.busy = FALSE;
+      return FALSE;
+   }
+
+   return TRUE;
+}
+
+
+bool_t spiTransferBusy( spiMap_t spi )
+{
+   return (spi == SPI0) && spiDma.busy;
+}
+
+
+bool_t spiTransfer( spiMap_t spi, const uint8_t* txBuffer, uint8_t* rxBuffer,
+                    uint32_t size )
+{
+   spiSegment_t segment = { txBuffer, rxBuffer, size };
+
+   if( !spiTransferStart( spi, &segment, 1, NULL, NULL ) ) {
+      return FALSE;
+   }
+   while( spiTransferBusy( spi ) );
+
+   return spiDma.ok;
+}
+
+
 /*==================[ISR external functions definition]======================*/
 
 
@@ -245,9 +245,11 @@ void TIMER0_IRQHandler(void)
         compareMatchNumber <= TIMERCOMPAREMATCH3;
         compareMatchNumber++ ) {
       if( Chip_TIMER_MatchPending(LPC_TIMER0, compareMatchNumber) ) {
+         // Cleared first: a match the function programs again (stop on
+         // match, short delay) can fire before it returns
+         Chip_TIMER_ClearMatch(LPC_TIMER0, compareMatchNumber);
          /*Run the functions saved in the timer dynamic data structure*/
          (*timer_dd[TIMER0].timerCompareMatchFunctionPointer[compareMatchNumber])(0);
-         Chip_TIMER_ClearMatch(LPC_TIMER0, compareMatchNumber);
       }
    }
 }
@@ -261,9 +263,11 @@ void TIMER1_IRQHandler( void )
         compareMatchNumber <= TIMERCOMPAREMATCH3;
         compareMatchNumber++ ) {
       if( Chip_TIMER_MatchPending(LPC_TIMER1, compareMatchNumber) ) {
+         // Cleared first: a match the function programs again (stop on
+         // match, short delay) can fire before it returns
+         Chip_TIMER_ClearMatch(LPC_TIMER1, compareMatchNumber);
          /*Run the functions saved in the timer dynamic data structure*/
          (*timer_dd[TIMER1].timerCompareMatchFunctionPointer[compareMatchNumber])(0);
-         Chip_TIMER_ClearMatch(LPC_TIMER1, compareMatchNumber);
       }
    }
 }
@@ -276,9 +280,11 @@ void TIMER2_IRQHandler( void )
         compareMatchNumber <= TIMERCOMPAREMATCH3;
         compareMatchNumber++ ) {
       if( Chip_TIMER_MatchPending(LPC_TIMER2, compareMatchNumber) ) {
+         // Cleared first: a match the function programs again (stop on
+         // match, short delay) can fire before it returns
+         Chip_TIMER_ClearMatch(LPC_TIMER2, compareMatchNumber);
          /*Run the functions saved in the timer dynamic data structure*/
          (*timer_dd[TIMER2].timerCompareMatchFunctionPointer[compareMatchNumber])(0);
-         Chip_TIMER_ClearMatch(LPC_TIMER2, compareMatchNumber);
       }
    }
 }
@@ -293,9 +299,11 @@ void TIMER3_IRQHandler( void )
         compareMatchNumber <= TIMERCOMPAREMATCH3;
         compareMatchNumber++ ) {
       if (Chip_TIMER_MatchPending(LPC_TIMER3, compareMatchNumber)) {
+         // Cleared first: a match the function programs again (stop on
+         // match, short delay) can fire before it returns
+         Chip_TIMER_ClearMatch(LPC_TIMER3, compareMatchNumber);
          /*Run the functions saved in the timer dynamic data structure*/
          (*timer_dd[TIMER3].timerCompareMatchFunctionPointer[compareMatchNumber])(0);
-         Chip_TIMER_ClearMatch(LPC_TIMER3, compareMatchNumber);
       }
    }
 }